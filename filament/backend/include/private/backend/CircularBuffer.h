@@ -42,7 +42,7 @@ public:
 
     static size_t getBlockSize() noexcept { return sPageSize; }
 
-    // Total size of circular buffer. This is a constant.
+    // Total size of circular buffer. This only changes with resize().
     size_t size() const noexcept { return mSize; }
 
     // Allocates `s` bytes in the circular buffer and returns a pointer to the memory. All
@@ -71,16 +71,34 @@ public:
     };
     Range getBuffer() noexcept;
 
+    // Memory backing a circular buffer.
+    struct Storage {
+        void* data = nullptr;
+        size_t size = 0;
+        int ashmemFd = -1;
+        bool contains(void const* p) const noexcept {
+            return p >= data && p < static_cast<char const*>(data) + size;
+        }
+    };
+
+    // Replaces the memory of an empty buffer (i.e.: right after getBuffer()) with a new one of
+    // the given size. The previous memory is returned, because the ranges retrieved with
+    // getBuffer() still point to it. It must be freed with release() once they're no longer
+    // in use.
+    Storage resize(size_t bufferSize);
+
+    static void release(Storage const& storage) noexcept;
+
 private:
     void* alloc(size_t size) noexcept;
     void dealloc() noexcept;
 
-    // pointer to the beginning of the circular buffer (constant)
+    // pointer to the beginning of the circular buffer
     void* mData = nullptr;
     int mAshmemFd = -1;
 
-    // size of the circular buffer (constant)
-    size_t const mSize;
+    // size of the circular buffer
+    size_t mSize;
 
     // pointer to the beginning of recorded data
     void* mTail = nullptr;
@@ -30,7 +30,11 @@
 namespace filament::backend {
 
 /*
- * A producer-consumer command queue that uses a CircularBuffer as main storage
+ * A producer-consumer command queue that uses a CircularBuffer as main storage.
+ *
+ * When flush() would have to wait for the consumer, the CircularBuffer is replaced by a larger
+ * one instead (up to maxBufferSize), and it goes back to its initial size once that size has
+ * been sufficient for SHRINK_FLUSH_COUNT consecutive flushes.
  */
 class CommandBufferQueue {
     struct Range {
@@ -38,7 +42,17 @@ class CommandBufferQueue {
         void* end;
     };
 
+    // a CircularBuffer storage that was replaced, but still holds commands to execute
+    struct RetiredBuffer {
+        CircularBuffer::Storage storage;
+        size_t used;
+    };
+
+    static constexpr uint32_t SHRINK_FLUSH_COUNT = 600;
+
     const size_t mRequiredSize;
+    const size_t mInitialSize;
+    const size_t mMaxSize;
 
     CircularBuffer mCircularBuffer;
 
@@ -47,16 +61,24 @@ class CommandBufferQueue {
     mutable utils::Mutex mLock;
     mutable utils::Condition mCondition;
     mutable std::vector<Range> mCommandBuffersToExecute;
+    std::vector<RetiredBuffer> mRetiredBuffers;
     size_t mFreeSpace = 0;
     size_t mHighWatermark = 0;
+    size_t mRecentHighWatermark = 0;
+    uint32_t mQuietFlushCount = 0;
     uint32_t mExitRequested = 0;
     bool mPaused = false;
 
     static constexpr uint32_t EXIT_REQUESTED = 0x31415926;
 
+    // must be called from the producer thread, with the lock held
+    void resize(std::unique_lock<utils::Mutex>& lock, size_t bufferSize);
+
 public:
     // requiredSize: guaranteed available space after flush()
-    CommandBufferQueue(size_t requiredSize, size_t bufferSize, bool paused);
+    // maxBufferSize: size up to which the buffer can grow, no growth if smaller than bufferSize
+    CommandBufferQueue(size_t requiredSize, size_t bufferSize, bool paused,
+            size_t maxBufferSize = 0);
     ~CommandBufferQueue();
 
     CircularBuffer& getCircularBuffer() noexcept { return mCircularBuffer; }
@@ -64,8 +86,14 @@ public:
 
     size_t getCapacity() const noexcept { return mRequiredSize; }
 
+    // current size of the circular buffer
+    size_t getBufferSize() const noexcept { return mCircularBuffer.size(); }
+
     size_t getHighWatermark() const noexcept { return mHighWatermark; }
 
+    // largest amount of memory used by commands since the last call to this method
+    size_t takeRecentHighWatermark() noexcept;
+
     // wait for commands to be available and returns an array containing these commands
     std::vector<Range> waitForCommands() const;
 
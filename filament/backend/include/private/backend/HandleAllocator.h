@@ -22,6 +22,7 @@
 #include <utils/Allocator.h>
 #include <utils/CString.h>
 #include <utils/Log.h>
+#include <utils/Mutex.h>
 #include <utils/Panic.h>
 #include <utils/compiler.h>
 #include <utils/debug.h>
@@ -29,11 +30,14 @@
 
 #include <tsl/robin_map.h>
 
+#include <array>
+#include <atomic>
 #include <cstddef>
 #include <exception>
 #include <type_traits>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include <stddef.h>
 #include <stdint.h>
@@ -254,58 +258,106 @@ private:
         Pool<P1> mPool1;
         Pool<P2> mPool2;
         UTILS_UNUSED_IN_RELEASE const utils::AreaPolicy::HeapArea& mArea;
-        bool mUseAfterFreeCheckDisabled;
     public:
-        explicit Allocator(const utils::AreaPolicy::HeapArea& area, bool disableUseAfterFreeCheck);
+        explicit Allocator(const utils::AreaPolicy::HeapArea& area);
 
         static constexpr size_t getAlignment() noexcept { return MIN_ALIGNMENT; }
 
         // this is in fact always called with a constexpr size argument
-        [[nodiscard]] inline void* alloc(size_t size, size_t, size_t, uint8_t* outAge) noexcept {
+        [[nodiscard]] inline void* alloc(size_t size, size_t, size_t) noexcept {
             void* p = nullptr;
             if      (size <= mPool0.getSize()) p = mPool0.alloc(size);
             else if (size <= mPool1.getSize()) p = mPool1.alloc(size);
             else if (size <= mPool2.getSize()) p = mPool2.alloc(size);
-            if (UTILS_LIKELY(p)) {
-                Node const* const pNode = static_cast<Node const*>(p);
-                // we are guaranteed to have at least sizeof<Node> bytes of extra storage before
-                // the allocation address.
-                *outAge = pNode[-1].age;
-            }
             return p;
         }
 
-        // this is in fact always called with a constexpr size argument
-        inline void free(void* p, size_t size, uint8_t age) noexcept {
+        // Returns a block to its pool. The block's age must already have been advanced by
+        // HandleAllocator::retire().
+        inline void free(void* p, size_t size) noexcept {
             assert_invariant(p >= mArea.begin() && (char*)p + size <= (char*)mArea.end());
-
-            // check for double-free
-            Node* const pNode = static_cast<Node*>(p);
-            uint8_t& expectedAge = pNode[-1].age;
-            if (UTILS_UNLIKELY(!mUseAfterFreeCheckDisabled)) {
-                FILAMENT_CHECK_POSTCONDITION(expectedAge == age) <<
-                        "double-free of Handle of size " << size << " at " << p;
-            }
-            expectedAge = (expectedAge + 1) & 0xF; // fixme
-
             if (size <= mPool0.getSize()) { mPool0.free(p); return; }
             if (size <= mPool1.getSize()) { mPool1.free(p); return; }
             if (size <= mPool2.getSize()) { mPool2.free(p); return; }
         }
     };
 
-// FIXME: We should be using a Spinlock here, at least on platforms where mutexes are not
-//        efficient (i.e. non-Linux). However, we've seen some hangs on that spinlock, which
-//        we don't understand well (b/308029108).
+    // Arenas are only accessed in batches, under the lock of their Tier.
 #ifndef NDEBUG
     using HandleArena = utils::Arena<Allocator,
-            utils::LockingPolicy::Mutex,
+            utils::LockingPolicy::NoLock,
             utils::TrackingPolicy::DebugAndHighWatermark>;
 #else
     using HandleArena = utils::Arena<Allocator,
-            utils::LockingPolicy::Mutex>;
+            utils::LockingPolicy::NoLock>;
 #endif
 
+    // The primary tier is sized by the driver's configuration. When it is full, secondary tiers of
+    // the same size are added; their handles have HANDLE_TIER_FLAG set and an index that spans
+    // all secondary tiers, so that finding the tier of a handle is a division.
+    struct Tier {
+        Tier(const char* name, size_t size, uint32_t firstIndex) noexcept
+                : arena(name, size), firstIndex(firstIndex) {
+        }
+        HandleArena arena;
+// FIXME: We should be using a Spinlock here, at least on platforms where mutexes are not
+//        efficient (i.e. non-Linux). However, we've seen some hangs on that spinlock, which
+//        we don't understand well (b/308029108).
+        utils::Mutex lock;
+        const uint32_t firstIndex;
+    };
+
+    // Handles are allocated from, and freed to, per-thread magazines of ids, which are refilled
+    // from or returned to the tiers MAGAZINE_BATCH ids at a time. This way the tier locks are
+    // only taken once per batch, even when handles are always allocated by one thread and freed
+    // by another, as is the case with DriverApi.
+    static constexpr uint32_t MAGAZINE_CAPACITY = 64;
+    static constexpr uint32_t MAGAZINE_BATCH = MAGAZINE_CAPACITY / 2;
+
+    struct Magazine {
+        uint32_t count = 0;
+        HandleBase::HandleId ids[MAGAZINE_CAPACITY];    // without their age
+    };
+
+    // A thread can use a few allocators of the same type without flushing their magazines, for
+    // instance when several Engines are driven from the same thread. The least recently used one
+    // is flushed to make room for another.
+    static constexpr size_t THREAD_CACHE_ENTRY_COUNT = 4;
+
+    struct ThreadCache {
+        ~ThreadCache() noexcept;
+        struct Entry {
+            HandleAllocator* owner = nullptr;
+            uint32_t lastUse = 0;
+            Magazine magazines[3];                      // one per pool
+        };
+        Entry entries[THREAD_CACHE_ENTRY_COUNT];
+        uint32_t current = 0;                           // entry of the last allocator used
+        uint32_t clock = 0;
+    };
+
+    static ThreadCache& getThreadCache() noexcept {
+        static thread_local ThreadCache cache;
+        return cache;
+    }
+
+    // returns this allocator's magazines for the calling thread
+    Magazine* getMagazines() noexcept {
+        ThreadCache& cache = getThreadCache();
+        typename ThreadCache::Entry& entry = cache.entries[cache.current];
+        if (UTILS_UNLIKELY(entry.owner != this)) {
+            return attachThreadCache(cache);
+        }
+        return entry.magazines;
+    }
+
+    template<size_t SIZE>
+    static constexpr size_t getPoolIndex() noexcept {
+        if constexpr (SIZE == P0) { return 0; }
+        if constexpr (SIZE == P1) { return 1; }
+        return 2;
+    }
+
     // allocateHandle()/deallocateHandle() selects the pool to use at compile-time based on the
     // allocation size this is always inlined, because all these do is to call
     // allocateHandleInPool()/deallocateHandleFromPool() with the right pool size.
@@ -322,80 +374,113 @@ private:
     }
 
     // allocateHandleInPool()/deallocateHandleFromPool() is NOT inlined, which will cause three
-    // versions to be generated, one for each pool. Because the arena is synchronized,
-    // the code generated is not trivial (even if it's not insane either).
+    // versions to be generated, one for each pool. In the common case, they only touch the
+    // calling thread's magazine.
     template<size_t SIZE>
     UTILS_NOINLINE
     HandleBase::HandleId allocateHandleInPool() noexcept {
-        uint8_t age;
-        void* p = mHandleArena.alloc(SIZE, alignof(std::max_align_t), 0, &age);
-        if (UTILS_LIKELY(p)) {
-            uint32_t const tag = (uint32_t(age) << HANDLE_AGE_SHIFT) & HANDLE_AGE_MASK;
-            return arenaPointerToHandle(p, tag);
-        } else {
-            return allocateHandleSlow(SIZE);
+        Magazine& magazine = getMagazines()[getPoolIndex<SIZE>()];
+        if (UTILS_UNLIKELY(magazine.count == 0)) {
+            refill(magazine, SIZE);
         }
+        HandleBase::HandleId const id = magazine.ids[--magazine.count];
+        auto const pNode = static_cast<typename Allocator::Node*>(handleToPointer(id).first);
+        uint32_t const tag = (uint32_t(pNode[-1].age) << HANDLE_AGE_SHIFT) & HANDLE_AGE_MASK;
+        return id | tag;
     }
 
     template<size_t SIZE>
     UTILS_NOINLINE
     void deallocateHandleFromPool(HandleBase::HandleId id) noexcept {
-        if (UTILS_LIKELY(isPoolHandle(id))) {
-            auto [p, tag] = handleToPointer(id);
-            uint8_t const age = (tag & HANDLE_AGE_MASK) >> HANDLE_AGE_SHIFT;
-            mHandleArena.free(p, SIZE, age);
-        } else {
-            deallocateHandleSlow(id, SIZE);
+        auto [p, tag] = handleToPointer(id);
+        retire(p, SIZE, uint8_t((tag & HANDLE_AGE_MASK) >> HANDLE_AGE_SHIFT));
+        Magazine& magazine = getMagazines()[getPoolIndex<SIZE>()];
+        if (UTILS_UNLIKELY(magazine.count == MAGAZINE_CAPACITY)) {
+            flush(magazine, SIZE, MAGAZINE_BATCH);
         }
+        magazine.ids[magazine.count++] = id & ~HANDLE_AGE_MASK;
     }
 
+    // Checks for double-free and advances the age of a block, which invalidates the handles that
+    // refer to it.
+    void retire(void* p, size_t size, uint8_t age) noexcept {
+        auto const pNode = static_cast<typename Allocator::Node*>(p);
+        uint8_t& expectedAge = pNode[-1].age;
+        if (UTILS_UNLIKELY(!mUseAfterFreeCheckDisabled)) {
+            FILAMENT_CHECK_POSTCONDITION(expectedAge == age) <<
+                    "double-free of Handle of size " << size << " at " << p;
+        }
+        expectedAge = (expectedAge + 1) & 0xF; // fixme
+    }
+
+    Magazine* attachThreadCache(ThreadCache& cache) noexcept;
+    void detachThreadCache(ThreadCache& cache, typename ThreadCache::Entry& entry) noexcept;
+    void refill(Magazine& magazine, size_t size);
+    void flush(Magazine& magazine, size_t size, size_t count) noexcept;
+    void fill(Tier& tier, Magazine& magazine, size_t size, uint32_t flag) noexcept;
+    Tier* grow(size_t expectedTierCount);
+
     // we handle a 4 bits age per address
-    static constexpr uint32_t HANDLE_HEAP_FLAG      = 0x80000000u;      // pool vs heap handle
+    static constexpr uint32_t HANDLE_TIER_FLAG      = 0x80000000u;      // primary vs secondary
     static constexpr uint32_t HANDLE_AGE_MASK       = 0x78000000u;      // handle's age
     static constexpr uint32_t HANDLE_INDEX_MASK     = 0x07FFFFFFu;      // handle index
     static constexpr uint32_t HANDLE_TAG_MASK       = HANDLE_AGE_MASK;
     static constexpr uint32_t HANDLE_AGE_SHIFT      = 27;
+    static constexpr size_t MAX_TIER_COUNT = 64;
 
+    // all handles come from a pool, except the null handle
     static bool isPoolHandle(HandleBase::HandleId id) noexcept {
-        return (id & HANDLE_HEAP_FLAG) == 0u;
+        return id != HandleBase::nullid;
     }
 
-    HandleBase::HandleId allocateHandleSlow(size_t size);
-    void deallocateHandleSlow(HandleBase::HandleId id, size_t size) noexcept;
+    Tier* getTier(HandleBase::HandleId id) const noexcept {
+        if (!(id & HANDLE_TIER_FLAG)) {
+            return const_cast<Tier*>(&mPrimary);
+        }
+        size_t const index = (id & HANDLE_INDEX_MASK) / mTierIndexCount;
+        return index < MAX_TIER_COUNT ? mTiers[index].load(std::memory_order_acquire) : nullptr;
+    }
 
     // We inline this because it's just 4 instructions in the fast case
     inline std::pair<void*, uint32_t> handleToPointer(HandleBase::HandleId id) const noexcept {
-        // note: the null handle will end-up returning nullptr b/c it'll be handled as
-        // a non-pool handle.
-        if (UTILS_LIKELY(isPoolHandle(id))) {
-            char* const base = (char*)mHandleArena.getArea().begin();
-            uint32_t const tag = id & HANDLE_TAG_MASK;
+        uint32_t const tag = id & HANDLE_TAG_MASK;
+        if (UTILS_LIKELY(!(id & HANDLE_TIER_FLAG))) {
+            char* const base = (char*)mPrimary.arena.getArea().begin();
             size_t const offset = (id & HANDLE_INDEX_MASK) * Allocator::getAlignment();
             return { static_cast<void*>(base + offset), tag };
         }
-        return { handleToPointerSlow(id), 0 };
+        // note: the null handle ends-up here and returns nullptr
+        return { handleToPointerSlow(id), tag };
     }
 
     void* handleToPointerSlow(HandleBase::HandleId id) const noexcept;
 
     // We inline this because it's just 3 instructions
-    inline HandleBase::HandleId arenaPointerToHandle(void* p, uint32_t tag) const noexcept {
-        char* const base = (char*)mHandleArena.getArea().begin();
+    static inline HandleBase::HandleId arenaPointerToHandle(
+            Tier const& tier, void* p, uint32_t flag) noexcept {
+        char* const base = (char*)tier.arena.getArea().begin();
         size_t const offset = (char*)p - base;
         assert_invariant((offset % Allocator::getAlignment()) == 0);
-        auto id = HandleBase::HandleId(offset / Allocator::getAlignment());
-        id |= tag & HANDLE_TAG_MASK;
-        assert_invariant((id & HANDLE_HEAP_FLAG) == 0);
-        return id;
+        auto id = HandleBase::HandleId(tier.firstIndex + offset / Allocator::getAlignment());
+        assert_invariant((id & ~HANDLE_INDEX_MASK) == 0);
+        return id | flag;
     }
 
-    HandleArena mHandleArena;
+    const char* const mName;
+    Tier mPrimary;
+
+    // Secondary tiers are only ever added, so they can be looked up without locking.
+    std::array<std::atomic<Tier*>, MAX_TIER_COUNT> mTiers{};
+    std::atomic<size_t> mTierCount{ 0 };
+    size_t mTierIndexCount = 0;     // number of handle indices of each secondary tier
+    size_t mMaxTierCount = 0;       // limited by HANDLE_INDEX_MASK
+    utils::Mutex mTierLock;
+
+    // thread caches currently attached to this allocator, protected by getRegistryLock()
+    std::vector<ThreadCache*> mThreadCaches;
+    static utils::Mutex& getRegistryLock() noexcept;
 
-    // Below is only used when running out of space in the HandleArena
-    mutable utils::Mutex mLock;
-    tsl::robin_map<HandleBase::HandleId, void*> mOverflowMap;
     tsl::robin_map<HandleBase::HandleId, utils::CString> mDebugTags;
-    HandleBase::HandleId mId = 0;
     bool mUseAfterFreeCheckDisabled = false;
 };
 
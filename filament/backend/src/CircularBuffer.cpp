@@ -141,19 +141,34 @@ void* CircularBuffer::alloc(size_t size) noexcept {
 
 UTILS_NOINLINE
 void CircularBuffer::dealloc() noexcept {
+    release({ .data = mData, .size = mSize, .ashmemFd = mAshmemFd });
+    mData = nullptr;
+    mAshmemFd = -1;
+}
+
+void CircularBuffer::release(Storage const& storage) noexcept {
 #if HAS_MMAP
-    if (mData) {
+    if (storage.data) {
         size_t const BLOCK_SIZE = getBlockSize();
-        munmap(mData, mSize * 2 + BLOCK_SIZE);
-        if (mAshmemFd >= 0) {
-            close(mAshmemFd);
-            mAshmemFd = -1;
+        munmap(storage.data, storage.size * 2 + BLOCK_SIZE);
+        if (storage.ashmemFd >= 0) {
+            close(storage.ashmemFd);
         }
     }
 #else
-    ::free(mData);
+    ::free(storage.data);
 #endif
-    mData = nullptr;
+}
+
+CircularBuffer::Storage CircularBuffer::resize(size_t bufferSize) {
+    assert_invariant(empty());
+    Storage const previous{ .data = mData, .size = mSize, .ashmemFd = mAshmemFd };
+    mAshmemFd = -1;
+    mSize = bufferSize;
+    mData = alloc(bufferSize);
+    mTail = mData;
+    mHead = mData;
+    return previous;
 }
 
 
@@ -39,8 +39,11 @@ using namespace utils;
 
 namespace filament::backend {
 
-CommandBufferQueue::CommandBufferQueue(size_t requiredSize, size_t bufferSize, bool paused)
+CommandBufferQueue::CommandBufferQueue(size_t requiredSize, size_t bufferSize, bool paused,
+        size_t maxBufferSize)
         : mRequiredSize((requiredSize + (CircularBuffer::getBlockSize() - 1u)) & ~(CircularBuffer::getBlockSize() -1u)),
+          mInitialSize(bufferSize),
+          mMaxSize(std::max(bufferSize, maxBufferSize)),
           mCircularBuffer(bufferSize),
           mFreeSpace(mCircularBuffer.size()),
           mPaused(paused) {
@@ -49,6 +52,9 @@ CommandBufferQueue::CommandBufferQueue(size_t requiredSize, size_t bufferSize, b
 
 CommandBufferQueue::~CommandBufferQueue() {
     assert_invariant(mCommandBuffersToExecute.empty());
+    for (auto const& retired : mRetiredBuffers) {
+        CircularBuffer::release(retired.storage);
+    }
 }
 
 void CommandBufferQueue::requestExit() {
@@ -115,18 +121,40 @@ void CommandBufferQueue::flush() noexcept {
     mCommandBuffersToExecute.push_back({ begin, end });
     mCondition.notify_one();
 
+    size_t totalUsed = circularBuffer.size() - mFreeSpace;
+    for (auto const& retired : mRetiredBuffers) {
+        totalUsed += retired.used;
+    }
+    mHighWatermark = std::max(mHighWatermark, totalUsed);
+    mRecentHighWatermark = std::max(mRecentHighWatermark, totalUsed);
+
+    size_t const bufferSize = circularBuffer.size();
+    if (UTILS_UNLIKELY(mFreeSpace < requiredSize && bufferSize < mMaxSize)) {
+        // grow the buffer rather than waiting for the consumer
+        size_t const blockSize = CircularBuffer::getBlockSize();
+        size_t const newSize = (std::min(bufferSize * 2, mMaxSize) + blockSize - 1) & ~(blockSize - 1);
+        slog.i << "CommandStream buffer grows to " << newSize / 1024 << " KiB" << io::endl;
+        resize(lock, newSize);
+        mQuietFlushCount = 0;
+    } else if (UTILS_UNLIKELY(bufferSize > mInitialSize)) {
+        // shrink back once the initial size has been sufficient for a while
+        if (totalUsed + requiredSize > mInitialSize) {
+            mQuietFlushCount = 0;
+        } else if (++mQuietFlushCount >= SHRINK_FLUSH_COUNT) {
+            resize(lock, mInitialSize);
+            mQuietFlushCount = 0;
+        }
+    }
+
     // wait until there is enough space in the buffer
     if (UTILS_UNLIKELY(mFreeSpace < requiredSize)) {
 
 #ifndef NDEBUG
-        size_t const totalUsed = circularBuffer.size() - mFreeSpace;
         slog.d << "CommandStream used too much space (will block): "
                 << "needed space " << requiredSize << " out of " << mFreeSpace
                 << ", totalUsed=" << totalUsed << ", current=" << used
                 << ", queue size=" << mCommandBuffersToExecute.size() << " buffers"
                 << io::endl;
-
-        mHighWatermark = std::max(mHighWatermark, totalUsed);
 #endif
 
         SYSTRACE_NAME("waiting: CircularBuffer::flush()");
@@ -156,9 +184,46 @@ std::vector<CommandBufferQueue::Range> CommandBufferQueue::waitForCommands() con
 void CommandBufferQueue::releaseBuffer(CommandBufferQueue::Range const& buffer) {
     size_t const used = std::distance(
             static_cast<char const*>(buffer.begin), static_cast<char const*>(buffer.end));
-    std::lock_guard<utils::Mutex> const lock(mLock);
-    mFreeSpace += used;
+    CircularBuffer::Storage unused;
+    std::unique_lock<utils::Mutex> lock(mLock);
+    // buffers are released in order, so only the oldest retired storage can hold this one
+    if (!mRetiredBuffers.empty() && mRetiredBuffers.front().storage.contains(buffer.begin)) {
+        RetiredBuffer& retired = mRetiredBuffers.front();
+        assert_invariant(retired.used >= used);
+        retired.used -= used;
+        if (retired.used == 0) {
+            unused = retired.storage;
+            mRetiredBuffers.erase(mRetiredBuffers.begin());
+        }
+    } else {
+        mFreeSpace += used;
+    }
     mCondition.notify_one();
+    lock.unlock();
+    CircularBuffer::release(unused);
+}
+
+void CommandBufferQueue::resize(std::unique_lock<utils::Mutex>& lock, size_t bufferSize) {
+    SYSTRACE_CALL();
+    // The consumer never accesses mCircularBuffer, so the new storage can be allocated without
+    // holding the lock; only the accounting of the free space needs it.
+    lock.unlock();
+    CircularBuffer::Storage const previous = mCircularBuffer.resize(bufferSize);
+    lock.lock();
+
+    // all the space in use belongs to the previous storage at this point
+    size_t const used = previous.size - mFreeSpace;
+    mFreeSpace = mCircularBuffer.size();
+    if (used) {
+        mRetiredBuffers.push_back({ previous, used });
+    } else {
+        CircularBuffer::release(previous);
+    }
+}
+
+size_t CommandBufferQueue::takeRecentHighWatermark() noexcept {
+    std::lock_guard<utils::Mutex> const lock(mLock);
+    return std::exchange(mRecentHighWatermark, 0);
 }
 
 } // namespace filament::backend
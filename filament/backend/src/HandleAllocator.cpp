@@ -39,10 +39,8 @@ using namespace utils;
 
 template <size_t P0, size_t P1, size_t P2>
 UTILS_NOINLINE
-HandleAllocator<P0, P1, P2>::Allocator::Allocator(AreaPolicy::HeapArea const& area,
-        bool disableUseAfterFreeCheck)
-        : mArea(area),
-          mUseAfterFreeCheckDisabled(disableUseAfterFreeCheck) {
+HandleAllocator<P0, P1, P2>::Allocator::Allocator(AreaPolicy::HeapArea const& area)
+        : mArea(area) {
 
     // The largest handle this allocator can generate currently depends on the architecture's
     // min alignment, typically 8 or 16 bytes.
@@ -78,8 +76,15 @@ HandleAllocator<P0, P1, P2>::Allocator::Allocator(AreaPolicy::HeapArea const& ar
 template <size_t P0, size_t P1, size_t P2>
 HandleAllocator<P0, P1, P2>::HandleAllocator(const char* name, size_t size,
         bool disableUseAfterFreeCheck) noexcept
-    : mHandleArena(name, size, disableUseAfterFreeCheck),
+    : mName(name),
+      mPrimary(name, size, 0),
       mUseAfterFreeCheckDisabled(disableUseAfterFreeCheck) {
+    // Secondary tiers have the size of the primary tier, and all their handle indices must be
+    // representable (and different from the null handle's).
+    size_t const usableSize = std::min(size, HANDLE_INDEX_MASK * Allocator::getAlignment());
+    mTierIndexCount = std::max(size_t(1), usableSize / Allocator::getAlignment());
+    mMaxTierCount = std::min(MAX_TIER_COUNT, HANDLE_INDEX_MASK / mTierIndexCount);
+
     // Reserve initial space for debug tags. This prevents excessive calls to malloc when the first
     // few tags are set.
     mDebugTags.reserve(512);
@@ -87,64 +92,197 @@ HandleAllocator<P0, P1, P2>::HandleAllocator(const char* name, size_t size,
 
 template <size_t P0, size_t P1, size_t P2>
 HandleAllocator<P0, P1, P2>::~HandleAllocator() {
-    auto& overflowMap = mOverflowMap;
-    if (!overflowMap.empty()) {
-        PANIC_LOG("Not all handles have been freed. Probably leaking memory.");
-        // Free remaining handle memory
-        for (auto& entry : overflowMap) {
-            ::free(entry.second);
+    {
+        // The thread caches still attached to us just forget their handles, which belong to
+        // the arenas we're about to destroy.
+        std::lock_guard const registryLock(getRegistryLock());
+        for (ThreadCache* const cache : mThreadCaches) {
+            for (auto& entry : cache->entries) {
+                if (entry.owner == this) {
+                    entry.owner = nullptr;
+                    for (Magazine& magazine : entry.magazines) {
+                        magazine.count = 0;
+                    }
+                }
+            }
         }
+        mThreadCaches.clear();
+    }
+    for (size_t i = 0, c = mTierCount.load(std::memory_order_relaxed); i < c; i++) {
+        delete mTiers[i].load(std::memory_order_relaxed);
     }
 }
 
 template <size_t P0, size_t P1, size_t P2>
 UTILS_NOINLINE
 void* HandleAllocator<P0, P1, P2>::handleToPointerSlow(HandleBase::HandleId id) const noexcept {
-    auto& overflowMap = mOverflowMap;
-    std::lock_guard lock(mLock);
-    auto pos = overflowMap.find(id);
-    if (pos != overflowMap.end()) {
-        return pos.value();
+    if (UTILS_UNLIKELY(id == HandleBase::nullid)) {
+        return nullptr;
+    }
+    Tier const* const tier = getTier(id);
+    if (UTILS_UNLIKELY(!tier)) {
+        return nullptr;
+    }
+    char* const base = (char*)tier->arena.getArea().begin();
+    size_t const offset = ((id & HANDLE_INDEX_MASK) - tier->firstIndex) * Allocator::getAlignment();
+    return static_cast<void*>(base + offset);
+}
+
+template <size_t P0, size_t P1, size_t P2>
+UTILS_NOINLINE
+Mutex& HandleAllocator<P0, P1, P2>::getRegistryLock() noexcept {
+    // this is intentionally leaked, thread caches can be destroyed after static destructors ran
+    static Mutex* const lock = new Mutex();
+    return *lock;
+}
+
+template <size_t P0, size_t P1, size_t P2>
+UTILS_NOINLINE
+typename HandleAllocator<P0, P1, P2>::Magazine*
+HandleAllocator<P0, P1, P2>::attachThreadCache(ThreadCache& cache) noexcept {
+    std::lock_guard const registryLock(getRegistryLock());
+    cache.clock++;
+
+    // this thread may already have magazines for us, otherwise take a free entry, or the least
+    // recently used one.
+    uint32_t index = 0;
+    for (uint32_t i = 0; i < THREAD_CACHE_ENTRY_COUNT; i++) {
+        auto const& entry = cache.entries[i];
+        if (entry.owner == this) {
+            index = i;
+            break;
+        }
+        auto const& candidate = cache.entries[index];
+        if (candidate.owner && (!entry.owner || entry.lastUse < candidate.lastUse)) {
+            index = i;
+        }
+    }
+
+    auto& entry = cache.entries[index];
+    if (entry.owner != this) {
+        if (entry.owner) {
+            // give its handles back to the allocator this entry was used for
+            entry.owner->detachThreadCache(cache, entry);
+        }
+        entry.owner = this;
+        mThreadCaches.push_back(&cache);
     }
-    return nullptr;
+    entry.lastUse = cache.clock;
+    cache.current = index;
+    return entry.magazines;
 }
 
 template <size_t P0, size_t P1, size_t P2>
-HandleBase::HandleId HandleAllocator<P0, P1, P2>::allocateHandleSlow(size_t size) {
-    void* p = ::malloc(size);
-    std::unique_lock lock(mLock);
+void HandleAllocator<P0, P1, P2>::detachThreadCache(ThreadCache& cache,
+        typename ThreadCache::Entry& entry) noexcept {
+    // must be called with the registry lock held
+    flush(entry.magazines[0], P0, entry.magazines[0].count);
+    flush(entry.magazines[1], P1, entry.magazines[1].count);
+    flush(entry.magazines[2], P2, entry.magazines[2].count);
+    auto pos = std::find(mThreadCaches.begin(), mThreadCaches.end(), &cache);
+    if (pos != mThreadCaches.end()) {
+        mThreadCaches.erase(pos);
+    }
+    entry.owner = nullptr;
+}
 
-    HandleBase::HandleId id = (++mId) | HANDLE_HEAP_FLAG;
+template <size_t P0, size_t P1, size_t P2>
+HandleAllocator<P0, P1, P2>::ThreadCache::~ThreadCache() noexcept {
+    std::lock_guard const registryLock(getRegistryLock());
+    for (auto& entry : entries) {
+        if (entry.owner) {
+            entry.owner->detachThreadCache(*this, entry);
+        }
+    }
+}
 
-    FILAMENT_CHECK_POSTCONDITION(mId < HANDLE_HEAP_FLAG) <<
+template <size_t P0, size_t P1, size_t P2>
+void HandleAllocator<P0, P1, P2>::fill(Tier& tier, Magazine& magazine, size_t size,
+        uint32_t flag) noexcept {
+    std::lock_guard const lock(tier.lock);
+    while (magazine.count < MAGAZINE_BATCH) {
+        void* const p = tier.arena.alloc(size, Allocator::getAlignment(), 0);
+        if (UTILS_UNLIKELY(!p)) {
+            break;
+        }
+        magazine.ids[magazine.count++] = arenaPointerToHandle(tier, p, flag);
+    }
+}
+
+template <size_t P0, size_t P1, size_t P2>
+UTILS_NOINLINE
+void HandleAllocator<P0, P1, P2>::refill(Magazine& magazine, size_t size) {
+    assert_invariant(magazine.count == 0);
+
+    fill(mPrimary, magazine, size, 0);
+
+    size_t tierCount = mTierCount.load(std::memory_order_acquire);
+    for (size_t i = 0; i < tierCount && magazine.count < MAGAZINE_BATCH; i++) {
+        fill(*mTiers[i].load(std::memory_order_acquire), magazine, size, HANDLE_TIER_FLAG);
+    }
+
+    while (UTILS_UNLIKELY(magazine.count == 0)) {
+        // all tiers are full (or were while we looked at them), add a new one
+        Tier* const tier = grow(tierCount);
+        tierCount = mTierCount.load(std::memory_order_acquire);
+        fill(*tier, magazine, size, HANDLE_TIER_FLAG);
+    }
+}
+
+template <size_t P0, size_t P1, size_t P2>
+UTILS_NOINLINE
+typename HandleAllocator<P0, P1, P2>::Tier*
+HandleAllocator<P0, P1, P2>::grow(size_t expectedTierCount) {
+    std::lock_guard const lock(mTierLock);
+    size_t const tierCount = mTierCount.load(std::memory_order_relaxed);
+    if (tierCount != expectedTierCount) {
+        // another thread added a tier in the meantime, try that one first
+        return mTiers[tierCount - 1].load(std::memory_order_relaxed);
+    }
+
+    FILAMENT_CHECK_POSTCONDITION(tierCount < mMaxTierCount) <<
             "No more Handle ids available! This can happen if HandleAllocator arena has been full"
             " for a while. Please increase FILAMENT_OPENGL_HANDLE_ARENA_SIZE_IN_MB";
 
-    mOverflowMap.emplace(id, p);
-    lock.unlock();
-
-    if (UTILS_UNLIKELY(id == (HANDLE_HEAP_FLAG | 1u))) { // meaning id was zero
-        PANIC_LOG("HandleAllocator arena is full, using slower system heap. Please increase "
-                  "the appropriate constant (e.g. FILAMENT_OPENGL_HANDLE_ARENA_SIZE_IN_MB).");
+    if (UTILS_UNLIKELY(tierCount == 0)) {
+        slog.w << "HandleAllocator arena is full, adding a secondary arena. Please increase "
+                  "the appropriate constant (e.g. FILAMENT_OPENGL_HANDLE_ARENA_SIZE_IN_MB)."
+               << io::endl;
     }
-    return id;
+
+    Tier* const tier = new Tier(mName, mPrimary.arena.getArea().size(),
+            uint32_t(tierCount * mTierIndexCount));
+    mTiers[tierCount].store(tier, std::memory_order_release);
+    mTierCount.store(tierCount + 1, std::memory_order_release);
+    return tier;
 }
 
 template <size_t P0, size_t P1, size_t P2>
-void HandleAllocator<P0, P1, P2>::deallocateHandleSlow(HandleBase::HandleId id, size_t) noexcept {
-    assert_invariant(id & HANDLE_HEAP_FLAG);
-    void* p = nullptr;
-    auto& overflowMap = mOverflowMap;
-
-    std::unique_lock lock(mLock);
-    auto pos = overflowMap.find(id);
-    if (pos != overflowMap.end()) {
-        p = pos.value();
-        overflowMap.erase(pos);
+UTILS_NOINLINE
+void HandleAllocator<P0, P1, P2>::flush(Magazine& magazine, size_t size, size_t count) noexcept {
+    assert_invariant(count <= magazine.count);
+
+    // return the oldest ids, and lock each tier only once per run of ids that belong to it
+    std::unique_lock<Mutex> lock;
+    Tier* lockedTier = nullptr;
+    for (size_t i = 0; i < count; i++) {
+        HandleBase::HandleId const id = magazine.ids[i];
+        Tier* const tier = getTier(id);
+        assert_invariant(tier);
+        if (tier != lockedTier) {
+            // never hold two tier locks at once, other threads may take them in another order
+            if (lock) {
+                lock.unlock();
+            }
+            lock = std::unique_lock<Mutex>(tier->lock);
+            lockedTier = tier;
+        }
+        tier->arena.free(handleToPointer(id).first, size);
     }
-    lock.unlock();
+    lock = {};
 
-    ::free(p);
+    std::copy(magazine.ids + count, magazine.ids + magazine.count, magazine.ids);
+    magazine.count -= count;
 }
 
 // Explicit template instantiations.
@@ -0,0 +1,374 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <filament/Camera.h>
+#include <filament/Engine.h>
+#include <filament/IndexBuffer.h>
+#include <filament/LightManager.h>
+#include <filament/Material.h>
+#include <filament/MaterialInstance.h>
+#include <filament/RenderableManager.h>
+#include <filament/Renderer.h>
+#include <filament/Scene.h>
+#include <filament/TransformManager.h>
+#include <filament/VertexBuffer.h>
+#include <filament/View.h>
+#include <filament/Viewport.h>
+
+#include "Allocators.h"
+#include "details/Camera.h"
+#include "details/Engine.h"
+#include "details/View.h"
+
+#include <utils/Entity.h>
+#include <utils/EntityManager.h>
+#include <utils/JobSystem.h>
+#include <utils/memalign.h>
+
+#include <math/mat4.h>
+#include <math/vec3.h>
+#include <math/vec4.h>
+
+#include <atomic>
+#include <cmath>
+#include <new>
+#include <random>
+#include <vector>
+
+#include <stdlib.h>
+
+using namespace filament;
+using namespace filament::math;
+using namespace utils;
+
+// These benchmarks measure the CPU side of a frame (scene preparation, culling, froxelization,
+// command generation and sorting, frame graph, command encoding) with the NOOP backend, so they can
+// run on machines without a GPU.
+//
+// Heap allocations made through operator new are counted for the whole process, which includes
+// the driver thread and the job system. This replaces the global allocation functions, which is
+// why these benchmarks are built as their own executable. The default array versions of operator new
+// and the other versions of operator delete call the ones below, so they don't need to be replaced.
+
+static std::atomic<size_t> sAllocationCount{ 0 };
+
+void* operator new(size_t size, std::nothrow_t const&) noexcept {
+    sAllocationCount.fetch_add(1, std::memory_order_relaxed);
+    return malloc(size ? size : 1);
+}
+
+void* operator new(size_t size, std::align_val_t align, std::nothrow_t const&) noexcept {
+    sAllocationCount.fetch_add(1, std::memory_order_relaxed);
+    return utils::aligned_alloc(size ? size : 1, size_t(align));
+}
+
+void* operator new(size_t size) {
+    void* p = operator new(size, std::nothrow);
+    if (UTILS_UNLIKELY(!p)) {
+        abort();
+    }
+    return p;
+}
+
+void* operator new(size_t size, std::align_val_t align) {
+    void* p = operator new(size, align, std::nothrow);
+    if (UTILS_UNLIKELY(!p)) {
+        abort();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+    utils::aligned_free(p);
+}
+
+void operator delete(void* p, size_t, std::align_val_t) noexcept {
+    utils::aligned_free(p);
+}
+
+class FrontendFixture : public benchmark::Fixture {
+protected:
+    // Arguments of every benchmark registered with sceneArguments()
+    enum {
+        RENDERABLES,        // number of renderables
+        LIGHTS,             // number of point lights
+        SHADOWED_SPOTS,     // number of spot lights that cast shadows
+        INSTANCED,          // whether automatic instancing is enabled
+    };
+
+    static constexpr uint32_t WIDTH = 1920;
+    static constexpr uint32_t HEIGHT = 1080;
+
+    Engine* engine = nullptr;
+    SwapChain* swapChain = nullptr;
+    Renderer* renderer = nullptr;
+    Scene* scene = nullptr;
+    View* view = nullptr;
+    Entity cameraEntity;
+    VertexBuffer* vertexBuffer = nullptr;
+    IndexBuffer* indexBuffer = nullptr;
+    std::vector<Entity> renderables;
+    std::vector<Entity> lights;
+    std::vector<mat4f> transforms;
+    size_t allocationCount = 0;
+
+public:
+    void SetUp(benchmark::State const& state) override {
+        const size_t renderableCount = size_t(state.range(RENDERABLES));
+        const size_t lightCount = size_t(state.range(LIGHTS));
+        const size_t spotCount = size_t(state.range(SHADOWED_SPOTS));
+        const bool instanced = state.range(INSTANCED) != 0;
+
+        engine = Engine::Builder().backend(Engine::Backend::NOOP).build();
+        engine->setAutomaticInstancingEnabled(instanced);
+        swapChain = engine->createSwapChain(WIDTH, HEIGHT);
+        renderer = engine->createRenderer();
+        scene = engine->createScene();
+        view = engine->createView();
+
+        cameraEntity = EntityManager::get().create();
+        Camera* camera = engine->createCamera(cameraEntity);
+        view->setCamera(camera);
+        view->setScene(scene);
+        view->setViewport({ 0, 0, WIDTH, HEIGHT });
+
+        // The renderables are scattered in a cube whose density doesn't depend on their count.
+        // The camera looks at its center from one of its faces, so that some are culled.
+        const float size = 4.0f * std::cbrt(float(renderableCount));
+        camera->setProjection(60.0, double(WIDTH) / HEIGHT, 0.1, 4.0 * size);
+        camera->lookAt({ 0, 0, size }, { 0, 0, 0 }, { 0, 1, 0 });
+
+        static const float3 positions[] = {
+                { -1, -1, -1 }, {  1, -1, -1 }, { -1,  1, -1 }, {  1,  1, -1 },
+                { -1, -1,  1 }, {  1, -1,  1 }, { -1,  1,  1 }, {  1,  1,  1 },
+        };
+        static const uint16_t indices[] = {
+                0, 2, 1, 1, 2, 3,   4, 5, 6, 5, 7, 6,   0, 1, 4, 1, 5, 4,
+                2, 6, 3, 3, 6, 7,   0, 4, 2, 2, 4, 6,   1, 3, 5, 3, 7, 5,
+        };
+
+        vertexBuffer = VertexBuffer::Builder()
+                .vertexCount(8)
+                .bufferCount(1)
+                .attribute(VertexAttribute::POSITION, 0, VertexBuffer::AttributeType::FLOAT3)
+                .build(*engine);
+        vertexBuffer->setBufferAt(*engine, 0,
+                VertexBuffer::BufferDescriptor(positions, sizeof(positions)));
+
+        indexBuffer = IndexBuffer::Builder()
+                .indexCount(36)
+                .bufferType(IndexBuffer::IndexType::USHORT)
+                .build(*engine);
+        indexBuffer->setBuffer(*engine,
+                IndexBuffer::BufferDescriptor(indices, sizeof(indices)));
+
+        // All renderables share their geometry and material, so they can all be instanced.
+        MaterialInstance const* const mi = engine->getDefaultMaterial()->getDefaultInstance();
+
+        std::default_random_engine gen; // NOLINT
+        std::uniform_real_distribution<float> rand(-0.5f * size, 0.5f * size);
+
+        renderables.resize(renderableCount);
+        transforms.resize(renderableCount);
+        EntityManager::get().create(renderables.size(), renderables.data());
+        TransformManager& tcm = engine->getTransformManager();
+        for (size_t i = 0; i < renderableCount; i++) {
+            transforms[i] = mat4f::translation(float3{ rand(gen), rand(gen), rand(gen) });
+            tcm.create(renderables[i], {}, transforms[i]);
+            RenderableManager::Builder(1)
+                    .boundingBox({{ 0, 0, 0 }, { 1, 1, 1 }})
+                    .material(0, mi)
+                    .geometry(0, RenderableManager::PrimitiveType::TRIANGLES,
+                            vertexBuffer, indexBuffer)
+                    .castShadows(spotCount > 0)
+                    .receiveShadows(spotCount > 0)
+                    .build(*engine, renderables[i]);
+        }
+        scene->addEntities(renderables.data(), renderables.size());
+
+        lights.resize(1 + lightCount + spotCount);
+        EntityManager::get().create(lights.size(), lights.data());
+        LightManager::Builder(LightManager::Type::SUN)
+                .direction({ 0, -1, -1 })
+                .intensity(100000.0f)
+                .build(*engine, lights[0]);
+        for (size_t i = 0; i < lightCount; i++) {
+            LightManager::Builder(LightManager::Type::POINT)
+                    .position({ rand(gen), rand(gen), rand(gen) })
+                    .falloff(8.0f)
+                    .intensity(10000.0f)
+                    .build(*engine, lights[1 + i]);
+        }
+        for (size_t i = 0; i < spotCount; i++) {
+            const float3 position{ rand(gen), 0.5f * size, rand(gen) };
+            LightManager::Builder(LightManager::Type::FOCUSED_SPOT)
+                    .position(position)
+                    .direction({ 0, -1, 0 })
+                    .spotLightCone(0.5f, 0.7f)
+                    .falloff(size)
+                    .intensity(100000.0f)
+                    .castShadows(true)
+                    .build(*engine, lights[1 + lightCount + i]);
+        }
+        scene->addEntities(lights.data(), lights.size());
+
+        // Render a few frames so that one-time initializations are not measured.
+        for (size_t i = 0; i < 4; i++) {
+            renderFrame();
+        }
+        engine->flushAndWait();
+
+        // Reset the high watermarks reported by getMemoryStatistics().
+        engine->getMemoryStatistics();
+        allocationCount = sAllocationCount.load(std::memory_order_relaxed);
+    }
+
+    void TearDown(benchmark::State const&) override {
+        for (Entity e : renderables) {
+            engine->destroy(e);
+        }
+        for (Entity e : lights) {
+            engine->destroy(e);
+        }
+        EntityManager::get().destroy(renderables.size(), renderables.data());
+        EntityManager::get().destroy(lights.size(), lights.data());
+        renderables.clear();
+        lights.clear();
+        transforms.clear();
+
+        engine->destroy(vertexBuffer);
+        engine->destroy(indexBuffer);
+        engine->destroyCameraComponent(cameraEntity);
+        EntityManager::get().destroy(cameraEntity);
+        engine->destroy(view);
+        engine->destroy(scene);
+        engine->destroy(renderer);
+        engine->destroy(swapChain);
+        Engine::destroy(&engine);
+    }
+
+protected:
+    bool renderFrame() {
+        if (!renderer->beginFrame(swapChain)) {
+            return false;
+        }
+        renderer->render(view);
+        renderer->endFrame();
+        return true;
+    }
+
+    void setCounters(benchmark::State& state) {
+        const size_t allocations =
+                sAllocationCount.load(std::memory_order_relaxed) - allocationCount;
+        const Engine::MemoryStatistics stats = engine->getMemoryStatistics();
+        state.counters.insert({
+                { "allocs", { double(allocations), benchmark::Counter::kAvgIterations }},
+                { "arenaKiB", double(stats.perRenderPassArenaHighWatermark) / 1024.0 },
+                { "commandsKiB", double(stats.commandBufferHighWatermark) / 1024.0 },
+        });
+        state.SetItemsProcessed(int64_t(state.iterations()) * state.range(RENDERABLES));
+    }
+};
+
+// Updates the local transform of every renderable, which is the only per-frame work done on the
+// client side in these scenes.
+BENCHMARK_DEFINE_F(FrontendFixture, transforms)(benchmark::State& state) {
+    TransformManager& tcm = engine->getTransformManager();
+    for (auto _ : state) {
+        tcm.openLocalTransformTransaction();
+        for (size_t i = 0, c = renderables.size(); i < c; i++) {
+            tcm.setTransform(tcm.getInstance(renderables[i]), transforms[i]);
+        }
+        tcm.commitLocalTransformTransaction();
+    }
+    setCounters(state);
+}
+
+// Runs the part of a frame that prepares the view: Renderer::beginFrame(), which calls
+// FEngine::prepare(), then FScene::prepare(), renderable and light culling, froxelization, shadow
+// map setup and uniform updates the way Renderer::render() does, and Renderer::endFrame().
+BENCHMARK_DEFINE_F(FrontendFixture, prepare)(benchmark::State& state) {
+    FEngine& fengine = downcast(*engine);
+    FView& fview = downcast(*view);
+    JobSystem& js = fengine.getJobSystem();
+    size_t skipped = 0;
+    for (auto _ : state) {
+        if (!renderer->beginFrame(swapChain)) {
+            skipped++;
+            continue;
+        }
+        {
+            RootArenaScope rootArenaScope(fengine.getPerRenderPassArena());
+            auto* rootJob = js.setRootJob(js.createJob());
+            CameraInfo const cameraInfo = fview.computeCameraInfo(fengine);
+            fview.prepare(fengine, fengine.getDriverApi(), rootArenaScope, view->getViewport(),
+                    cameraInfo, float4{}, false);
+            fengine.flush();
+            js.runAndWait(rootJob);
+        }
+        renderer->endFrame();
+    }
+    setCounters(state);
+    state.counters["skipped"] = double(skipped);
+}
+
+// Runs complete frames. Compared to "prepare", this adds the generation, sorting and instancing of
+// the render pass commands, the frame graph, and the encoding of the backend commands.
+BENCHMARK_DEFINE_F(FrontendFixture, frame)(benchmark::State& state) {
+    size_t skipped = 0;
+    for (auto _ : state) {
+        skipped += renderFrame() ? 0 : 1;
+    }
+    setCounters(state);
+    state.counters["skipped"] = double(skipped);
+}
+
+static void transformArguments(benchmark::internal::Benchmark* b) {
+    b->ArgNames({ "renderables", "lights", "spots", "instanced" });
+    for (int64_t renderables : { 1000, 10000, 100000, 1000000 }) {
+        b->Args({ renderables, 0, 0, 0 });
+    }
+    b->Unit(benchmark::kMicrosecond);
+}
+
+static void sceneArguments(benchmark::internal::Benchmark* b) {
+    b->ArgNames({ "renderables", "lights", "spots", "instanced" });
+    for (int64_t renderables : { 1000, 10000, 100000, 1000000 }) {
+        b->Args({ renderables, 0, 0, 0 });
+        b->Args({ renderables, 0, 0, 1 });
+    }
+    for (int64_t lights : { 64, 256, 1024, 4096 }) {
+        b->Args({ 10000, lights, 0, 0 });
+    }
+    for (int64_t spots : { 1, 4, 16 }) {
+        b->Args({ 10000, 256, spots, 0 });
+    }
+    b->Unit(benchmark::kMicrosecond);
+}
+
+BENCHMARK_REGISTER_F(FrontendFixture, transforms)->Apply(transformArguments);
+BENCHMARK_REGISTER_F(FrontendFixture, prepare)->Apply(sceneArguments);
+BENCHMARK_REGISTER_F(FrontendFixture, frame)->Apply(sceneArguments);
@@ -212,8 +212,9 @@ public:
         /**
          * Size in MiB of the low-level command buffer arena.
          *
-         * Each new command buffer is allocated from here. If this buffer is too small the program
-         * might terminate or rendering errors might occur.
+         * Each new command buffer is allocated from here. If this buffer is too small to batch-up
+         * frames without waiting for the backend, it grows up to 4 times this size, and goes back
+         * to this size once the extra space has not been needed for a while.
          *
          * This is typically set to minCommandBufferSizeMB * 3, so that up to 3 frames can be
          * batched-up at once.
@@ -229,8 +230,9 @@ public:
          * This is the main arena used for allocations when preparing a frame.
          * e.g.: Froxel data and high-level commands are allocated from this arena.
          *
-         * If this size is too small, the program will abort on debug builds and have undefined
-         * behavior otherwise.
+         * If this size is too small, extra memory is allocated from the heap, which is kept until
+         * it has not been needed for a while. Engine::getMemoryStatistics() reports how much of
+         * this arena is actually used.
          *
          * This value affects the application's memory usage.
          */
@@ -266,7 +268,7 @@ public:
          * Size in MiB of the per-frame high level command buffer.
          *
          * This buffer is related to the number of draw calls achievable within a frame, if it is
-         * too small, the program will abort on debug builds and have undefined behavior otherwise.
+         * too small, commands are allocated from the heap instead, which is slower.
          *
          * It is allocated from the 'per-render-pass arena' above. Make sure that at least 1 MiB is
          * left in the per-render-pass arena when deciding the size of this buffer.
@@ -677,6 +679,49 @@ public:
      */
     const Config& getConfig() const noexcept;
 
+    /**
+     * Memory usage, in bytes, of the buffers whose sizes are set by Config.
+     *
+     * The per-render-pass arena and the command buffer grow when a frame needs more memory than
+     * configured, and go back to their configured sizes after a while. The high watermarks can be
+     * used to choose Config values that fit a given workload.
+     *
+     * @see getMemoryStatistics
+     */
+    struct MemoryStatistics {
+        /** Current size of the per-render-pass arena, see Config::perRenderPassArenaSizeMB */
+        size_t perRenderPassArenaSize;
+        /** Largest use of the per-render-pass arena */
+        size_t perRenderPassArenaHighWatermark;
+        /** Largest use of the per-frame commands buffer, see Config::perFrameCommandsSizeMB */
+        size_t perFrameCommandsHighWatermark;
+        /** Current size of the command buffer, see Config::commandBufferSizeMB */
+        size_t commandBufferSize;
+        /** Largest use of the command buffer */
+        size_t commandBufferHighWatermark;
+    };
+
+    /**
+     * Retrieves the memory usage of the buffers whose sizes are set by Config.
+     *
+     * High watermarks cover the period since the previous call to this method, so calling it once
+     * per frame yields per-frame values.
+     *
+     * @return a MemoryStatistics object
+     * @see Config
+     */
+    MemoryStatistics getMemoryStatistics() noexcept;
+
+    /**
+     * Retrieves the number of draw calls issued for renderables since the previous call to this
+     * method. Draw calls of post-processing effects are not included.
+     *
+     * Calling this once per frame yields the number of draw calls of each frame.
+     *
+     * @return the number of draw calls
+     */
+    size_t getDrawCallCount() noexcept;
+
     /**
      * Returns the maximum number of stereoscopic eyes supported by Filament. The actual number of
      * eyes rendered is set at Engine creation time with the Engine::Config::stereoscopicEyeCount
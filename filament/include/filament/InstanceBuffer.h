@@ -28,16 +28,26 @@
 
 namespace filament {
 
+class Box;
+
 /**
  * InstanceBuffer holds draw (GPU) instance transforms. These can be provided to a renderable to
  * "offset" each draw instance.
  *
+ * Instance transforms are kept in GPU memory and only the ranges modified with
+ * setLocalTransforms() are uploaded again. Renderables with more instances than
+ * Engine::getMaxAutomaticInstances() are drawn with one draw call per
+ * Engine::getMaxAutomaticInstances() instances.
+ *
  * @see RenderableManager::Builder::instances(size_t, InstanceBuffer*)
  */
 class UTILS_PUBLIC InstanceBuffer : public FilamentAPI {
     struct BuilderDetails;
 
 public:
+    //! Maximum number of instances an InstanceBuffer can hold.
+    static constexpr size_t MAX_INSTANCE_COUNT = 1u << 20u;
+
     class Builder : public BuilderBase<BuilderDetails>, public BuilderNameMixin<Builder> {
         friend struct BuilderDetails;
 
@@ -45,8 +55,7 @@ public:
 
         /**
          * @param instanceCount the number of instances this InstanceBuffer will support, must be
-         *                      >= 1 and <= \c Engine::getMaxAutomaticInstances()
-         * @see Engine::getMaxAutomaticInstances
+         *                      >= 1 and <= \c MAX_INSTANCE_COUNT
          */
         explicit Builder(size_t instanceCount) noexcept;
 
@@ -70,6 +79,20 @@ public:
          */
         Builder& localTransforms(math::mat4f const* UTILS_NULLABLE localTransforms) noexcept;
 
+        /**
+         * Enables per-instance frustum culling. Each frame, only the instances whose bounding box
+         * intersects the camera frustum are uploaded and drawn, which helps when a large number
+         * of instances is spread across the scene.
+         *
+         * Culled instances do not cast shadows. Because visible instances are packed together,
+         * \c getInstanceIndex() in the material doesn't identify an instance when culling is
+         * enabled.
+         *
+         * @param instanceBoundingBox the bounding box of a single instance, in the local space of
+         *                            the instance (i.e. before its local transform is applied)
+         */
+        Builder& culling(Box const& instanceBoundingBox) noexcept;
+
         /**
          * Associate an optional name with this InstanceBuffer for debugging purposes.
          *
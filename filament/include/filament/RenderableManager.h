@@ -549,12 +549,15 @@ public:
         /**
          * Specifies the number of draw instances of this renderable and an \c InstanceBuffer
          * containing their local transforms. The default is 1 instance and the maximum number of
-         * instances allowed when supplying transforms is given by
-         * \c Engine::getMaxAutomaticInstances (64 on most platforms). 0 is invalid. The
-         * \c InstanceBuffer must not be destroyed before this renderable.
+         * instances allowed when supplying transforms is \c InstanceBuffer::MAX_INSTANCE_COUNT.
+         * 0 is invalid. The \c InstanceBuffer must not be destroyed before this renderable.
+         *
+         * Instances are drawn in batches of \c Engine::getMaxAutomaticInstances (64 on most
+         * platforms), one draw call per batch.
          *
          * All instances are culled using the same bounding box, so care must be taken to make
-         * sure all instances render inside the specified bounding box.
+         * sure all instances render inside the specified bounding box. In addition, each instance
+         * can be culled individually, see \c InstanceBuffer::Builder::culling.
          *
          * The material must set its `instanced` parameter to `true` in order to use
          * \c getInstanceIndex() in the vertex or fragment shader to get the instance index.
@@ -567,7 +570,7 @@ public:
          * \see InstanceBuffer
          * \see instances(size_t, * math::mat4f const*)
          * @param instanceCount the number of instances, silently clamped between 1 and
-         *                      the result of Engine::getMaxAutomaticInstances().
+         *                      InstanceBuffer::MAX_INSTANCE_COUNT.
          * @param instanceBuffer an InstanceBuffer containing at least instanceCount transforms
          */
         Builder& instances(size_t instanceCount,
@@ -593,6 +596,22 @@ public:
          */
         Result build(Engine& engine, utils::Entity entity);
 
+        /**
+         * Adds identical Renderable components to several entities.
+         *
+         * This is equivalent to, but faster than, calling build(Engine&, utils::Entity) for each
+         * entity, because the storage for all the components is reserved at once.
+         *
+         * @param engine Reference to the filament::Engine to associate the Renderables with.
+         * @param count Number of entities in the array.
+         * @param entities Array of entities to add the Renderable component to.
+         * @return Success if all components were created successfully, Error otherwise. In case
+         *         of error, the components that were already created are not destroyed.
+         *
+         * @see build(Engine&, utils::Entity)
+         */
+        Result build(Engine& engine, size_t count, utils::Entity const* UTILS_NONNULL entities);
+
     private:
         friend class FEngine;
         friend class FRenderPrimitive;
@@ -619,6 +638,12 @@ public:
      */
     void destroy(utils::Entity e) noexcept;
 
+    /**
+     * Destroys the renderable components of several entities.
+     * Entities without a renderable component are ignored.
+     */
+    void destroy(size_t count, utils::Entity const* UTILS_NONNULL entities) noexcept;
+
     /**
      * Changes the bounding box used for frustum culling.
      * The renderable must not have staticGeometry enabled.
@@ -182,6 +182,19 @@ public:
     void create(utils::Entity entity, Instance parent, const math::mat4& localTransform); //!< \overload
     void create(utils::Entity entity, Instance parent = {}); //!< \overload
 
+    /**
+     * Creates transform components with an identity local transform for several entities.
+     * This is equivalent to, but faster than, calling create(utils::Entity, Instance) for each
+     * entity, because the storage for all the components is reserved at once.
+     *
+     * @param count     Number of entities in the array.
+     * @param entities  Array of entities to associate a transform component to.
+     * @param parent    The Instance of the parent transform of all the entities, or Instance{}.
+     *
+     * @see destroy(size_t, utils::Entity const*)
+     */
+    void create(size_t count, utils::Entity const* UTILS_NONNULL entities, Instance parent = {});
+
     /**
      * Destroys this component from the given entity, children are orphaned.
      * @param e An entity.
@@ -194,6 +207,15 @@ public:
      */
     void destroy(utils::Entity e) noexcept;
 
+    /**
+     * Destroys the transform components of several entities.
+     * @param count     Number of entities in the array.
+     * @param entities  Array of entities, entities without a transform component are ignored.
+     *
+     * @see destroy(utils::Entity)
+     */
+    void destroy(size_t count, utils::Entity const* UTILS_NONNULL entities) noexcept;
+
     /**
      * Re-parents an entity to a new one.
      * @param i             The instance of the transform component to re-parent
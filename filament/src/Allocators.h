@@ -34,7 +34,7 @@ using HeapAllocatorArena = utils::Arena<
         utils::AreaPolicy::NullArea>;
 
 using LinearAllocatorArena = utils::Arena<
-        utils::LinearAllocator,
+        utils::GrowingLinearAllocator,
         utils::LockingPolicy::NoLock,
         utils::TrackingPolicy::DebugAndHighWatermark>;
 
@@ -49,7 +49,7 @@ using HeapAllocatorArena = utils::Arena<
         utils::AreaPolicy::NullArea>;
 
 using LinearAllocatorArena = utils::Arena<
-        utils::LinearAllocator,
+        utils::GrowingLinearAllocator,
         utils::LockingPolicy::NoLock>;
 
 #endif
@@ -430,6 +430,14 @@ const Engine::Config& Engine::getConfig() const noexcept {
     return downcast(this)->getConfig();
 }
 
+Engine::MemoryStatistics Engine::getMemoryStatistics() noexcept {
+    return downcast(this)->getMemoryStatistics();
+}
+
+size_t Engine::getDrawCallCount() noexcept {
+    return downcast(this)->getDrawCallCount();
+}
+
 bool Engine::isStereoSupported(StereoscopicType) const noexcept {
     return downcast(this)->isStereoSupported();
 }
@@ -120,7 +120,7 @@ MaterialParser::ParseResult MaterialParser::parse() noexcept {
     }
 
     const auto [chosenLanguage, matTag, dictTag] = result.value();
-    if (UTILS_UNLIKELY(!DictionaryReader::unflatten(cc, dictTag, mImpl.mBlobDictionary))) {
+    if (UTILS_UNLIKELY(!DictionaryReader::unflatten(cc, dictTag, mImpl.mDictionary))) {
         return ParseResult::ERROR_OTHER;
     }
     if (UTILS_UNLIKELY(!mImpl.mMaterialChunk.initialize(matTag))) {
@@ -391,7 +391,7 @@ bool MaterialParser::getReflectionMode(ReflectionMode* value) const noexcept {
 bool MaterialParser::getShader(ShaderContent& shader,
         ShaderModel shaderModel, Variant variant, ShaderStage stage) noexcept {
     return mImpl.mMaterialChunk.getShader(shader,
-            mImpl.mBlobDictionary, shaderModel, variant, stage);
+            mImpl.mDictionary, shaderModel, variant, stage);
 }
 
 // ------------------------------------------------------------------------------------------------
@@ -18,6 +18,7 @@
 #define TNT_FILAMENT_MATERIALPARSER_H
 
 #include <filaflat/ChunkContainer.h>
+#include <filaflat/LazyDictionary.h>
 #include <filaflat/MaterialChunk.h>
 
 #include <filament/MaterialEnums.h>
@@ -172,7 +173,8 @@ private:
 
         // Keep MaterialChunk alive between calls to getShader to avoid reload the shader index.
         filaflat::MaterialChunk mMaterialChunk;
-        filaflat::BlobDictionary mBlobDictionary;
+        // Shaders are decoded lazily, only when a variant is actually used.
+        filaflat::LazyDictionary mDictionary;
     };
 
     filaflat::ChunkContainer& getChunkContainer() noexcept;
@@ -42,6 +42,7 @@
 
 #include <utils/compiler.h>
 #include <utils/debug.h>
+#include <utils/Hash.h>
 #include <utils/JobSystem.h>
 #include <utils/Panic.h>
 #include <utils/Slice.h>
@@ -158,7 +159,8 @@ RenderPass::RenderPass(FEngine& engine, RenderPassBuilder const& builder) noexce
             stereoscopicEyeCount *= engine.getConfig().stereoscopicEyeCount;
         }
         commandEnd = resize(builder.mArena,
-                instanceify(engine, commandBegin, commandEnd, stereoscopicEyeCount));
+                instanceify(engine, commandBegin, commandEnd, stereoscopicEyeCount,
+                        builder.mInstancingCache));
     }
 
     // these are `const` from this point on...
@@ -287,11 +289,113 @@ void RenderPass::execute(RenderPass const& pass,
     driver.endRenderPass();
 }
 
+void RenderPass::InstancingCache::clear() noexcept {
+    mHash = 0;
+    mCommandCount = 0;
+    mRuns.clear();
+    mData.clear();
+    mUboHandle = {};
+}
+
+size_t RenderPass::hashInstancingInputs(Command const* const begin, Command const* const end,
+        int32_t eyeCount) noexcept {
+    // This covers everything instanceify() looks at: the order of the commands, which of them
+    // can be instanced together and which renderable they belong to.
+    size_t seed = size_t(eyeCount);
+    for (Command const* curr = begin; curr != end; ++curr) {
+        PrimitiveInfo const& info = curr->info;
+        hash::combine(seed, curr->key);
+        hash::combine(seed, uintptr_t(info.mi));
+        hash::combine(seed, info.rph.getId());
+        hash::combine(seed, info.vbih.getId());
+        hash::combine(seed, info.boh.getId());
+        hash::combine(seed, info.indexOffset);
+        hash::combine(seed, info.indexCount);
+        hash::combine(seed, info.index);
+        hash::combine(seed, info.rasterState.u);
+        hash::combine(seed, uint32_t(info.hasSkinning) | uint32_t(info.hasMorphing) << 1u |
+                uint32_t(info.hasHybridInstancing) << 2u);
+    }
+    return seed;
+}
+
+RenderPass::Command* RenderPass::instanceifyCached(FEngine& engine,
+        Command* const curr, Command* const last,
+        int32_t eyeCount, InstancingCache& cache) const noexcept {
+    SYSTRACE_NAME("instanceify (cached)");
+
+    if (cache.mRuns.empty()) {
+        return last;
+    }
+
+    PerRenderableData const* const uboData = mRenderableSoa.data<FScene::UBO>();
+    PerRenderableData* const cachedData = cache.mData.data();
+    uint32_t dirtyBegin = std::numeric_limits<uint32_t>::max();
+    uint32_t dirtyEnd = 0;
+    uint32_t instancedPrimitiveOffset = 0;
+
+    for (auto const& run : cache.mRuns) {
+        Command* const first = curr + run.first;
+
+        // only the per-renderable data of the instances could have changed
+        for (uint32_t i = 0; i < run.count; i++) {
+            PerRenderableData const& data = uboData[first[i].info.index];
+            PerRenderableData& cached = cachedData[instancedPrimitiveOffset + i];
+            if (memcmp(&cached, &data, sizeof(PerRenderableData)) != 0) {
+                cached = data;
+                dirtyBegin = std::min(dirtyBegin, instancedPrimitiveOffset + i);
+                dirtyEnd = instancedPrimitiveOffset + i + 1;
+            }
+        }
+
+        // make the first command instanced
+        first[0].info.instanceCount = run.count * eyeCount;
+        first[0].info.index = instancedPrimitiveOffset;
+        first[0].info.boh = cache.mUboHandle;
+
+        // cancel commands that are now instances
+        for (uint32_t i = 1; i < run.count; i++) {
+            first[i].key = uint64_t(Pass::SENTINEL);
+        }
+
+        instancedPrimitiveOffset += run.count;
+    }
+
+    if (dirtyBegin < dirtyEnd) {
+        // The UBO may still be in use by the previous frame, so this can't be unsynchronized.
+        uint32_t const size = sizeof(PerRenderableData) * (dirtyEnd - dirtyBegin);
+        void* const stagingBuffer = ::malloc(size);
+        memcpy(stagingBuffer, cachedData + dirtyBegin, size);
+        engine.getDriverApi().updateBufferObject(cache.mUboHandle, {
+                stagingBuffer, size,
+                +[](void* buffer, size_t, void*) {
+                    ::free(buffer);
+                }
+        }, sizeof(PerRenderableData) * dirtyBegin);
+    }
+
+    mInstancedUboHandle = cache.mUboHandle;
+
+    // remove all the canceled commands
+    return std::remove_if(curr + cache.mRuns.front().first, last, [](auto const& command) {
+        return command.key == uint64_t(Pass::SENTINEL);
+    });
+}
+
 RenderPass::Command* RenderPass::instanceify(FEngine& engine,
         Command* curr, Command* const last,
-        int32_t eyeCount) const noexcept {
+        int32_t eyeCount, InstancingCache* cache) const noexcept {
     SYSTRACE_NAME("instanceify");
 
+    size_t hash = 0;
+    if (cache) {
+        hash = hashInstancingInputs(curr, last, eyeCount);
+        if (cache->mCommandCount == uint32_t(last - curr) && cache->mHash == hash) {
+            return instanceifyCached(engine, curr, last, eyeCount, *cache);
+        }
+        cache->clear();
+    }
+
     // instanceify works by scanning the **sorted** command stream, looking for repeat draw
     // commands. When one is found, it is replaced by an instanced command.
     // A "repeat" draw is one that ends-up using the same draw parameters and state.
@@ -308,6 +412,7 @@ RenderPass::Command* RenderPass::instanceify(FEngine& engine,
     uint32_t stagingBufferSize = 0;
     uint32_t instancedPrimitiveOffset = 0;
     size_t const count = last - curr;
+    Command* const begin = curr;
 
     // TODO: for the case of instancing we could actually use 128 instead of 64 instances
     constexpr size_t maxInstanceCount = CONFIG_MAX_INSTANCES;
@@ -319,8 +424,10 @@ RenderPass::Command* RenderPass::instanceify(FEngine& engine,
         // Additionally, we can't have a different skinning/morphing per instance anyway.
         // And thirdly, the info.index meaning changes with instancing, it is the index into
         // the instancing buffer no longer the index into the soa.
+        // Renderables with an InstanceBuffer are already instanced and use their own UBO.
         Command const* e = curr + 1;
-        if (UTILS_LIKELY(!curr->info.hasSkinning && !curr->info.hasMorphing)) {
+        if (UTILS_LIKELY(!curr->info.hasSkinning && !curr->info.hasMorphing &&
+                !curr->info.hasHybridInstancing)) {
             // we can't have nice things! No more than maxInstanceCount due to UBO size limits
             e = std::find_if_not(curr, std::min(last, curr + maxInstanceCount),
                     [lhs = *curr](Command const& rhs) {
@@ -346,10 +453,12 @@ RenderPass::Command* RenderPass::instanceify(FEngine& engine,
             if (UTILS_UNLIKELY(!stagingBuffer)) {
 
                 // create a temporary UBO for instancing
+                // a cached UBO gets updated in place in later frames
                 mInstancedUboHandle = BufferObjectSharedHandle{
                         engine.getDriverApi().createBufferObject(
                                 count * sizeof(PerRenderableData) + sizeof(PerRenderableUib),
-                                BufferObjectBinding::UNIFORM, BufferUsage::STATIC),
+                                BufferObjectBinding::UNIFORM,
+                                cache ? BufferUsage::DYNAMIC : BufferUsage::STATIC),
                         engine.getDriverApi() };
 
                 // TODO: use stream inline buffer for small sizes
@@ -368,6 +477,10 @@ RenderPass::Command* RenderPass::instanceify(FEngine& engine,
                 stagingBuffer[instancedPrimitiveOffset + i] = uboData[curr[i].info.index];
             }
 
+            if (cache) {
+                cache->mRuns.push_back({ uint32_t(curr - begin), instanceCount });
+            }
+
             // make the first command instanced
             curr[0].info.instanceCount = instanceCount * eyeCount;
             curr[0].info.index = instancedPrimitiveOffset;
@@ -385,6 +498,11 @@ RenderPass::Command* RenderPass::instanceify(FEngine& engine,
         curr = const_cast<Command*>(e);
     }
 
+    if (cache) {
+        cache->mHash = hash;
+        cache->mCommandCount = uint32_t(count);
+    }
+
     if (UTILS_UNLIKELY(firstSentinel)) {
         //slog.d << "auto-instancing, saving " << drawCallsSavedCount << " draw calls, out of "
         //       << count << io::endl;
@@ -392,6 +510,11 @@ RenderPass::Command* RenderPass::instanceify(FEngine& engine,
         // we have instanced primitives
         DriverApi& driver = engine.getDriverApi();
 
+        if (cache) {
+            cache->mData.assign(stagingBuffer, stagingBuffer + instancedPrimitiveOffset);
+            cache->mUboHandle = mInstancedUboHandle;
+        }
+
         // copy our instanced ubo data
         driver.updateBufferObjectUnsynchronized(mInstancedUboHandle, {
                 stagingBuffer, sizeof(PerRenderableData) * instancedPrimitiveOffset,
@@ -652,9 +775,22 @@ RenderPass::Command* RenderPass::generateCommandsImpl(RenderPass::CommandTypeFla
         cmd.info.index = i;
         cmd.info.hasHybridInstancing = (bool)soaInstanceInfo[i].handle;
         cmd.info.instanceCount = soaInstanceInfo[i].count;
+        cmd.info.instanceBufferCount = 0;
         cmd.info.hasMorphing = (bool)morphing.handle;
         cmd.info.hasSkinning = (bool)skinning.handle;
 
+        if (cmd.info.hasHybridInstancing) {
+            // All instances may have been culled.
+            if (UTILS_UNLIKELY(!soaInstanceInfo[i].count)) {
+                continue;
+            }
+            // The InstanceBuffer is drawn in chunks of CONFIG_MAX_INSTANCES instances, see
+            // Executor::execute().
+            cmd.info.instanceBufferCount = soaInstanceInfo[i].count;
+            cmd.info.instanceCount = uint16_t(std::min(
+                    soaInstanceInfo[i].count, uint32_t(CONFIG_MAX_INSTANCES)));
+        }
+
         // soaInstanceInfo[i].count is the number of instances the user has requested, either for
         // manual or hybrid instancing. Instanced stereo multiplies the number of instances by the
         // eye count.
@@ -896,6 +1032,8 @@ void RenderPass::Executor::execute(FEngine& engine,
         // Maximum space occupied in the CircularBuffer by a single `Command`. This must be
         // reevaluated when the inner loop below adds DriverApi commands or when we change the
         // CommandStream protocol. Currently, the maximum is 320 bytes.
+        // The extra draw calls of instance buffers larger than CONFIG_MAX_INSTANCES are not
+        // included, the inner loop makes room for them separately.
         // The batch size is calculated by adding the size of all commands that can possibly be
         // emitted per draw call:
         constexpr size_t const maxCommandSizeInBytes =
@@ -921,6 +1059,7 @@ void RenderPass::Executor::execute(FEngine& engine,
         // skinning and morphing aren't used. With a 2 MiB buffer (the default) a batch is
         // 6553 commands (i.e. draw calls).
         size_t const batchCommandCount = capacity / maxCommandSizeInBytes;
+        size_t drawCallCount = 0;
         while(first != last) {
             Command const* const batchLast = std::min(first + batchCommandCount, last);
 
@@ -1069,9 +1208,38 @@ void RenderPass::Executor::execute(FEngine& engine,
                 }
 
                 driver.draw2(info.indexOffset, info.indexCount, info.instanceCount);
+                drawCallCount++;
+
+                if (UTILS_UNLIKELY(info.instanceBufferCount > CONFIG_MAX_INSTANCES)) {
+                    // Each chunk of CONFIG_MAX_INSTANCES instances is in its own
+                    // PerRenderableUib, so the remaining chunks need their own draw call.
+                    // maxCommandSizeInBytes only accounts for one draw call per Command, so we
+                    // flush as needed to keep room for each chunk and the rest of the batch.
+                    constexpr size_t chunkSizeInBytes =
+                            sizeof(COMMAND_TYPE(bindBufferRange)) + sizeof(COMMAND_TYPE(draw2));
+                    size_t const reservedSizeInBytes =
+                            (batchLast - first - 1) * maxCommandSizeInBytes + chunkSizeInBytes;
+                    uint32_t const eyeCount = info.instanceCount / CONFIG_MAX_INSTANCES;
+                    for (uint32_t chunk = CONFIG_MAX_INSTANCES; chunk < info.instanceBufferCount;
+                            chunk += CONFIG_MAX_INSTANCES) {
+                        if (UTILS_UNLIKELY(
+                                circularBuffer.getUsed() > capacity - reservedSizeInBytes)) {
+                            engine.flush();
+                        }
+                        uint32_t const count = std::min(info.instanceBufferCount - chunk,
+                                uint32_t(CONFIG_MAX_INSTANCES));
+                        driver.bindBufferRange(BufferObjectBinding::UNIFORM,
+                                +UniformBindingPoints::PER_RENDERABLE, info.boh,
+                                chunk * sizeof(PerRenderableData), sizeof(PerRenderableUib));
+                        driver.draw2(info.indexOffset, info.indexCount, count * eyeCount);
+                        drawCallCount++;
+                    }
+                }
             }
         }
 
+        engine.recordDrawCalls(drawCallCount);
+
         // If the remaining space is less than half the capacity, we flush right away to
         // allow some headroom for commands that might come later.
         if (UTILS_UNLIKELY(circularBuffer.getUsed() > capacity / 2)) {
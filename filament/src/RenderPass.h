@@ -262,7 +262,8 @@ public:
         bool hasMorphing : 1;                                           //              1 bit
         bool hasHybridInstancing : 1;                                   //              1 bit
 
-        uint32_t rfu[2];                                                // 16 bytes
+        uint32_t instanceBufferCount = 0;                               // 4 bytes
+        uint32_t rfu;                                                   // 4 bytes
     };
     static_assert(sizeof(PrimitiveInfo) == 56);
 
@@ -325,6 +326,30 @@ public:
     using BufferObjectSharedHandle = SharedHandle<
             backend::HwBufferObject, BufferObjectHandleDeleter>;
 
+    /*
+     * InstancingCache keeps the result of instanceify() from one frame to the next. When the
+     * sorted command stream of a pass is the same as in the previous frame, the instanced runs
+     * and their UBO are reused, and only the per-renderable data that changed is uploaded.
+     * The cache must outlive the RenderPasses that use it, and is typically owned by a View.
+     */
+    class InstancingCache {
+    public:
+        // releases the cached UBO
+        void clear() noexcept;
+
+    private:
+        friend class RenderPass;
+        struct Run {
+            uint32_t first;                         // index of the first command of the run
+            uint32_t count;                         // number of instances in the run
+        };
+        size_t mHash = 0;                           // hash of the command stream
+        uint32_t mCommandCount = 0;                 // size of the command stream
+        std::vector<Run> mRuns;
+        std::vector<PerRenderableData> mData;       // content of mUboHandle
+        BufferObjectSharedHandle mUboHandle;
+    };
+
     /*
      * Executor holds the range of commands to execute for a given pass
      */
@@ -418,7 +443,15 @@ private:
     // instanceify commands then trims sentinels
     RenderPass::Command* instanceify(FEngine& engine,
             Command* begin, Command* end,
-            int32_t eyeCount) const noexcept;
+            int32_t eyeCount, InstancingCache* cache) const noexcept;
+
+    // replays the instanced runs of the previous frame, see InstancingCache
+    RenderPass::Command* instanceifyCached(FEngine& engine,
+            Command* begin, Command* end,
+            int32_t eyeCount, InstancingCache& cache) const noexcept;
+
+    static size_t hashInstancingInputs(Command const* begin, Command const* end,
+            int32_t eyeCount) noexcept;
 
     // We choose the command count per job to minimize JobSystem overhead.
     static constexpr size_t JOBS_PARALLEL_FOR_COMMANDS_COUNT = 128;
@@ -476,6 +509,7 @@ class RenderPassBuilder {
     RenderPass::RenderFlags mFlags{};
     Variant mVariant{};
     FScene::VisibleMaskType mVisibilityMask = std::numeric_limits<FScene::VisibleMaskType>::max();
+    RenderPass::InstancingCache* mInstancingCache = nullptr;
 
     using CustomCommandRecord = std::tuple<
             uint8_t,
@@ -547,6 +581,13 @@ public:
         return *this;
     }
 
+    // Reuses the automatic instancing layout of the previous frame when the command stream is
+    // unchanged. The cache must only be used by a single pass each frame.
+    RenderPassBuilder& instancingCache(RenderPass::InstancingCache* cache) noexcept {
+        mInstancingCache = cache;
+        return *this;
+    }
+
     RenderPassBuilder& customCommand(FEngine& engine,
             uint8_t channel,
             RenderPass::Pass pass,
@@ -56,6 +56,10 @@ void RenderableManager::destroy(utils::Entity e) noexcept {
     return downcast(this)->destroy(e);
 }
 
+void RenderableManager::destroy(size_t count, utils::Entity const* entities) noexcept {
+    return downcast(this)->destroy(count, entities);
+}
+
 void RenderableManager::setAxisAlignedBoundingBox(Instance instance, const Box& aabb) {
     downcast(this)->setAxisAlignedBoundingBox(instance, aabb);
 }
@@ -58,10 +58,18 @@ void TransformManager::create(Entity entity, Instance parent) {
     downcast(this)->create(entity, parent, mat4f{});
 }
 
+void TransformManager::create(size_t count, Entity const* entities, Instance parent) {
+    downcast(this)->create(count, entities, parent);
+}
+
 void TransformManager::destroy(Entity e) noexcept {
     downcast(this)->destroy(e);
 }
 
+void TransformManager::destroy(size_t count, Entity const* entities) noexcept {
+    downcast(this)->destroy(count, entities);
+}
+
 void TransformManager::setTransform(Instance ci, const mat4f& model) noexcept {
     downcast(this)->setTransform(ci, model);
 }
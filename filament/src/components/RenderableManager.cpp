@@ -76,7 +76,7 @@ struct RenderableManager::BuilderDetails {
     uint8_t mPriority = 0x4;
     uint8_t mCommandChannel = RenderableManager::Builder::DEFAULT_CHANNEL;
     uint8_t mLightChannels = 1;
-    uint16_t mInstanceCount = 1;
+    uint32_t mInstanceCount = 1;
     bool mCulling : 1;
     bool mCastShadows : 1;
     bool mReceiveShadows : 1;
@@ -436,12 +436,6 @@ RenderableManager::Builder::Result RenderableManager::Builder::build(Engine& eng
     FILAMENT_CHECK_PRECONDITION(mImpl->mSkinningBoneCount <= CONFIG_MAX_BONE_COUNT)
             << "bone count > " << CONFIG_MAX_BONE_COUNT;
 
-    FILAMENT_CHECK_PRECONDITION(
-            mImpl->mInstanceCount <= CONFIG_MAX_INSTANCES || !mImpl->mInstanceBuffer)
-            << "instance count is " << mImpl->mInstanceCount
-            << ", but instance count is limited to CONFIG_MAX_INSTANCES (" << CONFIG_MAX_INSTANCES
-            << ") instances when supplying transforms via an InstanceBuffer.";
-
     if (mImpl->mGeometryType == GeometryType::STATIC) {
         FILAMENT_CHECK_PRECONDITION(mImpl->mSkinningBoneCount == 0)
                 << "Skinning can't be used with STATIC geometry";
@@ -515,6 +509,19 @@ RenderableManager::Builder::Result RenderableManager::Builder::build(Engine& eng
     return Success;
 }
 
+RenderableManager::Builder::Result RenderableManager::Builder::build(Engine& engine,
+        size_t count, Entity const* entities) {
+    // reserve the storage for all the new components at once
+    FRenderableManager& rcm = downcast(engine).getRenderableManager();
+    rcm.reserve(rcm.getComponentCount() + count);
+    for (size_t i = 0; i < count; i++) {
+        if (UTILS_UNLIKELY(build(engine, entities[i]) != Success)) {
+            return Error;
+        }
+    }
+    return Success;
+}
+
 RenderableManager::Builder& RenderableManager::Builder::instances(size_t instanceCount) noexcept {
     mImpl->mInstanceCount = clamp((unsigned int)instanceCount, 1u, 32767u);
     return *this;
@@ -522,7 +529,8 @@ RenderableManager::Builder& RenderableManager::Builder::instances(size_t instanc
 
 RenderableManager::Builder& RenderableManager::Builder::instances(
         size_t instanceCount, InstanceBuffer* instanceBuffer) noexcept {
-    mImpl->mInstanceCount = clamp(instanceCount, (size_t)1, CONFIG_MAX_INSTANCES);
+    mImpl->mInstanceCount = uint32_t(
+            clamp(instanceCount, (size_t)1, InstanceBuffer::MAX_INSTANCE_COUNT));
     mImpl->mInstanceBuffer = downcast(instanceBuffer);
     return *this;
 }
@@ -582,12 +590,12 @@ void FRenderableManager::create(
         instances.count = builder->mInstanceCount;
         instances.buffer = builder->mInstanceBuffer;
         if (instances.buffer) {
-            // Allocate our instance buffer for this Renderable. We always allocate a size to match
-            // PerRenderableUib, regardless of the number of instances. This is because the buffer
-            // will get bound to the PER_RENDERABLE UBO, and we can't bind a buffer smaller than the
-            // full size of the UBO.
-            instances.handle = driver.createBufferObject(sizeof(PerRenderableUib),
+            // Allocate our instance buffer for this Renderable. Its size is a multiple of
+            // PerRenderableUib, see FInstanceBuffer::getBufferSize().
+            instances.handle = driver.createBufferObject(
+                    FInstanceBuffer::getBufferSize(instances.count),
                     BufferObjectBinding::UNIFORM, backend::BufferUsage::DYNAMIC);
+            instances.buffer->attach(instances.handle);
             if (auto name = instances.buffer->getName(); !name.empty()) {
                 driver.setDebugTag(instances.handle.getId(), std::move(name));
             }
@@ -720,6 +728,12 @@ void FRenderableManager::destroy(utils::Entity e) noexcept {
     }
 }
 
+void FRenderableManager::destroy(size_t count, utils::Entity const* entities) noexcept {
+    for (size_t i = 0; i < count; i++) {
+        destroy(entities[i]);
+    }
+}
+
 // this destroys all components in this manager
 void FRenderableManager::terminate() noexcept {
     auto& manager = mManager;
@@ -771,6 +785,7 @@ void FRenderableManager::destroyComponent(Instance ci) noexcept {
 
     InstancesInfo const& instances = manager[ci].instances;
     if (instances.handle) {
+        instances.buffer->detach(instances.handle);
         driver.destroyBufferObject(instances.handle);
     }
 }
@@ -120,6 +120,12 @@ public:
 
     void destroy(utils::Entity e) noexcept;
 
+    void destroy(size_t count, utils::Entity const* entities) noexcept;
+
+    void reserve(size_t count) {
+        mManager.reserve(count);
+    }
+
     inline void setAxisAlignedBoundingBox(Instance instance, const Box& aabb);
 
     inline void setLayerMask(Instance instance, uint8_t select, uint8_t values) noexcept;
@@ -191,8 +197,7 @@ public:
             uint64_t padding;          // ensures the pointer is 64 bits on all archs
         };
         backend::Handle<backend::HwBufferObject> handle;
-        uint16_t count;
-        char padding0[2];
+        uint32_t count;
     };
     static_assert(sizeof(InstancesInfo) == 16);
     inline InstancesInfo getInstancesInfo(Instance instance) const noexcept;
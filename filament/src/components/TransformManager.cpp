@@ -16,6 +16,7 @@
 
 #include "components/TransformManager.h"
 
+#include <math/batch.h>
 #include <math/mat4.h>
 
 #include <utils/debug.h>
@@ -92,6 +93,14 @@ void FTransformManager::create(Entity entity, Instance parent, const mat4& local
     }
 }
 
+void FTransformManager::create(size_t count, Entity const* entities, Instance parent) {
+    // reserve the storage for all the new components at once
+    mManager.reserve(mManager.getComponentCount() + count);
+    for (size_t i = 0; i < count; i++) {
+        create(entities[i], parent, mat4f{});
+    }
+}
+
 void FTransformManager::setParent(Instance i, Instance parent) noexcept {
     validateNode(i);
     if (i) {
@@ -167,6 +176,12 @@ void FTransformManager::destroy(Entity e) noexcept {
     }
 }
 
+void FTransformManager::destroy(size_t count, Entity const* entities) noexcept {
+    for (size_t i = 0; i < count; i++) {
+        destroy(entities[i]);
+    }
+}
+
 void FTransformManager::setTransform(Instance ci, const mat4f& model) noexcept {
     validateNode(ci);
     if (ci) {
@@ -402,14 +417,11 @@ void FTransformManager::computeWorldTransform(
         float3 const& UTILS_RESTRICT localTranslationLo,    // reference to avoid unneeded access
         bool accurate) {
 
-    outWorld[0] = pt * local[0];
-    outWorld[1] = pt * local[1];
-    outWorld[2] = pt * local[2];
+    // the last column is computed again below in the accurate case
+    batch::multiply(&outWorld, pt, &local, 1);
 
     // "a branch not taken is free", i.e.: we burn a BT cache entry only in the accurate case
-    if (UTILS_LIKELY(!accurate)) {
-        outWorld[3] = pt * local[3];
-    } else {
+    if (UTILS_UNLIKELY(accurate)) {
         // this version takes the extra precision of the translation into account,
         // we assume that the last row of local is [0 0 0 x].
         // Only the last column of the result needs special treatment -- unfortunately this requires
@@ -81,8 +81,12 @@ public:
 
     void create(utils::Entity entity, Instance parent, const math::mat4& localTransform);
 
+    void create(size_t count, utils::Entity const* entities, Instance parent);
+
     void destroy(utils::Entity e) noexcept;
 
+    void destroy(size_t count, utils::Entity const* entities) noexcept;
+
     void setParent(Instance i, Instance newParent) noexcept;
 
     utils::Entity getParent(Instance i) const noexcept;
@@ -206,7 +206,8 @@ FEngine::FEngine(Engine::Builder const& builder) :
         mCommandBufferQueue(
                 builder->mConfig.minCommandBufferSizeMB * MiB,
                 builder->mConfig.commandBufferSizeMB * MiB,
-                builder->mPaused),
+                builder->mPaused,
+                builder->mConfig.commandBufferSizeMB * MiB * MAX_COMMAND_BUFFER_GROWTH),
         mPerRenderPassArena(
                 "FEngine::mPerRenderPassAllocator",
                 builder->mConfig.perRenderPassArenaSizeMB * MiB),
@@ -589,6 +590,20 @@ void FEngine::flush() {
     flushCommandBuffer(mCommandBufferQueue);
 }
 
+Engine::MemoryStatistics FEngine::getMemoryStatistics() noexcept {
+    auto& allocator = mPerRenderPassArena.getAllocator();
+    Engine::MemoryStatistics const stats{
+            .perRenderPassArenaSize = allocator.getCapacity(),
+            .perRenderPassArenaHighWatermark = allocator.getHighWatermark(),
+            .perFrameCommandsHighWatermark = mPerFrameCommandsHighWatermark,
+            .commandBufferSize = mCommandBufferQueue.getBufferSize(),
+            .commandBufferHighWatermark = mCommandBufferQueue.takeRecentHighWatermark(),
+    };
+    allocator.resetHighWatermark();
+    mPerFrameCommandsHighWatermark = 0;
+    return stats;
+}
+
 void FEngine::flushAndWait() {
     FILAMENT_CHECK_PRECONDITION(!mCommandBufferQueue.isPaused())
             << "Cannot call flushAndWait() when rendering thread is paused!";
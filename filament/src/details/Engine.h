@@ -65,6 +65,7 @@
 #include <utils/JobSystem.h>
 #include <utils/compiler.h>
 
+#include <algorithm>
 #include <chrono>
 #include <memory>
 #include <new>
@@ -72,6 +73,7 @@
 #include <thread>
 #include <type_traits>
 #include <unordered_map>
+#include <utility>
 
 #if FILAMENT_ENABLE_MATDBG
 #include <matdbg/DebugServer.h>
@@ -451,6 +453,8 @@ public:
     backend::Handle<backend::HwTexture> getZeroTextureArray() const { return mDummyZeroTextureArray; }
 
     static constexpr const size_t MiB = 1024u * 1024u;
+    // the command buffer can grow up to this multiple of Config::commandBufferSizeMB
+    static constexpr const size_t MAX_COMMAND_BUFFER_GROWTH = 4u;
     size_t getMinCommandBufferSize() const noexcept { return mConfig.minCommandBufferSizeMB * MiB; }
     size_t getCommandBufferSize() const noexcept { return mConfig.commandBufferSizeMB * MiB; }
     size_t getPerFrameCommandsSize() const noexcept { return mConfig.perFrameCommandsSizeMB * MiB; }
@@ -458,6 +462,20 @@ public:
     size_t getRequestedDriverHandleArenaSize() const noexcept { return mConfig.driverHandleArenaSizeMB * MiB; }
     Config const& getConfig() const noexcept { return mConfig; }
 
+    Engine::MemoryStatistics getMemoryStatistics() noexcept;
+
+    void recordPerFrameCommandsHighWatermark(size_t watermark) noexcept {
+        mPerFrameCommandsHighWatermark = std::max(mPerFrameCommandsHighWatermark, watermark);
+    }
+
+    void recordDrawCalls(size_t count) noexcept {
+        mDrawCallCount += count;
+    }
+
+    size_t getDrawCallCount() noexcept {
+        return std::exchange(mDrawCallCount, 0);
+    }
+
     bool hasFeatureLevel(backend::FeatureLevel neededFeatureLevel) const noexcept {
         return FEngine::getActiveFeatureLevel() >= neededFeatureLevel;
     }
@@ -552,6 +570,8 @@ private:
     uint32_t mFlushCounter = 0;
 
     RootArenaScope::Arena mPerRenderPassArena;
+    size_t mPerFrameCommandsHighWatermark = 0;
+    size_t mDrawCallCount = 0;
     HeapAllocatorArena mHeapAllocator;
 
     utils::JobSystem mJobSystem;
@@ -16,6 +16,8 @@
 
 #include "details/InstanceBuffer.h"
 
+#include "Culler.h"
+
 #include <details/Engine.h>
 #include <private/filament/UibStructs.h>
 
@@ -24,13 +26,32 @@
 #include <math/mat3.h>
 #include <math/vec3.h>
 
+#include <utils/JobSystem.h>
+#include <utils/Systrace.h>
+
+#include <algorithm>
+#include <functional>
+
+#include <string.h>
+
 namespace filament {
 
 using namespace backend;
+using namespace math;
+using namespace utils;
+
+// Below this number of instances, culling and uploading are done on the calling thread.
+static constexpr uint32_t JOBS_PARALLEL_FOR_INSTANCES_COUNT = 4096;
+
+// Number of instances culled in one go, must be a multiple of Culler::MODULO.
+static constexpr uint32_t CULLING_BATCH_SIZE = 256;
+static_assert(CULLING_BATCH_SIZE % Culler::MODULO == 0);
 
 struct InstanceBuffer::BuilderDetails {
     size_t mInstanceCount = 0;
     math::mat4f const* mLocalTransforms = nullptr;
+    Box mBoundingBox;
+    bool mCulling = false;
 };
 
 using BuilderType = InstanceBuffer;
@@ -50,19 +71,27 @@ InstanceBuffer::Builder& InstanceBuffer::Builder::localTransforms(
     return *this;
 }
 
+InstanceBuffer::Builder& InstanceBuffer::Builder::culling(Box const& instanceBoundingBox) noexcept {
+    mImpl->mBoundingBox = instanceBoundingBox;
+    mImpl->mCulling = true;
+    return *this;
+}
+
 InstanceBuffer* InstanceBuffer::Builder::build(Engine& engine) {
     FILAMENT_CHECK_PRECONDITION(mImpl->mInstanceCount >= 1) << "instanceCount must be >= 1.";
-    FILAMENT_CHECK_PRECONDITION(mImpl->mInstanceCount <= engine.getMaxAutomaticInstances())
+    FILAMENT_CHECK_PRECONDITION(mImpl->mInstanceCount <= InstanceBuffer::MAX_INSTANCE_COUNT)
             << "instanceCount is " << mImpl->mInstanceCount
-            << ", but instance count is limited to Engine::getMaxAutomaticInstances() ("
-            << engine.getMaxAutomaticInstances() << ") instances when supplying transforms.";
+            << ", but instance count is limited to InstanceBuffer::MAX_INSTANCE_COUNT ("
+            << InstanceBuffer::MAX_INSTANCE_COUNT << ").";
     return downcast(engine).createInstanceBuffer(*this);
 }
 
 // ------------------------------------------------------------------------------------------------
 
 FInstanceBuffer::FInstanceBuffer(FEngine& engine, const Builder& builder)
-    : mName(builder.getName()) {
+    : mName(builder.getName()),
+      mBoundingBox(builder->mBoundingBox),
+      mCulling(builder->mCulling) {
     mInstanceCount = builder->mInstanceCount;
 
     mLocalTransforms.reserve(mInstanceCount);
@@ -81,34 +110,202 @@ void FInstanceBuffer::setLocalTransforms(
             << " instances, but trying to set " << count 
             << " transforms at offset " << offset << ".";
     memcpy(mLocalTransforms.data() + offset, localTransforms, sizeof(math::mat4f) * count);
+
+    // only the modified range needs to be uploaded again
+    for (auto it = mTargets.begin(); it != mTargets.end(); ++it) {
+        Target& target = it.value();
+        if (target.dirtyBegin == target.dirtyEnd) {
+            target.dirtyBegin = uint32_t(offset);
+            target.dirtyEnd = uint32_t(offset + count);
+        } else {
+            target.dirtyBegin = std::min(target.dirtyBegin, uint32_t(offset));
+            target.dirtyEnd = std::max(target.dirtyEnd, uint32_t(offset + count));
+        }
+    }
 }
 
-void FInstanceBuffer::prepare(FEngine& engine, math::mat4f rootTransform,
-        const PerRenderableData& ubo, Handle<HwBufferObject> handle) {
+size_t FInstanceBuffer::getBufferSize(size_t instanceCount) noexcept {
+    // We always allocate whole PerRenderableUib, because each chunk of instances gets bound to
+    // the PER_RENDERABLE UBO, and we can't bind a buffer smaller than the full size of the UBO.
+    size_t const chunkCount = (instanceCount + CONFIG_MAX_INSTANCES - 1) / CONFIG_MAX_INSTANCES;
+    return std::max(chunkCount, size_t(1)) * sizeof(PerRenderableUib);
+}
+
+void FInstanceBuffer::attach(Handle<HwBufferObject> handle) {
+    // handles can be recycled, so the state of a previous renderable must not be reused
+    mTargets[handle.getId()] = {};
+}
+
+void FInstanceBuffer::detach(Handle<HwBufferObject> handle) noexcept {
+    mTargets.erase(handle.getId());
+}
+
+uint32_t FInstanceBuffer::prepare(FEngine& engine, math::mat4f const& rootTransform,
+        const PerRenderableData& ubo, Handle<HwBufferObject> handle,
+        uint32_t instanceCount, Frustum const& frustum) {
+    assert_invariant(instanceCount <= mInstanceCount);
+
+    Target& target = mTargets[handle.getId()];
+
+    // Everything must be uploaded again if the renderable itself changed.
+    bool const stale = target.instanceCount != instanceCount ||
+            memcmp(&target.rootTransform, &rootTransform, sizeof(rootTransform)) != 0 ||
+            memcmp(&target.ubo, &ubo, sizeof(ubo)) != 0;
+
+    uint32_t const dirtyBegin = std::min(target.dirtyBegin, instanceCount);
+    uint32_t const dirtyEnd = std::min(target.dirtyEnd, instanceCount);
+
+    uint32_t drawCount = instanceCount;
+    uint32_t begin = 0;
+    uint32_t end = 0;
+    uint32_t const* indices = nullptr;
+
+    if (mCulling) {
+        // Visibility depends on the camera, so it is recomputed every time, but only the part of
+        // the buffer that doesn't already hold the visible instances is uploaded.
+        std::vector<uint32_t>& visible = mVisibleInstances;
+        cull(engine, rootTransform, instanceCount, frustum, visible);
+        drawCount = uint32_t(visible.size());
+
+        if (stale) {
+            begin = 0;
+            end = drawCount;
+        } else {
+            auto const& previous = target.visibleInstances;
+            begin = uint32_t(std::mismatch(visible.begin(), visible.end(),
+                    previous.begin(), previous.end()).first - visible.begin());
+            end = drawCount;
+            if (dirtyBegin != dirtyEnd) {
+                // visible instances are sorted, so the modified ones occupy contiguous slots
+                uint32_t const first = uint32_t(std::lower_bound(
+                        visible.begin(), visible.end(), dirtyBegin) - visible.begin());
+                uint32_t const last = uint32_t(std::lower_bound(
+                        visible.begin(), visible.end(), dirtyEnd) - visible.begin());
+                if (first < last) {
+                    end = begin < end ? end : last;
+                    begin = std::min(begin, first);
+                }
+            }
+        }
+        // the previous list becomes the scratch buffer for the next call
+        std::swap(target.visibleInstances, visible);
+        indices = target.visibleInstances.data();
+    } else if (stale) {
+        begin = 0;
+        end = instanceCount;
+    } else {
+        begin = dirtyBegin;
+        end = dirtyEnd;
+    }
+
+    if (begin < end) {
+        upload(engine, rootTransform, ubo, handle, indices, begin, end);
+    }
+
+    target.rootTransform = rootTransform;
+    target.ubo = ubo;
+    target.instanceCount = instanceCount;
+    target.dirtyBegin = 0;
+    target.dirtyEnd = 0;
+    return drawCount;
+}
+
+void FInstanceBuffer::cull(FEngine& engine, math::mat4f const& rootTransform,
+        uint32_t instanceCount, Frustum const& frustum,
+        std::vector<uint32_t>& visibleInstances) const {
+    SYSTRACE_CALL();
+
+    FixedCapacityVector<Culler::result_type> visibility(instanceCount);
+
+    auto work = [this, &rootTransform, &frustum, results = visibility.data(), instanceCount]
+            (uint32_t start, uint32_t count) {
+        float3 centers[CULLING_BATCH_SIZE];
+        float3 extents[CULLING_BATCH_SIZE];
+        Culler::result_type batch[CULLING_BATCH_SIZE];
+        uint32_t const first = start * CULLING_BATCH_SIZE;
+        uint32_t const last = std::min((start + count) * CULLING_BATCH_SIZE, instanceCount);
+        for (uint32_t b = first; b < last; b += CULLING_BATCH_SIZE) {
+            uint32_t const n = std::min(CULLING_BATCH_SIZE, last - b);
+            for (uint32_t i = 0; i < n; i++) {
+                Box const box = rigidTransform(mBoundingBox,
+                        rootTransform * mLocalTransforms[b + i]);
+                centers[i] = box.center;
+                extents[i] = box.halfExtent;
+            }
+            // Culler processes multiples of Culler::MODULO boxes, the padding is ignored.
+            std::fill(centers + n, centers + Culler::round(n), float3{});
+            std::fill(extents + n, extents + Culler::round(n), float3{});
+            std::fill(batch, batch + Culler::round(n), Culler::result_type(0));
+            Culler::intersects(batch, frustum, centers, extents, n, 0);
+            std::copy_n(batch, n, results + b);
+        }
+    };
+
+    uint32_t const batchCount = (instanceCount + CULLING_BATCH_SIZE - 1) / CULLING_BATCH_SIZE;
+    if (instanceCount <= JOBS_PARALLEL_FOR_INSTANCES_COUNT) {
+        work(0, batchCount);
+    } else {
+        JobSystem& js = engine.getJobSystem();
+        auto* job = jobs::parallel_for(js, nullptr, 0, batchCount, std::cref(work),
+                jobs::CountSplitter<JOBS_PARALLEL_FOR_INSTANCES_COUNT / CULLING_BATCH_SIZE>());
+        js.runAndWait(job);
+    }
+
+    visibleInstances.clear();
+    visibleInstances.reserve(instanceCount);
+    for (uint32_t i = 0; i < instanceCount; i++) {
+        if (visibility[i] & 1u) {
+            visibleInstances.push_back(i);
+        }
+    }
+}
+
+void FInstanceBuffer::upload(FEngine& engine, math::mat4f const& rootTransform,
+        const PerRenderableData& ubo, Handle<HwBufferObject> handle,
+        uint32_t const* indices, uint32_t begin, uint32_t end) const {
+    SYSTRACE_CALL();
+
     DriverApi& driver = engine.getDriverApi();
 
     // TODO: allocate this staging buffer from a pool.
-    uint32_t stagingBufferSize = sizeof(PerRenderableUib);
-    PerRenderableData* stagingBuffer = (PerRenderableData*)::malloc(stagingBufferSize);
-    // TODO: consider using JobSystem to parallelize this.
-    for (size_t i = 0, c = mInstanceCount; i < c; i++) {
-        stagingBuffer[i] = ubo;
-        math::mat4f model = rootTransform * mLocalTransforms[i];
-        stagingBuffer[i].worldFromModelMatrix = model;
-
-        math::mat3f m = math::mat3f::getTransformForNormals(model.upperLeft());
-        stagingBuffer[i].worldFromModelNormalMatrix = math::prescaleForNormals(m);
+    uint32_t const count = end - begin;
+    uint32_t const stagingBufferSize = count * sizeof(PerRenderableData);
+    PerRenderableData* const stagingBuffer = (PerRenderableData*)::malloc(stagingBufferSize);
+
+    // slot i of the GPU buffer holds instance indices[i], or instance i without culling
+    auto work = [this, &rootTransform, &ubo, stagingBuffer, indices, begin]
+            (uint32_t start, uint32_t count) {
+        for (uint32_t i = start, c = start + count; i < c; i++) {
+            uint32_t const slot = begin + i;
+            uint32_t const instance = indices ? indices[slot] : slot;
+            PerRenderableData& data = stagingBuffer[i];
+            data = ubo;
+            math::mat4f const model = rootTransform * mLocalTransforms[instance];
+            data.worldFromModelMatrix = model;
+
+            math::mat3f const m = math::mat3f::getTransformForNormals(model.upperLeft());
+            data.worldFromModelNormalMatrix = math::prescaleForNormals(m);
+        }
+    };
+
+    if (count <= JOBS_PARALLEL_FOR_INSTANCES_COUNT) {
+        work(0, count);
+    } else {
+        JobSystem& js = engine.getJobSystem();
+        auto* job = jobs::parallel_for(js, nullptr, 0, count, std::cref(work),
+                jobs::CountSplitter<JOBS_PARALLEL_FOR_INSTANCES_COUNT>());
+        js.runAndWait(job);
     }
+
     driver.updateBufferObject(handle, {
             stagingBuffer, stagingBufferSize,
             +[](void* buffer, size_t, void*) {
                 ::free(buffer);
             }
-    }, 0);
+    }, begin * sizeof(PerRenderableData));
 }
 
 void FInstanceBuffer::terminate(FEngine& engine) {
 }
 
 } // namespace filament
-
@@ -19,8 +19,11 @@
 
 #include "downcast.h"
 
+#include <filament/Box.h>
 #include <filament/InstanceBuffer.h>
 
+#include <private/filament/UibStructs.h>
+
 #include <backend/Handle.h>
 
 #include <math/mat4.h>
@@ -28,11 +31,16 @@
 #include <utils/CString.h>
 #include <utils/FixedCapacityVector.h>
 
+#include <tsl/robin_map.h>
+
+#include <vector>
+
+#include <stdint.h>
+
 namespace filament {
 
 class FEngine;
-
-struct PerRenderableData;
+class Frustum;
 
 class FInstanceBuffer : public InstanceBuffer {
 public:
@@ -44,17 +52,51 @@ public:
 
     void setLocalTransforms(math::mat4f const* localTransforms, size_t count, size_t offset);
 
-    void prepare(FEngine& engine, math::mat4f rootTransform, const PerRenderableData& ubo,
-            backend::Handle<backend::HwBufferObject> handle);
+    // Size of the GPU buffer needed by a renderable that draws instanceCount instances. Instances
+    // are stored in PerRenderableUib sized chunks, each of which is drawn by a single draw call.
+    static size_t getBufferSize(size_t instanceCount) noexcept;
+
+    // Registers the GPU buffer of a renderable using this InstanceBuffer. The next prepare() for
+    // this handle uploads all instances.
+    void attach(backend::Handle<backend::HwBufferObject> handle);
+    void detach(backend::Handle<backend::HwBufferObject> handle) noexcept;
+
+    // Uploads the instances that changed since the last prepare() for this handle. When culling
+    // is enabled, only the instances that intersect the frustum are uploaded, packed at the start
+    // of the buffer. Returns the number of instances to draw.
+    uint32_t prepare(FEngine& engine, math::mat4f const& rootTransform,
+            const PerRenderableData& ubo, backend::Handle<backend::HwBufferObject> handle,
+            uint32_t instanceCount, Frustum const& frustum);
 
     utils::CString const& getName() const noexcept { return mName; }
 
 private:
     friend class RenderableManager;
 
+    // Upload state of a renderable's GPU buffer.
+    struct Target {
+        math::mat4f rootTransform;
+        PerRenderableData ubo;
+        uint32_t dirtyBegin = 0;                // range of instances modified since last upload
+        uint32_t dirtyEnd = 0;
+        uint32_t instanceCount = 0;             // number of instances uploaded, 0 if none yet
+        std::vector<uint32_t> visibleInstances; // instances uploaded when culling is enabled
+    };
+
+    void cull(FEngine& engine, math::mat4f const& rootTransform, uint32_t instanceCount,
+            Frustum const& frustum, std::vector<uint32_t>& visibleInstances) const;
+
+    void upload(FEngine& engine, math::mat4f const& rootTransform, const PerRenderableData& ubo,
+            backend::Handle<backend::HwBufferObject> handle,
+            uint32_t const* indices, uint32_t begin, uint32_t end) const;
+
     utils::FixedCapacityVector<math::mat4f> mLocalTransforms;
+    tsl::robin_map<backend::HandleBase::HandleId, Target> mTargets;
+    std::vector<uint32_t> mVisibleInstances;    // scratch buffer used by prepare()
     utils::CString mName;
     size_t mInstanceCount;
+    Box mBoundingBox;
+    bool mCulling = false;
 };
 
 FILAMENT_DOWNCAST(InstanceBuffer)
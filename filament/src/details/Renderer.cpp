@@ -1066,6 +1066,9 @@ void FRenderer::renderJob(RootArenaScope& rootArenaScope, FView& view) {
         passBuilder.renderFlags(renderFlags);
     }
 
+    // the color pass is usually the same from one frame to the next
+    passBuilder.instancingCache(&view.getInstancingCache());
+
     RenderPass const pass{ passBuilder.build(engine) };
 
     FrameGraphTexture::Descriptor colorBufferDesc = {
@@ -1326,6 +1329,7 @@ void FRenderer::renderJob(RootArenaScope& rootArenaScope, FView& view) {
     view.commitFrameHistory(engine);
 
     recordHighWatermark(commandArena.getListener().getHighWatermark());
+    engine.recordPerFrameCommandsHighWatermark(commandArena.getListener().getHighWatermark());
 }
 
 } // namespace filament
@@ -33,10 +33,13 @@
 #include <utils/Range.h>
 #include <utils/Systrace.h>
 
+#include <math/batch.h>
 #include <math/quat.h>
 
 #include <algorithm>
 
+#include <string.h>
+
 using namespace filament::backend;
 using namespace filament::math;
 using namespace utils;
@@ -182,8 +185,8 @@ void FScene::prepare(utils::JobSystem& js,
                     worldTransform * tcm.getWorldTransformAccurate(ti) };
             const bool reversedWindingOrder = det(shaderWorldTransform.upperLeft()) < 0;
 
-            // compute the world AABB so we can perform culling
-            const Box worldAABB = rigidTransform(rcm.getAABB(ri), shaderWorldTransform);
+            // the world AABB is computed below for the whole range
+            const Box aabb = rcm.getAABB(ri);
 
             auto visibility = rcm.getVisibility(ri);
             visibility.reversedWindingOrder = reversedWindingOrder;
@@ -206,16 +209,23 @@ void FScene::prepare(utils::JobSystem& js,
             sceneData.elementAt<SKINNING_BUFFER>(index)     = rcm.getSkinningBufferInfo(ri);
             sceneData.elementAt<MORPHING_BUFFER>(index)     = rcm.getMorphingBufferInfo(ri);
             sceneData.elementAt<INSTANCES>(index)           = rcm.getInstancesInfo(ri);
-            sceneData.elementAt<WORLD_AABB_CENTER>(index)   = worldAABB.center;
+            sceneData.elementAt<WORLD_AABB_CENTER>(index)   = aabb.center;
             sceneData.elementAt<VISIBLE_MASK>(index)        = 0;
             sceneData.elementAt<CHANNELS>(index)            = rcm.getChannels(ri);
             sceneData.elementAt<LAYERS>(index)              = rcm.getLayerMask(ri);
-            sceneData.elementAt<WORLD_AABB_EXTENT>(index)   = worldAABB.halfExtent;
+            sceneData.elementAt<WORLD_AABB_EXTENT>(index)   = aabb.halfExtent;
             //sceneData.elementAt<PRIMITIVES>(index)          = {}; // already initialized, Slice<>
             sceneData.elementAt<SUMMED_PRIMITIVE_COUNT>(index) = 0;
             //sceneData.elementAt<UBO>(index)                 = {}; // not needed here
             sceneData.elementAt<USER_DATA>(index)           = scale;
         }
+
+        // compute the world AABBs so we can perform culling, this is done in place
+        size_t const start = std::distance(first, p);
+        float3* const center = sceneData.data<WORLD_AABB_CENTER>() + start;
+        float3* const halfExtent = sceneData.data<WORLD_AABB_EXTENT>() + start;
+        batch::transformBoxes(center, halfExtent, center, halfExtent,
+                sceneData.data<WORLD_TRANSFORM>() + start, c);
     };
 
     auto lightWork = [first = lightInstances.data(), &lcm, &tcm, &worldTransform,
@@ -331,27 +341,36 @@ void FScene::prepareVisibleRenderables(Range<uint32_t> visibleRenderables) noexc
     RenderableSoa& sceneData = mRenderableData;
     FRenderableManager const& rcm = mEngine.getRenderableManager();
 
+    // normal matrices are computed by blocks, which is where this loop spends most of its time
+    constexpr uint32_t BLOCK_SIZE = 64;
+    mat3f normalMatrices[BLOCK_SIZE];
+
     mHasContactShadows = false;
     for (uint32_t const i : visibleRenderables) {
+        uint32_t const j = (i - visibleRenderables.first) % BLOCK_SIZE;
+        if (j == 0) {
+            // Using mat3f::getTransformForNormals handles non-uniform scaling, but DOESN'T
+            // guarantee that the transformed normals will have unit-length, therefore they need to
+            // be normalized in the shader (that's already the case anyway, since normalization is
+            // needed after interpolation).
+            //
+            // We pre-scale normals by the inverse of the largest scale factor to avoid
+            // large post-transform magnitudes in the shader, especially in the fragment shader,
+            // where we use medium precision.
+            //
+            // Note: if the model matrix is known to be a rigid-transform, we could just use it
+            // directly.
+            batch::normalMatrices(normalMatrices, sceneData.data<WORLD_TRANSFORM>() + i,
+                    std::min(BLOCK_SIZE, visibleRenderables.last - i));
+        }
+
         PerRenderableData& uboData = sceneData.elementAt<UBO>(i);
 
         auto const visibility = sceneData.elementAt<VISIBILITY_STATE>(i);
         auto const& model = sceneData.elementAt<WORLD_TRANSFORM>(i);
         auto const ri = sceneData.elementAt<RENDERABLE_INSTANCE>(i);
 
-        // Using mat3f::getTransformForNormals handles non-uniform scaling, but DOESN'T guarantee that
-        // the transformed normals will have unit-length, therefore they need to be normalized
-        // in the shader (that's already the case anyway, since normalization is needed after
-        // interpolation).
-        //
-        // We pre-scale normals by the inverse of the largest scale factor to avoid
-        // large post-transform magnitudes in the shader, especially in the fragment shader, where
-        // we use medium precision.
-        //
-        // Note: if the model matrix is known to be a rigid-transform, we could just use it directly.
-
-        mat3f m = mat3f::getTransformForNormals(model.upperLeft());
-        m = prescaleForNormals(m);
+        mat3f m = normalMatrices[j];
 
         // The shading normal must be flipped for mirror transformations.
         // Basically we're shading the other side of the polygon and therefore need to negate the
@@ -382,63 +401,146 @@ void FScene::prepareVisibleRenderables(Range<uint32_t> visibleRenderables) noexc
     }
 }
 
+bool FScene::findDirtyUboRanges(PerRenderableData const* uboData,
+        Range<uint32_t> visibleRenderables,
+        Handle<HwBufferObject> renderableUbh,
+        RenderableUboHistory& history,
+        std::vector<Range<uint32_t>>& ranges, size_t& dirtyCount) noexcept {
+    // changed rows separated by fewer unchanged rows than this are uploaded together
+    static constexpr uint32_t MAX_DELTA_GAP_COUNT = 8;          // 2 KiB
+    // each range is a command, past this many, a single upload is cheaper
+    static constexpr size_t MAX_DELTA_RANGE_COUNT = 64;
+    const size_t count = visibleRenderables.size();
+
+    ranges.clear();
+    dirtyCount = 0;
+
+    if (history.ubh != renderableUbh) {
+        history.ubh = renderableUbh;
+        history.data.assign(uboData, uboData + count);
+        return false;
+    }
+
+    // The UBO still holds what we uploaded last time, find the rows that changed. When the
+    // set of visible renderables is stable, typically only the ones that moved did.
+    size_t const previousCount = std::min(count, history.data.size());
+    history.data.resize(count);
+    PerRenderableData* const previous = history.data.data();
+    for (uint32_t const i : visibleRenderables) {
+        if (i < previousCount &&
+                !memcmp(previous + i, uboData + i, sizeof(PerRenderableData))) {
+            continue;
+        }
+        previous[i] = uboData[i];
+        if (!ranges.empty() && i - ranges.back().last < MAX_DELTA_GAP_COUNT) {
+            dirtyCount += i + 1 - ranges.back().last;
+            ranges.back().last = i + 1;
+        } else {
+            dirtyCount++;
+            ranges.push_back({ i, i + 1 });
+        }
+    }
+
+    // when most of the rows changed, or they're too scattered, a single upload is cheaper
+    return dirtyCount <= count / 2 && ranges.size() <= MAX_DELTA_RANGE_COUNT;
+}
+
 void FScene::updateUBOs(
         Range<uint32_t> visibleRenderables,
-        Handle<HwBufferObject> renderableUbh) noexcept {
+        Handle<HwBufferObject> renderableUbh,
+        RenderableUboHistory& history,
+        Frustum const& cullingFrustum) noexcept {
     SYSTRACE_CALL();
     FEngine::DriverApi& driver = mEngine.getDriverApi();
 
     // don't allocate more than 16 KiB directly into the render stream
     static constexpr size_t MAX_STREAM_ALLOCATION_COUNT = 64;   // 16 KiB
     const size_t count = visibleRenderables.size();
-    PerRenderableData* buffer = [&]{
-        if (count >= MAX_STREAM_ALLOCATION_COUNT) {
-            // use the heap allocator
-            auto& bufferPoolAllocator = mSharedState->mBufferPoolAllocator;
-            return (PerRenderableData*)bufferPoolAllocator.get(count * sizeof(PerRenderableData));
-        } else {
-            // allocate space into the command stream directly
-            return driver.allocatePod<PerRenderableData>(count);
-        }
-    }();
 
     PerRenderableData const* const uboData = mRenderableData.data<UBO>();
     mat4f const* const worldTransformData = mRenderableData.data<WORLD_TRANSFORM>();
 
-    // prepare each InstanceBuffer.
-    FRenderableManager::InstancesInfo const* instancesData = mRenderableData.data<INSTANCES>();
+    // prepare each InstanceBuffer, this updates the number of instances to draw if they're culled.
+    FRenderableManager::InstancesInfo* instancesData = mRenderableData.data<INSTANCES>();
     for (uint32_t const i : visibleRenderables) {
         auto& instancesInfo = instancesData[i];
         if (UTILS_UNLIKELY(instancesInfo.buffer)) {
-            instancesInfo.buffer->prepare(
-                    mEngine, worldTransformData[i], uboData[i], instancesInfo.handle);
+            instancesInfo.count = instancesInfo.buffer->prepare(mEngine,
+                    worldTransformData[i], uboData[i], instancesInfo.handle,
+                    instancesInfo.count, cullingFrustum);
+        }
+    }
+
+    auto allocate = [&](size_t n) -> PerRenderableData* {
+        if (n >= MAX_STREAM_ALLOCATION_COUNT) {
+            // use the heap allocator
+            auto& bufferPoolAllocator = mSharedState->mBufferPoolAllocator;
+            return (PerRenderableData*)bufferPoolAllocator.get(n * sizeof(PerRenderableData));
+        } else {
+            // allocate space into the command stream directly
+            return driver.allocatePod<PerRenderableData>(n);
+        }
+    };
+
+    // Returns a descriptor for n rows at data, which lies in a buffer of bufferCount rows returned
+    // by allocate(). The buffer is released by the callback of this descriptor, so it must be the
+    // last one that reads it.
+    struct BufferRelease {
+        std::weak_ptr<SharedState> state;
+        void* buffer;
+    };
+    auto descriptor = [&](PerRenderableData const* data, size_t n,
+            PerRenderableData* buffer, size_t bufferCount) -> BufferDescriptor {
+        if (bufferCount < MAX_STREAM_ALLOCATION_COUNT) {
+            // the buffer belongs to the command stream
+            return { data, n * sizeof(PerRenderableData) };
         }
+        // We capture state shared between Scene and the update buffer callback, because the Scene
+        // could be destroyed before the callback executes.
+        BufferRelease* const release = new BufferRelease{ mSharedState, buffer };
+        return { data, n * sizeof(PerRenderableData),
+                +[](void*, size_t, void* user) {
+                    BufferRelease* const release = static_cast<BufferRelease*>(user);
+                    if (auto state = release->state.lock()) {
+                        state->mBufferPoolAllocator.put(release->buffer);
+                    }
+                    delete release;
+                }, release };
+    };
+
+    auto& ranges = mDirtyUboRanges;
+    size_t dirtyCount;
+    if (findDirtyUboRanges(uboData, visibleRenderables, renderableUbh, history,
+            ranges, dirtyCount)) {
+        if (ranges.empty()) {
+            return;
+        }
+        // The changed rows are packed into a single buffer. The commands are executed in order
+        // and read their data when they execute, so only the last update needs to release it.
+        PerRenderableData* const buffer = allocate(dirtyCount);
+        PerRenderableData* rows = buffer;
+        for (size_t k = 0, c = ranges.size(); k < c; k++) {
+            Range<uint32_t> const& range = ranges[k];
+            memcpy(rows, uboData + range.first, range.size() * sizeof(PerRenderableData));
+            driver.updateBufferObject(renderableUbh, k + 1 < c ?
+                            BufferDescriptor{ rows, range.size() * sizeof(PerRenderableData) } :
+                            descriptor(rows, range.size(), buffer, dirtyCount),
+                    range.first * sizeof(PerRenderableData));
+            rows += range.size();
+        }
+        return;
     }
 
     // copy our data into the UBO for each visible renderable
+    PerRenderableData* const buffer = allocate(count);
     for (uint32_t const i : visibleRenderables) {
         buffer[i] = uboData[i];
     }
 
-    // We capture state shared between Scene and the update buffer callback, because the Scene could
-    // be destroyed before the callback executes.
-    std::weak_ptr<SharedState>* const weakShared = new std::weak_ptr<SharedState>(mSharedState);
-
-    // update the UBO
+    // update the whole UBO
     driver.resetBufferObject(renderableUbh);
-    driver.updateBufferObjectUnsynchronized(renderableUbh, {
-            buffer, count * sizeof(PerRenderableData),
-            +[](void* p, size_t s, void* user) {
-                std::weak_ptr<SharedState>* const weakShared =
-                        static_cast<std::weak_ptr<SharedState>*>(user);
-                if (s >= MAX_STREAM_ALLOCATION_COUNT * sizeof(PerRenderableData)) {
-                    if (auto state = weakShared->lock()) {
-                        state->mBufferPoolAllocator.put(p);
-                    }
-                }
-                delete weakShared;
-            }, weakShared
-    }, 0);
+    driver.updateBufferObjectUnsynchronized(renderableUbh,
+            descriptor(buffer, count, buffer, count), 0);
 }
 
 void FScene::terminate(FEngine&) {
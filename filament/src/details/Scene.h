@@ -45,6 +45,7 @@
 #include <tsl/robin_set.h>
 
 #include <memory>
+#include <vector>
 
 namespace filament {
 
@@ -182,8 +183,35 @@ public:
     LightSoa const& getLightData() const noexcept { return mLightData; }
     LightSoa& getLightData() noexcept { return mLightData; }
 
+    /*
+     * Copy of the per-renderable data last uploaded into a UBO. It's owned by the caller of
+     * updateUBOs() (i.e. the View), so that when the same UBO is updated again, only the rows
+     * that changed need to be uploaded.
+     */
+    struct RenderableUboHistory {
+        backend::Handle<backend::HwBufferObject> ubh;
+        std::vector<PerRenderableData> data;
+        void clear() noexcept {
+            ubh.clear();
+            data = {};
+        }
+    };
+
     void updateUBOs(utils::Range<uint32_t> visibleRenderables,
-            backend::Handle<backend::HwBufferObject> renderableUbh) noexcept;
+            backend::Handle<backend::HwBufferObject> renderableUbh,
+            RenderableUboHistory& history,
+            Frustum const& cullingFrustum) noexcept;
+
+    /*
+     * Compares the per-renderable data with the history of the given UBO and updates it. Returns
+     * true if only the rows in `ranges`, which cover `dirtyCount` rows, need to be uploaded, or
+     * false if the whole UBO must be, because it's new or because too many rows changed.
+     */
+    static bool findDirtyUboRanges(PerRenderableData const* uboData,
+            utils::Range<uint32_t> visibleRenderables,
+            backend::Handle<backend::HwBufferObject> renderableUbh,
+            RenderableUboHistory& history,
+            std::vector<utils::Range<uint32_t>>& ranges, size_t& dirtyCount) noexcept;
 
     bool hasContactShadows() const noexcept;
 
@@ -226,6 +254,9 @@ private:
     LightSoa mLightData;
     bool mHasContactShadows = false;
 
+    // scratch list of the UBO rows to upload, kept to avoid reallocating it every frame
+    std::vector<utils::Range<uint32_t>> mDirtyUboRanges;
+
     // State shared between Scene and driver callbacks.
     struct SharedState {
         BufferPoolAllocator<3> mBufferPoolAllocator = {};
@@ -24,11 +24,14 @@
 
 #include "FilamentAPI-impl.h"
 
+#include <math/batch.h>
 #include <math/half.h>
 #include <math/mat4.h>
+#include <math/quat.h>
 
 #include <utils/CString.h>
 
+#include <algorithm>
 #include <cstring>
 
 namespace filament {
@@ -128,15 +131,25 @@ static uint32_t packHalf2x16(half2 v) noexcept {
     return (hi << 16) | lo;
 }
 
+// number of bones processed at once by the batch kernels, small enough for the stack
+static constexpr size_t BONE_BLOCK_SIZE = 64;
+
 void FSkinningBuffer::setBones(FEngine& engine, Handle<backend::HwBufferObject> handle,
         RenderableManager::Bone const* transforms, size_t boneCount, size_t offset) noexcept {
     auto& driverApi = engine.getDriverApi();
     auto* UTILS_RESTRICT out = driverApi.allocatePod<PerRenderableBoneUib::BoneData>(boneCount);
-    for (size_t i = 0, c = boneCount; i < c; ++i) {
-        // the transform is stored in row-major, last row is not stored.
-        mat4f transform(transforms[i].unitQuaternion);
-        transform[3] = float4{ transforms[i].translation, 1.0f };
-        out[i] = makeBone(transform);
+    quatf rotations[BONE_BLOCK_SIZE];
+    mat4f matrices[BONE_BLOCK_SIZE];
+    for (size_t i = 0; i < boneCount; i += BONE_BLOCK_SIZE) {
+        size_t const n = std::min(boneCount - i, BONE_BLOCK_SIZE);
+        for (size_t j = 0; j < n; ++j) {
+            rotations[j] = transforms[i + j].unitQuaternion;
+        }
+        batch::rotationMatrices(matrices, rotations, n);
+        for (size_t j = 0; j < n; ++j) {
+            matrices[j][3] = float4{ transforms[i + j].translation, 1.0f };
+        }
+        makeBones(out + i, matrices, n);
     }
     driverApi.updateBufferObject(handle, {
                     out, boneCount * sizeof(PerRenderableBoneUib::BoneData) },
@@ -157,14 +170,33 @@ PerRenderableBoneUib::BoneData FSkinningBuffer::makeBone(mat4f transform) noexce
     };
 }
 
+void FSkinningBuffer::makeBones(PerRenderableBoneUib::BoneData* UTILS_RESTRICT out,
+        mat4f const* transforms, size_t boneCount) noexcept {
+    mat3f cofactors[BONE_BLOCK_SIZE];
+    for (size_t i = 0; i < boneCount; i += BONE_BLOCK_SIZE) {
+        size_t const n = std::min(boneCount - i, BONE_BLOCK_SIZE);
+        batch::cofactors(cofactors, transforms + i, n);
+        for (size_t j = 0; j < n; ++j) {
+            // the transform is stored in row-major, last row is not stored.
+            mat4f const transform = transpose(transforms[i + j]);
+            out[i + j] = {
+                    .transform = {
+                            transform[0],
+                            transform[1],
+                            transform[2]
+                    },
+                    .cof0 = cofactors[j][0],
+                    .cof1x = cofactors[j][1].x
+            };
+        }
+    }
+}
+
 void FSkinningBuffer::setBones(FEngine& engine, Handle<backend::HwBufferObject> handle,
         mat4f const* transforms, size_t boneCount, size_t offset) noexcept {
     auto& driverApi = engine.getDriverApi();
     auto* UTILS_RESTRICT out = driverApi.allocatePod<PerRenderableBoneUib::BoneData>(boneCount);
-    for (size_t i = 0, c = boneCount; i < c; ++i) {
-        // the transform is stored in row-major, last row is not stored.
-        out[i] = makeBone(transforms[i]);
-    }
+    makeBones(out, transforms, boneCount);
     driverApi.updateBufferObject(handle, { out, boneCount * sizeof(PerRenderableBoneUib::BoneData) },
             offset * sizeof(PerRenderableBoneUib::BoneData));
 }
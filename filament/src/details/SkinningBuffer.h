@@ -71,6 +71,9 @@ private:
 
     static PerRenderableBoneUib::BoneData makeBone(math::mat4f transform) noexcept;
 
+    static void makeBones(PerRenderableBoneUib::BoneData* out,
+            math::mat4f const* transforms, size_t boneCount) noexcept;
+
     backend::Handle<backend::HwBufferObject> getHwHandle() const noexcept {
         return mHandle;
     }
@@ -130,6 +130,8 @@ void FView::terminate(FEngine& engine) {
     DriverApi& driver = engine.getDriverApi();
     driver.destroyBufferObject(mLightUbh);
     driver.destroyBufferObject(mRenderableUbh);
+    mRenderableUboHistory.clear();
+    mInstancingCache.clear();
     clearFrameHistory(engine);
 
     ShadowMapManager::terminate(engine, mShadowMapManager);
@@ -678,6 +680,8 @@ void FView::prepare(FEngine& engine, DriverApi& driver, RootArenaScope& rootAren
                 const size_t count = std::max(size_t(16u), (4u * merged.size() + 2u) / 3u);
                 mRenderableUBOSize = uint32_t(count * sizeof(PerRenderableData));
                 driver.destroyBufferObject(mRenderableUbh);
+                // the new handle could be the same as the old one, the history must go
+                mRenderableUboHistory.clear();
                 mRenderableUbh = driver.createBufferObject(
                         mRenderableUBOSize + sizeof(PerRenderableUib),
                         BufferObjectBinding::UNIFORM, BufferUsage::DYNAMIC);
@@ -685,7 +689,7 @@ void FView::prepare(FEngine& engine, DriverApi& driver, RootArenaScope& rootAren
                 // TODO: should we shrink the underlying UBO at some point?
             }
             assert_invariant(mRenderableUbh);
-            scene->updateUBOs(merged, mRenderableUbh);
+            scene->updateUBOs(merged, mRenderableUbh, mRenderableUboHistory, cullingFrustum);
         }
     }
 
@@ -29,6 +29,7 @@
 #include "Froxelizer.h"
 #include "PerViewUniforms.h"
 #include "PIDController.h"
+#include "RenderPass.h"
 #include "ShadowMap.h"
 #include "ShadowMapManager.h"
 #include "TypedUniformBuffer.h"
@@ -445,6 +446,10 @@ public:
         return mRenderableUbh;
     }
 
+    RenderPass::InstancingCache& getInstancingCache() noexcept {
+        return mInstancingCache;
+    }
+
 private:
     struct FPickingQuery : public PickingQuery {
     private:
@@ -499,6 +504,7 @@ private:
     // these are accessed in the render loop, keep together
     backend::Handle<backend::HwBufferObject> mLightUbh;
     backend::Handle<backend::HwBufferObject> mRenderableUbh;
+    RenderPass::InstancingCache mInstancingCache;   // automatic instancing of the color pass
 
     FScene* mScene = nullptr;
     // The camera set by the user, used for culling and viewing
@@ -561,6 +567,7 @@ private:
     Range mVisibleDirectionalShadowCasters;
     Range mSpotLightShadowCasters;
     uint32_t mRenderableUBOSize = 0;
+    FScene::RenderableUboHistory mRenderableUboHistory;
     mutable bool mHasDirectionalLight = false;
     mutable bool mHasDynamicLighting = false;
     mutable bool mHasShadowing = false;
@@ -0,0 +1,211 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <private/backend/HandleAllocator.h>
+
+#include <backend/Handle.h>
+
+#include <memory>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <stdint.h>
+
+// The HandleAllocator template is only instantiated for the backends that are built.
+#if defined(FILAMENT_SUPPORTS_OPENGL)
+
+using namespace filament::backend;
+
+namespace {
+
+// small enough that the handles of the tests don't all fit in the primary arena
+constexpr size_t ARENA_SIZE = 64 * 1024;
+
+struct HwSmall {
+    explicit HwSmall(uint32_t value) noexcept : value(value) {}
+    uint32_t value;
+};
+
+struct HwLarge {
+    explicit HwLarge(uint32_t value) noexcept : value(value), check(~value) {}
+    uint32_t value;
+    uint8_t padding[96] = {};
+    uint32_t check;
+};
+
+struct Allocation {
+    Handle<HwSmall> small;
+    Handle<HwLarge> large;
+    uint32_t value;
+};
+
+template<typename Allocator>
+void allocate(Allocator& allocator, std::vector<Allocation>& result, uint32_t first,
+        uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t const value = first + i;
+        result.push_back({
+                allocator.template allocateAndConstruct<HwSmall>(value),
+                allocator.template allocateAndConstruct<HwLarge>(value),
+                value });
+    }
+}
+
+template<typename Allocator>
+bool isIntact(Allocator& allocator, Allocation const& a) {
+    auto const* small = allocator.template handle_cast<HwSmall*>(a.small);
+    auto const* large = allocator.template handle_cast<HwLarge*>(a.large);
+    return small->value == a.value && large->value == a.value && large->check == ~a.value;
+}
+
+template<typename Allocator>
+void deallocate(Allocator& allocator, std::vector<Allocation>& allocations) {
+    for (Allocation& a : allocations) {
+        allocator.deallocate(a.small);
+        allocator.deallocate(a.large);
+    }
+    allocations.clear();
+}
+
+} // anonymous namespace
+
+TEST(HandleAllocator, ConcurrentAllocateAndFree) {
+    constexpr uint32_t THREAD_COUNT = 4;
+    constexpr uint32_t HANDLE_COUNT = 500;
+    constexpr uint32_t ROUND_COUNT = 8;
+
+    HandleAllocatorGL allocator("HandleAllocatorTest", ARENA_SIZE, false);
+    std::vector<Allocation> allocations[THREAD_COUNT];
+
+    auto runThreads = [&](auto const& work) {
+        std::vector<std::thread> threads;
+        for (uint32_t t = 0; t < THREAD_COUNT; t++) {
+            threads.emplace_back(work, t);
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+    };
+
+    for (uint32_t round = 0; round < ROUND_COUNT; round++) {
+        // every thread allocates handles, and frees some of them right away
+        runThreads([&](uint32_t t) {
+            allocate(allocator, allocations[t], t * HANDLE_COUNT, HANDLE_COUNT);
+            for (uint32_t i = 0; i < HANDLE_COUNT; i += 3) {
+                allocator.deallocate(allocations[t][i].small);
+                allocator.deallocate(allocations[t][i].large);
+                allocations[t][i] = {
+                        allocator.allocateAndConstruct<HwSmall>(t * HANDLE_COUNT + i),
+                        allocator.allocateAndConstruct<HwLarge>(t * HANDLE_COUNT + i),
+                        t * HANDLE_COUNT + i };
+            }
+        });
+
+        // all the live handles are distinct, and none of them was overwritten by another thread
+        std::set<void const*> pointers;
+        for (auto const& list : allocations) {
+            for (Allocation const& a : list) {
+                EXPECT_TRUE(isIntact(allocator, a));
+                EXPECT_TRUE(pointers.insert(allocator.handle_cast<HwSmall*>(a.small)).second);
+                EXPECT_TRUE(pointers.insert(allocator.handle_cast<HwLarge*>(a.large)).second);
+            }
+        }
+
+        // the handles are freed by another thread than the one that allocated them, which is
+        // what happens with DriverApi
+        runThreads([&](uint32_t t) {
+            std::vector<Allocation>& list = allocations[(t + 1) % THREAD_COUNT];
+            std::vector<Allocation> const freed = list;
+            deallocate(allocator, list);
+            for (Allocation a : freed) {
+                EXPECT_FALSE(allocator.is_valid(a.small));
+                EXPECT_FALSE(allocator.is_valid(a.large));
+            }
+        });
+    }
+}
+
+TEST(HandleAllocator, SeveralAllocatorsOnOneThread) {
+    // more allocators than a thread keeps magazines for
+    constexpr size_t ALLOCATOR_COUNT = 5;
+    constexpr uint32_t HANDLE_COUNT = 300;
+
+    std::unique_ptr<HandleAllocatorGL> allocators[ALLOCATOR_COUNT];
+    std::vector<Allocation> allocations[ALLOCATOR_COUNT];
+    for (auto& allocator : allocators) {
+        allocator = std::make_unique<HandleAllocatorGL>("HandleAllocatorTest", ARENA_SIZE, false);
+    }
+
+    // interleave the allocations and frees of all allocators
+    for (uint32_t i = 0; i < HANDLE_COUNT; i++) {
+        for (size_t k = 0; k < ALLOCATOR_COUNT; k++) {
+            allocate(*allocators[k], allocations[k], i, 1);
+            if (i % 4 == 3) {
+                Allocation& a = allocations[k][i - 2];
+                allocators[k]->deallocate(a.small);
+                allocators[k]->deallocate(a.large);
+                a = { allocators[k]->allocateAndConstruct<HwSmall>(i - 2),
+                      allocators[k]->allocateAndConstruct<HwLarge>(i - 2), i - 2 };
+            }
+        }
+    }
+
+    for (size_t k = 0; k < ALLOCATOR_COUNT; k++) {
+        std::set<void const*> pointers;
+        for (Allocation const& a : allocations[k]) {
+            EXPECT_TRUE(isIntact(*allocators[k], a));
+            EXPECT_TRUE(pointers.insert(allocators[k]->handle_cast<HwSmall*>(a.small)).second);
+            EXPECT_TRUE(pointers.insert(allocators[k]->handle_cast<HwLarge*>(a.large)).second);
+        }
+        deallocate(*allocators[k], allocations[k]);
+    }
+
+    // an allocator can be destroyed while this thread still caches some of its handles
+    allocators[0].reset();
+    Allocation const a = { allocators[1]->allocateAndConstruct<HwSmall>(1),
+                           allocators[1]->allocateAndConstruct<HwLarge>(1), 1 };
+    EXPECT_TRUE(isIntact(*allocators[1], a));
+}
+
+TEST(HandleAllocator, TwoAllocatorsOnOneThreadKeepTheirHandles) {
+    HandleAllocatorGL a("HandleAllocatorTest", ARENA_SIZE, false);
+    HandleAllocatorGL b("HandleAllocatorTest", ARENA_SIZE, false);
+
+    for (uint32_t i = 0; i < 100; i++) {
+        Handle<HwSmall> ha = a.allocateAndConstruct<HwSmall>(i);
+        void const* const pa = a.handle_cast<HwSmall*>(ha);
+        a.deallocate(ha);
+
+        // using the other allocator must not return the handles cached for the first one, the
+        // block that was just freed is the first one reused.
+        Handle<HwSmall> hb = b.allocateAndConstruct<HwSmall>(i);
+        EXPECT_EQ(b.handle_cast<HwSmall*>(hb)->value, i);
+
+        Handle<HwSmall> ha2 = a.allocateAndConstruct<HwSmall>(i + 1);
+        EXPECT_EQ(a.handle_cast<HwSmall*>(ha2), pa);
+        EXPECT_NE(ha2, ha);     // the age of the block changed
+        EXPECT_FALSE(a.is_valid(ha));
+        EXPECT_EQ(a.handle_cast<HwSmall*>(ha2)->value, i + 1);
+
+        b.deallocate(hb);
+        a.deallocate(ha2);
+    }
+}
+
+#endif // FILAMENT_SUPPORTS_OPENGL
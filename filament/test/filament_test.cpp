@@ -41,6 +41,7 @@
 #include "details/Camera.h"
 #include "Froxelizer.h"
 #include "details/Engine.h"
+#include "details/Scene.h"
 #include "components/RenderableManager.h"
 #include "components/TransformManager.h"
 #include "UniformBuffer.h"
@@ -653,6 +654,74 @@ TEST(FilamentTest, ColorConversion) {
     EXPECT_PRED1(isGray, Color::toLinear<ACCURATE>(sRGBColor{0.5f}));
 }
 
+TEST(FilamentTest, RenderableUboDelta) {
+    constexpr uint32_t COUNT = 1000;
+    std::vector<PerRenderableData> data(COUNT);
+    for (uint32_t i = 0; i < COUNT; i++) {
+        data[i].objectId = i;
+    }
+
+    // the content of the UBO, as uploaded by FScene::updateUBOs()
+    std::vector<PerRenderableData> ubo(COUNT);
+    Range<uint32_t> const visible{ 0, COUNT };
+    FScene::RenderableUboHistory history;
+    std::vector<Range<uint32_t>> ranges;
+    size_t dirtyCount = 0;
+    auto update = [&](backend::Handle<backend::HwBufferObject> ubh) {
+        bool const delta = FScene::findDirtyUboRanges(data.data(), visible, ubh, history,
+                ranges, dirtyCount);
+        if (delta) {
+            size_t rowCount = 0;
+            for (Range<uint32_t> const& range : ranges) {
+                std::copy(data.begin() + range.first, data.begin() + range.last,
+                        ubo.begin() + range.first);
+                rowCount += range.size();
+            }
+            EXPECT_EQ(rowCount, dirtyCount);
+        } else {
+            ubo = data;
+        }
+        EXPECT_EQ(0, memcmp(ubo.data(), data.data(), COUNT * sizeof(PerRenderableData)));
+        return delta;
+    };
+
+    backend::Handle<backend::HwBufferObject> const ubh{ 1 };
+
+    // the first update uploads everything
+    EXPECT_FALSE(update(ubh));
+
+    // nothing changed
+    EXPECT_TRUE(update(ubh));
+    EXPECT_TRUE(ranges.empty());
+
+    // a few sparse rows changed, nearby ones are merged
+    data[10].userData = 1.0f;
+    data[500].userData = 1.0f;
+    data[503].userData = 1.0f;
+    data[999].userData = 1.0f;
+    EXPECT_TRUE(update(ubh));
+    EXPECT_EQ(ranges.size(), 3);
+    EXPECT_EQ(dirtyCount, 6);
+
+    // too many scattered rows changed, everything is uploaded again
+    for (uint32_t i = 0; i < COUNT; i += 9) {
+        data[i].userData = 2.0f;
+    }
+    EXPECT_FALSE(update(ubh));
+    EXPECT_TRUE(update(ubh));
+    EXPECT_TRUE(ranges.empty());
+
+    // more than half of the rows changed
+    for (uint32_t i = 0; i < COUNT; i += 2) {
+        data[i].userData = 3.0f;
+        data[i + 1].userData = 3.0f;
+    }
+    EXPECT_FALSE(update(ubh));
+
+    // a different UBO is uploaded entirely
+    data[0].userData = 4.0f;
+    EXPECT_FALSE(update(backend::Handle<backend::HwBufferObject>{ 2 }));
+}
 
 TEST(FilamentTest, FroxelData) {
     using namespace filament;
@@ -18,6 +18,7 @@
 #define TNT_FILAFLAT_DICTIONARY_READER_H
 
 #include <filaflat/ChunkContainer.h>
+#include <filaflat/LazyDictionary.h>
 
 namespace filaflat {
 
@@ -25,6 +26,11 @@ struct DictionaryReader {
     static bool unflatten(ChunkContainer const& container,
             ChunkContainer::Type dictionaryTag,
             BlobDictionary& dictionary);
+
+    // Only records where each blob is, decoding happens in LazyDictionary::decode().
+    static bool unflatten(ChunkContainer const& container,
+            ChunkContainer::Type dictionaryTag,
+            LazyDictionary& dictionary);
 };
 
 } // namespace filaflat
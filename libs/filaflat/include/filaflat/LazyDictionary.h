@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_FILAFLAT_LAZY_DICTIONARY_H
+#define TNT_FILAFLAT_LAZY_DICTIONARY_H
+
+#include <filaflat/ChunkContainer.h>
+
+#include <utils/compiler.h>
+#include <utils/FixedCapacityVector.h>
+
+#include <array>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace filaflat {
+
+// A dictionary that references its blobs in the material package instead of copying them, and
+// that decodes compressed (SMOL-V) blobs only when they are requested. The same blob is often
+// shared by several variants, so the most recently decoded blobs are kept in a small cache.
+// The material package must outlive the dictionary.
+class UTILS_PUBLIC LazyDictionary {
+public:
+    // A blob as it is stored in the package. Text blobs include their trailing null.
+    struct Blob {
+        uint8_t const* mData = nullptr;
+        size_t mSize = 0;
+        uint8_t const* data() const noexcept { return mData; }
+        size_t size() const noexcept { return mSize; }
+    };
+
+    size_t size() const noexcept { return mBlobs.size(); }
+
+    // Returns the blob as it is stored in the package, i.e. still compressed for SPIR-V.
+    Blob const& operator[](size_t index) const noexcept { return mBlobs[index]; }
+
+    // Copies the decoded content of a blob into content. Returns false on failure.
+    bool decode(size_t index, ShaderContent& content);
+
+private:
+    friend struct DictionaryReader;
+
+    static constexpr size_t CACHE_SIZE = 4;
+
+    struct CacheEntry {
+        uint32_t index = UINT32_MAX;
+        uint32_t lastUse = 0;
+        ShaderContent content;
+    };
+
+    utils::FixedCapacityVector<Blob> mBlobs;
+    std::array<CacheEntry, CACHE_SIZE> mCache;
+    uint32_t mUseCount = 0;
+    bool mCompressed = false;
+};
+
+} // namespace filaflat
+
+#endif // TNT_FILAFLAT_LAZY_DICTIONARY_H
@@ -20,6 +20,7 @@
 #include <filament/MaterialChunkType.h>
 
 #include <filaflat/ChunkContainer.h>
+#include <filaflat/LazyDictionary.h>
 #include <filaflat/Unflattener.h>
 
 #include <private/filament/Variant.h>
@@ -50,6 +51,10 @@ public:
     bool getShader(ShaderContent& shaderContent, BlobDictionary const& dictionary,
             ShaderModel shaderModel, filament::Variant variant, ShaderStage stage);
 
+    // same as above, but binary shaders are only decoded when requested
+    bool getShader(ShaderContent& shaderContent, LazyDictionary& dictionary,
+            ShaderModel shaderModel, filament::Variant variant, ShaderStage stage);
+
     uint32_t getShaderCount() const noexcept;
 
     void visitShaders(utils::Invocable<void(ShaderModel, Variant, ShaderStage)>&& visitor) const;
@@ -70,12 +75,18 @@ private:
     const uint8_t* mBase = nullptr;
     tsl::robin_map<uint32_t, uint32_t> mOffsets;
 
+    template<typename Dictionary>
+    bool getShaderImpl(ShaderContent& shaderContent, Dictionary& dictionary,
+            ShaderModel shaderModel, filament::Variant variant, ShaderStage stage);
+
+    template<typename Dictionary>
     bool getTextShader(Unflattener unflattener,
-            BlobDictionary const& dictionary, ShaderContent& shaderContent,
+            Dictionary const& dictionary, ShaderContent& shaderContent,
             ShaderModel shaderModel, filament::Variant variant, ShaderStage shaderStage);
 
+    template<typename Dictionary>
     bool getBinaryShader(
-            BlobDictionary const& dictionary, ShaderContent& shaderContent,
+            Dictionary& dictionary, ShaderContent& shaderContent,
             ShaderModel shaderModel, filament::Variant variant, ShaderStage shaderStage);
 };
 
@@ -120,4 +120,55 @@ bool DictionaryReader::unflatten(ChunkContainer const& container,
     return false;
 }
 
+bool DictionaryReader::unflatten(ChunkContainer const& container,
+        ChunkContainer::Type dictionaryTag,
+        LazyDictionary& dictionary) {
+
+    auto [start, end] = container.getChunkRange(dictionaryTag);
+    Unflattener unflattener(start, end);
+
+    if (dictionaryTag == ChunkType::DictionarySpirv) {
+        uint32_t compressionScheme;
+        if (!unflattener.read(&compressionScheme)) {
+            return false;
+        }
+        // For now, 1 is the only acceptable compression scheme.
+        assert(compressionScheme == 1);
+        dictionary.mCompressed = true;
+    } else if (dictionaryTag == ChunkType::DictionaryMetalLibrary) {
+        dictionary.mCompressed = false;
+    } else if (dictionaryTag == ChunkType::DictionaryText) {
+        dictionary.mCompressed = false;
+    } else {
+        return false;
+    }
+
+    uint32_t blobCount;
+    if (!unflattener.read(&blobCount)) {
+        return false;
+    }
+
+    dictionary.mBlobs.reserve(blobCount);
+    for (uint32_t i = 0; i < blobCount; i++) {
+        if (dictionaryTag == ChunkType::DictionaryText) {
+            const char* str;
+            if (!unflattener.read(&str)) {
+                return false;
+            }
+            // the trailing null is included, like in BlobDictionary
+            dictionary.mBlobs.push_back({ (uint8_t const*)str, strlen(str) + 1 });
+        } else {
+            unflattener.skipAlignmentPadding();
+
+            const char* data;
+            size_t dataSize;
+            if (!unflattener.read(&data, &dataSize)) {
+                return false;
+            }
+            dictionary.mBlobs.push_back({ (uint8_t const*)data, dataSize });
+        }
+    }
+    return true;
+}
+
 } // namespace filaflat
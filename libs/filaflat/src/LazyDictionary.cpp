@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <filaflat/LazyDictionary.h>
+
+#if defined (FILAMENT_DRIVER_SUPPORTS_VULKAN)
+#include <smolv.h>
+#endif
+
+#include <utils/Systrace.h>
+
+#include <algorithm>
+
+#include <string.h>
+
+namespace filaflat {
+
+bool LazyDictionary::decode(size_t index, ShaderContent& content) {
+    if (index >= mBlobs.size()) {
+        return false;
+    }
+
+    Blob const& blob = mBlobs[index];
+    if (!mCompressed) {
+        ShaderContent copy(blob.size());
+        memcpy(copy.data(), blob.data(), blob.size());
+        content = std::move(copy);
+        return true;
+    }
+
+    for (CacheEntry& entry : mCache) {
+        if (entry.index == index) {
+            entry.lastUse = ++mUseCount;
+            content = entry.content;
+            return true;
+        }
+    }
+
+#if defined (FILAMENT_DRIVER_SUPPORTS_VULKAN)
+    SYSTRACE_CALL();
+
+    size_t const spirvSize = smolv::GetDecodedBufferSize(blob.data(), blob.size());
+    if (spirvSize == 0) {
+        return false;
+    }
+    ShaderContent spirv(spirvSize);
+    if (!smolv::Decode(blob.data(), blob.size(), spirv.data(), spirvSize)) {
+        return false;
+    }
+
+    // replace the least recently used entry
+    CacheEntry& entry = *std::min_element(mCache.begin(), mCache.end(),
+            [](CacheEntry const& lhs, CacheEntry const& rhs) {
+                return lhs.lastUse < rhs.lastUse;
+            });
+    entry.index = uint32_t(index);
+    entry.lastUse = ++mUseCount;
+    entry.content = spirv;
+
+    content = std::move(spirv);
+    return true;
+#else
+    return false;
+#endif
+}
+
+} // namespace filaflat
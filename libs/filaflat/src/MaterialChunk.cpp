@@ -23,6 +23,17 @@
 
 namespace filaflat {
 
+static bool copyBlob(BlobDictionary const& dictionary, size_t index,
+        ShaderContent& shaderContent) {
+    shaderContent = dictionary[index];
+    return true;
+}
+
+static bool copyBlob(LazyDictionary& dictionary, size_t index,
+        ShaderContent& shaderContent) {
+    return dictionary.decode(index, shaderContent);
+}
+
 static inline uint32_t makeKey(
         MaterialChunk::ShaderModel shaderModel,
         MaterialChunk::Variant variant,
@@ -95,8 +106,9 @@ bool MaterialChunk::initialize(filamat::ChunkType materialTag) {
     return true;
 }
 
+template<typename Dictionary>
 bool MaterialChunk::getTextShader(Unflattener unflattener,
-        BlobDictionary const& dictionary, ShaderContent& shaderContent,
+        Dictionary const& dictionary, ShaderContent& shaderContent,
         ShaderModel shaderModel, Variant variant, ShaderStage shaderStage) {
     if (mBase == nullptr) {
         return false;
@@ -153,7 +165,8 @@ bool MaterialChunk::getTextShader(Unflattener unflattener,
     return true;
 }
 
-bool MaterialChunk::getBinaryShader(BlobDictionary const& dictionary,
+template<typename Dictionary>
+bool MaterialChunk::getBinaryShader(Dictionary& dictionary,
         ShaderContent& shaderContent, ShaderModel shaderModel, filament::Variant variant, ShaderStage shaderStage) {
 
     if (mBase == nullptr) {
@@ -166,8 +179,7 @@ bool MaterialChunk::getBinaryShader(BlobDictionary const& dictionary,
         return false;
     }
 
-    shaderContent = dictionary[pos->second];
-    return true;
+    return copyBlob(dictionary, pos->second, shaderContent);
 }
 
 bool MaterialChunk::hasShader(ShaderModel model, Variant variant, ShaderStage stage) const noexcept {
@@ -178,7 +190,8 @@ bool MaterialChunk::hasShader(ShaderModel model, Variant variant, ShaderStage st
     return pos != mOffsets.end();
 }
 
-bool MaterialChunk::getShader(ShaderContent& shaderContent, BlobDictionary const& dictionary,
+template<typename Dictionary>
+bool MaterialChunk::getShaderImpl(ShaderContent& shaderContent, Dictionary& dictionary,
         ShaderModel shaderModel, filament::Variant variant, ShaderStage stage) {
     switch (mMaterialTag) {
         case filamat::ChunkType::MaterialGlsl:
@@ -193,6 +206,16 @@ bool MaterialChunk::getShader(ShaderContent& shaderContent, BlobDictionary const
     }
 }
 
+bool MaterialChunk::getShader(ShaderContent& shaderContent, BlobDictionary const& dictionary,
+        ShaderModel shaderModel, filament::Variant variant, ShaderStage stage) {
+    return getShaderImpl(shaderContent, dictionary, shaderModel, variant, stage);
+}
+
+bool MaterialChunk::getShader(ShaderContent& shaderContent, LazyDictionary& dictionary,
+        ShaderModel shaderModel, filament::Variant variant, ShaderStage stage) {
+    return getShaderImpl(shaderContent, dictionary, shaderModel, variant, stage);
+}
+
 uint32_t MaterialChunk::getShaderCount() const noexcept {
     Unflattener unflattener{ mUnflattener }; // make a copy
     uint64_t numShaders;
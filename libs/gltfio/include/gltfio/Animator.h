@@ -44,6 +44,9 @@ public:
      *
      * @param animationIndex Zero-based index for the \c animation of interest.
      * @param time Elapsed time of interest in seconds.
+     *
+     * Animations with many channels are evaluated on the engine's JobSystem, so this must be called
+     * from the thread that created the engine.
      */
     void applyAnimation(size_t animationIndex, float time) const;
 
@@ -52,6 +55,9 @@ public:
      * the results into filament::RenderableManager::setBones.
      * Uses filament::TransformManager and filament::RenderableManager.
      *
+     * Bone matrices of large skins, or of many instances, are computed on the engine's JobSystem,
+     * so this must be called from the thread that created the engine.
+     *
      * NOTE: this operation is independent of \c animation.
      */
     void updateBoneMatrices();
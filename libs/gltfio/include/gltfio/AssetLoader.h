@@ -83,6 +83,14 @@ struct AssetConfiguration {
     //! Optional to enable mikktspace tangents. Lifetime of struct only needs to be maintained for
     //  the duration of the constructor of AssetLoader.
     AssetConfigurationExtended* ext = nullptr;
+
+    //! Converts vertex attributes to compact formats when uploading them. Texture coordinates
+    //! become half floats. Positions become normalized 16-bit integers, and the transform that
+    //! restores them is folded into the transform of the renderable; this is only done for meshes
+    //! that are neither skinned nor morphed, and whose nodes have no children and are not animated.
+    //! When enabled, the local transform of these nodes includes the dequantization transform.
+    //! This is not supported with the extended implementation.
+    bool quantizeVertices = false;
 };
 
 /**
@@ -204,6 +212,26 @@ public:
     FilamentAsset* createInstancedAsset(const uint8_t* bytes, uint32_t numBytes,
             FilamentInstance** instances, size_t numInstances);
 
+    /**
+     * Loads a GLB or a JSON-based glTF 2.0 file from the file system and returns an asset with one
+     * instance, or null on failure.
+     *
+     * Rather than being copied, the file is memory-mapped and kept mapped until the source data
+     * is released and every vertex and index buffer upload that points into it has completed.
+     * ResourceLoader also maps external buffer files (.bin) this way. This keeps the peak
+     * resident memory of very large models close to the size of the data actually in use.
+     *
+     * The mapping is private, so the file is never modified.
+     */
+    FilamentAsset* createAssetFromFile(const char* path);
+
+    /**
+     * Same as createInstancedAsset() but loads the glTF file from the file system like
+     * createAssetFromFile().
+     */
+    FilamentAsset* createInstancedAssetFromFile(const char* path,
+            FilamentInstance** instances, size_t numInstances);
+
     /**
      * Adds a new instance to the asset.
      *
@@ -23,7 +23,10 @@
 
 #include <utils/compiler.h>
 
+#include <stddef.h>
+
 namespace filament {
+    class Camera;
     class Engine;
 }
 
@@ -49,6 +52,25 @@ struct ResourceConfiguration {
     //! If true, adjusts skinning weights to sum to 1. Well formed glTF files do not need this,
     //! but it is useful for robustness.
     bool normalizeSkinningWeights;
+
+    //! If true, reorders the triangles and vertices of each indexed triangle primitive to improve
+    //! the efficiency of the GPU vertex cache, overdraw and vertex fetch, before uploading them.
+    //! This is done in place in the source buffers, and only for primitives that do not share
+    //! any of their data with other primitives.
+    bool optimizeMeshes = false;
+
+    //! If true, ResourceLoader::asyncBeginLoad() does not upload the vertex, index and morph target
+    //! buffers right away. Instead, each call to ResourceLoader::asyncUpdateLoad() uploads the
+    //! geometry of a few meshes, the ones nearest to the streaming camera first, or the largest
+    //! ones if there is no camera (see ResourceLoader::asyncSetStreamingCamera). Renderables are
+    //! not returned by FilamentAsset::popRenderables() until their geometry has been uploaded.
+    //! This has no effect on the synchronous ResourceLoader::loadResources().
+    bool streamGeometry = false;
+
+    //! Maximum number of bytes of geometry uploaded by each call to
+    //! ResourceLoader::asyncUpdateLoad() when streamGeometry is true. The geometry of a mesh is
+    //! never split, so at least one mesh is uploaded per call.
+    size_t geometryUploadBudget = 4u * 1024u * 1024u;
 };
 
 /**
@@ -147,11 +169,31 @@ public:
      */
     void asyncUpdateLoad();
 
+    /**
+     * Raises the decoding priority of the textures used by the given renderables, for example the
+     * ones that are currently visible, so that they are decoded before the rest of the asset.
+     *
+     * This only affects textures that have not started decoding, and it is ignored by texture
+     * providers that do not support priorities.
+     */
+    void asyncPrioritizeEntities(const utils::Entity* entities, size_t count);
+
+    /**
+     * Sets the camera used to order the geometry uploads when ResourceConfiguration::streamGeometry
+     * is enabled. The meshes nearest to the camera are uploaded first; without a camera, which is
+     * the default, the largest meshes are uploaded first. The priorities are evaluated on each call
+     * to #asyncUpdateLoad, so the camera can move while the asset is streamed.
+     *
+     * The camera is not owned by the loader, it must outlive the load or be reset to nullptr.
+     */
+    void asyncSetStreamingCamera(const Camera* camera);
+
     /**
      * Cancels pending decoder jobs, frees all CPU-side texel data, and flushes the Engine.
      *
      * Calling this is only necessary if the asyncBeginLoad API was used
-     * and cancellation is required before progress reaches 100%.
+     * and cancellation is required before progress reaches 100%. When streaming geometry, this
+     * must also be called before destroying an asset whose load is not complete.
      */
     void asyncCancelLoad();
 
@@ -0,0 +1,192 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GLTFIO_STATICBATCHER_H
+#define GLTFIO_STATICBATCHER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <utils/compiler.h>
+#include <utils/Entity.h>
+
+#include <math/vec3.h>
+
+namespace filament {
+    class Engine;
+}
+
+namespace filament::gltfio {
+
+class FilamentInstance;
+
+/**
+ * \struct StaticBatcherConfiguration StaticBatcher.h gltfio/StaticBatcher.h
+ * \brief Construction parameters for StaticBatcher.
+ */
+struct StaticBatcherConfiguration {
+    //! The engine used to create and destroy the merged renderables.
+    class filament::Engine* engine;
+
+    //! Maximum number of vertices in a single merged renderable.
+    uint32_t maxVertexCount = 65536;
+
+    //! Largest dimension of the world-space bounding box of a merged renderable, or zero for no
+    //! limit. Smaller batches are culled more accurately but cost more draw calls.
+    float maxExtent = 0.0f;
+
+    //! Primitives with more triangles than this are left alone, since they do not benefit much
+    //! from merging. Zero means that all eligible primitives are merged.
+    uint32_t maxTriangleCount = 4096;
+};
+
+/**
+ * \class StaticBatcher StaticBatcher.h gltfio/StaticBatcher.h
+ * \brief Merges the static primitives of glTF instances into a small number of renderables.
+ *
+ * Scenes made of many small renderables are often limited by the per-renderable cost of culling,
+ * sorting and command generation rather than by their triangle count. StaticBatcher gathers the
+ * primitives of an instance that share the same MaterialInstance (and visibility and shadow
+ * settings), sorts them spatially and merges them into clusters whose vertices are pre-transformed
+ * into the space of the instance root. Each cluster becomes a single renderable with one
+ * primitive, which is culled as a whole.
+ *
+ * Only static geometry is merged: primitives of skinned nodes, of nodes with morph targets, of
+ * animated nodes (or their descendants), triangle lists compressed with Draco, and non-triangle
+ * primitives are left untouched. A renderable is only merged if all of its primitives can be, in
+ * which case it is hidden by setting its layer mask to zero; it is restored when the instance is
+ * removed.
+ *
+ * The vertex data is read from the glTF source, so instances must be added after their resources
+ * have been loaded and before FilamentAsset::releaseSourceData() is called. Material variants must
+ * be applied before the instance is added.
+ *
+ * The batcher keeps track of which source entity contributed which range of triangles, so that
+ * individual entities can still be hidden with setVisible() and picking results can be mapped back
+ * to a source entity with getSourceEntity().
+ *
+ * StaticBatcher must be used from the thread that created the Engine.
+ *
+ * Example usage:
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * resourceLoader.loadResources(asset);
+ * StaticBatcher* batcher = StaticBatcher::create({ .engine = engine });
+ * size_t const count = batcher->addInstance(asset->getInstance());
+ * scene->addEntities(batcher->getBatchEntities() + batcher->getBatchCount() - count, count);
+ * scene->addEntities(asset->getEntities(), asset->getEntityCount());
+ * asset->releaseSourceData();
+ *
+ * do {
+ *     batcher->setVisible(entity, false);
+ *     ...
+ *     batcher->update();
+ * } while (!quit);
+ *
+ * scene->removeEntities(batcher->getBatchEntities(), batcher->getBatchCount());
+ * StaticBatcher::destroy(&batcher);
+ * loader->destroyAsset(asset);
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ */
+class UTILS_PUBLIC StaticBatcher {
+public:
+    /**
+     * Creates a static batcher with the given configuration.
+     */
+    static StaticBatcher* create(const StaticBatcherConfiguration& config);
+
+    /**
+     * Removes all instances and frees the batcher.
+     */
+    static void destroy(StaticBatcher** batcher);
+
+    /**
+     * Merges the static primitives of the given instance.
+     *
+     * The new renderables are appended to the list returned by getBatchEntities(), and are
+     * children of the instance root in the TransformManager, so the instance can still be moved as
+     * a whole. Clients are responsible for adding them to their Scene.
+     *
+     * @return the number of renderables that were created
+     */
+    size_t addInstance(FilamentInstance* instance);
+
+    /**
+     * Destroys the merged renderables of the given instance and restores the layer mask of its
+     * source renderables.
+     *
+     * This must be called before the instance is destroyed.
+     */
+    void removeInstance(FilamentInstance* instance);
+
+    /**
+     * Returns the renderables that were created by addInstance().
+     */
+    const utils::Entity* getBatchEntities() const noexcept;
+
+    /**
+     * Returns the number of renderables that were created by addInstance().
+     */
+    size_t getBatchCount() const noexcept;
+
+    /**
+     * Returns true if the primitives of the given entity were merged.
+     */
+    bool isBatched(utils::Entity source) const noexcept;
+
+    /**
+     * Shows or hides all merged primitives of the given source entity.
+     *
+     * Changes take effect during the next call to update().
+     */
+    void setVisible(utils::Entity source, bool visible);
+
+    /**
+     * Returns false if the given source entity was hidden with setVisible().
+     */
+    bool isVisible(utils::Entity source) const noexcept;
+
+    /**
+     * Rebuilds the index buffers and bounding boxes of the merged renderables whose source
+     * entities have been shown or hidden since the previous call.
+     */
+    void update();
+
+    /**
+     * Maps a picking result back to the source entity that it hit.
+     *
+     * @param batch the renderable reported by View::pick()
+     * @param position the world-space position of the picking hit
+     * @return the smallest visible source entity whose bounds contain the given position, or a
+     *         null entity if there is none. If the given entity is not a merged renderable it is
+     *         returned unchanged.
+     */
+    utils::Entity getSourceEntity(utils::Entity batch, math::float3 const& position) const noexcept;
+
+protected:
+    StaticBatcher() noexcept = default;
+    ~StaticBatcher() = default;
+
+public:
+    StaticBatcher(StaticBatcher const&) = delete;
+    StaticBatcher(StaticBatcher&&) = delete;
+    StaticBatcher& operator=(StaticBatcher const&) = delete;
+    StaticBatcher& operator=(StaticBatcher&&) = delete;
+};
+
+} // namespace filament::gltfio
+
+#endif // GLTFIO_STATICBATCHER_H
@@ -30,6 +30,8 @@ namespace filament {
 
 namespace filament::gltfio {
 
+class TextureStreamer;
+
 /**
  * TextureProvider is an interface that allows clients to implement their own texture decoding
  * facility for JPEG, PNG, or KTX2 content. It constructs Filament Texture objects synchronously,
@@ -155,6 +157,15 @@ public:
      */
     virtual void cancelDecoding() = 0;
 
+    /**
+     * Changes the decoding priority of a texture that has been pushed but not yet decoded.
+     *
+     * Textures with a higher priority are decoded first, textures with equal priorities are
+     * decoded in the order they were pushed. The default priority is zero. This has no effect on
+     * textures whose decoding has already started, and the default implementation ignores it.
+     */
+    virtual void setPriority(Texture* texture, float priority) {}
+
     /** Total number of successful push calls since the provider was created. */
     virtual size_t getPushedCount() const = 0;
 
@@ -173,6 +184,12 @@ public:
  */
 TextureProvider* createStbProvider(filament::Engine* engine);
 
+/**
+ * Creates a stb_image decoder that makes only the coarse miplevels of each texture resident, and
+ * hands the textures over to the given TextureStreamer, which streams in finer miplevels on demand.
+ */
+TextureProvider* createStbProvider(filament::Engine* engine, TextureStreamer* streamer);
+
 /**
  * Creates a decoder that can handle certain types of "image/ktx2" content as specified in
  * the KHR_texture_basisu specification.
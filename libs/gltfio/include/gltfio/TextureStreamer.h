@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GLTFIO_TEXTURESTREAMER_H
+#define GLTFIO_TEXTURESTREAMER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <utils/compiler.h>
+
+namespace filament {
+    class Engine;
+    class View;
+}
+
+namespace filament::gltfio {
+
+class FilamentAsset;
+
+/**
+ * \struct TextureStreamerConfiguration TextureStreamer.h gltfio/TextureStreamer.h
+ * \brief Construction parameters for TextureStreamer.
+ */
+struct TextureStreamerConfiguration {
+    //! The engine used to create and destroy streamed textures.
+    class filament::Engine* engine;
+
+    //! Maximum amount of GPU memory that streamed textures can occupy, including their mip chain.
+    size_t budgetInBytes = 256u * 1024u * 1024u;
+
+    //! Maximum number of texel bytes uploaded by a single call to TextureStreamer::update().
+    size_t uploadBudgetInBytes = 16u * 1024u * 1024u;
+
+    //! Largest dimension of the coarse miplevel that every texture keeps resident. Textures that
+    //! are smaller than this are loaded at full resolution and never streamed.
+    uint32_t residentSize = 128;
+
+    //! Bias added to the miplevel computed from screen-space usage. Positive values select
+    //! coarser miplevels.
+    float lodBias = 0.0f;
+
+    //! Number of consecutive updates during which a texture must need fewer texels than are
+    //! resident before it is downgraded, unless the memory budget requires it sooner.
+    uint32_t evictionDelay = 60;
+};
+
+/**
+ * \class TextureStreamer TextureStreamer.h gltfio/TextureStreamer.h
+ * \brief Keeps a limited range of miplevels resident for each texture, based on screen usage.
+ *
+ * Textures that are decoded by a streaming-enabled TextureProvider (see createStbProvider) are
+ * initially created with only their coarse miplevels. Each call to update() estimates the
+ * screen-space size of every renderable that uses a streamed texture, picks the finest miplevel
+ * that is useful at that size, and then streams finer miplevels in or evicts them, while keeping
+ * the total under the configured memory budget.
+ *
+ * Streaming a miplevel in or out replaces the Filament Texture object and re-binds it to every
+ * material instance of the asset, so clients should not hold on to the Texture pointers of
+ * streamed assets.
+ *
+ * TextureStreamer must be used from the thread that created the Engine. Assets must be removed
+ * from the streamer before they are destroyed.
+ *
+ * Example usage:
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * TextureStreamer* streamer = TextureStreamer::create({ .engine = engine });
+ * TextureProvider* decoder = createStbProvider(engine, streamer);
+ * resourceLoader.addTextureProvider("image/png", decoder);
+ * resourceLoader.addTextureProvider("image/jpeg", decoder);
+ * resourceLoader.loadResources(asset);
+ * streamer->addAsset(asset);
+ *
+ * do {
+ *     streamer->update(*view);
+ *     ...
+ * } while (!quit);
+ *
+ * streamer->removeAsset(asset);
+ * loader->destroyAsset(asset);
+ * delete decoder;
+ * TextureStreamer::destroy(&streamer);
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ */
+class UTILS_PUBLIC TextureStreamer {
+public:
+    struct Stats {
+        size_t textureCount;      //!< number of streamed textures
+        size_t residentBytes;     //!< GPU memory currently used by streamed textures
+        size_t requestedBytes;    //!< GPU memory that would be used without a budget
+        size_t pendingCount;      //!< number of miplevel changes that are being decoded
+        size_t uploadedBytes;     //!< texel bytes uploaded during the most recent update
+    };
+
+    /**
+     * Creates a texture streamer with the given configuration.
+     */
+    static TextureStreamer* create(const TextureStreamerConfiguration& config);
+
+    /**
+     * Cancels all pending work and frees the streamer.
+     *
+     * This does not destroy the Filament textures, which are owned by their asset.
+     */
+    static void destroy(TextureStreamer** streamer);
+
+    /**
+     * Allows the textures of the given asset to be streamed.
+     *
+     * This must be called after ResourceLoader has started loading the asset's resources.
+     */
+    void addAsset(FilamentAsset* asset);
+
+    /**
+     * Stops streaming the textures of the given asset and frees the associated source data.
+     *
+     * This must be called before the asset is destroyed.
+     */
+    void removeAsset(FilamentAsset* asset);
+
+    /**
+     * Computes the miplevel required by each texture from the given view's camera and viewport,
+     * kicks off decoding jobs and uploads miplevels that have finished decoding.
+     *
+     * Clients should call this once per frame, before rendering the view.
+     */
+    void update(View const& view);
+
+    /**
+     * Returns memory usage statistics for the most recent call to update().
+     */
+    Stats getStats() const noexcept;
+
+protected:
+    TextureStreamer() noexcept = default;
+    ~TextureStreamer() = default;
+
+public:
+    TextureStreamer(TextureStreamer const&) = delete;
+    TextureStreamer(TextureStreamer&&) = delete;
+    TextureStreamer& operator=(TextureStreamer const&) = delete;
+    TextureStreamer& operator=(TextureStreamer&&) = delete;
+};
+
+} // namespace filament::gltfio
+
+#endif // GLTFIO_TEXTURESTREAMER_H
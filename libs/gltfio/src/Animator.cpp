@@ -26,7 +26,9 @@
 #include <filament/RenderableManager.h>
 #include <filament/TransformManager.h>
 
+#include <utils/JobSystem.h>
 #include <utils/Log.h>
+#include <utils/Systrace.h>
 
 #include <math/mat4.h>
 #include <math/quat.h>
@@ -34,6 +36,8 @@
 #include <math/vec3.h>
 #include <math/vec4.h>
 
+#include <algorithm>
+#include <functional>
 #include <map>
 #include <string>
 #include <vector>
@@ -45,12 +49,19 @@ using namespace utils;
 
 namespace filament::gltfio {
 
-using TimeValues = map<float, size_t>;
+using TimeValues = vector<float>;
+using KeyframeIndices = vector<uint32_t>;
 using SourceValues = vector<float>;
 using BoneVector = vector<mat4f>;
 
+// Below these counts, animation channels and bone matrices are evaluated on the calling thread
+// since the cost of dispatching jobs would outweigh the benefits.
+static constexpr size_t JOBS_PARALLEL_FOR_CHANNELS_COUNT = 128;
+static constexpr size_t JOBS_PARALLEL_FOR_BONES_COUNT = 256;
+
 struct Sampler {
-    TimeValues times;
+    TimeValues times;           // sorted and unique keyframe times
+    KeyframeIndices indices;    // index into "values" for each keyframe time
     SourceValues values;
     enum { LINEAR, STEP, CUBIC } interpolation;
 };
@@ -59,13 +70,29 @@ struct Channel {
     const Sampler* sourceData;
     Entity targetEntity;
     enum { TRANSLATION, ROTATION, SCALE, WEIGHTS } transformType;
+    uint32_t cursor; // most recent keyframe, speeds up the search when time moves forward
 };
 
 struct Animation {
     float duration;
     std::string name;
     vector<Sampler> samplers;
+
+    // Transform channels are sorted by target entity so that all channels targeting a given
+    // entity are evaluated by the same job. Morph weight channels are evaluated on the calling
+    // thread because setMorphWeights() is not thread safe.
     vector<Channel> channels;
+    vector<Channel> weightChannels;
+    vector<uint32_t> groups; // index of the first channel of each target entity, plus the end
+};
+
+// A single call to RenderableManager::setBones(), whose matrices live in a shared staging area.
+struct SkinTarget {
+    const FFilamentInstance::Skin* skin;
+    const FFilamentAsset::Skin* assetSkin;
+    Entity entity;
+    RenderableManager::Instance renderable;
+    size_t offset;
 };
 
 struct AnimatorImpl {
@@ -76,19 +103,48 @@ struct AnimatorImpl {
     RenderableManager* renderableManager;
     TransformManager* transformManager;
     TrsTransformManager* trsTransformManager;
+    JobSystem* jobSystem;
     vector<float> weights;
+    vector<SkinTarget> skinTargets;
     FixedCapacityVector<mat4f> crossFade;
     void addChannels(const FixedCapacityVector<Entity>& nodeMap, const cgltf_animation& srcAnim,
             Animation& dst);
+    static void sortChannels(Animation& anim);
+    void applyChannel(Channel& channel, float time);
     void applyAnimation(const Channel& channel, float t, size_t prevIndex, size_t nextIndex);
     void stashCrossFade();
     void applyCrossFade(float alpha);
     void resetBoneMatrices(FFilamentInstance* instance);
-    void updateBoneMatrices(FFilamentInstance* instance);
+    void addSkinTargets(FFilamentInstance* instance);
+    void computeBoneMatrices(const SkinTarget& target);
+    void updateBoneMatrices();
 };
 
+// Returns the index of the first keyframe whose time is greater or equal to the given time, or
+// the keyframe count if there is none, just like std::lower_bound. Playback time usually moves
+// forward by less than a keyframe between calls, so the cursor and its successor are tested before
+// falling back to a binary search.
+static size_t findKeyframe(const TimeValues& times, float time, uint32_t& cursor) {
+    const size_t count = times.size();
+    auto isMatch = [&times, count, time](size_t i) {
+        return (i == 0 || times[i - 1] < time) && (i == count || times[i] >= time);
+    };
+    size_t index = cursor;
+    if (index > count || !isMatch(index)) {
+        if (index < count && isMatch(index + 1)) {
+            ++index;
+        } else {
+            index = std::lower_bound(times.begin(), times.end(), time) - times.begin();
+        }
+    }
+    cursor = uint32_t(index);
+    return index;
+}
+
 static void createSampler(const cgltf_animation_sampler& src, Sampler& dst) {
-    // Copy the time values into a red-black tree.
+    // Sort the time values through a red-black tree, which also removes duplicates, then flatten
+    // them for cache-friendly lookups.
+    map<float, size_t> times;
     const cgltf_accessor* timelineAccessor = src.input;
     const uint8_t* timelineBlob = nullptr;
     const float* timelineFloats = nullptr;
@@ -101,7 +157,13 @@ static void createSampler(const cgltf_animation_sampler& src, Sampler& dst) {
                 timelineAccessor->buffer_view->offset);
     }
     for (size_t i = 0, len = timelineAccessor->count; i < len; ++i) {
-        dst.times[timelineFloats[i]] = i;
+        times[timelineFloats[i]] = i;
+    }
+    dst.times.reserve(times.size());
+    dst.indices.reserve(times.size());
+    for (const auto& [time, index] : times) {
+        dst.times.push_back(time);
+        dst.indices.push_back(uint32_t(index));
     }
 
     // Convert source data to float.
@@ -193,6 +255,7 @@ Animator::Animator(FFilamentAsset const* asset, FFilamentInstance* instance) {
     mImpl->renderableManager = &asset->mEngine->getRenderableManager();
     mImpl->transformManager = &asset->mEngine->getTransformManager();
     mImpl->trsTransformManager = asset->getTrsTransformManager();
+    mImpl->jobSystem = &asset->mEngine->getJobSystem();
 
     const cgltf_data* srcAsset = asset->mSourceAsset->hierarchy;
     const cgltf_animation* srcAnims = srcAsset->animations;
@@ -222,7 +285,7 @@ Animator::Animator(FFilamentAsset const* asset, FFilamentInstance* instance) {
             Sampler& dstSampler = dstAnim.samplers[j];
             createSampler(srcSampler, dstSampler);
             if (dstSampler.times.size() > 1) {
-                float maxtime = (--dstSampler.times.end())->first;
+                float maxtime = dstSampler.times.back();
                 dstAnim.duration = std::max(dstAnim.duration, maxtime);
             }
         }
@@ -235,6 +298,7 @@ Animator::Animator(FFilamentAsset const* asset, FFilamentInstance* instance) {
                 mImpl->addChannels(instance->mNodeMap, srcAnim, dstAnim);
             }
         }
+        AnimatorImpl::sortChannels(dstAnim);
     }
 }
 
@@ -251,6 +315,7 @@ void Animator::addInstance(FFilamentInstance* instance) {
         const cgltf_animation& srcAnim = srcAnims[i];
         Animation& dstAnim = mImpl->animations[i];
         mImpl->addChannels(instance->mNodeMap, srcAnim, dstAnim);
+        AnimatorImpl::sortChannels(dstAnim);
     }
 }
 
@@ -263,49 +328,34 @@ size_t Animator::getAnimationCount() const {
 }
 
 void Animator::applyAnimation(size_t animationIndex, float time) const {
-    const Animation& anim = mImpl->animations[animationIndex];
+    SYSTRACE_CALL();
+    Animation& anim = mImpl->animations[animationIndex];
     time = fmod(time, anim.duration);
     TransformManager& transformManager = *mImpl->transformManager;
     transformManager.openLocalTransformTransaction();
-    for (const auto& channel : anim.channels) {
-        const Sampler* sampler = channel.sourceData;
-        if (sampler->times.size() < 2) {
-            continue;
-        }
-
-        const TimeValues& times = sampler->times;
-
-        // Find the first keyframe after the given time, or the keyframe that matches it exactly.
-        TimeValues::const_iterator iter = times.lower_bound(time);
-
-        // Compute the interpolant (between 0 and 1) and determine the keyframe pair.
-        float t = 0.0f;
-        size_t nextIndex;
-        size_t prevIndex;
-        if (iter == times.end()) {
-            nextIndex = times.size() - 1;
-            prevIndex = nextIndex;
-        } else if (iter == times.begin()) {
-            nextIndex = 0;
-            prevIndex = 0;
-        } else {
-            TimeValues::const_iterator prev = iter; --prev;
-            nextIndex = iter->second;
-            prevIndex = prev->second;
-            const float nextTime = iter->first;
-            const float prevTime = prev->first;
-            float deltaTime = nextTime - prevTime;
-            assert(deltaTime >= 0);
-            if (deltaTime > 0) {
-                t = (time - prevTime) / deltaTime;
-            }
-        }
 
-        if (sampler->interpolation == Sampler::STEP) {
-            t = 0.0f;
+    // While the transaction is open, setting a local transform does not touch other nodes, so
+    // channels that target distinct entities can be evaluated concurrently.
+    AnimatorImpl* const impl = mImpl;
+    const uint32_t* const groups = anim.groups.data();
+    Channel* const channels = anim.channels.data();
+    auto work = [impl, groups, channels, time](uint32_t start, uint32_t count) {
+        for (uint32_t i = groups[start], end = groups[start + count]; i < end; ++i) {
+            impl->applyChannel(channels[i], time);
         }
+    };
+    const uint32_t groupCount = anim.groups.empty() ? 0 : uint32_t(anim.groups.size() - 1);
+    if (anim.channels.size() <= JOBS_PARALLEL_FOR_CHANNELS_COUNT) {
+        work(0, groupCount);
+    } else {
+        JobSystem& js = *mImpl->jobSystem;
+        auto* job = jobs::parallel_for(js, nullptr, 0, groupCount, std::cref(work),
+                jobs::CountSplitter<JOBS_PARALLEL_FOR_CHANNELS_COUNT / 4>());
+        js.runAndWait(job);
+    }
 
-        mImpl->applyAnimation(channel, t, prevIndex, nextIndex);
+    for (Channel& channel : anim.weightChannels) {
+        mImpl->applyChannel(channel, time);
     }
     transformManager.commitLocalTransformTransaction();
 }
@@ -324,16 +374,20 @@ void Animator::resetBoneMatrices() {
 }
 
 void Animator::updateBoneMatrices() {
+    SYSTRACE_CALL();
+    mImpl->skinTargets.clear();
+
     // If this is a single-instance animator, then update only this instance.
     if (mImpl->instance) {
-        mImpl->updateBoneMatrices(mImpl->instance);
-        return;
+        mImpl->addSkinTargets(mImpl->instance);
+    } else {
+        // If this is a broadcast animator, then update all instances.
+        for (FFilamentInstance* instance : mImpl->asset->mInstances) {
+            mImpl->addSkinTargets(instance);
+        }
     }
 
-    // If this is a broadcast animator, then update all instances.
-    for (FFilamentInstance* instance : mImpl->asset->mInstances) {
-        mImpl->updateBoneMatrices(instance);
-    }
+    mImpl->updateBoneMatrices();
 }
 
 float Animator::getAnimationDuration(size_t animationIndex) const {
@@ -426,9 +480,68 @@ void AnimatorImpl::addChannels(const FixedCapacityVector<Entity>& nodeMap,
         Channel dstChannel;
         dstChannel.sourceData = samplers + (srcChannel.sampler - srcSamplers);
         dstChannel.targetEntity = targetEntity;
+        dstChannel.cursor = 0;
         setTransformType(srcChannel, dstChannel);
-        dst.channels.push_back(dstChannel);
+        if (dstChannel.transformType == Channel::WEIGHTS) {
+            dst.weightChannels.push_back(dstChannel);
+        } else {
+            dst.channels.push_back(dstChannel);
+        }
+    }
+}
+
+void AnimatorImpl::sortChannels(Animation& anim) {
+    auto& channels = anim.channels;
+    std::stable_sort(channels.begin(), channels.end(), [](const Channel& lhs, const Channel& rhs) {
+        return lhs.targetEntity.getId() < rhs.targetEntity.getId();
+    });
+    anim.groups.clear();
+    for (size_t i = 0, n = channels.size(); i < n; ++i) {
+        if (i == 0 || channels[i].targetEntity != channels[i - 1].targetEntity) {
+            anim.groups.push_back(uint32_t(i));
+        }
+    }
+    anim.groups.push_back(uint32_t(channels.size()));
+}
+
+void AnimatorImpl::applyChannel(Channel& channel, float time) {
+    const Sampler* sampler = channel.sourceData;
+    if (sampler->times.size() < 2) {
+        return;
     }
+
+    const TimeValues& times = sampler->times;
+
+    // Find the first keyframe after the given time, or the keyframe that matches it exactly.
+    const size_t next = findKeyframe(times, time, channel.cursor);
+
+    // Compute the interpolant (between 0 and 1) and determine the keyframe pair.
+    float t = 0.0f;
+    size_t nextIndex;
+    size_t prevIndex;
+    if (next == times.size()) {
+        nextIndex = sampler->indices.back();
+        prevIndex = nextIndex;
+    } else if (next == 0) {
+        nextIndex = sampler->indices.front();
+        prevIndex = nextIndex;
+    } else {
+        nextIndex = sampler->indices[next];
+        prevIndex = sampler->indices[next - 1];
+        const float nextTime = times[next];
+        const float prevTime = times[next - 1];
+        float deltaTime = nextTime - prevTime;
+        assert(deltaTime >= 0);
+        if (deltaTime > 0) {
+            t = (time - prevTime) / deltaTime;
+        }
+    }
+
+    if (sampler->interpolation == Sampler::STEP) {
+        t = 0.0f;
+    }
+
+    applyAnimation(channel, t, prevIndex, nextIndex);
 }
 
 void AnimatorImpl::applyAnimation(const Channel& channel, float t, size_t prevIndex,
@@ -542,35 +655,73 @@ void AnimatorImpl::resetBoneMatrices(FFilamentInstance* instance) {
     }
 }
 
-void AnimatorImpl::updateBoneMatrices(FFilamentInstance* instance) {
+void AnimatorImpl::addSkinTargets(FFilamentInstance* instance) {
     assert_invariant(instance->mSkins.size() == asset->mSkins.size());
+    size_t offset = skinTargets.empty() ? 0 :
+            skinTargets.back().offset + skinTargets.back().skin->joints.size();
     size_t skinIndex = 0;
     for (const auto& skin : instance->mSkins) {
         const auto& assetSkin = asset->mSkins[skinIndex++];
-        size_t njoints = skin.joints.size();
-        boneMatrices.resize(njoints);
         for (Entity entity : skin.targets) {
             auto renderable = renderableManager->getInstance(entity);
             if (!renderable) {
                 continue;
             }
-            mat4 inverseGlobalTransform;
-            auto xformable = transformManager->getInstance(entity);
-            if (xformable) {
-                inverseGlobalTransform = inverse(transformManager->getWorldTransformAccurate(xformable));
-            }
-            for (size_t boneIndex = 0; boneIndex < njoints; ++boneIndex) {
-                const auto& joint = skin.joints[boneIndex];
-                const mat4f& inverseBindMatrix = assetSkin.inverseBindMatrices[boneIndex];
-                TransformManager::Instance jointInstance = transformManager->getInstance(joint);
-                mat4 globalJointTransform = transformManager->getWorldTransformAccurate(jointInstance);
-                boneMatrices[boneIndex] =
-                        mat4f{ inverseGlobalTransform * globalJointTransform } *
-                        inverseBindMatrix;
-            }
-            renderableManager->setBones(renderable, boneMatrices.data(), boneMatrices.size());
+            skinTargets.push_back({ &skin, &assetSkin, entity, renderable, offset });
+            offset += skin.joints.size();
         }
     }
 }
 
+void AnimatorImpl::computeBoneMatrices(const SkinTarget& target) {
+    const auto& skin = *target.skin;
+    const auto& assetSkin = *target.assetSkin;
+    mat4f* const out = boneMatrices.data() + target.offset;
+    mat4 inverseGlobalTransform;
+    auto xformable = transformManager->getInstance(target.entity);
+    if (xformable) {
+        inverseGlobalTransform = inverse(transformManager->getWorldTransformAccurate(xformable));
+    }
+    for (size_t boneIndex = 0, njoints = skin.joints.size(); boneIndex < njoints; ++boneIndex) {
+        const auto& joint = skin.joints[boneIndex];
+        const mat4f& inverseBindMatrix = assetSkin.inverseBindMatrices[boneIndex];
+        TransformManager::Instance jointInstance = transformManager->getInstance(joint);
+        mat4 globalJointTransform = transformManager->getWorldTransformAccurate(jointInstance);
+        out[boneIndex] = mat4f{ inverseGlobalTransform * globalJointTransform } * inverseBindMatrix;
+    }
+}
+
+void AnimatorImpl::updateBoneMatrices() {
+    if (skinTargets.empty()) {
+        return;
+    }
+
+    // All bone matrices are computed into a single staging area, the skins can be processed
+    // concurrently since they only read from the TransformManager.
+    const SkinTarget& last = skinTargets.back();
+    const size_t boneCount = last.offset + last.skin->joints.size();
+    boneMatrices.resize(boneCount);
+
+    AnimatorImpl* const impl = this;
+    auto work = [impl](const SkinTarget* targets, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            impl->computeBoneMatrices(targets[i]);
+        }
+    };
+    if (boneCount <= JOBS_PARALLEL_FOR_BONES_COUNT || skinTargets.size() == 1) {
+        work(skinTargets.data(), skinTargets.size());
+    } else {
+        JobSystem& js = *jobSystem;
+        auto* job = jobs::parallel_for(js, nullptr, skinTargets.data(),
+                uint32_t(skinTargets.size()), std::cref(work), jobs::CountSplitter<4>());
+        js.runAndWait(job);
+    }
+
+    // Uploading must happen on the calling thread.
+    for (const SkinTarget& target : skinTargets) {
+        renderableManager->setBones(target.renderable, boneMatrices.data() + target.offset,
+                target.skin->joints.size());
+    }
+}
+
 } // namespace filament::gltfio
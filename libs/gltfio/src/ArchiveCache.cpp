@@ -30,8 +30,6 @@
 #include <utils/memalign.h>
 #include <utils/ostream.h>
 
-#include <zstd.h>
-
 #include <stdint.h>
 #include <stddef.h>
 #include <string.h>
@@ -54,105 +52,144 @@ constexpr static void debugSuitability(int index, const char* msg) {
     }
 }
 
-static bool strIsEqual(const CString& a, const char* b) {
-    return strncmp(a.c_str(), b, a.size()) == 0;
-}
-
 void ArchiveCache::load(const void* archiveData, uint64_t archiveByteCount) {
     assert_invariant(mArchive == nullptr && "Do not call load() twice");
-    const uint64_t decompSize = ZSTD_getFrameContentSize(archiveData, archiveByteCount);
-    if (decompSize == ZSTD_CONTENTSIZE_UNKNOWN || decompSize == ZSTD_CONTENTSIZE_ERROR) {
+    size_t packagesOffset = 0;
+    mArchive = readArchive(archiveData, archiveByteCount, &packagesOffset);
+    if (mArchive == nullptr) {
         PANIC_POSTCONDITION("Decompression error.");
     }
-    uint64_t* basePointer = (uint64_t*) utils::aligned_alloc(decompSize, 8);
-    ZSTD_decompress(basePointer, decompSize, archiveData, archiveByteCount);
-    mArchive = (ReadableArchive*) basePointer;
-    convertOffsetsToPointers(mArchive);
     mMaterials = FixedCapacityVector<Material*>(mArchive->specsCount, nullptr);
+
+    // The packages of seekable archives are decompressed only when their material is first
+    // requested. We keep a copy because the archive data is not required to outlive us.
+    if (isSeekable(mArchive)) {
+        mPackages = FixedCapacityVector<uint8_t>(archiveByteCount - packagesOffset);
+        memcpy(mPackages.data(), (const uint8_t*) archiveData + packagesOffset, mPackages.size());
+    }
+
+    buildIndex();
 }
 
-// This loops though all ubershaders and returns the first one that meets the given requirements.
-Material* ArchiveCache::getMaterial(const ArchiveRequirements& reqs) {
-    assert_invariant(mArchive && "Please call load() before requesting any materials.");
-    if (mArchive == nullptr) {
-        return nullptr;
+void ArchiveCache::buildIndex() {
+    mSpecMasks = FixedCapacityVector<ArchiveSpecMask>::with_capacity(mArchive->specsCount);
+    if (ArchiveIndex const* index = getArchiveIndex(mArchive)) {
+        for (uint64_t i = 0; i < index->featuresCount; ++i) {
+            mFeatureBits[index->features[i].name] = uint32_t(i);
+        }
+        for (uint64_t i = 0; i < mArchive->specsCount; ++i) {
+            mSpecMasks.push_back(index->masks[i]);
+        }
+        return;
     }
 
+    // Older archives don't have an index, so we build it from the flags of each spec.
     for (uint64_t i = 0; i < mArchive->specsCount; ++i) {
         const ArchiveSpec& spec = mArchive->specs[i];
-        if (spec.blendingMode != INVALID_BLENDING && spec.blendingMode != reqs.blendingMode) {
+        ArchiveSpecMask mask = {};
+        for (uint64_t j = 0; j < spec.flagsCount; ++j) {
+            const ArchiveFlag& flag = spec.flags[j];
+            auto [pos, inserted] = mFeatureBits.try_emplace(flag.name, mFeatureBits.size());
+            if (pos->second >= MAX_ARCHIVE_FEATURE_COUNT) {
+                PANIC_POSTCONDITION("Archives cannot have more than %zu feature flags.",
+                        MAX_ARCHIVE_FEATURE_COUNT);
+            }
+            if (flag.value != ArchiveFeature::UNSUPPORTED) {
+                mask.supported |= uint64_t(1) << pos->second;
+            }
+            if (flag.value == ArchiveFeature::REQUIRED) {
+                mask.required |= uint64_t(1) << pos->second;
+            }
+        }
+        mSpecMasks.push_back(mask);
+    }
+}
+
+// This loops though all ubershaders and returns the index of the first one that meets the given
+// requirements, or -1.
+int32_t ArchiveCache::findSpec(SpecKey const& key) const noexcept {
+    for (uint64_t i = 0; i < mArchive->specsCount; ++i) {
+        const ArchiveSpec& spec = mArchive->specs[i];
+        if (spec.blendingMode != INVALID_BLENDING && spec.blendingMode != key.blendingMode) {
             debugSuitability(i, "blend mode mismatch.");
             continue;
         }
-        if (spec.shadingModel != INVALID_SHADING_MODEL && spec.shadingModel != reqs.shadingModel) {
+        if (spec.shadingModel != INVALID_SHADING_MODEL && spec.shadingModel != key.shadingModel) {
             debugSuitability(i, "material model.");
             continue;
         }
-        bool specIsSuitable = true;
 
         // For each feature required by the mesh, this ubershader is suitable only if it includes a
         // feature flag for it and the feature flag is either OPTIONAL or REQUIRED.
-        for (const auto& req : reqs.features) {
-            const CString& meshRequirement = req.first;
-            if (req.second == false) {
-                continue;
-            }
-            bool found = false;
-            for (uint64_t j = 0; j < spec.flagsCount && !found; ++j) {
-                const ArchiveFlag& flag = spec.flags[j];
-                if (strIsEqual(meshRequirement, flag.name)) {
-                    if (flag.value != ArchiveFeature::UNSUPPORTED) {
-                        found = true;
-                    }
-                    break;
-                }
-            }
-            if (!found) {
-                debugSuitability(i, meshRequirement.c_str());
-                specIsSuitable = false;
-                break;
-            }
+        const ArchiveSpecMask& mask = mSpecMasks[i];
+        if (key.features & ~mask.supported) {
+            debugSuitability(i, "unsupported feature.");
+            continue;
         }
 
         // If this ubershader requires a certain feature to be enabled in the glTF, but the glTF
-        // mesh doesn't have it, then this ubershader is not suitable. This occurs very rarely, so
-        // it intentionally comes after the other suitability check.
-        for (uint64_t j = 0; j < spec.flagsCount && specIsSuitable; ++j) {
-            ArchiveFlag const& flag = spec.flags[j];
-            if (UTILS_UNLIKELY(flag.value == ArchiveFeature::REQUIRED)) {
-                // This allocates a new CString just to make a robin_map lookup, but this is rare
-                // because almost none of our feature flags are REQUIRED.
-                auto iter = reqs.features.find(CString(flag.name));
-                if (iter == reqs.features.end() || iter.value() == false) {
-                    debugSuitability(i, flag.name);
-                    specIsSuitable = false;
-                }
-            }
+        // mesh doesn't have it, then this ubershader is not suitable.
+        if (mask.required & ~key.features) {
+            debugSuitability(i, "missing required feature.");
+            continue;
         }
+        return int32_t(i);
+    }
+    return -1;
+}
 
-        if (specIsSuitable) {
-            if (mMaterials[i] == nullptr) {
-                mMaterials[i] = Material::Builder()
-                    .package(spec.package, spec.packageByteCount)
-                    .build(mEngine);
-            }
+Material* ArchiveCache::getMaterial(const ArchiveRequirements& reqs) {
+    assert_invariant(mArchive && "Please call load() before requesting any materials.");
+    if (mArchive == nullptr) {
+        return nullptr;
+    }
 
-            return mMaterials[i];
+    SpecKey key = { 0, reqs.shadingModel, reqs.blendingMode };
+    for (const auto& req : reqs.features) {
+        if (req.second == false) {
+            continue;
         }
+        auto iter = mFeatureBits.find({ req.first.c_str(), req.first.size() });
+        if (iter == mFeatureBits.end()) {
+            // no ubershader in the archive has this feature
+            return nullptr;
+        }
+        key.features |= uint64_t(1) << iter->second;
+    }
+
+    auto pos = mSpecIndices.find(key);
+    if (pos == mSpecIndices.end()) {
+        pos = mSpecIndices.emplace(key, findSpec(key)).first;
+    }
+    return pos->second < 0 ? nullptr : getSpecMaterial(pos->second);
+}
+
+Material* ArchiveCache::getSpecMaterial(size_t specIndex) {
+    if (mMaterials[specIndex] != nullptr) {
+        return mMaterials[specIndex];
     }
-    return nullptr;
+    const ArchiveSpec& spec = mArchive->specs[specIndex];
+    if (!isSeekable(mArchive)) {
+        mMaterials[specIndex] = Material::Builder()
+            .package(spec.package, spec.packageByteCount)
+            .build(mEngine);
+        return mMaterials[specIndex];
+    }
+    FixedCapacityVector<uint8_t> package(spec.packageByteCount);
+    if (!decompressPackage(spec, mPackages.data(), mPackages.size(), package.data())) {
+        PANIC_POSTCONDITION("Decompression error.");
+    }
+    mMaterials[specIndex] = Material::Builder()
+        .package(package.data(), package.size())
+        .build(mEngine);
+    return mMaterials[specIndex];
 }
 
 Material* ArchiveCache::getDefaultMaterial() {
     assert_invariant(mArchive && "Please call load() before requesting any materials.");
     assert_invariant(!mMaterials.empty() && "Archive must have at least one material.");
     if (!mArchive) return nullptr;
-    if (mMaterials[0] == nullptr) {
-        mMaterials[0] = Material::Builder()
-            .package(mArchive->specs[0].package, mArchive->specs[0].packageByteCount)
-            .build(mEngine);
-    }
-    return mMaterials[0];
+    return getSpecMaterial(0);
 }
 
 void ArchiveCache::destroyMaterials() {
@@ -22,8 +22,11 @@
 
 #include <tsl/robin_map.h>
 
+#include <functional>
 #include <string_view>
 
+#include <stdint.h>
+
 #include <uberz/ReadableArchive.h>
 
 #include <utils/CString.h>
@@ -50,9 +53,42 @@ namespace filament::gltfio {
         FeatureMap getFeatureMap(Material* material) const;
 
     private:
+        // What a suitable spec is looked up by; features has a bit set for each feature that is
+        // enabled, in the bit assignment of the archive index.
+        struct SpecKey {
+            uint64_t features;
+            Shading shadingModel;
+            BlendingMode blendingMode;
+            bool operator==(SpecKey const& rhs) const noexcept {
+                return features == rhs.features && shadingModel == rhs.shadingModel &&
+                        blendingMode == rhs.blendingMode;
+            }
+            struct Hasher {
+                size_t operator()(SpecKey const& key) const noexcept {
+                    return std::hash<uint64_t>{}(key.features * 31u +
+                            (uint64_t(key.shadingModel) << 8u | uint64_t(key.blendingMode)));
+                }
+            };
+        };
+
+        void buildIndex();
+        int32_t findSpec(SpecKey const& key) const noexcept;
+        Material* getSpecMaterial(size_t specIndex);
+
         Engine& mEngine;
         utils::FixedCapacityVector<Material*> mMaterials;
         uberz::ReadableArchive* mArchive = nullptr;
+
+        // packages of seekable archives, which stay compressed until they're first needed
+        utils::FixedCapacityVector<uint8_t> mPackages;
+
+        // bit assigned to each feature name (the names are owned by mArchive) and the features
+        // supported or required by each spec
+        tsl::robin_map<std::string_view, uint32_t> mFeatureBits;
+        utils::FixedCapacityVector<uberz::ArchiveSpecMask> mSpecMasks;
+
+        // index of the spec found for each set of requirements, or -1
+        tsl::robin_map<SpecKey, int32_t, SpecKey::Hasher> mSpecIndices;
     };
 
     struct ArchiveRequirements {
@@ -58,9 +58,13 @@
 
 #include "downcast.h"
 
+#include <algorithm>
 #include <codecvt>
 #include <locale>
 #include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
 using namespace filament;
 using namespace filament::math;
@@ -265,6 +269,7 @@ struct FAssetLoader : public AssetLoader {
             mTransformManager(config.engine->getTransformManager()),
             mMaterials(*config.materials),
             mEngine(*config.engine),
+            mQuantizeVertices(config.quantizeVertices && !config.ext),
             mDefaultNodeName(config.defaultNodeName) {
         if (config.ext) {
             FILAMENT_CHECK_PRECONDITION(AssetConfigurationExtended::isSupported())
@@ -277,6 +282,8 @@ struct FAssetLoader : public AssetLoader {
     FFilamentAsset* createAsset(const uint8_t* bytes, uint32_t nbytes);
     FFilamentAsset* createInstancedAsset(const uint8_t* bytes, uint32_t numBytes,
             FilamentInstance** instances, size_t numInstances);
+    FFilamentAsset* createInstancedAssetFromFile(const char* path,
+            FilamentInstance** instances, size_t numInstances);
     FilamentInstance* createInstance(FFilamentAsset* fAsset);
 
     static void destroy(FAssetLoader** loader) noexcept {
@@ -305,19 +312,40 @@ struct FAssetLoader : public AssetLoader {
     }
 
 private:
+    // Parses the glTF content held by either glbData or file, which are moved to the asset.
+    FFilamentAsset* createAssetFromSource(utils::FixedCapacityVector<uint8_t>&& glbData,
+            std::unique_ptr<MappedFile>&& file, FilamentInstance** instances,
+            size_t numInstances);
+
     void importSkins(FFilamentInstance* instance, const cgltf_data* srcAsset);
 
     // Methods used during the first traveral (creation of VertexBuffer, IndexBuffer, etc)
     FFilamentAsset* createRootAsset(const cgltf_data* srcAsset);
+    void computeQuantizedBounds(FFilamentAsset* fAsset);
     void recursePrimitives(const cgltf_node* rootNode, FFilamentAsset* fAsset);
     void createPrimitives(const cgltf_node* node, const char* name, FFilamentAsset* fAsset);
     bool createPrimitive(const cgltf_primitive& inPrim, const char* name, Primitive* outPrim,
-            FFilamentAsset* fAsset);
+            const Aabb* quantizedBounds, FFilamentAsset* fAsset);
+
+    // A node of the asset's hierarchy with everything that doesn't depend on the instance. The
+    // nodes are flattened in depth-first order, so parents always come before their children.
+    struct NodeTemplate {
+        static constexpr size_t ROOT = ~size_t(0);
+        const cgltf_node* node;
+        size_t parent;                      // index of the parent node, or ROOT
+        SceneMask scenes;
+        mat4f localTransform;               // includes the dequantization of the mesh positions
+        std::string name;
+        std::vector<Entity>* namedEntities; // the entry of the name in mNameToEntity
+    };
 
     // Methods used during subsequent traverals (creation of entities, renderables, etc)
     void createInstances(size_t numInstances, FFilamentAsset* fAsset);
-    void recurseEntities(const cgltf_node* node, SceneMask scenes, Entity parent,
-            FFilamentAsset* fAsset, FFilamentInstance* instance);
+    bool createInstanceBatch(size_t numInstances, FFilamentAsset* fAsset);
+    void flattenNodes(const cgltf_node* node, SceneMask scenes, size_t parent,
+            FFilamentAsset* fAsset, std::vector<NodeTemplate>& nodes);
+    FFilamentInstance* instantiate(FFilamentAsset* fAsset, std::vector<NodeTemplate> const& nodes,
+            Entity root, Entity const* entities);
     void createRenderable(const cgltf_node* node, Entity entity, const char* name,
             FFilamentAsset* fAsset);
     void createLight(const cgltf_light* light, Entity entity, FFilamentAsset* fAsset);
@@ -346,6 +374,7 @@ public:
     Engine& mEngine;
     FNodeManager mNodeManager;
     FTrsTransformManager mTrsTransformManager;
+    const bool mQuantizeVertices;
 
     // Transient state used only for the asset currently being loaded:
     const char* mDefaultNodeName;
@@ -369,6 +398,25 @@ FFilamentAsset* FAssetLoader::createAsset(const uint8_t* bytes, uint32_t byteCou
 
 FFilamentAsset* FAssetLoader::createInstancedAsset(const uint8_t* bytes, uint32_t byteCount,
         FilamentInstance** instances, size_t numInstances) {
+    // Clients can free up their source blob immediately, but cgltf has pointers into the data that
+    // need to stay valid. Therefore we create a copy of the source blob and stash it inside the
+    // asset.
+    utils::FixedCapacityVector<uint8_t> glbdata(byteCount);
+    std::copy_n(bytes, byteCount, glbdata.data());
+    return createAssetFromSource(std::move(glbdata), {}, instances, numInstances);
+}
+
+FFilamentAsset* FAssetLoader::createInstancedAssetFromFile(const char* path,
+        FilamentInstance** instances, size_t numInstances) {
+    std::unique_ptr<MappedFile> file = MappedFile::open(path);
+    if (!file) {
+        return nullptr;
+    }
+    return createAssetFromSource({}, std::move(file), instances, numInstances);
+}
+
+FFilamentAsset* FAssetLoader::createAssetFromSource(utils::FixedCapacityVector<uint8_t>&& glbData,
+        std::unique_ptr<MappedFile>&& file, FilamentInstance** instances, size_t numInstances) {
     // This method can be used to load JSON or GLB. By using a default options struct, we are asking
     // cgltf to examine the magic identifier to determine which type of file is being loaded.
     cgltf_options options {};
@@ -387,15 +435,12 @@ FFilamentAsset* FAssetLoader::createInstancedAsset(const uint8_t* bytes, uint32_
         options.file.release = [](const cgltf_memory_options*, const cgltf_file_options*, void*) {};
     }
 
-    // Clients can free up their source blob immediately, but cgltf has pointers into the data that
-    // need to stay valid. Therefore we create a copy of the source blob and stash it inside the
-    // asset.
-    utils::FixedCapacityVector<uint8_t> glbdata(byteCount);
-    std::copy_n(bytes, byteCount, glbdata.data());
+    uint8_t const* const bytes = file ? file->getData() : glbData.data();
+    size_t const byteCount = file ? file->getSize() : glbData.size();
 
     // The ownership of an allocated `sourceAsset` will be moved to FFilamentAsset::mSourceAsset.
     cgltf_data* sourceAsset;
-    cgltf_result result = cgltf_parse(&options, glbdata.data(), byteCount, &sourceAsset);
+    cgltf_result result = cgltf_parse(&options, bytes, byteCount, &sourceAsset);
     if (result != cgltf_result_success) {
         slog.e << "Unable to parse glTF file." << io::endl;
         return nullptr;
@@ -408,7 +453,10 @@ FFilamentAsset* FAssetLoader::createInstancedAsset(const uint8_t* bytes, uint32_
         mError = false;
         return nullptr;
     }
-    glbdata.swap(fAsset->mSourceAsset->glbData);
+    glbData.swap(fAsset->mSourceAsset->glbData);
+    if (file) {
+        fAsset->mSourceAsset->mappedFiles.push_back(std::move(file));
+    }
 
     createInstances(numInstances, fAsset);
     if (mError) {
@@ -423,26 +471,99 @@ FFilamentAsset* FAssetLoader::createInstancedAsset(const uint8_t* bytes, uint32_
 }
 
 FilamentInstance* FAssetLoader::createInstance(FFilamentAsset* fAsset) {
+    return createInstanceBatch(1, fAsset) ? fAsset->mInstances.back() : nullptr;
+}
+
+bool FAssetLoader::createInstanceBatch(size_t numInstances, FFilamentAsset* fAsset) {
+    SYSTRACE_CALL();
+
     if (!fAsset->mSourceAsset) {
         slog.e << "Source data has been released; asset is frozen." << io::endl;
-        return nullptr;
+        return false;
     }
     const cgltf_data* srcAsset = fAsset->mSourceAsset->hierarchy;
     if (srcAsset->scenes == nullptr) {
         slog.e << "There is no scene in the asset." << io::endl;
-        return nullptr;
+        return false;
     }
 
-    auto rootTransform = mTransformManager.getInstance(fAsset->mRoot);
-    Entity instanceRoot = mEntityManager.create();
-    mTransformManager.create(instanceRoot, rootTransform);
+    // Everything that doesn't depend on the instance, such as node names and local transforms, is
+    // computed once for the whole batch.
+    std::vector<NodeTemplate> nodes;
+    nodes.reserve(srcAsset->nodes_count);
+    for (const auto& [node, scenes] : fAsset->mRootNodes) {
+        flattenNodes(node, scenes, NodeTemplate::ROOT, fAsset, nodes);
+    }
+
+    // Create the entities of all instances at once: the instance roots come first, followed by
+    // the nodes of each instance.
+    const size_t nodeCount = nodes.size();
+    FixedCapacityVector<Entity> entities(numInstances * (nodeCount + 1));
+    mEntityManager.create(entities.size(), entities.data());
+    mTransformManager.create(numInstances, entities.data(),
+            mTransformManager.getInstance(fAsset->mRoot));
+
+    fAsset->mInstances.reserve(fAsset->mInstances.size() + numInstances);
+    fAsset->mEntities.reserve(fAsset->mEntities.size() + numInstances * nodeCount);
+    for (NodeTemplate const& node : nodes) {
+        node.namedEntities->reserve(node.namedEntities->size() + numInstances);
+    }
+
+    const Entity* nodeEntities = entities.data() + numInstances;
+    for (size_t i = 0; i < numInstances; ++i, nodeEntities += nodeCount) {
+        FFilamentInstance* instance = instantiate(fAsset, nodes, entities[i], nodeEntities);
+        fAsset->mInstances.push_back(instance);
+    }
+
+    // Committing the edges checks every material of the asset, so it is done once per batch
+    // rather than once per instance.
+    fAsset->mDependencyGraph.commitEdges();
+
+    return true;
+}
+
+void FAssetLoader::flattenNodes(const cgltf_node* node, SceneMask scenes, size_t parent,
+        FFilamentAsset* fAsset, std::vector<NodeTemplate>& nodes) {
+    const cgltf_data* srcAsset = fAsset->mSourceAsset->hierarchy;
+
+    NodeTemplate item{ node, parent, scenes };
+    if (node->has_matrix) {
+        memcpy(&item.localTransform[0][0], &node->matrix[0], 16 * sizeof(float));
+    } else {
+        item.localTransform = composeMatrix(*(float3 const*) &node->translation[0],
+                *(quatf const*) &node->rotation[0], *(float3 const*) &node->scale[0]);
+    }
+
+    // Quantized positions are restored by the transform of their renderable.
+    if (node->mesh) {
+        const Aabb& bounds = fAsset->mQuantizedBounds[node->mesh - srcAsset->meshes];
+        if (!bounds.isEmpty()) {
+            item.localTransform = item.localTransform * getDequantizeTransform(bounds);
+        }
+    }
+
+    // mNameToEntity is node-based, so its entries stay valid while other names are inserted.
+    item.name = getNodeName(node, mDefaultNodeName);
+    item.namedEntities = &fAsset->mNameToEntity[item.name];
+
+    const size_t index = nodes.size();
+    nodes.push_back(std::move(item));
+
+    for (cgltf_size i = 0, len = node->children_count; i < len; ++i) {
+        flattenNodes(node->children[i], scenes, index, fAsset, nodes);
+    }
+}
+
+FFilamentInstance* FAssetLoader::instantiate(FFilamentAsset* fAsset,
+        std::vector<NodeTemplate> const& nodes, Entity root, Entity const* entities) {
+    const cgltf_data* srcAsset = fAsset->mSourceAsset->hierarchy;
 
     mMaterialInstanceCache = MaterialInstanceCache(srcAsset);
 
     // Create an instance object, which is a just a lightweight wrapper around a vector of
     // entities and an animator. The creation of animator is triggered from ResourceLoader
     // because it could require external bin data.
-    FFilamentInstance* instance = new FFilamentInstance(instanceRoot, fAsset);
+    FFilamentInstance* instance = new FFilamentInstance(root, fAsset);
 
     // Check if the asset has variants.
     instance->mVariants.reserve(srcAsset->variants_count);
@@ -450,9 +571,59 @@ FilamentInstance* FAssetLoader::createInstance(FFilamentAsset* fAsset) {
         instance->mVariants.push_back({ CString(srcAsset->variants[i].name) });
     }
 
-    // For each scene root, recursively create all entities.
-    for (const auto& pair : fAsset->mRootNodes) {
-        recurseEntities(pair.first, pair.second, instanceRoot, fAsset, instance);
+    NodeManager& nm = mNodeManager;
+    instance->mEntities.reserve(nodes.size());
+    for (size_t i = 0, n = nodes.size(); i < n; ++i) {
+        NodeTemplate const& item = nodes[i];
+        const cgltf_node* node = item.node;
+        const Entity entity = entities[i];
+        const Entity parent = item.parent == NodeTemplate::ROOT ? root : entities[item.parent];
+
+        nm.create(entity);
+        nm.setSceneMembership(nm.getInstance(entity), item.scenes);
+
+        // Always create a transform component to reflect the original hierarchy.
+        if (!node->has_matrix) {
+            mTrsTransformManager.create(entity, *(float3 const*) &node->translation[0],
+                    *(quatf const*) &node->rotation[0], *(float3 const*) &node->scale[0]);
+        }
+        mTransformManager.create(entity, mTransformManager.getInstance(parent),
+                item.localTransform);
+
+        // Check if this node has an extras string.
+        const cgltf_size extras_size = node->extras.end_offset - node->extras.start_offset;
+        if (extras_size > 0) {
+            nm.setExtras(nm.getInstance(entity),
+                    {srcAsset->json + node->extras.start_offset, extras_size});
+        }
+
+        // Update the asset's entity list and private node mapping.
+        fAsset->mEntities.push_back(entity);
+        instance->mEntities.push_back(entity);
+        instance->mNodeMap[node - srcAsset->nodes] = entity;
+
+        const char* name = item.name.c_str();
+        item.namedEntities->push_back(entity);
+        if (mNameManager) {
+            mNameManager->addComponent(entity);
+            mNameManager->setName(mNameManager->getInstance(entity), name);
+        }
+
+        // If the node has a mesh, then create a renderable component.
+        if (node->mesh) {
+            createRenderable(node, entity, name, fAsset);
+            if (srcAsset->variants_count > 0) {
+                createMaterialVariants(node->mesh, entity, fAsset, instance);
+            }
+        }
+
+        if (node->light) {
+            createLight(node->light, entity, fAsset);
+        }
+
+        if (node->camera) {
+            createCamera(node->camera, entity, fAsset);
+        }
     }
 
     importSkins(instance, srcAsset);
@@ -461,8 +632,6 @@ FilamentInstance* FAssetLoader::createInstance(FFilamentAsset* fAsset) {
     // Note that it may need to defer actual creation until external buffers are fully loaded.
     instance->createAnimator();
 
-    fAsset->mInstances.push_back(instance);
-
     // Bounding boxes are not shared because users might call recomputeBoundingBoxes() which can
     // be affected by entity transforms. However, upon instance creation we can safely copy over
     // the asset's bounding box.
@@ -470,8 +639,6 @@ FilamentInstance* FAssetLoader::createInstance(FFilamentAsset* fAsset) {
 
     mMaterialInstanceCache.flush(&instance->mMaterialInstances);
 
-    fAsset->mDependencyGraph.commitEdges();
-
     return instance;
 }
 
@@ -530,6 +697,10 @@ FFilamentAsset* FAssetLoader::createRootAsset(const cgltf_data* srcAsset) {
         }
     }
 
+    if (mQuantizeVertices) {
+        computeQuantizedBounds(fAsset);
+    }
+
     for (const auto& [node, sceneMask] : fAsset->mRootNodes) {
         recursePrimitives(node, fAsset);
     }
@@ -556,6 +727,66 @@ FFilamentAsset* FAssetLoader::createRootAsset(const cgltf_data* srcAsset) {
     return fAsset;
 }
 
+void FAssetLoader::computeQuantizedBounds(FFilamentAsset* fAsset) {
+    const cgltf_data* srcAsset = fAsset->mSourceAsset->hierarchy;
+
+    // The dequantization transform is folded into the local transform of each node that uses the
+    // mesh, which is only safe if no other transform depends on it or overwrites it. This excludes
+    // lights and cameras, which are attached to the node entity, and skin joints.
+    FixedCapacityVector<bool> eligible(srcAsset->meshes_count, true);
+    for (cgltf_size i = 0, n = srcAsset->nodes_count; i < n; ++i) {
+        const cgltf_node& node = srcAsset->nodes[i];
+        if (node.mesh && (node.children_count || node.skin || node.light || node.camera)) {
+            eligible[node.mesh - srcAsset->meshes] = false;
+        }
+    }
+    for (cgltf_size i = 0, n = srcAsset->skins_count; i < n; ++i) {
+        const cgltf_skin& skin = srcAsset->skins[i];
+        for (cgltf_size j = 0, m = skin.joints_count; j < m; ++j) {
+            const cgltf_node* joint = skin.joints[j];
+            if (joint && joint->mesh) {
+                eligible[joint->mesh - srcAsset->meshes] = false;
+            }
+        }
+    }
+    for (cgltf_size i = 0, n = srcAsset->animations_count; i < n; ++i) {
+        const cgltf_animation& anim = srcAsset->animations[i];
+        for (cgltf_size j = 0, m = anim.channels_count; j < m; ++j) {
+            const cgltf_node* node = anim.channels[j].target_node;
+            if (node && node->mesh) {
+                eligible[node->mesh - srcAsset->meshes] = false;
+            }
+        }
+    }
+
+    for (cgltf_size i = 0, n = srcAsset->meshes_count; i < n; ++i) {
+        const cgltf_mesh& mesh = srcAsset->meshes[i];
+        Aabb bounds;
+        for (cgltf_size j = 0; eligible[i] && j < mesh.primitives_count; ++j) {
+            const cgltf_primitive& prim = mesh.primitives[j];
+            const cgltf_accessor* positions = nullptr;
+            for (cgltf_size k = 0; k < prim.attributes_count; ++k) {
+                if (prim.attributes[k].type == cgltf_attribute_type_position) {
+                    positions = prim.attributes[k].data;
+                }
+            }
+            if (prim.targets_count || !positions || positions->type != cgltf_type_vec3 ||
+                    positions->component_type != cgltf_component_type_r_32f ||
+                    !positions->has_min || !positions->has_max) {
+                eligible[i] = false;
+                break;
+            }
+            bounds.min = min(bounds.min, float3(positions->min[0], positions->min[1],
+                    positions->min[2]));
+            bounds.max = max(bounds.max, float3(positions->max[0], positions->max[1],
+                    positions->max[2]));
+        }
+        if (eligible[i] && !bounds.isEmpty()) {
+            fAsset->mQuantizedBounds[i] = bounds;
+        }
+    }
+}
+
 void FAssetLoader::recursePrimitives(const cgltf_node* node, FFilamentAsset* fAsset) {
     auto nameStr = getNodeName(node, mDefaultNodeName);
     const char* name = nameStr.c_str();
@@ -575,11 +806,8 @@ void FAssetLoader::createInstances(size_t numInstances, FFilamentAsset* fAsset)
     // Create a separate entity hierarchy for each instance. Note that MeshCache (vertex
     // buffers and index buffers) and MaterialInstanceCache (materials and textures) help avoid
     // needless duplication of resources.
-    for (size_t index = 0; index < numInstances; ++index) {
-        if (createInstance(fAsset) == nullptr) {
-            mError = true;
-            break;
-        }
+    if (!createInstanceBatch(numInstances, fAsset)) {
+        mError = true;
     }
 
     // Sort the entities so that the renderable ones come first. This allows us to expose
@@ -590,78 +818,6 @@ void FAssetLoader::createInstances(size_t numInstances, FFilamentAsset* fAsset)
     });
 }
 
-void FAssetLoader::recurseEntities(const cgltf_node* node, SceneMask scenes, Entity parent,
-        FFilamentAsset* fAsset, FFilamentInstance* instance) {
-    NodeManager& nm = mNodeManager;
-    const cgltf_data* srcAsset = fAsset->mSourceAsset->hierarchy;
-    const Entity entity = mEntityManager.create();
-    nm.create(entity);
-    const auto nodeInstance = nm.getInstance(entity);
-    nm.setSceneMembership(nodeInstance, scenes);
-
-    // Always create a transform component to reflect the original hierarchy.
-    mat4f localTransform;
-    if (node->has_matrix) {
-        memcpy(&localTransform[0][0], &node->matrix[0], 16 * sizeof(float));
-    } else {
-        quatf* rotation = (quatf*) &node->rotation[0];
-        float3* scale = (float3*) &node->scale[0];
-        float3* translation = (float3*) &node->translation[0];
-        mTrsTransformManager.create(entity, *translation, *rotation, *scale);
-        localTransform = mTrsTransformManager.getTransform(
-                mTrsTransformManager.getInstance(entity));
-    }
-
-    auto parentTransform = mTransformManager.getInstance(parent);
-    mTransformManager.create(entity, parentTransform, localTransform);
-
-    // Check if this node has an extras string.
-    const cgltf_size extras_size = node->extras.end_offset - node->extras.start_offset;
-    if (extras_size > 0) {
-        mNodeManager.setExtras(mNodeManager.getInstance(entity),
-                {srcAsset->json + node->extras.start_offset, extras_size});
-    }
-
-    // Update the asset's entity list and private node mapping.
-    fAsset->mEntities.push_back(entity);
-    instance->mEntities.push_back(entity);
-    instance->mNodeMap[node - srcAsset->nodes] = entity;
-
-    auto nameStr = getNodeName(node, mDefaultNodeName);
-    const char* name = nameStr.c_str();
-
-    if (name) {
-        fAsset->mNameToEntity[name].push_back(entity);
-        if (mNameManager) {
-            mNameManager->addComponent(entity);
-            mNameManager->setName(mNameManager->getInstance(entity), name);
-        }
-    }
-
-    // If no name is provided in the glTF or AssetConfiguration, use "node" for error messages.
-    name = name ? name : "node";
-
-    // If the node has a mesh, then create a renderable component.
-    if (node->mesh) {
-        createRenderable(node, entity, name, fAsset);
-        if (srcAsset->variants_count > 0) {
-            createMaterialVariants(node->mesh, entity, fAsset, instance);
-        }
-    }
-
-    if (node->light) {
-        createLight(node->light, entity, fAsset);
-    }
-
-    if (node->camera) {
-        createCamera(node->camera, entity, fAsset);
-    }
-
-    for (cgltf_size i = 0, len = node->children_count; i < len; ++i) {
-        recurseEntities(node->children[i], scenes, entity, fAsset, instance);
-    }
-}
-
 void FAssetLoader::createPrimitives(const cgltf_node* node, const char* name,
         FFilamentAsset* fAsset) {
     cgltf_data* gltf = fAsset->mSourceAsset->hierarchy;
@@ -693,6 +849,7 @@ void FAssetLoader::createPrimitives(const cgltf_node* node, const char* name,
                         .prim = &inputPrim,
                         .name = name,
                         .dracoCache = &fAsset->mSourceAsset->dracoCache,
+                        .mappedFiles = &fAsset->mSourceAsset->mappedFiles,
                         .material = getMaterial(gltf, inputPrim.material, &outputPrim.uvmap,
                                 utility::primitiveHasVertexColor(&inputPrim)),
                 };
@@ -709,7 +866,9 @@ void FAssetLoader::createPrimitives(const cgltf_node* node, const char* name,
             } else {
                 // Create a Filament VertexBuffer and IndexBuffer for this prim if we haven't
                 // already.
-                mError = !createPrimitive(inputPrim, name, &outputPrim, fAsset);
+                const Aabb& bounds = fAsset->mQuantizedBounds[mesh - gltf->meshes];
+                mError = !createPrimitive(inputPrim, name, &outputPrim,
+                        bounds.isEmpty() ? nullptr : &bounds, fAsset);
             }
             if (mError) {
                 return;
@@ -878,6 +1037,11 @@ void FAssetLoader::createRenderable(const cgltf_node* node, Entity entity, const
         builder.skinning(node->skin->joints_count);
     }
 
+    // The bounding box of quantized positions is in their normalized space.
+    if (const Aabb& bounds = fAsset->mQuantizedBounds[mesh - srcAsset->meshes]; !bounds.isEmpty()) {
+        aabb = aabb.transform(inverse(getDequantizeTransform(bounds)));
+    }
+
     // Per the spec, glTF models must have valid mix / max annotations for position attributes.
     // If desired, clients can call "recomputeBoundingBoxes()" in FilamentInstance.
     Box box = Box().set(aabb.min, aabb.max);
@@ -933,7 +1097,7 @@ void FAssetLoader::createMaterialVariants(const cgltf_mesh* mesh, Entity entity,
 }
 
 bool FAssetLoader::createPrimitive(const cgltf_primitive& inPrim, const char* name,
-        Primitive* outPrim, FFilamentAsset* fAsset) {
+        Primitive* outPrim, const Aabb* quantizedBounds, FFilamentAsset* fAsset) {
 
     using BufferSlot = FFilamentAsset::ResourceInfo::BufferSlot;
 
@@ -1089,6 +1253,24 @@ bool FAssetLoader::createPrimitive(const cgltf_primitive& inPrim, const char* na
         }
         const int stride = (fatype == actualType) ? accessor->stride : 0;
 
+        // Compact attributes are converted into tightly packed buffers by ResourceLoader.
+        if (atype == cgltf_attribute_type_position && quantizedBounds) {
+            vbb.attribute(semantic, slot, VertexBuffer::AttributeType::SHORT4);
+            vbb.normalized(semantic);
+            BufferSlot entry = { accessor, atype, slot++ };
+            entry.quantizedBounds = quantizedBounds;
+            addBufferSlot(entry);
+            continue;
+        }
+        if (atype == cgltf_attribute_type_texcoord && mQuantizeVertices &&
+                fatype == VertexBuffer::AttributeType::FLOAT2) {
+            vbb.attribute(semantic, slot, VertexBuffer::AttributeType::HALF2);
+            BufferSlot entry = { accessor, atype, slot++ };
+            entry.halfFloat = true;
+            addBufferSlot(entry);
+            continue;
+        }
+
         // The cgltf library provides a stride value for all accessors, even though they do not
         // exist in the glTF file. It is computed from the type and the stride of the buffer view.
         // As a convenience, cgltf also replaces zero (default) stride with the actual stride.
@@ -1766,6 +1948,16 @@ FilamentAsset* AssetLoader::createInstancedAsset(const uint8_t* bytes, uint32_t
     return downcast(this)->createInstancedAsset(bytes, numBytes, instances, numInstances);
 }
 
+FilamentAsset* AssetLoader::createAssetFromFile(const char* path) {
+    FilamentInstance* instances;
+    return downcast(this)->createInstancedAssetFromFile(path, &instances, 1);
+}
+
+FilamentAsset* AssetLoader::createInstancedAssetFromFile(const char* path,
+        FilamentInstance** instances, size_t numInstances) {
+    return downcast(this)->createInstancedAssetFromFile(path, instances, numInstances);
+}
+
 FilamentInstance* AssetLoader::createInstance(FilamentAsset* asset) {
     return downcast(this)->createInstance(downcast(asset));
 }
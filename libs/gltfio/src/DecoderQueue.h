@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GLTFIO_DECODERQUEUE_H
+#define GLTFIO_DECODERQUEUE_H
+
+#include <utils/compiler.h>
+#include <utils/JobSystem.h>
+#include <utils/Mutex.h>
+
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include <stdint.h>
+
+namespace filament::gltfio {
+
+/**
+ * DecoderQueue is a prioritized queue of decoding tasks that are executed on the JobSystem.
+ *
+ * JobSystem jobs cannot be cancelled once they have been run, so rather than binding each job to
+ * a particular item, every job pops the most important item from the queue when it starts. This
+ * allows items to be re-prioritized or cancelled until a worker thread actually picks them up.
+ *
+ * On platforms without threads no jobs are created, and clients are expected to call pop()
+ * periodically from the foreground thread instead.
+ */
+template<typename T>
+class DecoderQueue {
+public:
+    using Decoder = std::function<void(T* item)>;
+
+    DecoderQueue(utils::JobSystem& js, Decoder decoder) noexcept
+            : mJobSystem(js), mDecoder(std::move(decoder)) {
+        mRootJob = mJobSystem.createJob();
+    }
+
+    ~DecoderQueue() {
+        cancel();
+        wait();
+        mJobSystem.release(mRootJob);
+    }
+
+    DecoderQueue(DecoderQueue const&) = delete;
+    DecoderQueue& operator=(DecoderQueue const&) = delete;
+
+    // Enqueues the given item and kicks off a job that decodes the most important queued item.
+    void push(T* item, float priority = 0.0f) {
+        {
+            std::lock_guard<utils::Mutex> const guard(mLock);
+            mEntries.push_back({ item, priority, mSequence++ });
+        }
+        if constexpr (UTILS_HAS_THREADING) {
+            mJobSystem.run(utils::jobs::createJob(mJobSystem, mRootJob, [this] {
+                if (T* item = pop()) {
+                    mDecoder(item);
+                }
+            }));
+        }
+    }
+
+    // Changes the priority of a queued item. Returns false if the item is not in the queue, e.g.
+    // because its decoding has already started.
+    bool setPriority(T const* item, float priority) noexcept {
+        std::lock_guard<utils::Mutex> const guard(mLock);
+        for (Entry& entry : mEntries) {
+            if (entry.item == item) {
+                entry.priority = priority;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Removes the item with the highest priority, or the oldest one among equal priorities.
+    // Returns null if the queue is empty.
+    T* pop() noexcept {
+        std::lock_guard<utils::Mutex> const guard(mLock);
+        if (mEntries.empty()) {
+            return nullptr;
+        }
+        auto best = mEntries.begin();
+        for (auto it = best + 1; it != mEntries.end(); ++it) {
+            if (it->priority > best->priority ||
+                    (it->priority == best->priority && it->sequence < best->sequence)) {
+                best = it;
+            }
+        }
+        T* const item = best->item;
+        *best = mEntries.back();
+        mEntries.pop_back();
+        return item;
+    }
+
+    // Removes all items whose decoding has not started. Jobs that were created for them return
+    // immediately when they run.
+    std::vector<T*> cancel() {
+        std::lock_guard<utils::Mutex> const guard(mLock);
+        std::vector<T*> items;
+        items.reserve(mEntries.size());
+        for (Entry const& entry : mEntries) {
+            items.push_back(entry.item);
+        }
+        mEntries.clear();
+        return items;
+    }
+
+    // Waits for all jobs to complete. After cancel(), this only waits on in-flight decoders.
+    void wait() {
+        if constexpr (UTILS_HAS_THREADING) {
+            mJobSystem.runAndWait(mRootJob);
+            mRootJob = mJobSystem.createJob();
+        }
+    }
+
+private:
+    struct Entry {
+        T* item;
+        float priority;
+        uint64_t sequence;
+    };
+
+    utils::JobSystem& mJobSystem;
+    utils::JobSystem::Job* mRootJob;
+    Decoder mDecoder;
+    utils::Mutex mLock;
+    std::vector<Entry> mEntries;
+    uint64_t mSequence = 0;
+};
+
+} // namespace filament::gltfio
+
+#endif // GLTFIO_DECODERQUEUE_H
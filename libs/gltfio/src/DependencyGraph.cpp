@@ -75,6 +75,26 @@ void DependencyGraph::addEdge(Texture* texture, MaterialInstance* material, cons
     }
 }
 
+void DependencyGraph::addEdge(Entity entity, const cgltf_mesh* mesh) {
+    if (mMeshToEntity[mesh].insert(entity).second) {
+        mEntityToMaterial[entity].numPendingMeshes++;
+    }
+}
+
+void DependencyGraph::commitMeshEdges() {
+    std::queue<Entity> ready;
+    for (; !mReadyRenderables.empty(); mReadyRenderables.pop()) {
+        Entity const entity = mReadyRenderables.front();
+        auto iter = mEntityToMaterial.find(entity);
+        if (iter != mEntityToMaterial.end() && iter->second.numPendingMeshes > 0) {
+            iter.value().revealWhenUploaded = true;
+        } else {
+            ready.push(entity);
+        }
+    }
+    mReadyRenderables = std::move(ready);
+}
+
 void DependencyGraph::checkReadiness(Material* material) {
     auto& status = mMaterialToTexture.at(material);
 
@@ -109,6 +129,22 @@ void DependencyGraph::markAsReady(Texture* texture) {
     }
 }
 
+void DependencyGraph::markAsReady(const cgltf_mesh* mesh) {
+    auto iter = mMeshToEntity.find(mesh);
+    if (iter == mMeshToEntity.end()) {
+        return;
+    }
+    for (auto entity : iter->second) {
+        auto& status = mEntityToMaterial.at(entity);
+        assert_invariant(status.numPendingMeshes > 0);
+        if (--status.numPendingMeshes == 0 && status.revealWhenUploaded) {
+            status.revealWhenUploaded = false;
+            mReadyRenderables.push(entity);
+        }
+    }
+    mMeshToEntity.erase(iter);
+}
+
 void DependencyGraph::markAsReady(MaterialInstance* material) {
     auto iter = mMaterialToEntity.find(material);
     if (iter == mMaterialToEntity.end()) {
@@ -122,7 +158,7 @@ void DependencyGraph::markAsReady(MaterialInstance* material) {
             continue;
         }
         if (++status.numReadyMaterials == status.materials.size()) {
-            mReadyRenderables.push(entity);
+            reveal(entity, status);
         }
     }
 }
@@ -138,11 +174,21 @@ DependencyGraph::TextureNode* DependencyGraph::getStatus(Texture* texture) {
     return iter->second.get();
 }
 
+void DependencyGraph::reveal(Entity entity, EntityNode& status) {
+    // Entities whose geometry is still streaming are revealed once it has been uploaded.
+    if (status.numPendingMeshes > 0) {
+        status.revealWhenUploaded = true;
+        return;
+    }
+    mReadyRenderables.push(entity);
+}
+
 void DependencyGraph::disableProgressiveReveal() {
     mDisabled = true;
-    for (auto& [entity, status] : mEntityToMaterial) {
+    for (auto iter = mEntityToMaterial.begin(); iter != mEntityToMaterial.end(); ++iter) {
+        EntityNode& status = iter.value();
         if (status.numReadyMaterials < status.materials.size()) {
-            mReadyRenderables.push(entity);
+            reveal(iter->first, status);
         }
     }
 }
@@ -25,6 +25,8 @@
 #include <queue>
 #include <string>
 
+struct cgltf_mesh;
+
 namespace filament {
     class MaterialInstance;
     class Texture;
@@ -72,6 +74,15 @@ public:
     void addEdge(Material* material, const char* parameter);
     void addEdge(Texture* texture, Material* material, const char* parameter);
 
+    // Holds back the given entity until the geometry of the given mesh has been uploaded. This is
+    // used when streaming geometry, and works even if progressive reveal is disabled.
+    void addEdge(Entity entity, const cgltf_mesh* mesh);
+
+    // Takes the entities that wait for a mesh back out of the ready queue, where they may already
+    // be if they're not textured. They're queued again once their geometry has been uploaded.
+    // Entities that have already been popped can't be held back.
+    void commitMeshEdges();
+
     // Commits a set of edges to the graph. This simply triggers a check to see if
     // any entities are already ready, e.g. if any entities are non-textured.
     void commitEdges();
@@ -79,6 +90,9 @@ public:
     // Marks the given texture as being fully decoded, with all miplevels initialized.
     void markAsReady(Texture* texture);
 
+    // Marks the geometry of the given mesh as being fully uploaded.
+    void markAsReady(const cgltf_mesh* mesh);
+
     // Causes the dependency graph to enter a disabled state, whereby adding Entity <=> Material
     // edges will immediately mark the entity as ready without actually growing the graph.
     void disableProgressiveReveal();
@@ -96,17 +110,21 @@ private:
     struct EntityNode {
         tsl::robin_set<Material*> materials;
         size_t numReadyMaterials = 0;
+        size_t numPendingMeshes = 0;
+        bool revealWhenUploaded = false;
     };
 
     void checkReadiness(Material* material);
     void markAsReady(Material* material);
     TextureNode* getStatus(Texture* texture);
+    void reveal(Entity entity, EntityNode& status);
 
     // The following maps contain the directed edges in the graph.
     tsl::robin_map<Entity, EntityNode, Entity::Hasher> mEntityToMaterial;
     tsl::robin_map<Material*, tsl::robin_set<Entity, Entity::Hasher>> mMaterialToEntity;
     tsl::robin_map<Material*, MaterialNode> mMaterialToTexture;
     tsl::robin_map<Texture*, tsl::robin_set<Material*>> mTextureToMaterial;
+    tsl::robin_map<const cgltf_mesh*, tsl::robin_set<Entity, Entity::Hasher>> mMeshToEntity;
 
     // Each texture (and its readiness flag) can be referenced from multiple nodes, so we own
     // a collection of wrapper objects in the following map. This uses std::unique_ptr to allow
@@ -45,8 +45,10 @@
 #include "DependencyGraph.h"
 #include "DracoCache.h"
 #include "FFilamentInstance.h"
+#include "MappedFile.h"
 #include "Utility.h"
 
+#include <algorithm>
 #include <string>
 #include <unordered_map>
 #include <variant>
@@ -102,6 +104,15 @@ struct Primitive {
 };
 using MeshCache = utils::FixedCapacityVector<utils::FixedCapacityVector<Primitive>>;
 
+// Quantized positions are normalized to [-1, 1] within a cube that encloses the bounds of their
+// mesh. The scale is uniform so that normals and tangents do not need to be adjusted.
+inline math::mat4f getDequantizeTransform(Aabb const& bounds) noexcept {
+    const math::float3 center = (bounds.min + bounds.max) * 0.5f;
+    const math::float3 extent = (bounds.max - bounds.min) * 0.5f;
+    const float scale = std::max({ extent.x, extent.y, extent.z });
+    return math::mat4f::translation(center) * math::mat4f::scaling(scale > 0.0f ? scale : 1.0f);
+}
+
 struct FFilamentAsset : public FilamentAsset {
     struct ResourceInfo;
     struct ResourceInfoExtended;
@@ -114,7 +125,8 @@ struct FFilamentAsset : public FilamentAsset {
             mNodeManager(nodeManager), mTrsTransformManager(trsTransformManager),
             mSourceAsset(new SourceAsset {(cgltf_data*)srcAsset}),
             mTextures(srcAsset->textures_count),
-            mMeshCache(srcAsset->meshes_count) {
+            mMeshCache(srcAsset->meshes_count),
+            mQuantizedBounds(srcAsset->meshes_count) {
         if (!useExtendedAlgo) {
             mResourceInfo = ResourceInfo{};
         } else {
@@ -248,6 +260,10 @@ struct FFilamentAsset : public FilamentAsset {
     // to the dependency graph used for gradual reveal of entities.
     void applyTextureBinding(size_t textureIndex,const TextureSlot& tb, bool addDependency = true);
 
+    // Substitutes the given texture in every material instance that it has been bound to. This is
+    // used for texture streaming, which needs to re-create textures with a different base level.
+    void replaceTexture(Texture* oldTexture, Texture* newTexture) noexcept;
+
     struct Skin {
         utils::CString name;
         utils::FixedCapacityVector<math::mat4f> inverseBindMatrices;
@@ -287,11 +303,13 @@ struct FFilamentAsset : public FilamentAsset {
 
     // Encapsulates reference-counted source data, which includes the cgltf hierachy
     // and potentially also includes buffer data that can be uploaded to the GPU.
+    // The glTF file and its buffers are either copied into glbData or memory-mapped.
     struct SourceAsset {
         ~SourceAsset() { cgltf_free(hierarchy); }
         cgltf_data* hierarchy;
         DracoCache dracoCache;
         utils::FixedCapacityVector<uint8_t> glbData;
+        MappedFileList mappedFiles;
     };
 
     // We used shared ownership for the raw cgltf data in order to permit ResourceLoader to
@@ -307,9 +325,13 @@ struct FFilamentAsset : public FilamentAsset {
     // Note that more than one cgltf_texture can map to a single Filament texture,
     // e.g. if several have the same URL or bufferView. For each Filament texture,
     // only one of its corresponding TextureInfo slots will have isOwner=true.
+    // The "bindings" are pending until the Filament texture has been created, whereas the
+    // "appliedBindings" are kept around for streaming, which can swap out the texture.
     struct TextureInfo {
         std::vector<TextureSlot> bindings;
+        std::vector<TextureSlot> appliedBindings;
         Texture* texture;
+        TextureSampler sampler;
         TextureProvider::TextureFlags flags;
         bool isOwner;
     };
@@ -323,6 +345,10 @@ struct FFilamentAsset : public FilamentAsset {
     // The mapping from cgltf_mesh to VertexBuffer* (etc) is required when creating new instances.
     MeshCache mMeshCache;
 
+    // For each mesh whose positions are quantized at import, the bounds of its positions. The box
+    // is empty for all other meshes. See AssetConfiguration::quantizeVertices.
+    utils::FixedCapacityVector<Aabb> mQuantizedBounds;
+
     // Asset information that is produced by AssetLoader and consumed by ResourceLoader:
     struct ResourceInfo {
         // Encapsulates VertexBuffer::setBufferAt() or IndexBuffer::setBuffer().
@@ -335,6 +361,8 @@ struct FFilamentAsset : public FilamentAsset {
             MorphTargetBuffer* morphTargetBuffer;
             uint32_t morphTargetOffset;
             uint32_t morphTargetCount;
+            const Aabb* quantizedBounds;    // converts positions to normalized SHORT4
+            bool halfFloat;                 // converts texture coordinates to HALF2
         };
 
         std::vector<BufferSlot> mBufferSlots;
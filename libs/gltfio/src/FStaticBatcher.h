@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GLTFIO_FSTATICBATCHER_H
+#define GLTFIO_FSTATICBATCHER_H
+
+#include <gltfio/StaticBatcher.h>
+
+#include "downcast.h"
+
+#include <filament/Box.h>
+#include <filament/IndexBuffer.h>
+#include <filament/VertexBuffer.h>
+
+#include <utils/compiler.h>
+#include <utils/Entity.h>
+
+#include <tsl/robin_map.h>
+
+#include <memory>
+#include <vector>
+
+namespace filament::gltfio {
+
+struct FFilamentInstance;
+
+class UTILS_PRIVATE FStaticBatcher : public StaticBatcher {
+public:
+    explicit FStaticBatcher(const StaticBatcherConfiguration& config);
+    ~FStaticBatcher();
+
+    size_t addInstance(FFilamentInstance* instance);
+    void removeInstance(FFilamentInstance* instance);
+
+    const utils::Entity* getBatchEntities() const noexcept {
+        return mBatchEntities.empty() ? nullptr : mBatchEntities.data();
+    }
+
+    size_t getBatchCount() const noexcept { return mBatchEntities.size(); }
+
+    bool isBatched(utils::Entity source) const noexcept {
+        return mSources.find(source) != mSources.end();
+    }
+
+    void setVisible(utils::Entity source, bool visible);
+    bool isVisible(utils::Entity source) const noexcept;
+    void update();
+    utils::Entity getSourceEntity(utils::Entity batch, math::float3 const& position) const noexcept;
+
+private:
+    // A range of triangles in a batch that comes from a single primitive of a source entity.
+    struct Member {
+        utils::Entity source;
+        uint32_t firstIndex;
+        uint32_t indexCount;
+        Aabb bounds;                        // in the space of the instance root
+    };
+
+    struct Batch {
+        FFilamentInstance* instance;
+        VertexBuffer* vertices = nullptr;
+        IndexBuffer* indices = nullptr;
+        std::vector<uint32_t> indexData;    // the indices of all members, visible or not
+        std::vector<Member> members;
+        uint8_t layerMask;
+        bool dirty = false;
+    };
+
+    struct Source {
+        FFilamentInstance* instance;
+        std::vector<utils::Entity> batches; // batches with at least one member from this source
+        uint8_t layerMask;                  // layer mask of the source renderable before merging
+        bool visible = true;
+    };
+
+    void updateBatch(utils::Entity entity, Batch& batch);
+
+    filament::Engine* const mEngine;
+    const StaticBatcherConfiguration mConfig;
+    std::vector<FFilamentInstance*> mInstances;
+    std::vector<utils::Entity> mBatchEntities;
+    tsl::robin_map<utils::Entity, std::unique_ptr<Batch>, utils::Entity::Hasher> mBatches;
+    tsl::robin_map<utils::Entity, Source, utils::Entity::Hasher> mSources;
+};
+
+FILAMENT_DOWNCAST(StaticBatcher)
+
+} // namespace filament::gltfio
+
+#endif // GLTFIO_FSTATICBATCHER_H
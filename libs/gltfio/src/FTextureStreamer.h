@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GLTFIO_FTEXTURESTREAMER_H
+#define GLTFIO_FTEXTURESTREAMER_H
+
+#include <gltfio/TextureStreamer.h>
+
+#include "downcast.h"
+
+#include <filament/Texture.h>
+
+#include <utils/compiler.h>
+#include <utils/JobSystem.h>
+
+#include <tsl/robin_map.h>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace filament {
+class MaterialInstance;
+}
+
+namespace filament::gltfio {
+
+struct FFilamentAsset;
+
+class UTILS_PRIVATE FTextureStreamer : public TextureStreamer {
+public:
+    explicit FTextureStreamer(const TextureStreamerConfiguration& config);
+    ~FTextureStreamer();
+
+    void addAsset(FFilamentAsset* asset);
+    void removeAsset(FFilamentAsset* asset);
+    void update(View const& view);
+    Stats getStats() const noexcept { return mStats; }
+
+    // Returns the first miplevel that fits within the configured resident size. Streaming-enabled
+    // providers create their textures with this miplevel as the base level.
+    uint8_t getResidentLevel(uint32_t width, uint32_t height) const noexcept;
+
+    // Called by a streaming-enabled TextureProvider once the coarse miplevels of a texture have
+    // been uploaded. The encoded source is retained so that finer miplevels can be decoded later.
+    void addTexture(Texture* texture, std::vector<uint8_t>&& source,
+            uint32_t width, uint32_t height, uint8_t residentLevel);
+
+    // Decodes the given PNG / JPEG content to RGBA8 and box-filters it down to the given miplevel.
+    // The returned texels must be freed with free(). Returns null on failure.
+    static uint8_t* decodeLevel(const uint8_t* data, size_t size, uint8_t level,
+            uint32_t* width, uint32_t* height) noexcept;
+
+private:
+    // Declare some sentinel values for the "texels" field, similar to StbProvider.
+    static constexpr intptr_t DECODING_NOT_READY = 0x0;
+    static constexpr intptr_t DECODING_ERROR = 0x1;
+
+    struct StreamedTexture {
+        std::vector<uint8_t> source;        // encoded PNG / JPEG content
+        Texture* texture;                   // texture that is currently bound to materials
+        FFilamentAsset* asset = nullptr;    // owner of the texture, null until addAsset
+        uint32_t width;                     // width of miplevel 0
+        uint32_t height;                    // height of miplevel 0
+        uint8_t residentLevel;              // base level of the current texture
+        uint8_t coarsestLevel;              // base level that is always kept resident
+        uint8_t targetLevel;                // base level requested by the most recent update
+        uint32_t evictionCounter = 0;       // consecutive updates with targetLevel > residentLevel
+        float coverage = 0.0f;              // largest screen-space size, in pixels
+
+        // Decoding state of a pending miplevel change.
+        uint8_t pendingLevel = 0;
+        std::atomic<intptr_t> texels = DECODING_NOT_READY;
+        utils::JobSystem::Job* job = nullptr;
+    };
+
+    using MaterialUsage = tsl::robin_map<MaterialInstance const*, std::vector<StreamedTexture*>>;
+
+    struct AssetInfo {
+        FFilamentAsset* asset;
+        MaterialUsage usage;
+        size_t bindingCount = 0;
+    };
+
+    void refreshUsage(AssetInfo& info);
+    void computeCoverage(View const& view);
+    void computeTargetLevels();
+    void uploadCompletedJobs();
+    void scheduleJobs();
+    void cancelJob(StreamedTexture* st);
+
+    static size_t computeSize(uint32_t width, uint32_t height, uint8_t level) noexcept;
+
+    filament::Engine* const mEngine;
+    const TextureStreamerConfiguration mConfig;
+    std::vector<std::unique_ptr<StreamedTexture>> mTextures;
+    tsl::robin_map<Texture const*, StreamedTexture*> mTextureMap;
+    std::vector<AssetInfo> mAssets;
+    utils::JobSystem::Job* mDecoderRootJob;
+    Stats mStats = {};
+};
+
+FILAMENT_DOWNCAST(TextureStreamer)
+
+} // namespace filament::gltfio
+
+#endif // GLTFIO_FTEXTURESTREAMER_H
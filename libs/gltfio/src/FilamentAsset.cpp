@@ -72,8 +72,8 @@ FFilamentAsset::~FFilamentAsset() {
         mEntityManager->destroy(mRoot);
         for (auto entity : mEntities) {
             mEngine->destroy(entity);
-            mEntityManager->destroy(entity);
         }
+        mEntityManager->destroy(mEntities.size(), mEntities.data());
     }
 
     for (auto vb : mVertexBuffers) {
@@ -85,7 +85,7 @@ FFilamentAsset::~FFilamentAsset() {
     for (auto ib : mIndexBuffers) {
         mEngine->destroy(ib);
     }
-    for (auto tx : mTextures) {
+    for (auto const& tx : mTextures) {
         if (UTILS_LIKELY(tx.isOwner)) {
             mEngine->destroy(tx.texture);
         }
@@ -130,10 +130,10 @@ void FFilamentAsset::addTextureBinding(MaterialInstance* materialInstance,
 
 void FFilamentAsset::applyTextureBinding(size_t textureIndex, const TextureSlot& tb,
         bool addDependency) {
-    const TextureInfo& info = mTextures[textureIndex];
+    TextureInfo& info = mTextures[textureIndex];
     assert_invariant(info.texture);
     const cgltf_sampler* srcSampler = mSourceAsset->hierarchy->textures[textureIndex].sampler;
-    TextureSampler sampler;
+    TextureSampler& sampler = info.sampler;
     if (srcSampler) {
         sampler.setWrapModeS(getWrapMode(srcSampler->wrap_s));
         sampler.setWrapModeT(getWrapMode(srcSampler->wrap_t));
@@ -151,11 +151,24 @@ void FFilamentAsset::applyTextureBinding(size_t textureIndex, const TextureSlot&
         sampler.setMinFilter(TextureSampler::MinFilter::LINEAR_MIPMAP_LINEAR);
     }
     tb.materialInstance->setParameter(tb.materialParameter, info.texture, sampler);
+    info.appliedBindings.push_back(tb);
     if (addDependency) {
         mDependencyGraph.addEdge(info.texture, tb.materialInstance, tb.materialParameter);
     }
 }
 
+void FFilamentAsset::replaceTexture(Texture* oldTexture, Texture* newTexture) noexcept {
+    for (TextureInfo& info : mTextures) {
+        if (info.texture != oldTexture) {
+            continue;
+        }
+        info.texture = newTexture;
+        for (const TextureSlot& tb : info.appliedBindings) {
+            tb.materialInstance->setParameter(tb.materialParameter, newTexture, info.sampler);
+        }
+    }
+}
+
 const char* FFilamentAsset::getMorphTargetNameAt(utils::Entity entity,
         size_t targetIndex) const noexcept {
     if (!mResourcesLoaded) {
@@ -306,6 +306,13 @@ void FFilamentInstance::recomputeBoundingBoxes() {
                 aabb.min = min(aabb.min, primBounds.min);
                 aabb.max = max(aabb.max, primBounds.max);
             }
+
+            // The bounding box of quantized positions is in their normalized space.
+            const Aabb& quantizedBounds = mOwner->mQuantizedBounds[mesh - hierarchy->meshes];
+            if (!quantizedBounds.isEmpty()) {
+                aabb = aabb.transform(inverse(getDequantizeTransform(quantizedBounds)));
+            }
+
             auto renderable = rm.getInstance(entity);
             rm.setAxisAlignedBoundingBox(renderable, Box().set(aabb.min, aabb.max));
 
@@ -0,0 +1,198 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "GeometryStreamer.h"
+
+#include "FFilamentAsset.h"
+#include "FFilamentInstance.h"
+
+#include <filament/Engine.h>
+#include <filament/TransformManager.h>
+
+#include <utils/Systrace.h>
+
+#include <cgltf.h>
+
+#include <math/vec3.h>
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+using namespace filament;
+using namespace filament::math;
+using namespace utils;
+
+namespace filament::gltfio {
+
+namespace {
+
+float distance(Aabb const& box, float3 const& p) noexcept {
+    return length(max(max(box.min - p, p - box.max), float3(0.0f)));
+}
+
+} // anonymous namespace
+
+void GeometryStreamer::begin(FFilamentAsset* asset, size_t budget) {
+    flush();
+
+    mAsset = asset;
+    mBudget = budget;
+    mMeshes.clear();
+    mPending.clear();
+    mBufferToMesh.clear();
+
+    cgltf_data const* gltf = asset->mSourceAsset->hierarchy;
+    mMeshes.resize(gltf->meshes_count);
+    for (size_t i = 0, n = gltf->meshes_count; i < n; ++i) {
+        Mesh& mesh = mMeshes[i];
+        mesh.mesh = gltf->meshes + i;
+        for (Primitive const& prim : asset->mMeshCache[i]) {
+            mesh.bounds.min = min(mesh.bounds.min, prim.aabb.min);
+            mesh.bounds.max = max(mesh.bounds.max, prim.aabb.max);
+            for (const void* buffer : { (const void*) prim.vertices, (const void*) prim.indices,
+                    (const void*) prim.morphTargetBuffer }) {
+                if (buffer) {
+                    mBufferToMesh.try_emplace(buffer, uint32_t(i));
+                }
+            }
+        }
+    }
+
+    // A buffer that is shared by several meshes is uploaded with the first of them, so each
+    // renderable waits for all the meshes that own one of its buffers.
+    DependencyGraph& graph = asset->mDependencyGraph;
+    for (FFilamentInstance const* instance : asset->mInstances) {
+        for (size_t i = 0, n = gltf->nodes_count; i < n; ++i) {
+            cgltf_node const& node = gltf->nodes[i];
+            Entity const entity = instance->mNodeMap[i];
+            if (!node.mesh || !entity) {
+                continue;
+            }
+            for (Primitive const& prim : asset->mMeshCache[node.mesh - gltf->meshes]) {
+                for (const void* buffer : { (const void*) prim.vertices,
+                        (const void*) prim.indices, (const void*) prim.morphTargetBuffer }) {
+                    auto iter = mBufferToMesh.find(buffer);
+                    if (!buffer || iter == mBufferToMesh.end()) {
+                        continue;
+                    }
+                    Mesh& owner = mMeshes[iter->second];
+                    if (owner.entities.empty() || owner.entities.back() != entity) {
+                        owner.entities.push_back(entity);
+                    }
+                    graph.addEdge(entity, owner.mesh);
+                }
+            }
+        }
+    }
+    graph.commitMeshEdges();
+}
+
+void GeometryStreamer::upload(const void* buffer, size_t byteCount, Upload&& upload) {
+    auto iter = mBufferToMesh.find(buffer);
+    if (iter == mBufferToMesh.end()) {
+        upload();
+        return;
+    }
+    Mesh& mesh = mMeshes[iter->second];
+    mesh.uploads.push_back(std::move(upload));
+    mesh.byteCount += byteCount;
+}
+
+void GeometryStreamer::commit() {
+    // From now on, buffers can't be deferred anymore. This also prevents the uploads of another
+    // asset from being deferred if its buffers happen to reuse the addresses of this one.
+    mBufferToMesh.clear();
+
+    for (size_t i = 0, n = mMeshes.size(); i < n; ++i) {
+        if (mMeshes[i].uploads.empty()) {
+            mAsset->mDependencyGraph.markAsReady(mMeshes[i].mesh);
+        } else {
+            mPending.push_back(uint32_t(i));
+        }
+    }
+}
+
+void GeometryStreamer::update(const float3* viewpoint) {
+    if (mPending.empty()) {
+        return;
+    }
+
+    SYSTRACE_CALL();
+
+    // The world transforms can change while the asset is streamed, so the priorities are
+    // evaluated again on each update. Meshes that are not used by any node come last.
+    TransformManager const& tm = mAsset->mEngine->getTransformManager();
+    std::vector<std::pair<float, uint32_t>> queue;
+    queue.reserve(mPending.size());
+    for (uint32_t index : mPending) {
+        Mesh const& mesh = mMeshes[index];
+        float priority = -std::numeric_limits<float>::infinity();
+        for (Entity entity : mesh.entities) {
+            auto ti = tm.getInstance(entity);
+            if (!ti) {
+                continue;
+            }
+            Aabb const box = mesh.bounds.transform(tm.getWorldTransform(ti));
+            priority = std::max(priority,
+                    viewpoint ? -distance(box, *viewpoint) : length(box.extent()));
+        }
+        queue.emplace_back(priority, index);
+    }
+    std::make_heap(queue.begin(), queue.end());
+
+    size_t byteCount = 0;
+    while (!queue.empty()) {
+        Mesh& mesh = mMeshes[queue.front().second];
+        if (byteCount && byteCount + mesh.byteCount > mBudget) {
+            break;
+        }
+        byteCount += mesh.byteCount;
+        std::pop_heap(queue.begin(), queue.end());
+        queue.pop_back();
+        uploadMesh(mesh);
+    }
+
+    mPending.erase(std::remove_if(mPending.begin(), mPending.end(),
+            [this](uint32_t index) { return mMeshes[index].uploads.empty(); }), mPending.end());
+}
+
+void GeometryStreamer::flush() {
+    for (uint32_t index : mPending) {
+        uploadMesh(mMeshes[index]);
+    }
+    mPending.clear();
+}
+
+void GeometryStreamer::cancel() noexcept {
+    for (uint32_t index : mPending) {
+        mMeshes[index].uploads.clear();
+    }
+    mPending.clear();
+    mBufferToMesh.clear();
+    mAsset = nullptr;
+}
+
+void GeometryStreamer::uploadMesh(Mesh& mesh) {
+    for (Upload& upload : mesh.uploads) {
+        upload();
+    }
+    mesh.uploads.clear();
+    mesh.byteCount = 0;
+    mAsset->mDependencyGraph.markAsReady(mesh.mesh);
+}
+
+} // namespace filament::gltfio
@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GLTFIO_GEOMETRY_STREAMER_H
+#define GLTFIO_GEOMETRY_STREAMER_H
+
+#include <filament/Box.h>
+
+#include <utils/Entity.h>
+#include <utils/Invocable.h>
+
+#include <math/vec3.h>
+
+#include <tsl/robin_map.h>
+
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct cgltf_mesh;
+
+namespace filament::gltfio {
+
+struct FFilamentAsset;
+
+/**
+ * Internal helper that defers the upload of vertex, index and morph target buffers so that the
+ * geometry of an asset can be spread over several frames. The uploads are grouped by mesh, and
+ * the meshes nearest to the viewpoint (or the largest ones, when there is no viewpoint) are
+ * uploaded first. The renderables of the asset are held back by its DependencyGraph until the
+ * geometry of their meshes has been uploaded.
+ *
+ * Deferred uploads refer to the asset, which must outlive them or be cancelled.
+ */
+class GeometryStreamer {
+public:
+    using Upload = utils::Invocable<void()>;
+
+    // Groups the buffers of the given asset by mesh, and makes the renderables of its instances
+    // wait for their meshes. The uploads that are still pending for a previous asset are flushed.
+    void begin(FFilamentAsset* asset, size_t budget);
+
+    // Defers the given upload until the mesh that owns the given buffer is streamed. Uploads to
+    // buffers that don't belong to the streamed asset are performed immediately.
+    void upload(const void* buffer, size_t byteCount, Upload&& upload);
+
+    // Marks the meshes that have nothing to upload as ready. This must be called once all the
+    // uploads of the asset have been submitted.
+    void commit();
+
+    // Performs the uploads of the most important meshes, up to the byte budget. The geometry of a
+    // mesh is never split, so at least one mesh is uploaded if any is pending.
+    void update(const math::float3* viewpoint);
+
+    // Performs all the pending uploads.
+    void flush();
+
+    // Drops all the pending uploads.
+    void cancel() noexcept;
+
+    size_t getMeshCount() const noexcept { return mMeshes.size(); }
+    size_t getUploadedCount() const noexcept { return mMeshes.size() - mPending.size(); }
+
+private:
+    struct Mesh {
+        const cgltf_mesh* mesh;
+        Aabb bounds;                        // object-space union of the primitives
+        std::vector<utils::Entity> entities;
+        std::vector<Upload> uploads;
+        size_t byteCount = 0;
+    };
+
+    void uploadMesh(Mesh& mesh);
+
+    FFilamentAsset* mAsset = nullptr;
+    size_t mBudget = 0;
+    std::vector<Mesh> mMeshes;
+    std::vector<uint32_t> mPending;
+    tsl::robin_map<const void*, uint32_t> mBufferToMesh;
+};
+
+} // namespace filament::gltfio
+
+#endif // GLTFIO_GEOMETRY_STREAMER_H
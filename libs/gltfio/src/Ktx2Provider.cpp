@@ -16,6 +16,8 @@
 
 #include <gltfio/TextureProvider.h>
 
+#include "DecoderQueue.h"
+
 #include <string>
 #include <vector>
 
@@ -47,6 +49,7 @@ public:
     void updateQueue() final;
     void waitForCompletion() final;
     void cancelDecoding() final;
+    void setPriority(Texture* texture, float priority) final;
     const char* getPushMessage() const final;
     const char* getPopMessage() const final;
     size_t getPushedCount() const final { return mPushedCount; }
@@ -70,20 +73,20 @@ private:
         ktxreader::Ktx2Reader::Async* async;
         QueueItemState state;
         atomic<TranscoderState> transcoderState;
-        JobSystem::Job* job;
     };
 
     void transcodeSingleTexture();
+    static void transcodeTexture(QueueItem* item);
 
     size_t mPushedCount = 0;
     size_t mPoppedCount = 0;
     size_t mDecodedCount = 0;
     vector<unique_ptr<QueueItem> > mQueueItems;
-    JobSystem::Job* mDecoderRootJob;
     std::string mRecentPushMessage;
     std::string mRecentPopMessage;
     std::unique_ptr<ktxreader::Ktx2Reader> mKtxReader;
     Engine* const mEngine;
+    DecoderQueue<QueueItem> mDecoderQueue;
 };
 
 Texture* Ktx2Provider::pushTexture(const uint8_t* data, size_t byteCount,
@@ -109,20 +112,8 @@ Texture* Ktx2Provider::pushTexture(const uint8_t* data, size_t byteCount,
 
     // On single threaded systems, it is usually fine to create jobs because the job system will
     // simply execute serially. However in our case, we wish to amortize the decoder cost across
-    // several frames, so we instead use the updateQueue() method to perform decoding.
-    if constexpr (!UTILS_HAS_THREADING) {
-        item->job = nullptr;
-        return async->getTexture();
-    }
-
-    JobSystem* js = &mEngine->getJobSystem();
-    item->job = jobs::createJob(*js, mDecoderRootJob, [item] {
-        using Result = ktxreader::Ktx2Reader::Result;
-        const bool success = Result::SUCCESS == item->async->doTranscoding();
-        item->transcoderState.store(success ? TranscoderState::SUCCESS : TranscoderState::ERROR);
-    });
-
-    js->runAndRetain(item->job);
+    // several frames, so the queue does not create jobs and updateQueue() performs decoding.
+    mDecoderQueue.push(item);
     return async->getTexture();
 }
 
@@ -153,7 +144,6 @@ void Ktx2Provider::updateQueue() {
     if (!UTILS_HAS_THREADING) {
         transcodeSingleTexture();
     }
-    JobSystem* js = &mEngine->getJobSystem();
     for (auto& item : mQueueItems) {
         if (item->state != QueueItemState::TRANSCODING) {
             continue;
@@ -161,9 +151,6 @@ void Ktx2Provider::updateQueue() {
         item->async->getTexture();
         const TranscoderState state = item->transcoderState.load();
         if (state != TranscoderState::NOT_STARTED) {
-            if (item->job) {
-                js->waitAndRelease(item->job);
-            }
             if (state == TranscoderState::ERROR) {
                 item->state = QueueItemState::READY;
                 ++mDecodedCount;
@@ -184,19 +171,14 @@ void Ktx2Provider::updateQueue() {
 }
 
 void Ktx2Provider::waitForCompletion() {
-    JobSystem& js = mEngine->getJobSystem();
-    for (auto& item : mQueueItems) {
-        if (item->job) {
-            js.waitAndRelease(item->job);
-        }
-    }
+    mDecoderQueue.wait();
 }
 
 void Ktx2Provider::cancelDecoding() {
-    // TODO: Currently, Ktx2Provider runs jobs eagerly and JobSystem does not allow cancellation of
-    // in-flight jobs. We should consider throttling the number of simultaneous decoder jobs, which
-    // would allow for actual cancellation.
-    waitForCompletion();
+    // Textures that have not started transcoding are removed from the queue, so this only needs to
+    // wait for the transcoders that are currently running.
+    mDecoderQueue.cancel();
+    mDecoderQueue.wait();
 
     // For cancelled jobs, we need to set the QueueItemState to POPPED and free the decoded data
     // stored in item->async.
@@ -210,6 +192,15 @@ void Ktx2Provider::cancelDecoding() {
     }
 }
 
+void Ktx2Provider::setPriority(Texture* texture, float priority) {
+    for (auto& item : mQueueItems) {
+        if (item->state == QueueItemState::TRANSCODING && item->async->getTexture() == texture) {
+            mDecoderQueue.setPriority(item.get(), priority);
+            return;
+        }
+    }
+}
+
 const char* Ktx2Provider::getPushMessage() const {
     return mRecentPushMessage.empty() ? nullptr : mRecentPushMessage.c_str();
 }
@@ -220,18 +211,19 @@ const char* Ktx2Provider::getPopMessage() const {
 
 void Ktx2Provider::transcodeSingleTexture() {
     assert_invariant(!UTILS_HAS_THREADING);
-    for (auto& item : mQueueItems) {
-        if (item->state == QueueItemState::TRANSCODING) {
-            using Result = ktxreader::Ktx2Reader::Result;
-            bool success = Result::SUCCESS == item->async->doTranscoding();
-            item->transcoderState.store(success ? TranscoderState::SUCCESS : TranscoderState::ERROR);
-            break;
-        }
+    if (QueueItem* item = mDecoderQueue.pop()) {
+        transcodeTexture(item);
     }
 }
 
-Ktx2Provider::Ktx2Provider(Engine* engine) : mEngine(engine) {
-    mDecoderRootJob = mEngine->getJobSystem().createJob();
+void Ktx2Provider::transcodeTexture(QueueItem* item) {
+    using Result = ktxreader::Ktx2Reader::Result;
+    const bool success = Result::SUCCESS == item->async->doTranscoding();
+    item->transcoderState.store(success ? TranscoderState::SUCCESS : TranscoderState::ERROR);
+}
+
+Ktx2Provider::Ktx2Provider(Engine* engine) : mEngine(engine),
+        mDecoderQueue(engine->getJobSystem(), &Ktx2Provider::transcodeTexture) {
 #ifdef NDEBUG
     const bool quiet = true;
 #else
@@ -253,7 +245,6 @@ Ktx2Provider::~Ktx2Provider() {
     for (auto& item : mQueueItems) {
         mKtxReader->asyncDestroy(&item->async);
     }
-    mEngine->getJobSystem().release(mDecoderRootJob);
 }
 
 TextureProvider* createKtx2Provider(Engine* engine) {
@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MappedFile.h"
+
+#include <utils/Log.h>
+#include <utils/Systrace.h>
+
+#if !defined(WIN32) && !defined(__EMSCRIPTEN__)
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#    define HAS_MMAP 1
+#else
+#    define HAS_MMAP 0
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace utils;
+
+namespace filament::gltfio {
+
+std::unique_ptr<MappedFile> MappedFile::open(const char* path) noexcept {
+    SYSTRACE_CALL();
+
+#if HAS_MMAP
+    int const fd = ::open(path, O_RDONLY);
+    if (fd < 0) {
+        slog.e << "Unable to open " << path << io::endl;
+        return {};
+    }
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        slog.e << "Unable to read " << path << io::endl;
+        ::close(fd);
+        return {};
+    }
+    size_t const size = size_t(st.st_size);
+    void* const data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    // the mapping keeps its own reference to the file
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        slog.e << "Unable to map " << path << io::endl;
+        return {};
+    }
+    return std::unique_ptr<MappedFile>(new MappedFile((uint8_t*)data, size));
+#else
+    FILE* const file = fopen(path, "rb");
+    if (!file) {
+        slog.e << "Unable to open " << path << io::endl;
+        return {};
+    }
+    fseek(file, 0, SEEK_END);
+    long const size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    uint8_t* const data = size > 0 ? (uint8_t*)malloc(size_t(size)) : nullptr;
+    if (!data || fread(data, 1, size_t(size), file) != size_t(size)) {
+        slog.e << "Unable to read " << path << io::endl;
+        free(data);
+        fclose(file);
+        return {};
+    }
+    fclose(file);
+    return std::unique_ptr<MappedFile>(new MappedFile(data, size_t(size)));
+#endif
+}
+
+MappedFile::~MappedFile() noexcept {
+#if HAS_MMAP
+    munmap(mData, mSize);
+#else
+    free(mData);
+#endif
+}
+
+} // namespace filament::gltfio
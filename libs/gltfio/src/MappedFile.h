@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GLTFIO_MAPPED_FILE_H
+#define GLTFIO_MAPPED_FILE_H
+
+#include <memory>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace filament::gltfio {
+
+// The content of a file, memory-mapped when the platform supports it, or read into memory
+// otherwise. The file is unmapped when the MappedFile is destroyed.
+//
+// The mapping is private and writable: pages are loaded lazily from the file and dropped by the
+// kernel under memory pressure, but the few passes that modify the source buffers in place (e.g.
+// mesh optimization or skinning weights normalization) get a copy of the pages they touch, which
+// never reaches the file.
+class MappedFile {
+public:
+    // Returns null if the file can't be opened or is empty.
+    static std::unique_ptr<MappedFile> open(const char* path) noexcept;
+
+    ~MappedFile() noexcept;
+
+    MappedFile(MappedFile const&) = delete;
+    MappedFile& operator=(MappedFile const&) = delete;
+
+    uint8_t* getData() const noexcept { return mData; }
+    size_t getSize() const noexcept { return mSize; }
+
+private:
+    MappedFile(uint8_t* data, size_t size) noexcept : mData(data), mSize(size) {}
+    uint8_t* const mData;
+    size_t const mSize;
+};
+
+using MappedFileList = std::vector<std::unique_ptr<MappedFile>>;
+
+} // namespace filament::gltfio
+
+#endif // GLTFIO_MAPPED_FILE_H
@@ -19,15 +19,18 @@
 
 #include "GltfEnums.h"
 #include "FFilamentAsset.h"
+#include "GeometryStreamer.h"
 #include "TangentsJob.h"
 #include "downcast.h"
 #include "Utility.h"
 #include "extended/ResourceLoaderExtended.h"
 
 #include <filament/BufferObject.h>
+#include <filament/Camera.h>
 #include <filament/Engine.h>
 #include <filament/IndexBuffer.h>
 #include <filament/MaterialInstance.h>
+#include <filament/RenderableManager.h>
 #include <filament/Texture.h>
 #include <filament/VertexBuffer.h>
 #include <filament/MorphTargetBuffer.h>
@@ -43,16 +46,20 @@
 #include <cgltf.h>
 #include <meshoptimizer.h>
 
+#include <math/half.h>
 #include <math/quat.h>
 #include <math/vec3.h>
 #include <math/vec4.h>
 
 #include <tsl/robin_map.h>
+#include <tsl/robin_set.h>
 
+#include <algorithm>
 #include <fstream>
 #include <memory>
 #include <string>
 #include <tuple>
+#include <vector>
 
 using namespace filament;
 using namespace filament::math;
@@ -81,11 +88,17 @@ struct ResourceLoader::Impl {
     explicit Impl(const ResourceConfiguration& config) :
         mEngine(config.engine),
         mNormalizeSkinningWeights(config.normalizeSkinningWeights),
+        mOptimizeMeshes(config.optimizeMeshes),
+        mStreamGeometry(config.streamGeometry),
+        mGeometryUploadBudget(config.geometryUploadBudget),
         mGltfPath(config.gltfPath ? config.gltfPath : ""),
         mUriDataCache(std::make_shared<UriDataCache>()) {}
 
     Engine* const mEngine;
     bool mNormalizeSkinningWeights;
+    bool mOptimizeMeshes;
+    bool mStreamGeometry;
+    size_t mGeometryUploadBudget;
     std::string mGltfPath;
 
     // User-provided resource data with URI string keys, populated with addResourceData().
@@ -102,7 +115,12 @@ struct ResourceLoader::Impl {
     FFilamentAsset* mAsyncAsset = nullptr;
     size_t mRemainingTextureDownloads = 0;
 
+    // Defers the geometry uploads of the asynchronously loaded asset when streaming is enabled.
+    GeometryStreamer mGeometryStreamer;
+    const Camera* mStreamingCamera = nullptr;
+
     void addResourceData(const char* uri, BufferDescriptor&& buffer);
+    void optimizeMeshes(FFilamentAsset* asset);
     void computeTangents(FFilamentAsset* asset);
     void createTextures(FFilamentAsset* asset, bool async);
     void cancelTextureDecoding();
@@ -119,8 +137,9 @@ struct UploadEvent {
     UriDataCacheHandle dataCacheHandle;
 };
 
-UploadEvent* uploadUserdata(FFilamentAsset* asset, UriDataCacheHandle dataCache) {
-    return new UploadEvent({ asset->mSourceAsset, dataCache });
+UploadEvent* uploadUserdata(FFilamentAsset::SourceHandle const& source,
+        UriDataCacheHandle const& dataCache) {
+    return new UploadEvent({ source, dataCache });
 }
 
 void uploadCallback(void* buffer, size_t size, void* user) {
@@ -227,94 +246,242 @@ inline void createSkins(cgltf_data const* gltf, bool normalize,
     }
 }
 
-inline void uploadBuffers(FFilamentAsset* asset, Engine& engine,
-        UriDataCacheHandle uriDataCache) {
-    // Upload VertexBuffer and IndexBuffer data to the GPU.
-    auto& slots = std::get<FFilamentAsset::ResourceInfo>(asset->mResourceInfo).mBufferSlots;
-    for (auto const& slot: slots) {
-        const cgltf_accessor* accessor = slot.accessor;
-        if (!accessor->buffer_view) {
-            continue;
-        }
-        const uint8_t* bufferData = nullptr;
-        const uint8_t* data = nullptr;
-        if (accessor->buffer_view->has_meshopt_compression) {
-            bufferData = (const uint8_t*) accessor->buffer_view->data;
-            data = bufferData + accessor->offset;
-        } else {
-            bufferData = (const uint8_t*) accessor->buffer_view->buffer->data;
-            data = utility::computeBindingOffset(accessor) + bufferData;
-        }
-        assert_invariant(bufferData);
-        const uint32_t size = utility::computeBindingSize(accessor);
-        if (slot.vertexBuffer) {
-            if (utility::requiresConversion(accessor)) {
-                const size_t floatsCount = accessor->count * cgltf_num_components(accessor->type);
-                const size_t floatsByteCount = sizeof(float) * floatsCount;
-                float* floatsData = (float*) malloc(floatsByteCount);
-                cgltf_accessor_unpack_floats(accessor, floatsData, floatsCount);
-                BufferObject* bo = BufferObject::Builder().size(floatsByteCount).build(engine);
-                asset->mBufferObjects.push_back(bo);
-                bo->setBuffer(engine, BufferDescriptor(floatsData, floatsByteCount, FREE_CALLBACK));
-                slot.vertexBuffer->setBufferObjectAt(engine, slot.bufferIndex, bo);
-                continue;
-            }
+// Normalizes the positions of the given accessor to the dequantization cube of their mesh.
+BufferObject* quantizePositions(Engine& engine, const cgltf_accessor* accessor,
+        Aabb const& bounds) {
+    const mat4f quantize = inverse(getDequantizeTransform(bounds));
+    const size_t count = accessor->count;
+    float3* positions = (float3*) malloc(sizeof(float3) * count);
+    cgltf_accessor_unpack_floats(accessor, &positions->x, count * 3);
+    const size_t byteCount = sizeof(short4) * count;
+    short4* data = (short4*) malloc(byteCount);
+    for (size_t i = 0; i < count; ++i) {
+        const float3 p = clamp((quantize * float4(positions[i], 1.0f)).xyz, -1.0f, 1.0f);
+        data[i] = short4(short3(round(p * 32767.0f)), 32767);
+    }
+    free(positions);
+    BufferObject* bo = BufferObject::Builder().size(byteCount).build(engine);
+    bo->setBuffer(engine, BufferDescriptor(data, byteCount, FREE_CALLBACK));
+    return bo;
+}
 
-            BufferObject* bo = BufferObject::Builder().size(size).build(engine);
+// Converts the texture coordinates of the given accessor to half floats.
+BufferObject* convertToHalf(Engine& engine, const cgltf_accessor* accessor) {
+    const size_t count = accessor->count;
+    float2* uvs = (float2*) malloc(sizeof(float2) * count);
+    cgltf_accessor_unpack_floats(accessor, &uvs->x, count * 2);
+    const size_t byteCount = sizeof(half2) * count;
+    half2* data = (half2*) malloc(byteCount);
+    for (size_t i = 0; i < count; ++i) {
+        data[i] = half2(uvs[i]);
+    }
+    free(uvs);
+    BufferObject* bo = BufferObject::Builder().size(byteCount).build(engine);
+    bo->setBuffer(engine, BufferDescriptor(data, byteCount, FREE_CALLBACK));
+    return bo;
+}
+
+// Uploads the content of a single buffer slot. The source asset is passed separately because the
+// upload can be deferred until after FilamentAsset::releaseSourceData().
+void uploadBufferSlot(FFilamentAsset* asset, Engine& engine,
+        FFilamentAsset::SourceHandle const& source, UriDataCacheHandle const& uriDataCache,
+        FFilamentAsset::ResourceInfo::BufferSlot const& slot, const Aabb* quantizedBounds) {
+    const cgltf_accessor* accessor = slot.accessor;
+    const uint8_t* bufferData = nullptr;
+    const uint8_t* data = nullptr;
+    if (accessor->buffer_view->has_meshopt_compression) {
+        bufferData = (const uint8_t*) accessor->buffer_view->data;
+        data = bufferData + accessor->offset;
+    } else {
+        bufferData = (const uint8_t*) accessor->buffer_view->buffer->data;
+        data = utility::computeBindingOffset(accessor) + bufferData;
+    }
+    assert_invariant(bufferData);
+    const uint32_t size = utility::computeBindingSize(accessor);
+    if (slot.vertexBuffer) {
+        if (quantizedBounds || slot.halfFloat) {
+            BufferObject* bo = quantizedBounds ?
+                    quantizePositions(engine, accessor, *quantizedBounds) :
+                    convertToHalf(engine, accessor);
             asset->mBufferObjects.push_back(bo);
-            bo->setBuffer(engine, BufferDescriptor(data, size, uploadCallback,
-                                          uploadUserdata(asset, uriDataCache)));
             slot.vertexBuffer->setBufferObjectAt(engine, slot.bufferIndex, bo);
-            continue;
-        } else if (slot.indexBuffer) {
-            if (accessor->component_type == cgltf_component_type_r_8u) {
-                const size_t size16 = size * 2;
-                uint16_t* data16 = (uint16_t*) malloc(size16);
-                utility::convertBytesToShorts(data16, data, size);
-                IndexBuffer::BufferDescriptor bd(data16, size16, FREE_CALLBACK);
-
-                slot.indexBuffer->setBuffer(engine, std::move(bd));
-                continue;
-            }
-            IndexBuffer::BufferDescriptor bd(data, size, uploadCallback,
-                    uploadUserdata(asset, uriDataCache));
-            slot.indexBuffer->setBuffer(engine, std::move(bd));
-            continue;
+            return;
         }
-
-        // If the buffer slot does not have an associated VertexBuffer or IndexBuffer, then this
-        // must be a morph target.
-        assert(slot.morphTargetBuffer);
-
-        if (utility::requiresPacking(accessor)) {
+        if (utility::requiresConversion(accessor)) {
             const size_t floatsCount = accessor->count * cgltf_num_components(accessor->type);
             const size_t floatsByteCount = sizeof(float) * floatsCount;
             float* floatsData = (float*) malloc(floatsByteCount);
             cgltf_accessor_unpack_floats(accessor, floatsData, floatsCount);
-            if (accessor->type == cgltf_type_vec3) {
-                slot.morphTargetBuffer->setPositionsAt(engine, slot.bufferIndex,
-                        (const float3*) floatsData,
-                        slot.morphTargetCount,
-                        slot.morphTargetOffset);
-            } else {
-                slot.morphTargetBuffer->setPositionsAt(engine, slot.bufferIndex,
-                        (const float4*) data, slot.morphTargetBuffer->getVertexCount(),
-                        slot.morphTargetOffset);
-            }
-            free(floatsData);
-            continue;
+            BufferObject* bo = BufferObject::Builder().size(floatsByteCount).build(engine);
+            asset->mBufferObjects.push_back(bo);
+            bo->setBuffer(engine, BufferDescriptor(floatsData, floatsByteCount, FREE_CALLBACK));
+            slot.vertexBuffer->setBufferObjectAt(engine, slot.bufferIndex, bo);
+            return;
         }
 
+        BufferObject* bo = BufferObject::Builder().size(size).build(engine);
+        asset->mBufferObjects.push_back(bo);
+        bo->setBuffer(engine, BufferDescriptor(data, size, uploadCallback,
+                                      uploadUserdata(source, uriDataCache)));
+        slot.vertexBuffer->setBufferObjectAt(engine, slot.bufferIndex, bo);
+        return;
+    } else if (slot.indexBuffer) {
+        if (accessor->component_type == cgltf_component_type_r_8u) {
+            const size_t size16 = size * 2;
+            uint16_t* data16 = (uint16_t*) malloc(size16);
+            utility::convertBytesToShorts(data16, data, size);
+            IndexBuffer::BufferDescriptor bd(data16, size16, FREE_CALLBACK);
+
+            slot.indexBuffer->setBuffer(engine, std::move(bd));
+            return;
+        }
+        IndexBuffer::BufferDescriptor bd(data, size, uploadCallback,
+                uploadUserdata(source, uriDataCache));
+        slot.indexBuffer->setBuffer(engine, std::move(bd));
+        return;
+    }
+
+    // If the buffer slot does not have an associated VertexBuffer or IndexBuffer, then this
+    // must be a morph target.
+    assert(slot.morphTargetBuffer);
+
+    if (utility::requiresPacking(accessor)) {
+        const size_t floatsCount = accessor->count * cgltf_num_components(accessor->type);
+        const size_t floatsByteCount = sizeof(float) * floatsCount;
+        float* floatsData = (float*) malloc(floatsByteCount);
+        cgltf_accessor_unpack_floats(accessor, floatsData, floatsCount);
         if (accessor->type == cgltf_type_vec3) {
-            slot.morphTargetBuffer->setPositionsAt(engine, slot.bufferIndex, (const float3*) data,
+            slot.morphTargetBuffer->setPositionsAt(engine, slot.bufferIndex,
+                    (const float3*) floatsData,
                     slot.morphTargetCount,
                     slot.morphTargetOffset);
         } else {
-            assert_invariant(accessor->type == cgltf_type_vec4);
-            slot.morphTargetBuffer->setPositionsAt(engine, slot.bufferIndex, (const float4*) data,
-                    slot.morphTargetCount,
+            slot.morphTargetBuffer->setPositionsAt(engine, slot.bufferIndex,
+                    (const float4*) data, slot.morphTargetBuffer->getVertexCount(),
                     slot.morphTargetOffset);
         }
+        free(floatsData);
+        return;
+    }
+
+    if (accessor->type == cgltf_type_vec3) {
+        slot.morphTargetBuffer->setPositionsAt(engine, slot.bufferIndex, (const float3*) data,
+                slot.morphTargetCount,
+                slot.morphTargetOffset);
+    } else {
+        assert_invariant(accessor->type == cgltf_type_vec4);
+        slot.morphTargetBuffer->setPositionsAt(engine, slot.bufferIndex, (const float4*) data,
+                slot.morphTargetCount,
+                slot.morphTargetOffset);
+    }
+}
+
+inline void uploadBuffers(FFilamentAsset* asset, Engine& engine,
+        UriDataCacheHandle const& uriDataCache, GeometryStreamer& streamer) {
+    // Upload VertexBuffer and IndexBuffer data to the GPU, or defer it if the geometry of the asset
+    // is streamed.
+    auto& slots = std::get<FFilamentAsset::ResourceInfo>(asset->mResourceInfo).mBufferSlots;
+    for (auto const& slot: slots) {
+        if (!slot.accessor->buffer_view) {
+            continue;
+        }
+        const void* buffer = slot.vertexBuffer ? (const void*) slot.vertexBuffer :
+                slot.indexBuffer ? (const void*) slot.indexBuffer :
+                (const void*) slot.morphTargetBuffer;
+        // The quantization bounds live in the mesh cache, which doesn't outlive the source data.
+        const Aabb bounds = slot.quantizedBounds ? *slot.quantizedBounds : Aabb{};
+        streamer.upload(buffer, utility::computeBindingSize(slot.accessor),
+                [asset, &engine, source = asset->mSourceAsset, uriDataCache, slot, bounds]() {
+                    uploadBufferSlot(asset, engine, source, uriDataCache, slot,
+                            slot.quantizedBounds ? &bounds : nullptr);
+                });
+    }
+}
+
+// Returns a writable pointer to the first element of the given accessor.
+uint8_t* getAccessorData(const cgltf_accessor* accessor) {
+    const cgltf_buffer_view* view = accessor->buffer_view;
+    if (view->has_meshopt_compression) {
+        return (uint8_t*) view->data + accessor->offset;
+    }
+    return (uint8_t*) view->buffer->data + view->offset + accessor->offset;
+}
+
+// Moves each vertex of the given accessor to its remapped location, dropping unused vertices.
+void remapVertices(const cgltf_accessor* accessor, const unsigned int* remap, size_t uniqueCount) {
+    const size_t count = accessor->count;
+    const size_t size = cgltf_calc_size(accessor->type, accessor->component_type);
+    const size_t stride = accessor->stride;
+    uint8_t* const data = getAccessorData(accessor);
+    std::unique_ptr<uint8_t[]> packed(new uint8_t[count * size]);
+    for (size_t i = 0; i < count; ++i) {
+        memcpy(packed.get() + i * size, data + i * stride, size);
+    }
+    std::unique_ptr<uint8_t[]> remapped(new uint8_t[uniqueCount * size]);
+    meshopt_remapVertexBuffer(remapped.get(), packed.get(), count, size, remap);
+    for (size_t i = 0; i < uniqueCount; ++i) {
+        memcpy(data + i * stride, remapped.get() + i * size, size);
+    }
+}
+
+// Optimizes the order of the triangles for the vertex cache and then for overdraw, and reorders
+// the vertices of all attributes and morph targets in the order they are first referenced.
+void optimizePrimitive(const cgltf_primitive* prim) {
+    const cgltf_accessor* const indexAccessor = prim->indices;
+    const size_t indexCount = indexAccessor->count;
+    const size_t vertexCount = prim->attributes[0].data->count;
+
+    std::vector<unsigned int> indices(indexCount);
+    for (size_t i = 0; i < indexCount; ++i) {
+        indices[i] = (unsigned int) cgltf_accessor_read_index(indexAccessor, i);
+        if (indices[i] >= vertexCount) {
+            slog.w << "Cannot optimize primitive, index out of range." << io::endl;
+            return;
+        }
+    }
+
+    meshopt_optimizeVertexCache(indices.data(), indices.data(), indexCount, vertexCount);
+
+    for (cgltf_size i = 0; i < prim->attributes_count; ++i) {
+        const cgltf_attribute& attr = prim->attributes[i];
+        if (attr.type == cgltf_attribute_type_position && attr.data->type == cgltf_type_vec3) {
+            std::unique_ptr<float[]> positions(new float[vertexCount * 3]);
+            cgltf_accessor_unpack_floats(attr.data, positions.get(), vertexCount * 3);
+            meshopt_optimizeOverdraw(indices.data(), indices.data(), indexCount, positions.get(),
+                    vertexCount, sizeof(float3), 1.05f);
+            break;
+        }
+    }
+
+    std::vector<unsigned int> remap(vertexCount);
+    const size_t uniqueCount = meshopt_optimizeVertexFetchRemap(remap.data(), indices.data(),
+            indexCount, vertexCount);
+    meshopt_remapIndexBuffer(indices.data(), indices.data(), indexCount, remap.data());
+
+    for (cgltf_size i = 0; i < prim->attributes_count; ++i) {
+        remapVertices(prim->attributes[i].data, remap.data(), uniqueCount);
+    }
+    for (cgltf_size t = 0; t < prim->targets_count; ++t) {
+        const cgltf_morph_target& target = prim->targets[t];
+        for (cgltf_size i = 0; i < target.attributes_count; ++i) {
+            remapVertices(target.attributes[i].data, remap.data(), uniqueCount);
+        }
+    }
+
+    uint8_t* const data = getAccessorData(indexAccessor);
+    const size_t stride = indexAccessor->stride;
+    for (size_t i = 0; i < indexCount; ++i) {
+        switch (indexAccessor->component_type) {
+            case cgltf_component_type_r_8u:
+                data[i * stride] = uint8_t(indices[i]);
+                break;
+            case cgltf_component_type_r_16u:
+                *(uint16_t*) (data + i * stride) = uint16_t(indices[i]);
+                break;
+            default:
+                *(uint32_t*) (data + i * stride) = uint32_t(indices[i]);
+                break;
+        }
     }
 }
 
@@ -328,6 +495,9 @@ ResourceLoader::~ResourceLoader() {
 
 void ResourceLoader::setConfiguration(const ResourceConfiguration& config) {
     pImpl->mNormalizeSkinningWeights = config.normalizeSkinningWeights;
+    pImpl->mOptimizeMeshes = config.optimizeMeshes;
+    pImpl->mStreamGeometry = config.streamGeometry;
+    pImpl->mGeometryUploadBudget = config.geometryUploadBudget;
     pImpl->mGltfPath = config.gltfPath;
 }
 
@@ -415,6 +585,12 @@ bool ResourceLoader::loadResources(FFilamentAsset* asset, bool async) {
 
     bool const isExtendedAlgo = asset->isUsingExtendedAlgorithm();
 
+    // Streamed renderables wait for their geometry even if progressive reveal is disabled, so this
+    // must be set up before disabling it.
+    if (async && pImpl->mStreamGeometry && !isExtendedAlgo) {
+        pImpl->mGeometryStreamer.begin(asset, pImpl->mGeometryUploadBudget);
+    }
+
     // At this point, any entities that are created in the future (i.e. dynamically added instances)
     // will not need the progressive feature to be enabled. This simplifies the dependency graph and
     // prevents it from growing.
@@ -428,7 +604,8 @@ bool ResourceLoader::loadResources(FFilamentAsset* asset, bool async) {
     cgltf_data const* gltf = asset->mSourceAsset->hierarchy;
 
     if (!isExtendedAlgo) {
-        utility::loadCgltfBuffers(gltf, pImpl->mGltfPath.c_str(), pImpl->mUriDataCache);
+        utility::loadCgltfBuffers(gltf, pImpl->mGltfPath.c_str(), pImpl->mUriDataCache,
+                &asset->mSourceAsset->mappedFiles);
 
         // Decompress Draco meshes early on, which allows us to exploit subsequent processing such
         // as tangent generation.
@@ -443,13 +620,22 @@ bool ResourceLoader::loadResources(FFilamentAsset* asset, bool async) {
         }
         utility::decodeMeshoptCompression((cgltf_data*) gltf);
 
-        uploadBuffers(asset, *pImpl->mEngine, pImpl->mUriDataCache);
+        // Reorder triangles and vertices before anything reads them back from the source buffers.
+        if (pImpl->mOptimizeMeshes) {
+            pImpl->optimizeMeshes(asset);
+        }
+
+        uploadBuffers(asset, *pImpl->mEngine, pImpl->mUriDataCache, pImpl->mGeometryStreamer);
 
         // Compute surface orientation quaternions if necessary. This is similar to sparse data in
         // that we need to generate the contents of a GPU buffer by processing one or more CPU
         // buffer(s).
         pImpl->computeTangents(asset);
 
+        if (async && pImpl->mStreamGeometry) {
+            pImpl->mGeometryStreamer.commit();
+        }
+
         std::get<FFilamentAsset::ResourceInfo>(asset->mResourceInfo).mBufferSlots.clear();
         std::get<FFilamentAsset::ResourceInfo>(asset->mResourceInfo).mPrimitives.clear();
     } else {
@@ -486,6 +672,7 @@ bool ResourceLoader::asyncBeginLoad(FilamentAsset* asset) {
 
 void ResourceLoader::asyncCancelLoad() {
     pImpl->cancelTextureDecoding();
+    pImpl->mGeometryStreamer.cancel();
     pImpl->mAsyncAsset = nullptr;
     pImpl->mEngine->flushAndWait();
 }
@@ -495,11 +682,14 @@ void ResourceLoader::addTextureProvider(const char* mimeType, TextureProvider* p
 }
 
 float ResourceLoader::asyncGetLoadProgress() const {
-    if (pImpl->mTextureProviders.empty() || !pImpl->mAsyncAsset) {
+    GeometryStreamer const& streamer = pImpl->mGeometryStreamer;
+    if ((pImpl->mTextureProviders.empty() && !streamer.getMeshCount()) || !pImpl->mAsyncAsset) {
         return 0;
     }
-    size_t pushedCount = 0;
-    size_t poppedCount = 0;
+
+    // Each streamed mesh counts as much as a texture.
+    size_t pushedCount = streamer.getMeshCount();
+    size_t poppedCount = streamer.getUploadedCount();
     for (const auto& iter : pImpl->mTextureProviders) {
         pushedCount += iter.second->getPushedCount();
         poppedCount += iter.second->getPoppedCount();
@@ -516,6 +706,12 @@ void ResourceLoader::asyncUpdateLoad() {
     if (!pImpl->mAsyncAsset) {
         return;
     }
+    if (pImpl->mStreamingCamera) {
+        const float3 viewpoint(pImpl->mStreamingCamera->getPosition());
+        pImpl->mGeometryStreamer.update(&viewpoint);
+    } else {
+        pImpl->mGeometryStreamer.update(nullptr);
+    }
     for (const auto& iter : pImpl->mTextureProviders) {
         iter.second->updateQueue();
         while (Texture* texture = iter.second->popTexture()) {
@@ -524,6 +720,42 @@ void ResourceLoader::asyncUpdateLoad() {
     }
 }
 
+void ResourceLoader::asyncSetStreamingCamera(const Camera* camera) {
+    pImpl->mStreamingCamera = camera;
+}
+
+void ResourceLoader::asyncPrioritizeEntities(const Entity* entities, size_t count) {
+    FFilamentAsset* asset = pImpl->mAsyncAsset;
+    if (!asset || pImpl->mTextureProviders.empty()) {
+        return;
+    }
+
+    auto& rm = pImpl->mEngine->getRenderableManager();
+    tsl::robin_set<const MaterialInstance*> materials;
+    for (size_t i = 0; i < count; ++i) {
+        if (auto ri = rm.getInstance(entities[i]); ri) {
+            for (size_t prim = 0, n = rm.getPrimitiveCount(ri); prim < n; ++prim) {
+                materials.insert(rm.getMaterialInstanceAt(ri, prim));
+            }
+        }
+    }
+
+    for (const FFilamentAsset::TextureInfo& info : asset->mTextures) {
+        if (!info.texture) {
+            continue;
+        }
+        const bool used = std::any_of(info.appliedBindings.begin(), info.appliedBindings.end(),
+                [&materials](const TextureSlot& slot) {
+                    return materials.find(slot.materialInstance) != materials.end();
+                });
+        if (used) {
+            for (const auto& iter : pImpl->mTextureProviders) {
+                iter.second->setPriority(info.texture, 1.0f);
+            }
+        }
+    }
+}
+
 std::pair<Texture*, CacheResult> ResourceLoader::Impl::getOrCreateTexture(FFilamentAsset* asset,
         size_t textureIndex, TextureProvider::TextureFlags flags) {
     const cgltf_texture& srcTexture = asset->mSourceAsset->hierarchy->textures[textureIndex];
@@ -673,6 +905,98 @@ void ResourceLoader::Impl::createTextures(FFilamentAsset* asset, bool async) {
     }
 }
 
+void ResourceLoader::Impl::optimizeMeshes(FFilamentAsset* asset) {
+    SYSTRACE_CALL();
+
+    cgltf_data const* gltf = asset->mSourceAsset->hierarchy;
+
+    // Vertices and indices are rewritten in place, so a primitive can only be optimized if none of
+    // the bytes it uses are read by another primitive, even through a different accessor or buffer
+    // view. Find the overlapping byte ranges of the source buffers.
+    struct ByteRange {
+        uintptr_t begin;
+        uintptr_t end;
+        const cgltf_primitive* prim;
+    };
+    std::vector<ByteRange> ranges;
+    auto addRange = [&ranges](const cgltf_accessor* accessor, const cgltf_primitive* prim) {
+        if (!accessor || !accessor->buffer_view || !accessor->count) {
+            return;
+        }
+        const size_t size = cgltf_calc_size(accessor->type, accessor->component_type);
+        const uintptr_t begin = uintptr_t(getAccessorData(accessor));
+        ranges.push_back({ begin, begin + accessor->stride * (accessor->count - 1) + size, prim });
+    };
+    for (cgltf_size m = 0; m < gltf->meshes_count; ++m) {
+        const cgltf_mesh& mesh = gltf->meshes[m];
+        for (cgltf_size p = 0; p < mesh.primitives_count; ++p) {
+            const cgltf_primitive* prim = mesh.primitives + p;
+            addRange(prim->indices, prim);
+            for (cgltf_size i = 0; i < prim->attributes_count; ++i) {
+                addRange(prim->attributes[i].data, prim);
+            }
+            for (cgltf_size t = 0; t < prim->targets_count; ++t) {
+                for (cgltf_size i = 0; i < prim->targets[t].attributes_count; ++i) {
+                    addRange(prim->targets[t].attributes[i].data, prim);
+                }
+            }
+        }
+    }
+    std::sort(ranges.begin(), ranges.end(), [](ByteRange const& lhs, ByteRange const& rhs) {
+        return lhs.begin < rhs.begin;
+    });
+    tsl::robin_set<const cgltf_primitive*> shared;
+    for (size_t i = 0, n = ranges.size(); i < n;) {
+        uintptr_t end = ranges[i].end;
+        bool isShared = false;
+        size_t j = i + 1;
+        for (; j < n && ranges[j].begin < end; ++j) {
+            end = std::max(end, ranges[j].end);
+            isShared = isShared || ranges[j].prim != ranges[i].prim;
+        }
+        for (size_t k = i; isShared && k < j; ++k) {
+            shared.insert(ranges[k].prim);
+        }
+        i = j;
+    }
+
+    auto isEligible = [](const cgltf_accessor* accessor, size_t vertexCount) {
+        return accessor && accessor->buffer_view && !accessor->is_sparse &&
+                (!vertexCount || accessor->count == vertexCount);
+    };
+
+    // Primitives are listed once per instance of their mesh.
+    tsl::robin_set<const cgltf_primitive*> primitives;
+    auto const& sources = std::get<FFilamentAsset::ResourceInfo>(asset->mResourceInfo).mPrimitives;
+    for (auto const& [prim, vertexBuffer] : sources) {
+        if (prim->type != cgltf_primitive_type_triangles || prim->has_draco_mesh_compression ||
+                !prim->attributes_count || !isEligible(prim->indices, 0) || shared.count(prim)) {
+            continue;
+        }
+        const size_t vertexCount = prim->attributes[0].data->count;
+        bool eligible = true;
+        for (cgltf_size i = 0; i < prim->attributes_count; ++i) {
+            eligible = eligible && isEligible(prim->attributes[i].data, vertexCount);
+        }
+        for (cgltf_size t = 0; t < prim->targets_count; ++t) {
+            for (cgltf_size i = 0; i < prim->targets[t].attributes_count; ++i) {
+                eligible = eligible && isEligible(prim->targets[t].attributes[i].data, vertexCount);
+            }
+        }
+        if (eligible) {
+            primitives.insert(prim);
+        }
+    }
+
+    // Each primitive owns all of its data, so they can be optimized concurrently.
+    JobSystem* js = &mEngine->getJobSystem();
+    JobSystem::Job* parent = js->createJob();
+    for (const cgltf_primitive* prim : primitives) {
+        js->run(jobs::createJob(*js, parent, [prim] { optimizePrimitive(prim); }));
+    }
+    js->runAndWait(parent);
+}
+
 void ResourceLoader::Impl::computeTangents(FFilamentAsset* asset) {
     SYSTRACE_CALL();
 
@@ -746,20 +1070,31 @@ void ResourceLoader::Impl::computeTangents(FFilamentAsset* asset) {
     }
     js->runAndWait(parent);
 
-    // Finally, upload quaternions to the GPU from the main thread.
+    // Finally, upload quaternions to the GPU from the main thread, or defer it if the geometry
+    // of the asset is streamed. The results are owned by the upload until it runs.
     for (Params& params : jobParams) {
+        struct Free { void operator()(short4* p) const noexcept { free(p); } };
+        std::unique_ptr<short4, Free> results(params.out.results);
+        const size_t vertexCount = params.out.vertexCount;
+        const size_t byteCount = vertexCount * sizeof(short4);
         if (params.context.vb) {
-            BufferObject* bo = BufferObject::Builder()
-                    .size(params.out.vertexCount * sizeof(short4)).build(*mEngine);
-            asset->mBufferObjects.push_back(bo);
-            bo->setBuffer(*mEngine, BufferDescriptor(
-                    params.out.results, bo->getByteCount(), FREE_CALLBACK));
-            params.context.vb->setBufferObjectAt(*mEngine, params.context.slot, bo);
+            mGeometryStreamer.upload(params.context.vb, byteCount,
+                    [this, asset, vb = params.context.vb, slot = params.context.slot, byteCount,
+                            results = std::move(results)]() mutable {
+                BufferObject* bo = BufferObject::Builder().size(byteCount).build(*mEngine);
+                asset->mBufferObjects.push_back(bo);
+                bo->setBuffer(*mEngine, BufferDescriptor(
+                        results.release(), byteCount, FREE_CALLBACK));
+                vb->setBufferObjectAt(*mEngine, slot, bo);
+            });
         } else {
             assert_invariant(params.context.tb);
-            params.context.tb->setTangentsAt(*mEngine, params.in.morphTargetIndex,
-                    params.out.results, params.out.vertexCount, params.context.offset);
-            free(params.out.results);
+            mGeometryStreamer.upload(params.context.tb, byteCount,
+                    [this, tb = params.context.tb, index = params.in.morphTargetIndex,
+                            offset = params.context.offset, vertexCount,
+                            results = std::move(results)]() {
+                tb->setTangentsAt(*mEngine, index, results.get(), vertexCount, offset);
+            });
         }
     }
 }
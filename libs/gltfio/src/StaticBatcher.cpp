@@ -0,0 +1,760 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "FStaticBatcher.h"
+#include "FFilamentAsset.h"
+#include "FFilamentInstance.h"
+
+#include <filament/Box.h>
+#include <filament/Engine.h>
+#include <filament/MaterialInstance.h>
+#include <filament/RenderableManager.h>
+#include <filament/TransformManager.h>
+
+#include <geometry/SurfaceOrientation.h>
+
+#include <utils/EntityManager.h>
+#include <utils/JobSystem.h>
+#include <utils/Panic.h>
+#include <utils/Systrace.h>
+
+#include <math/mat3.h>
+#include <math/mat4.h>
+#include <math/vec2.h>
+#include <math/vec3.h>
+#include <math/vec4.h>
+
+#include <cgltf.h>
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <tuple>
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace filament::math;
+using namespace utils;
+
+static const auto FREE_CALLBACK = [](void* mem, size_t, void*) { free(mem); };
+
+namespace filament::gltfio {
+
+namespace {
+
+// Every batch uses the same interleaved layout, so that any gltfio material can be applied to it.
+// Attributes that are missing from a source primitive are filled with default values.
+struct BatchVertex {
+    float3 position;
+    short4 tangents;
+    float2 uv0;
+    float2 uv1;
+    ubyte4 color;
+};
+
+// A primitive that can be merged, along with its transform into the space of the instance root.
+struct Candidate {
+    Entity source;
+    const cgltf_primitive* primitive;
+    UvMap uvmap;
+    mat4f transform;
+    Aabb bounds;
+    MaterialInstance* material;
+    uint8_t layerMask;
+    bool castShadows;
+    bool receiveShadows;
+    uint32_t vertexCount;
+    uint32_t mortonCode;
+};
+
+// A run of sorted candidates that are merged into a single renderable.
+struct Cluster {
+    Candidate const* candidates;
+    size_t count;
+    Aabb bounds;
+    uint32_t vertexCount;
+    BatchVertex* vertices = nullptr;            // handed over to the VertexBuffer
+    std::vector<uint32_t> indices;
+    std::vector<uint32_t> indexCounts;          // number of indices of each candidate
+};
+
+bool isSameBatch(Candidate const& a, Candidate const& b) noexcept {
+    return a.material == b.material && a.layerMask == b.layerMask &&
+            a.castShadows == b.castShadows && a.receiveShadows == b.receiveShadows;
+}
+
+// Spreads the 10 low bits of v so that there are two zero bits between each of them.
+uint32_t expandBits(uint32_t v) noexcept {
+    v = (v * 0x00010001u) & 0xFF0000FFu;
+    v = (v * 0x00000101u) & 0x0F00F00Fu;
+    v = (v * 0x00000011u) & 0xC30C30C3u;
+    v = (v * 0x00000005u) & 0x49249249u;
+    return v;
+}
+
+// Computes a 30-bit Morton code for a point in the unit cube.
+uint32_t computeMortonCode(float3 p) noexcept {
+    p = clamp(p * 1024.0f, float3(0.0f), float3(1023.0f));
+    return (expandBits(uint32_t(p.x)) << 2) | (expandBits(uint32_t(p.y)) << 1) |
+            expandBits(uint32_t(p.z));
+}
+
+const cgltf_accessor* findAttribute(const cgltf_primitive& prim, cgltf_attribute_type type,
+        cgltf_int index = 0) noexcept {
+    for (cgltf_size i = 0; i < prim.attributes_count; i++) {
+        const cgltf_attribute& attr = prim.attributes[i];
+        if (attr.type == type && attr.index == index) {
+            return attr.data;
+        }
+    }
+    return nullptr;
+}
+
+// Decodes the given accessor to floats, padding each element with the given value (or dropping
+// extra components) so that it has the requested number of components.
+std::vector<float> unpackFloats(const cgltf_accessor* accessor, size_t components, float fill) {
+    const size_t count = accessor->count;
+    const size_t n = cgltf_num_components(accessor->type);
+    std::vector<float> unpacked(count * n);
+    cgltf_accessor_unpack_floats(accessor, unpacked.data(), unpacked.size());
+    if (n == components) {
+        return unpacked;
+    }
+    std::vector<float> result(count * components, fill);
+    for (size_t i = 0; i < count; i++) {
+        std::copy_n(&unpacked[i * n], std::min(n, components), &result[i * components]);
+    }
+    return result;
+}
+
+// Transforms the given primitive into the space of the instance root and appends it to a batch.
+// The indices of the primitive are offset by baseVertex.
+void appendPrimitive(Candidate const& candidate, BatchVertex* vertices, uint32_t baseVertex,
+        std::vector<uint32_t>& indices) {
+    const cgltf_primitive& prim = *candidate.primitive;
+    const size_t vertexCount = candidate.vertexCount;
+    const mat4f& transform = candidate.transform;
+    const mat3f tangentMatrix = transform.upperLeft();
+    const mat3f normalMatrix = transpose(inverse(tangentMatrix));
+    const bool mirrored = det(tangentMatrix) < 0.0f;
+
+    // Gather the triangles first, since they are needed to generate normals and tangents.
+    const size_t first = indices.size();
+    if (prim.indices) {
+        indices.resize(first + prim.indices->count);
+        cgltf_accessor_unpack_indices(prim.indices, indices.data() + first, sizeof(uint32_t),
+                prim.indices->count);
+    } else {
+        indices.resize(first + vertexCount);
+        std::iota(indices.begin() + ptrdiff_t(first), indices.end(), 0u);
+    }
+    // Drop the triangles that refer to vertices that don't exist.
+    size_t triangleCount = 0;
+    for (size_t t = first, n = first + (indices.size() - first) / 3 * 3; t < n; t += 3) {
+        if (indices[t] < vertexCount && indices[t + 1] < vertexCount &&
+                indices[t + 2] < vertexCount) {
+            std::copy_n(&indices[t], 3, &indices[first + triangleCount * 3]);
+            triangleCount++;
+        }
+    }
+    indices.resize(first + triangleCount * 3);
+    uint32_t* const triangles = indices.data() + first;
+
+    // Transforms with a negative determinant flip the winding order of the baked triangles.
+    if (mirrored) {
+        for (size_t t = 0; t < triangleCount; t++) {
+            std::swap(triangles[t * 3 + 1], triangles[t * 3 + 2]);
+        }
+    }
+
+    std::vector<float3> positions(vertexCount);
+    cgltf_accessor_unpack_floats(findAttribute(prim, cgltf_attribute_type_position),
+            &positions.data()->x, vertexCount * 3);
+    for (float3& p : positions) {
+        p = (transform * float4(p, 1.0f)).xyz;
+    }
+
+    // Missing normals are generated by averaging the normals of adjacent faces.
+    std::vector<float3> normals;
+    if (const cgltf_accessor* accessor = findAttribute(prim, cgltf_attribute_type_normal);
+            accessor && accessor->count == vertexCount) {
+        normals.resize(vertexCount);
+        cgltf_accessor_unpack_floats(accessor, &normals.data()->x, vertexCount * 3);
+        for (float3& n : normals) {
+            n = normalMatrix * n;
+        }
+    } else {
+        normals.resize(vertexCount, float3(0.0f));
+        for (size_t t = 0; t < triangleCount; t++) {
+            const uint32_t a = triangles[t * 3 + 0];
+            const uint32_t b = triangles[t * 3 + 1];
+            const uint32_t c = triangles[t * 3 + 2];
+            const float3 n = cross(positions[b] - positions[a], positions[c] - positions[a]);
+            normals[a] += n;
+            normals[b] += n;
+            normals[c] += n;
+        }
+    }
+    for (float3& n : normals) {
+        const float len = length(n);
+        n = len > 0.0f ? n / len : float3(0.0f, 0.0f, 1.0f);
+    }
+
+    std::vector<float4> tangents;
+    if (const cgltf_accessor* accessor = findAttribute(prim, cgltf_attribute_type_tangent);
+            accessor && accessor->count == vertexCount) {
+        std::vector<float> unpacked = unpackFloats(accessor, 4, 1.0f);
+        tangents.resize(vertexCount);
+        for (size_t i = 0; i < vertexCount; i++) {
+            const float4 t = { unpacked[i * 4], unpacked[i * 4 + 1], unpacked[i * 4 + 2],
+                    unpacked[i * 4 + 3] };
+            tangents[i] = float4(normalize(tangentMatrix * t.xyz), mirrored ? -t.w : t.w);
+        }
+    }
+
+    for (size_t i = 0; i < vertexCount; i++) {
+        vertices[i] = {
+                .position = positions[i],
+                .tangents = {},
+                .uv0 = float2(0.0f),
+                .uv1 = float2(0.0f),
+                .color = ubyte4(255) };
+    }
+
+    // Texture coordinates follow the same mapping as AssetLoader::createPrimitive.
+    std::vector<float2> tangentUvs;
+    bool hasUv0 = false;
+    for (cgltf_size a = 0; a < prim.attributes_count; a++) {
+        const cgltf_attribute& attr = prim.attributes[a];
+        if (attr.type != cgltf_attribute_type_texcoord || attr.index >= UvMapSize ||
+                attr.data->count != vertexCount) {
+            continue;
+        }
+        std::vector<float> unpacked = unpackFloats(attr.data, 2, 0.0f);
+        float2 const* uvs = reinterpret_cast<float2 const*>(unpacked.data());
+        if (attr.index == 0) {
+            tangentUvs.assign(uvs, uvs + vertexCount);
+        }
+        UvSet uvset = candidate.uvmap[attr.index];
+        if (uvset == UNUSED && !hasUv0 && getNumUvSets(candidate.uvmap) == 0) {
+            uvset = UV0;
+        }
+        if (uvset == UNUSED) {
+            continue;
+        }
+        hasUv0 = hasUv0 || uvset == UV0;
+        for (size_t i = 0; i < vertexCount; i++) {
+            (uvset == UV0 ? vertices[i].uv0 : vertices[i].uv1) = uvs[i];
+        }
+    }
+
+    if (const cgltf_accessor* accessor = findAttribute(prim, cgltf_attribute_type_color);
+            accessor && accessor->count == vertexCount) {
+        std::vector<float> unpacked = unpackFloats(accessor, 4, 1.0f);
+        for (size_t i = 0; i < vertexCount; i++) {
+            for (size_t c = 0; c < 4; c++) {
+                const float v = std::clamp(unpacked[i * 4 + c], 0.0f, 1.0f);
+                vertices[i].color[c] = uint8_t(v * 255.0f + 0.5f);
+            }
+        }
+    }
+
+    // Compute the tangent frames the same way as TangentsJob, but from the baked attributes.
+    geometry::SurfaceOrientation::Builder sob;
+    sob.vertexCount(vertexCount).normals(normals.data());
+    if (!tangents.empty()) {
+        sob.tangents(tangents.data());
+    } else if (!tangentUvs.empty() && triangleCount > 0) {
+        sob.uvs(tangentUvs.data())
+                .positions(positions.data())
+                .triangleCount(triangleCount)
+                .triangles(reinterpret_cast<uint3 const*>(triangles));
+    }
+    if (geometry::SurfaceOrientation* helper = sob.build()) {
+        helper->getQuats(&vertices->tangents, vertexCount, sizeof(BatchVertex));
+        delete helper;
+    }
+
+    for (size_t i = 0, n = triangleCount * 3; i < n; i++) {
+        triangles[i] += baseVertex;
+    }
+}
+
+void buildCluster(Cluster& cluster) {
+    SYSTRACE_CALL();
+    cluster.vertices = (BatchVertex*) malloc(sizeof(BatchVertex) * cluster.vertexCount);
+    cluster.indexCounts.reserve(cluster.count);
+    uint32_t baseVertex = 0;
+    for (size_t i = 0; i < cluster.count; i++) {
+        Candidate const& candidate = cluster.candidates[i];
+        const size_t first = cluster.indices.size();
+        appendPrimitive(candidate, cluster.vertices + baseVertex, baseVertex, cluster.indices);
+        cluster.indexCounts.push_back(uint32_t(cluster.indices.size() - first));
+        baseVertex += candidate.vertexCount;
+    }
+}
+
+Aabb merge(Aabb const& a, Aabb const& b) noexcept {
+    return { min(a.min, b.min), max(a.max, b.max) };
+}
+
+} // anonymous namespace
+
+FStaticBatcher::FStaticBatcher(const StaticBatcherConfiguration& config)
+        : mEngine(config.engine), mConfig(config) {
+    FILAMENT_CHECK_PRECONDITION(mEngine) << "StaticBatcher requires an engine.";
+}
+
+FStaticBatcher::~FStaticBatcher() {
+    std::vector<FFilamentInstance*> const instances = mInstances;
+    for (FFilamentInstance* instance : instances) {
+        removeInstance(instance);
+    }
+}
+
+size_t FStaticBatcher::addInstance(FFilamentInstance* instance) {
+    SYSTRACE_CALL();
+
+    FFilamentAsset const* asset = instance->mOwner;
+
+    FILAMENT_CHECK_PRECONDITION(asset->mSourceAsset)
+            << "Do not call releaseSourceData before adding an instance to StaticBatcher";
+
+    FILAMENT_CHECK_PRECONDITION(asset->mResourcesLoaded)
+            << "Do not add an instance to StaticBatcher before loadResources or asyncBeginLoad";
+
+    FILAMENT_CHECK_PRECONDITION(
+            std::find(mInstances.begin(), mInstances.end(), instance) == mInstances.end())
+            << "This instance has already been added to StaticBatcher";
+
+    mInstances.push_back(instance);
+
+    const cgltf_data* srcAsset = asset->mSourceAsset->hierarchy;
+    RenderableManager& rm = mEngine->getRenderableManager();
+    TransformManager& tm = mEngine->getTransformManager();
+
+    // Nodes that are animated, or that have an animated ancestor, are not static.
+    std::vector<bool> animated(srcAsset->nodes_count, false);
+    for (cgltf_size i = 0; i < srcAsset->animations_count; i++) {
+        const cgltf_animation& anim = srcAsset->animations[i];
+        for (cgltf_size j = 0; j < anim.channels_count; j++) {
+            if (const cgltf_node* target = anim.channels[j].target_node) {
+                animated[target - srcAsset->nodes] = true;
+            }
+        }
+    }
+    auto isStatic = [&animated, srcAsset](const cgltf_node* node) {
+        for (; node; node = node->parent) {
+            if (animated[node - srcAsset->nodes]) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    // Gather the primitives that can be merged, in the space of the instance root.
+    const TransformManager::Instance root = tm.getInstance(instance->mRoot);
+    const mat4f rootInverse = inverse(tm.getWorldTransform(root));
+    std::vector<Candidate> candidates;
+    Aabb instanceBounds;
+    for (cgltf_size i = 0; i < srcAsset->nodes_count; i++) {
+        const cgltf_node& node = srcAsset->nodes[i];
+        const Entity entity = instance->mNodeMap[i];
+        const RenderableManager::Instance ri = rm.getInstance(entity);
+        if (!ri || !node.mesh || node.skin || !isStatic(&node) ||
+                rm.getPrimitiveCount(ri) != node.mesh->primitives_count) {
+            continue;
+        }
+
+        const cgltf_size meshIndex = node.mesh - srcAsset->meshes;
+        mat4f transform = rootInverse * tm.getWorldTransform(tm.getInstance(entity));
+
+        // The source data is not quantized, so undo the dequantization in the node transform.
+        if (const Aabb& bounds = asset->mQuantizedBounds[meshIndex]; !bounds.isEmpty()) {
+            transform = transform * inverse(getDequantizeTransform(bounds));
+        }
+
+        // The source renderable is hidden once it is batched, so either all of its primitives
+        // are merged or none of them is.
+        const size_t firstCandidate = candidates.size();
+        Aabb nodeBounds;
+        bool eligible = true;
+        for (cgltf_size p = 0; p < node.mesh->primitives_count; p++) {
+            const cgltf_primitive& prim = node.mesh->primitives[p];
+            const cgltf_accessor* positions = findAttribute(prim, cgltf_attribute_type_position);
+            if (prim.type != cgltf_primitive_type_triangles || prim.targets_count ||
+                    prim.has_draco_mesh_compression || !positions ||
+                    positions->type != cgltf_type_vec3 || positions->count == 0 ||
+                    positions->count > mConfig.maxVertexCount) {
+                eligible = false;
+                break;
+            }
+            const size_t triangleCount =
+                    (prim.indices ? prim.indices->count : positions->count) / 3;
+            if (triangleCount == 0 ||
+                    (mConfig.maxTriangleCount && triangleCount > mConfig.maxTriangleCount)) {
+                eligible = false;
+                break;
+            }
+            MaterialInstance* const material = rm.getMaterialInstanceAt(ri, p);
+            if (!material) {
+                eligible = false;
+                break;
+            }
+            Primitive const& cached = asset->mMeshCache[meshIndex][p];
+            Candidate& candidate = candidates.emplace_back();
+            candidate.source = entity;
+            candidate.primitive = &prim;
+            candidate.uvmap = cached.uvmap;
+            candidate.transform = transform;
+            candidate.bounds = cached.aabb.transform(transform);
+            candidate.material = material;
+            candidate.layerMask = rm.getLayerMask(ri);
+            candidate.castShadows = rm.isShadowCaster(ri);
+            candidate.receiveShadows = rm.isShadowReceiver(ri);
+            candidate.vertexCount = uint32_t(positions->count);
+            nodeBounds = merge(nodeBounds, candidate.bounds);
+        }
+        if (eligible) {
+            instanceBounds = merge(instanceBounds, nodeBounds);
+        } else {
+            candidates.resize(firstCandidate);
+        }
+    }
+
+    // Sort the candidates by batch key, and then along a Z-order curve so that each run of
+    // consecutive candidates is spatially coherent.
+    const float3 extent = max(instanceBounds.max - instanceBounds.min,
+            float3(std::numeric_limits<float>::min()));
+    for (Candidate& candidate : candidates) {
+        candidate.mortonCode = computeMortonCode(
+                (candidate.bounds.center() - instanceBounds.min) / extent);
+    }
+    std::sort(candidates.begin(), candidates.end(), [](Candidate const& a, Candidate const& b) {
+        return std::tie(a.material, a.layerMask, a.castShadows, a.receiveShadows, a.mortonCode) <
+                std::tie(b.material, b.layerMask, b.castShadows, b.receiveShadows, b.mortonCode);
+    });
+
+    std::vector<Cluster> clusters;
+    for (;;) {
+        clusters.clear();
+        std::vector<Entity> leftovers;
+        for (size_t i = 0, n = candidates.size(); i < n;) {
+            Candidate const& first = candidates[i];
+            Aabb bounds = first.bounds;
+            uint32_t vertexCount = first.vertexCount;
+            size_t j = i + 1;
+            for (; j < n; j++) {
+                Candidate const& candidate = candidates[j];
+                if (!isSameBatch(first, candidate) ||
+                        vertexCount + candidate.vertexCount > mConfig.maxVertexCount) {
+                    break;
+                }
+                const Aabb merged = merge(bounds, candidate.bounds);
+                const float3 size = merged.max - merged.min;
+                if (mConfig.maxExtent > 0.0f &&
+                        std::max({ size.x, size.y, size.z }) > mConfig.maxExtent) {
+                    break;
+                }
+                bounds = merged;
+                vertexCount += candidate.vertexCount;
+            }
+            // A primitive that ends up alone would gain nothing from being copied.
+            if (j - i > 1) {
+                clusters.push_back({ &first, j - i, bounds, vertexCount });
+            } else {
+                leftovers.push_back(first.source);
+            }
+            i = j;
+        }
+        if (leftovers.empty()) {
+            break;
+        }
+        // The other primitives of the entities that own a leftover primitive can't be merged
+        // either, since their renderable stays visible. Removing them changes the clusters, so
+        // this is repeated until every remaining primitive has a cluster.
+        std::sort(leftovers.begin(), leftovers.end());
+        candidates.erase(std::remove_if(candidates.begin(), candidates.end(),
+                [&leftovers](Candidate const& candidate) {
+                    return std::binary_search(leftovers.begin(), leftovers.end(),
+                            candidate.source);
+                }), candidates.end());
+    }
+
+    // Baking the vertices is the expensive part, so it is spread over the job system.
+    JobSystem& js = mEngine->getJobSystem();
+    JobSystem::Job* parent = js.createJob();
+    for (Cluster& cluster : clusters) {
+        js.run(jobs::createJob(js, parent, [&cluster] { buildCluster(cluster); }));
+    }
+    js.runAndWait(parent);
+
+    std::vector<Entity> newSources;
+    for (Cluster& cluster : clusters) {
+        Candidate const& first = cluster.candidates[0];
+
+        VertexBuffer* vertices = VertexBuffer::Builder()
+                .bufferCount(1)
+                .vertexCount(cluster.vertexCount)
+                .attribute(VertexAttribute::POSITION, 0, VertexBuffer::AttributeType::FLOAT3,
+                        offsetof(BatchVertex, position), sizeof(BatchVertex))
+                .attribute(VertexAttribute::TANGENTS, 0, VertexBuffer::AttributeType::SHORT4,
+                        offsetof(BatchVertex, tangents), sizeof(BatchVertex))
+                .normalized(VertexAttribute::TANGENTS)
+                .attribute(VertexAttribute::UV0, 0, VertexBuffer::AttributeType::FLOAT2,
+                        offsetof(BatchVertex, uv0), sizeof(BatchVertex))
+                .attribute(VertexAttribute::UV1, 0, VertexBuffer::AttributeType::FLOAT2,
+                        offsetof(BatchVertex, uv1), sizeof(BatchVertex))
+                .attribute(VertexAttribute::COLOR, 0, VertexBuffer::AttributeType::UBYTE4,
+                        offsetof(BatchVertex, color), sizeof(BatchVertex))
+                .normalized(VertexAttribute::COLOR)
+                .build(*mEngine);
+
+        vertices->setBufferAt(*mEngine, 0, VertexBuffer::BufferDescriptor(cluster.vertices,
+                sizeof(BatchVertex) * cluster.vertexCount, FREE_CALLBACK));
+
+        IndexBuffer* indices = IndexBuffer::Builder()
+                .indexCount(cluster.indices.size())
+                .bufferType(IndexBuffer::IndexType::UINT)
+                .build(*mEngine);
+
+        // The vertices are baked in the space of the instance root, so the batch must follow it.
+        const Entity entity = EntityManager::get().create();
+        tm.create(entity, root);
+
+        RenderableManager::Builder(1)
+                .boundingBox(Box().set(cluster.bounds.min, cluster.bounds.max))
+                .material(0, first.material)
+                .geometry(0, RenderableManager::PrimitiveType::TRIANGLES, vertices, indices)
+                .layerMask(0xff, first.layerMask)
+                .culling(true)
+                .castShadows(first.castShadows)
+                .receiveShadows(first.receiveShadows)
+                .build(*mEngine, entity);
+
+        auto batch = std::make_unique<Batch>();
+        batch->instance = instance;
+        batch->vertices = vertices;
+        batch->indices = indices;
+        batch->layerMask = first.layerMask;
+        batch->members.reserve(cluster.count);
+        uint32_t firstIndex = 0;
+        for (size_t i = 0; i < cluster.count; i++) {
+            Candidate const& candidate = cluster.candidates[i];
+            batch->members.push_back({ candidate.source, firstIndex, cluster.indexCounts[i],
+                    candidate.bounds });
+            firstIndex += cluster.indexCounts[i];
+
+            auto [it, inserted] = mSources.try_emplace(candidate.source);
+            Source& source = it.value();
+            if (inserted) {
+                source.instance = instance;
+                source.layerMask = candidate.layerMask;
+                newSources.push_back(candidate.source);
+            }
+            if (source.batches.empty() || source.batches.back() != entity) {
+                source.batches.push_back(entity);
+            }
+        }
+        batch->indexData = std::move(cluster.indices);
+
+        updateBatch(entity, *batch);
+        mBatchEntities.push_back(entity);
+        mBatches.emplace(entity, std::move(batch));
+    }
+
+    // Hide the source renderables; their layer mask is restored by removeInstance.
+    for (Entity entity : newSources) {
+        rm.setLayerMask(rm.getInstance(entity), 0xff, 0);
+    }
+
+    return clusters.size();
+}
+
+void FStaticBatcher::removeInstance(FFilamentInstance* instance) {
+    auto pos = std::find(mInstances.begin(), mInstances.end(), instance);
+    if (pos == mInstances.end()) {
+        return;
+    }
+    mInstances.erase(pos);
+
+    for (auto it = mBatches.begin(); it != mBatches.end();) {
+        Batch const& batch = *it->second;
+        if (batch.instance != instance) {
+            ++it;
+            continue;
+        }
+        const Entity entity = it->first;
+        mEngine->destroy(entity);
+        mEngine->destroy(batch.vertices);
+        mEngine->destroy(batch.indices);
+        EntityManager::get().destroy(entity);
+        mBatchEntities.erase(std::find(mBatchEntities.begin(), mBatchEntities.end(), entity));
+        it = mBatches.erase(it);
+    }
+
+    RenderableManager& rm = mEngine->getRenderableManager();
+    for (auto it = mSources.begin(); it != mSources.end();) {
+        Source const& source = it->second;
+        if (source.instance != instance) {
+            ++it;
+            continue;
+        }
+        if (const RenderableManager::Instance ri = rm.getInstance(it->first); ri) {
+            rm.setLayerMask(ri, 0xff, source.layerMask);
+        }
+        it = mSources.erase(it);
+    }
+}
+
+void FStaticBatcher::setVisible(Entity source, bool visible) {
+    auto it = mSources.find(source);
+    if (it == mSources.end() || it->second.visible == visible) {
+        return;
+    }
+    it.value().visible = visible;
+    for (Entity entity : it->second.batches) {
+        mBatches[entity]->dirty = true;
+    }
+}
+
+bool FStaticBatcher::isVisible(Entity source) const noexcept {
+    auto it = mSources.find(source);
+    return it == mSources.end() || it->second.visible;
+}
+
+void FStaticBatcher::update() {
+    SYSTRACE_CALL();
+    for (Entity entity : mBatchEntities) {
+        Batch& batch = *mBatches[entity];
+        if (batch.dirty) {
+            updateBatch(entity, batch);
+        }
+    }
+}
+
+void FStaticBatcher::updateBatch(Entity entity, Batch& batch) {
+    RenderableManager& rm = mEngine->getRenderableManager();
+    const RenderableManager::Instance ri = rm.getInstance(entity);
+    batch.dirty = false;
+
+    // Compact the indices of the visible members and shrink the bounding box to fit them, so
+    // that hidden members cost neither vertex processing nor culling accuracy.
+    uint32_t* const data = (uint32_t*) malloc(batch.indexData.size() * sizeof(uint32_t));
+    size_t count = 0;
+    Aabb bounds;
+    for (Member const& member : batch.members) {
+        if (!mSources[member.source].visible) {
+            continue;
+        }
+        memcpy(data + count, batch.indexData.data() + member.firstIndex,
+                member.indexCount * sizeof(uint32_t));
+        count += member.indexCount;
+        bounds = merge(bounds, member.bounds);
+    }
+
+    if (count == 0) {
+        free(data);
+        rm.setLayerMask(ri, 0xff, 0);
+        return;
+    }
+
+    batch.indices->setBuffer(*mEngine,
+            IndexBuffer::BufferDescriptor(data, count * sizeof(uint32_t), FREE_CALLBACK));
+    rm.setGeometryAt(ri, 0, RenderableManager::PrimitiveType::TRIANGLES,
+            batch.vertices, batch.indices, 0, count);
+    rm.setAxisAlignedBoundingBox(ri, Box().set(bounds.min, bounds.max));
+    rm.setLayerMask(ri, 0xff, batch.layerMask);
+}
+
+Entity FStaticBatcher::getSourceEntity(Entity batch, float3 const& position) const noexcept {
+    auto it = mBatches.find(batch);
+    if (it == mBatches.end()) {
+        return batch;
+    }
+
+    TransformManager& tm = mEngine->getTransformManager();
+    const mat4f worldToBatch = inverse(tm.getWorldTransform(tm.getInstance(batch)));
+    const float3 p = (worldToBatch * float4(position, 1.0f)).xyz;
+
+    // Picking positions are reconstructed from the depth buffer, so allow for a little slack.
+    Entity result;
+    float smallest = std::numeric_limits<float>::max();
+    for (Member const& member : it->second->members) {
+        const float3 size = member.bounds.max - member.bounds.min;
+        const float tolerance = 1e-3f * std::max({ size.x, size.y, size.z });
+        if (member.bounds.contains(p) > tolerance || !mSources.at(member.source).visible) {
+            continue;
+        }
+        const float volume = size.x * size.y * size.z;
+        if (volume < smallest) {
+            smallest = volume;
+            result = member.source;
+        }
+    }
+    return result;
+}
+
+StaticBatcher* StaticBatcher::create(const StaticBatcherConfiguration& config) {
+    return new FStaticBatcher(config);
+}
+
+void StaticBatcher::destroy(StaticBatcher** batcher) {
+    if (batcher) {
+        delete downcast(*batcher);
+        *batcher = nullptr;
+    }
+}
+
+size_t StaticBatcher::addInstance(FilamentInstance* instance) {
+    return downcast(this)->addInstance(downcast(instance));
+}
+
+void StaticBatcher::removeInstance(FilamentInstance* instance) {
+    downcast(this)->removeInstance(downcast(instance));
+}
+
+const Entity* StaticBatcher::getBatchEntities() const noexcept {
+    return downcast(this)->getBatchEntities();
+}
+
+size_t StaticBatcher::getBatchCount() const noexcept {
+    return downcast(this)->getBatchCount();
+}
+
+bool StaticBatcher::isBatched(Entity source) const noexcept {
+    return downcast(this)->isBatched(source);
+}
+
+void StaticBatcher::setVisible(Entity source, bool visible) {
+    downcast(this)->setVisible(source, visible);
+}
+
+bool StaticBatcher::isVisible(Entity source) const noexcept {
+    return downcast(this)->isVisible(source);
+}
+
+void StaticBatcher::update() {
+    downcast(this)->update();
+}
+
+Entity StaticBatcher::getSourceEntity(Entity batch, float3 const& position) const noexcept {
+    return downcast(this)->getSourceEntity(batch, position);
+}
+
+} // namespace filament::gltfio
@@ -16,6 +16,9 @@
 
 #include <gltfio/TextureProvider.h>
 
+#include "DecoderQueue.h"
+#include "FTextureStreamer.h"
+
 #include <string>
 #include <vector>
 
@@ -38,7 +41,7 @@ namespace filament::gltfio {
 
 class StbProvider final : public TextureProvider {
 public:
-    StbProvider(Engine* engine);
+    StbProvider(Engine* engine, FTextureStreamer* streamer);
     ~StbProvider();
 
     Texture* pushTexture(const uint8_t* data, size_t byteCount,
@@ -48,6 +51,7 @@ public:
     void updateQueue() final;
     void waitForCompletion() final;
     void cancelDecoding() final;
+    void setPriority(Texture* texture, float priority) final;
     const char* getPushMessage() const final;
     const char* getPopMessage() const final;
     size_t getPushedCount() const final { return mPushedCount; }
@@ -66,7 +70,9 @@ private:
         TextureState state;
         atomic<intptr_t> decodedTexelsBaseMipmap;
         vector<uint8_t> sourceBuffer;
-        JobSystem::Job*  decoderJob;
+        uint32_t width;         // dimensions of miplevel 0 of the source image
+        uint32_t height;
+        uint8_t baseLevel;      // source miplevel that is uploaded as the texture's base level
     };
 
     // Declare some sentinel values for the "decodedTexelsBaseMipmap" field.
@@ -75,15 +81,17 @@ private:
     static const intptr_t DECODING_ERROR = 0x1;
 
     void decodeSingleTexture();
+    static void decodeTexture(TextureInfo* info, bool keepSource);
 
     size_t mPushedCount = 0;
     size_t mPoppedCount = 0;
     size_t mDecodedCount = 0;
     vector<unique_ptr<TextureInfo> > mTextures;
-    JobSystem::Job* mDecoderRootJob;
     std::string mRecentPushMessage;
     std::string mRecentPopMessage;
     Engine* const mEngine;
+    FTextureStreamer* const mStreamer;
+    DecoderQueue<TextureInfo> mDecoderQueue;
 };
 
 Texture* StbProvider::pushTexture(const uint8_t* data, size_t byteCount,
@@ -96,9 +104,12 @@ Texture* StbProvider::pushTexture(const uint8_t* data, size_t byteCount,
 
     using InternalFormat = Texture::InternalFormat;
 
+    // When streaming, only the coarse miplevels are made resident up front.
+    const uint8_t baseLevel = mStreamer ? mStreamer->getResidentLevel(width, height) : 0;
+
     Texture* texture = Texture::Builder()
-            .width(width)
-            .height(height)
+            .width(std::max(1, width >> baseLevel))
+            .height(std::max(1, height >> baseLevel))
             .levels(0xff)
             .format(any(flags & TextureFlags::sRGB) ? InternalFormat::SRGB8_A8 : InternalFormat::RGBA8)
             .build(*mEngine);
@@ -116,31 +127,14 @@ Texture* StbProvider::pushTexture(const uint8_t* data, size_t byteCount,
     info->state = TextureState::DECODING;
     info->sourceBuffer.assign(data, data + byteCount);
     info->decodedTexelsBaseMipmap.store(DECODING_NOT_READY);
+    info->width = width;
+    info->height = height;
+    info->baseLevel = baseLevel;
 
     // On single threaded systems, it is usually fine to create jobs because the job system will
     // simply execute serially. However in our case, we wish to amortize the decoder cost across
-    // several frames, so we instead use the updateQueue() method to perform decoding.
-    if constexpr (!UTILS_HAS_THREADING) {
-        info->decoderJob = nullptr;
-        return texture;
-    }
-
-    JobSystem* js = &mEngine->getJobSystem();
-    info->decoderJob = jobs::createJob(*js, mDecoderRootJob, [info] {
-        auto& source = info->sourceBuffer;
-        int width, height, comp;
-
-        // Test asynchronous loading by uncommenting this line.
-        // std::this_thread::sleep_for(std::chrono::milliseconds(rand() % 10000));
-
-        stbi_uc* texels = stbi_load_from_memory(source.data(), source.size(),
-                &width, &height, &comp, 4);
-        source.clear();
-        source.shrink_to_fit();
-        info->decodedTexelsBaseMipmap.store(texels ? intptr_t(texels) : DECODING_ERROR);
-    });
-
-    js->runAndRetain(info->decoderJob);
+    // several frames, so the queue does not create jobs and updateQueue() performs decoding.
+    mDecoderQueue.push(info);
     return texture;
 }
 
@@ -168,16 +162,12 @@ void StbProvider::updateQueue() {
     if (!UTILS_HAS_THREADING) {
         decodeSingleTexture();
     }
-    JobSystem* js = &mEngine->getJobSystem();
     for (auto& info : mTextures) {
         if (info->state != TextureState::DECODING) {
             continue;
         }
         Texture* texture = info->texture;
         if (intptr_t data = info->decodedTexelsBaseMipmap.load()) {
-            if (info->decoderJob) {
-                js->waitAndRelease(info->decoderJob);
-            }
             if (data == DECODING_ERROR) {
                 info->state = TextureState::READY;
                 ++mDecodedCount;
@@ -192,6 +182,13 @@ void StbProvider::updateQueue() {
             // interface. Providers of hierarchical images (e.g. KTX) call this only if needed.
             texture->generateMipmaps(*mEngine);
 
+            // The streamer takes over the encoded source, so that it can decode finer miplevels
+            // on demand.
+            if (mStreamer) {
+                mStreamer->addTexture(texture, std::move(info->sourceBuffer),
+                        info->width, info->height, info->baseLevel);
+            }
+
             info->state = TextureState::READY;
             ++mDecodedCount;
         }
@@ -206,19 +203,14 @@ void StbProvider::updateQueue() {
 }
 
 void StbProvider::waitForCompletion() {
-    JobSystem& js = mEngine->getJobSystem();
-    for (auto& info : mTextures) {
-        if (info->decoderJob) {
-            js.waitAndRelease(info->decoderJob);
-        }
-    }
+    mDecoderQueue.wait();
 }
 
 void StbProvider::cancelDecoding() {
-    // TODO: Currently, StbProvider runs jobs eagerly and JobSystem does not allow cancellation of
-    // in-flight jobs. We should consider throttling the number of simultaneous decoder jobs, which
-    // would allow for actual cancellation.
-    waitForCompletion();
+    // Textures that have not started decoding are removed from the queue, so this only needs to
+    // wait for the decoders that are currently running.
+    mDecoderQueue.cancel();
+    mDecoderQueue.wait();
 
     // For cancelled jobs, we need to set the TextureInfo to the popped state and free the decoded
     // data.
@@ -230,13 +222,22 @@ void StbProvider::cancelDecoding() {
         // decodedTexelsBaseMipmap is loaded is in the job threads, and we have waited them to
         // completion above. We also expect the TextureProvider API calls to be made only from one
         // thread.
-        if (intptr_t data = info->decodedTexelsBaseMipmap.load()) {
-            delete [] (uint8_t*) data;
+        if (intptr_t data = info->decodedTexelsBaseMipmap.load(); data != DECODING_ERROR) {
+            stbi_image_free((void*) data);
         }
         info->state = TextureState::POPPED;
     }
 }
 
+void StbProvider::setPriority(Texture* texture, float priority) {
+    for (auto& info : mTextures) {
+        if (info->texture == texture && info->state == TextureState::DECODING) {
+            mDecoderQueue.setPriority(info.get(), priority);
+            return;
+        }
+    }
+}
+
 const char* StbProvider::getPushMessage() const {
     return mRecentPushMessage.empty() ? nullptr : mRecentPushMessage.c_str();
 }
@@ -247,22 +248,36 @@ const char* StbProvider::getPopMessage() const {
 
 void StbProvider::decodeSingleTexture() {
     assert_invariant(!UTILS_HAS_THREADING);
-    for (auto& info : mTextures) {
-        if (info->state == TextureState::DECODING) {
-            auto& source = info->sourceBuffer;
-            int width, height, comp;
-            stbi_uc* texels = stbi_load_from_memory(source.data(), source.size(),
-                    &width, &height, &comp, 4);
-            source.clear();
-            source.shrink_to_fit();
-            info->decodedTexelsBaseMipmap.store(texels ? intptr_t(texels) : DECODING_ERROR);
-            break;
-        }
+    if (TextureInfo* info = mDecoderQueue.pop()) {
+        decodeTexture(info, mStreamer != nullptr);
+    }
+}
+
+void StbProvider::decodeTexture(TextureInfo* info, bool keepSource) {
+    auto& source = info->sourceBuffer;
+    stbi_uc* texels;
+    if (info->baseLevel == 0) {
+        int width, height, comp;
+        texels = stbi_load_from_memory(source.data(), source.size(), &width, &height, &comp, 4);
+    } else {
+        uint32_t width, height;
+        texels = FTextureStreamer::decodeLevel(source.data(), source.size(), info->baseLevel,
+                &width, &height);
+    }
+    if (!keepSource) {
+        source.clear();
+        source.shrink_to_fit();
     }
+    info->decodedTexelsBaseMipmap.store(texels ? intptr_t(texels) : DECODING_ERROR);
 }
 
-StbProvider::StbProvider(Engine* engine) : mEngine(engine) {
-    mDecoderRootJob = mEngine->getJobSystem().createJob();
+StbProvider::StbProvider(Engine* engine, FTextureStreamer* streamer)
+        : mEngine(engine), mStreamer(streamer),
+          mDecoderQueue(engine->getJobSystem(), [this](TextureInfo* info) {
+              // Test asynchronous loading by uncommenting this line.
+              // std::this_thread::sleep_for(std::chrono::milliseconds(rand() % 10000));
+              decodeTexture(info, mStreamer != nullptr);
+          }) {
 #ifndef NDEBUG
     slog.i << "Texture Decoder has "
             << mEngine->getJobSystem().getThreadCount()
@@ -272,11 +287,14 @@ StbProvider::StbProvider(Engine* engine) : mEngine(engine) {
 
 StbProvider::~StbProvider() {
     cancelDecoding();
-    mEngine->getJobSystem().release(mDecoderRootJob);
 }
 
 TextureProvider* createStbProvider(Engine* engine) {
-    return new StbProvider(engine);
+    return new StbProvider(engine, nullptr);
+}
+
+TextureProvider* createStbProvider(Engine* engine, TextureStreamer* streamer) {
+    return new StbProvider(engine, streamer ? downcast(streamer) : nullptr);
 }
 
 } // namespace filament::gltfio
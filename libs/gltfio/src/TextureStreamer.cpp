@@ -0,0 +1,480 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "FTextureStreamer.h"
+#include "FFilamentAsset.h"
+
+#include <filament/Box.h>
+#include <filament/Camera.h>
+#include <filament/Engine.h>
+#include <filament/Frustum.h>
+#include <filament/RenderableManager.h>
+#include <filament/TransformManager.h>
+#include <filament/View.h>
+#include <filament/Viewport.h>
+
+#include <utils/Systrace.h>
+
+#include <math/scalar.h>
+#include <math/vec3.h>
+
+#include <stb_image.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace filament;
+using namespace filament::math;
+using namespace utils;
+
+namespace filament::gltfio {
+
+static const auto FREE_CALLBACK = [](void* mem, size_t, void*) { free(mem); };
+
+FTextureStreamer::FTextureStreamer(const TextureStreamerConfiguration& config) :
+        mEngine(config.engine), mConfig(config) {
+    mDecoderRootJob = mEngine->getJobSystem().createJob();
+}
+
+FTextureStreamer::~FTextureStreamer() {
+    for (auto& st : mTextures) {
+        cancelJob(st.get());
+    }
+    mEngine->getJobSystem().release(mDecoderRootJob);
+}
+
+uint8_t FTextureStreamer::getResidentLevel(uint32_t width, uint32_t height) const noexcept {
+    const uint32_t residentSize = std::max(mConfig.residentSize, 1u);
+    uint8_t level = 0;
+    while (std::max(width >> level, height >> level) > residentSize) {
+        ++level;
+    }
+    return level;
+}
+
+size_t FTextureStreamer::computeSize(uint32_t width, uint32_t height, uint8_t level) noexcept {
+    // Streamed textures are always RGBA8 with a full mip chain.
+    size_t size = 0;
+    width = std::max(1u, width >> level);
+    height = std::max(1u, height >> level);
+    while (true) {
+        size += size_t(width) * height * 4;
+        if (width == 1 && height == 1) {
+            break;
+        }
+        width = std::max(1u, width >> 1);
+        height = std::max(1u, height >> 1);
+    }
+    return size;
+}
+
+uint8_t* FTextureStreamer::decodeLevel(const uint8_t* data, size_t size, uint8_t level,
+        uint32_t* outWidth, uint32_t* outHeight) noexcept {
+    int w, h, comp;
+    stbi_uc* texels = stbi_load_from_memory(data, int(size), &w, &h, &comp, 4);
+    if (!texels) {
+        return nullptr;
+    }
+
+    // Successive 2x2 box filters, performed in place. This is safe because each destination texel
+    // is written at an offset that is no larger than the offset of any source texel that remains
+    // to be read. Note that this ignores the transfer function, just like most mipmap generators.
+    uint32_t width = w;
+    uint32_t height = h;
+    for (uint8_t l = 0; l < level && (width > 1 || height > 1); ++l) {
+        const uint32_t dstWidth = std::max(1u, width >> 1);
+        const uint32_t dstHeight = std::max(1u, height >> 1);
+        uint8_t* dst = texels;
+        for (uint32_t y = 0; y < dstHeight; ++y) {
+            const uint8_t* row0 = texels + size_t(std::min(2 * y, height - 1)) * width * 4;
+            const uint8_t* row1 = texels + size_t(std::min(2 * y + 1, height - 1)) * width * 4;
+            for (uint32_t x = 0; x < dstWidth; ++x) {
+                const uint32_t x0 = std::min(2 * x, width - 1) * 4;
+                const uint32_t x1 = std::min(2 * x + 1, width - 1) * 4;
+                for (uint32_t c = 0; c < 4; ++c) {
+                    const uint32_t sum = row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c];
+                    *dst++ = uint8_t((sum + 2) >> 2);
+                }
+            }
+        }
+        width = dstWidth;
+        height = dstHeight;
+    }
+
+    *outWidth = width;
+    *outHeight = height;
+    return texels;
+}
+
+void FTextureStreamer::addTexture(Texture* texture, std::vector<uint8_t>&& source,
+        uint32_t width, uint32_t height, uint8_t residentLevel) {
+    assert_invariant(mTextureMap.find(texture) == mTextureMap.end());
+    StreamedTexture* st = mTextures.emplace_back(new StreamedTexture).get();
+    st->source = std::move(source);
+    st->texture = texture;
+    st->width = width;
+    st->height = height;
+    st->residentLevel = residentLevel;
+    st->coarsestLevel = residentLevel;
+    st->targetLevel = residentLevel;
+    mTextureMap[texture] = st;
+}
+
+void FTextureStreamer::addAsset(FFilamentAsset* asset) {
+    auto pos = std::find_if(mAssets.begin(), mAssets.end(),
+            [asset](AssetInfo const& info) { return info.asset == asset; });
+    if (pos == mAssets.end()) {
+        mAssets.push_back({ asset });
+    }
+}
+
+void FTextureStreamer::removeAsset(FFilamentAsset* asset) {
+    mAssets.erase(std::remove_if(mAssets.begin(), mAssets.end(),
+            [asset](AssetInfo const& info) { return info.asset == asset; }), mAssets.end());
+
+    // The textures are owned by the asset, so here we simply forget about them. This includes
+    // textures that have not been associated with the asset yet, because they have not been used.
+    for (auto const& info : asset->mTextures) {
+        if (auto iter = mTextureMap.find(info.texture); iter != mTextureMap.end()) {
+            iter->second->asset = asset;
+        }
+    }
+    for (auto& st : mTextures) {
+        if (st->asset == asset) {
+            cancelJob(st.get());
+            mTextureMap.erase(st->texture);
+        }
+    }
+    mTextures.erase(std::remove_if(mTextures.begin(), mTextures.end(),
+            [asset](auto const& st) { return st->asset == asset; }), mTextures.end());
+}
+
+void FTextureStreamer::cancelJob(StreamedTexture* st) {
+    if (st->job) {
+        mEngine->getJobSystem().waitAndRelease(st->job);
+    }
+    if (intptr_t data = st->texels.load(); data != DECODING_NOT_READY && data != DECODING_ERROR) {
+        free((void*) data);
+    }
+    st->texels.store(DECODING_NOT_READY);
+}
+
+void FTextureStreamer::update(View const& view) {
+    SYSTRACE_CALL();
+    uploadCompletedJobs();
+    computeCoverage(view);
+    computeTargetLevels();
+    scheduleJobs();
+
+    size_t residentBytes = 0;
+    size_t pendingCount = 0;
+    for (auto const& st : mTextures) {
+        residentBytes += computeSize(st->width, st->height, st->residentLevel);
+        pendingCount += (st->job || st->texels.load() != DECODING_NOT_READY) ? 1 : 0;
+    }
+    mStats.textureCount = mTextures.size();
+    mStats.residentBytes = residentBytes;
+    mStats.pendingCount = pendingCount;
+}
+
+void FTextureStreamer::refreshUsage(AssetInfo& info) {
+    // Textures can become streamable after addAsset() when the asset is loaded asynchronously, and
+    // bindings are added whenever an instance is created, so the usage map is rebuilt as needed.
+    size_t bindingCount = 0;
+    for (auto const& ti : info.asset->mTextures) {
+        if (mTextureMap.find(ti.texture) != mTextureMap.end()) {
+            bindingCount += ti.appliedBindings.size();
+        }
+    }
+    if (bindingCount == info.bindingCount) {
+        return;
+    }
+    info.bindingCount = bindingCount;
+    info.usage.clear();
+    for (auto const& ti : info.asset->mTextures) {
+        auto iter = mTextureMap.find(ti.texture);
+        if (iter == mTextureMap.end()) {
+            continue;
+        }
+        StreamedTexture* st = iter->second;
+        st->asset = info.asset;
+        for (const TextureSlot& slot : ti.appliedBindings) {
+            auto& textures = info.usage[slot.materialInstance];
+            if (std::find(textures.begin(), textures.end(), st) == textures.end()) {
+                textures.push_back(st);
+            }
+        }
+    }
+}
+
+void FTextureStreamer::computeCoverage(View const& view) {
+    SYSTRACE_CALL();
+    for (auto& st : mTextures) {
+        st->coverage = 0.0f;
+    }
+
+    Camera const& camera = view.getCamera();
+    Viewport const& viewport = view.getViewport();
+    const Frustum frustum = camera.getFrustum();
+    const mat4 projection = camera.getProjectionMatrix();
+    const float3 eye = float3(camera.getPosition());
+
+    // The screen-space diameter, in pixels, of a sphere of radius r at distance d is approximately
+    // r / d * P[1][1] * viewport.height for a perspective projection, and r * P[1][1] *
+    // viewport.height for an orthographic projection.
+    const bool isOrthographic = projection[2][3] == 0.0;
+    const float scale = float(projection[1][1]) * float(viewport.height);
+
+    auto& rm = mEngine->getRenderableManager();
+    auto& tm = mEngine->getTransformManager();
+    for (AssetInfo& info : mAssets) {
+        refreshUsage(info);
+        if (info.usage.empty()) {
+            continue;
+        }
+        for (Entity entity : info.asset->mEntities) {
+            const auto ri = rm.getInstance(entity);
+            if (!ri) {
+                continue;
+            }
+            const Box box = rigidTransform(rm.getAxisAlignedBoundingBox(ri),
+                    tm.getWorldTransform(tm.getInstance(entity)));
+            if (!frustum.intersects(box)) {
+                continue;
+            }
+            const float radius = length(box.halfExtent);
+            const float d = distance(eye, box.center);
+            float pixels = std::numeric_limits<float>::max();
+            if (isOrthographic) {
+                pixels = radius * scale;
+            } else if (d > radius) {
+                pixels = radius / d * scale;
+            }
+            for (size_t prim = 0, n = rm.getPrimitiveCount(ri); prim < n; ++prim) {
+                auto iter = info.usage.find(rm.getMaterialInstanceAt(ri, prim));
+                if (iter == info.usage.end()) {
+                    continue;
+                }
+                for (StreamedTexture* st : iter->second) {
+                    st->coverage = std::max(st->coverage, pixels);
+                }
+            }
+        }
+    }
+}
+
+void FTextureStreamer::computeTargetLevels() {
+    SYSTRACE_CALL();
+    size_t requestedBytes = 0;
+    for (auto& st : mTextures) {
+        uint8_t level = st->coarsestLevel;
+        if (st->asset && st->coverage > 0.0f) {
+            // We assume that the texture is mapped once across the renderable, so the finest
+            // useful miplevel is the one whose size matches the renderable's size on screen.
+            const float size = float(std::max(st->width, st->height));
+            const float lod = std::log2(size / st->coverage) + mConfig.lodBias;
+            level = uint8_t(clamp(std::floor(lod), 0.0f, float(st->coarsestLevel)));
+        }
+        st->targetLevel = level;
+        requestedBytes += computeSize(st->width, st->height, level);
+    }
+    mStats.requestedBytes = requestedBytes;
+
+    if (requestedBytes <= mConfig.budgetInBytes) {
+        return;
+    }
+
+    // Over budget: coarsen the least visible textures first, one miplevel at a time.
+    std::vector<StreamedTexture*> candidates;
+    for (auto& st : mTextures) {
+        if (st->targetLevel < st->coarsestLevel) {
+            candidates.push_back(st.get());
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(),
+            [](StreamedTexture const* lhs, StreamedTexture const* rhs) {
+                return lhs->coverage < rhs->coverage;
+            });
+
+    size_t totalBytes = requestedBytes;
+    bool changed = true;
+    while (totalBytes > mConfig.budgetInBytes && changed) {
+        changed = false;
+        for (StreamedTexture* st : candidates) {
+            if (st->targetLevel == st->coarsestLevel) {
+                continue;
+            }
+            totalBytes -= computeSize(st->width, st->height, st->targetLevel);
+            st->targetLevel++;
+            totalBytes += computeSize(st->width, st->height, st->targetLevel);
+            changed = true;
+            if (totalBytes <= mConfig.budgetInBytes) {
+                break;
+            }
+        }
+    }
+}
+
+void FTextureStreamer::uploadCompletedJobs() {
+    SYSTRACE_CALL();
+    JobSystem& js = mEngine->getJobSystem();
+    size_t uploadedBytes = 0;
+    for (auto& st : mTextures) {
+        const intptr_t data = st->texels.load();
+        if (data == DECODING_NOT_READY) {
+            continue;
+        }
+        if (st->job) {
+            js.waitAndRelease(st->job);
+        }
+        if (data == DECODING_ERROR) {
+            st->texels.store(DECODING_NOT_READY);
+            continue;
+        }
+
+        const uint32_t width = std::max(1u, st->width >> st->pendingLevel);
+        const uint32_t height = std::max(1u, st->height >> st->pendingLevel);
+        const size_t byteCount = size_t(width) * height * 4;
+
+        // Always upload at least one texture per update, so that a single large texture cannot
+        // stall streaming forever. The others keep their decoded texels until the next update.
+        if (uploadedBytes > 0 && uploadedBytes + byteCount > mConfig.uploadBudgetInBytes) {
+            continue;
+        }
+
+        Texture* texture = Texture::Builder()
+                .width(width)
+                .height(height)
+                .levels(0xff)
+                .format(st->texture->getFormat())
+                .build(*mEngine);
+
+        Texture::PixelBufferDescriptor pbd((uint8_t*) data, byteCount, Texture::Format::RGBA,
+                Texture::Type::UBYTE, FREE_CALLBACK);
+        texture->setImage(*mEngine, 0, std::move(pbd));
+        texture->generateMipmaps(*mEngine);
+
+        st->asset->replaceTexture(st->texture, texture);
+        mTextureMap.erase(st->texture);
+        mEngine->destroy(st->texture);
+        mTextureMap[texture] = st.get();
+
+        st->texture = texture;
+        st->residentLevel = st->pendingLevel;
+        st->texels.store(DECODING_NOT_READY);
+        uploadedBytes += byteCount;
+    }
+    mStats.uploadedBytes = uploadedBytes;
+}
+
+void FTextureStreamer::scheduleJobs() {
+    SYSTRACE_CALL();
+    JobSystem& js = mEngine->getJobSystem();
+
+    size_t residentBytes = 0;
+    size_t pendingCount = 0;
+    for (auto const& st : mTextures) {
+        residentBytes += computeSize(st->width, st->height, st->residentLevel);
+        pendingCount += (st->job || st->texels.load() != DECODING_NOT_READY) ? 1 : 0;
+    }
+    const bool overBudget = residentBytes > mConfig.budgetInBytes;
+
+    std::vector<StreamedTexture*> candidates;
+    for (auto& st : mTextures) {
+        if (!st->asset || st->job || st->texels.load() != DECODING_NOT_READY) {
+            continue;
+        }
+        if (st->targetLevel <= st->residentLevel) {
+            st->evictionCounter = 0;
+            if (st->targetLevel < st->residentLevel) {
+                candidates.push_back(st.get());
+            }
+            continue;
+        }
+        // Downgrades are delayed to avoid thrashing when the camera moves back and forth.
+        if (overBudget || ++st->evictionCounter >= mConfig.evictionDelay) {
+            candidates.push_back(st.get());
+        }
+    }
+
+    // Evictions come first since they free memory, followed by the most visible textures.
+    std::sort(candidates.begin(), candidates.end(),
+            [](StreamedTexture const* lhs, StreamedTexture const* rhs) {
+                const bool lhsEviction = lhs->targetLevel > lhs->residentLevel;
+                const bool rhsEviction = rhs->targetLevel > rhs->residentLevel;
+                if (lhsEviction != rhsEviction) {
+                    return lhsEviction;
+                }
+                return lhs->coverage > rhs->coverage;
+            });
+
+    // On single threaded systems we decode at most one level per update, similar to StbProvider.
+    const size_t maxPendingCount = UTILS_HAS_THREADING ? std::max(js.getThreadCount(), size_t(1)) : 1;
+    for (StreamedTexture* st : candidates) {
+        if (pendingCount >= maxPendingCount) {
+            break;
+        }
+        st->evictionCounter = 0;
+        st->pendingLevel = st->targetLevel;
+        ++pendingCount;
+
+        if constexpr (!UTILS_HAS_THREADING) {
+            uint32_t width, height;
+            uint8_t* texels = decodeLevel(st->source.data(), st->source.size(),
+                    st->pendingLevel, &width, &height);
+            st->texels.store(texels ? intptr_t(texels) : DECODING_ERROR);
+            continue;
+        }
+
+        st->job = jobs::createJob(js, mDecoderRootJob, [st] {
+            uint32_t width, height;
+            uint8_t* texels = decodeLevel(st->source.data(), st->source.size(),
+                    st->pendingLevel, &width, &height);
+            st->texels.store(texels ? intptr_t(texels) : DECODING_ERROR);
+        });
+        js.runAndRetain(st->job);
+    }
+}
+
+TextureStreamer* TextureStreamer::create(const TextureStreamerConfiguration& config) {
+    return new FTextureStreamer(config);
+}
+
+void TextureStreamer::destroy(TextureStreamer** streamer) {
+    if (streamer) {
+        delete downcast(*streamer);
+        *streamer = nullptr;
+    }
+}
+
+void TextureStreamer::addAsset(FilamentAsset* asset) {
+    downcast(this)->addAsset(downcast(asset));
+}
+
+void TextureStreamer::removeAsset(FilamentAsset* asset) {
+    downcast(this)->removeAsset(downcast(asset));
+}
+
+void TextureStreamer::update(View const& view) {
+    downcast(this)->update(view);
+}
+
+TextureStreamer::Stats TextureStreamer::getStats() const noexcept {
+    return downcast(this)->getStats();
+}
+
+} // namespace filament::gltfio
@@ -21,12 +21,18 @@
 #include "GltfEnums.h"
 
 #include <utils/Log.h>
+#include <utils/Path.h>
 #include <utils/Systrace.h>
 
 #define CGLTF_IMPLEMENTATION
 #include <cgltf.h>
 #include <meshoptimizer.h>
 
+#include <memory>
+#include <string>
+
+#include <string.h>
+
 namespace filament::gltfio::utility {
 
 using namespace utils;
@@ -206,7 +212,7 @@ bool requiresPacking(cgltf_accessor const* accessor) {
 }
 
 bool loadCgltfBuffers(cgltf_data const* gltf, char const* gltfPath,
-        UriDataCacheHandle uriDataCacheHandle) {
+        UriDataCacheHandle uriDataCacheHandle, MappedFileList* mappedFiles) {
     SYSTRACE_CONTEXT();
     SYSTRACE_NAME_BEGIN("Load buffers");
     cgltf_options options{};
@@ -242,6 +248,29 @@ bool loadCgltfBuffers(cgltf_data const* gltf, char const* gltfPath,
 
         return cgltf_result_success;
     };
+#else
+    // Map the external buffer files rather than letting cgltf read them into memory. cgltf skips
+    // the buffers whose data is already set, and doesn't free them.
+    if (mappedFiles && gltfPath && *gltfPath) {
+        Path const parent = Path(gltfPath).getParent();
+        for (cgltf_size i = 0, n = gltf->buffers_count; i < n; ++i) {
+            cgltf_buffer& buffer = gltf->buffers[i];
+            if (buffer.data || !buffer.uri || strncmp(buffer.uri, "data:", 5) == 0 ||
+                    strstr(buffer.uri, "://")) {
+                continue;
+            }
+            std::string uri(buffer.uri);
+            uri.resize(cgltf_decode_uri(uri.data()));
+            std::unique_ptr<MappedFile> file = MappedFile::open((parent + uri).c_str());
+            if (!file || file->getSize() < buffer.size) {
+                // let cgltf report the error
+                continue;
+            }
+            buffer.data = file->getData();
+            buffer.data_free_method = cgltf_data_free_method_none;
+            mappedFiles->push_back(std::move(file));
+        }
+    }
 #endif
 
     // Read data from the file system and base64 URIs.
@@ -17,6 +17,8 @@
 #ifndef GLTFIO_UTILITY_H
 #define GLTFIO_UTILITY_H
 
+#include "MappedFile.h"
+
 #include <backend/BufferDescriptor.h>
 
 #include <tsl/robin_map.h>
@@ -51,8 +53,9 @@ void convertBytesToShorts(uint16_t* dst, uint8_t const* src, size_t count);
 uint32_t computeBindingOffset(cgltf_accessor const* accessor);
 bool requiresConversion(cgltf_accessor const* accessor);
 bool requiresPacking(cgltf_accessor const* accessor);
+// External buffer files are memory-mapped into mappedFiles when the file system is available.
 bool loadCgltfBuffers(cgltf_data const* gltf, char const* gltfPath,
-        UriDataCacheHandle uriDataCacheHandle);
+        UriDataCacheHandle uriDataCacheHandle, MappedFileList* mappedFiles);
 
 } // namespace filament::gltfio::utility
 
@@ -526,7 +526,8 @@ bool AssetLoaderExtended::createPrimitive(Input* input, Output* out,
     }
 
     if (!mCgltfBuffersLoaded) {
-        mCgltfBuffersLoaded = utility::loadCgltfBuffers(gltf, mGltfPath.c_str(), mUriDataCache);
+        mCgltfBuffersLoaded = utility::loadCgltfBuffers(gltf, mGltfPath.c_str(), mUriDataCache,
+                input->mappedFiles);
         if (!mCgltfBuffersLoaded) {
             return false;
         }
@@ -62,6 +62,7 @@ struct AssetLoaderExtended {
         cgltf_primitive* prim;
         char const* name;
         DracoCache* dracoCache;
+        MappedFileList* mappedFiles;
         Material* material;
     };
 
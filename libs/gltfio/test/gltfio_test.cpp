@@ -26,6 +26,7 @@
 #include <gltfio/AssetLoader.h>
 #include <gltfio/FilamentAsset.h>
 #include <gltfio/ResourceLoader.h>
+#include <gltfio/StaticBatcher.h>
 #include <gltfio/TextureProvider.h>
 #include <gltfio/math.h>
 #include <math/mathfwd.h>
@@ -33,10 +34,16 @@
 #include <utils/NameComponentManager.h>
 #include <utils/Path.h>
 
+#include <cgltf.h>
+
 #include "materials/uberarchive.h"
 
+#include <algorithm>
+#include <array>
 #include <fstream>
+#include <string>
 #include <unordered_map>
+#include <vector>
 
 using namespace filament;
 using namespace backend;
@@ -112,6 +119,59 @@ public:
     FilamentAsset* mAsset = nullptr;
 };
 
+// Encodes the given bytes as a data URI, so that tests can describe small assets inline.
+static std::string toDataUri(std::vector<uint8_t> const& data) {
+    static constexpr char const* alphabet =
+            "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string uri = "data:application/octet-stream;base64,";
+    for (size_t i = 0; i < data.size(); i += 3) {
+        uint32_t const n = uint32_t(data[i]) << 16 |
+                (i + 1 < data.size() ? uint32_t(data[i + 1]) << 8 : 0u) |
+                (i + 2 < data.size() ? uint32_t(data[i + 2]) : 0u);
+        uri += alphabet[(n >> 18) & 63u];
+        uri += alphabet[(n >> 12) & 63u];
+        uri += i + 1 < data.size() ? alphabet[(n >> 6) & 63u] : '=';
+        uri += i + 2 < data.size() ? alphabet[n & 63u] : '=';
+    }
+    return uri;
+}
+
+// Appends the raw bytes of the given values to a buffer.
+template<typename T>
+static void append(std::vector<uint8_t>& buffer, std::initializer_list<T> values) {
+    for (T const& value : values) {
+        uint8_t const* bytes = reinterpret_cast<uint8_t const*>(&value);
+        buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+    }
+}
+
+// Replaces the "DATA_URI" placeholder of the given glTF with the given buffer.
+static std::string withBuffer(std::string json, std::vector<uint8_t> const& buffer) {
+    json.replace(json.find("DATA_URI"), 8, toDataUri(buffer));
+    return json;
+}
+
+// A triangle with the vertices (0, 0, 0), (1, 0, 0) and (0, 1, 0): accessor 0 holds the positions
+// and accessor 1 the indices.
+static std::vector<uint8_t> createTriangleBuffer() {
+    std::vector<uint8_t> buffer;
+    append<float>(buffer, { 0, 0, 0,  1, 0, 0,  0, 1, 0 });
+    append<uint16_t>(buffer, { 0, 1, 2, 0 });
+    return buffer;
+}
+
+static constexpr char const* TRIANGLE_BUFFER_JSON = R"(
+    "buffers": [{ "byteLength": 44, "uri": "DATA_URI" }],
+    "bufferViews": [
+        { "buffer": 0, "byteOffset": 0, "byteLength": 36 },
+        { "buffer": 0, "byteOffset": 36, "byteLength": 6 }
+    ],
+    "accessors": [
+        { "bufferView": 0, "componentType": 5126, "count": 3, "type": "VEC3",
+          "min": [0, 0, 0], "max": [1, 1, 0] },
+        { "bufferView": 1, "componentType": 5123, "count": 3, "type": "SCALAR" }
+    ])";
+
 class glTFIOTest : public testing::Test {
 protected:
     Engine* mEngine = nullptr;
@@ -236,6 +296,200 @@ TEST_F(glTFIOTest, AnimatedMorphCubeRenderables) {
     EXPECT_EQ(morphTargetBuffer->getVertexCount(), 24u);
 }
 
+// Nodes a and b can be merged. The mesh of node c also has a point list, which can't be merged,
+// and node d is the only one using its material.
+static constexpr char const* BATCHER_GLTF_JSON = R"({
+    "asset": { "version": "2.0" },
+    "scene": 0,
+    "scenes": [{ "nodes": [0, 1, 2, 3] }],
+    "nodes": [
+        { "name": "a", "mesh": 0 },
+        { "name": "b", "mesh": 0, "translation": [2, 0, 0] },
+        { "name": "c", "mesh": 1, "translation": [4, 0, 0] },
+        { "name": "d", "mesh": 2, "translation": [6, 0, 0] }
+    ],
+    "meshes": [
+        { "primitives": [{ "attributes": { "POSITION": 0 }, "indices": 1, "material": 0 }] },
+        { "primitives": [
+            { "attributes": { "POSITION": 0 }, "indices": 1, "material": 0 },
+            { "attributes": { "POSITION": 0 }, "mode": 0, "material": 0 }
+        ] },
+        { "primitives": [{ "attributes": { "POSITION": 0 }, "indices": 1, "material": 1 }] }
+    ],
+    "materials": [{ "name": "shared" }, { "name": "single" }],)";
+
+TEST_F(glTFIOTest, StaticBatcherPartiallyMergeable) {
+    std::string const json = withBuffer(std::string(BATCHER_GLTF_JSON) + TRIANGLE_BUFFER_JSON + "}",
+            createTriangleBuffer());
+
+    AssetLoader* assetLoader = AssetLoader::create({ mEngine, mMaterialProvider, mNameManager });
+    ResourceLoader resourceLoader({ mEngine, "", false });
+    FilamentAsset* asset = assetLoader->createAsset((uint8_t const*) json.data(), json.size());
+    ASSERT_NE(asset, nullptr);
+    ASSERT_TRUE(resourceLoader.loadResources(asset));
+
+    Entity const a = asset->getFirstEntityByName("a");
+    Entity const b = asset->getFirstEntityByName("b");
+    Entity const c = asset->getFirstEntityByName("c");
+    Entity const d = asset->getFirstEntityByName("d");
+    auto& rm = mEngine->getRenderableManager();
+    uint8_t const layerMask = rm.getLayerMask(rm.getInstance(c));
+
+    StaticBatcher* batcher = StaticBatcher::create({ .engine = mEngine });
+    EXPECT_EQ(batcher->addInstance(asset->getInstance()), 1u);
+    ASSERT_EQ(batcher->getBatchCount(), 1u);
+    Entity const batch = batcher->getBatchEntities()[0];
+
+    // Only the renderables whose primitives are all in a batch are merged and hidden.
+    EXPECT_TRUE(batcher->isBatched(a));
+    EXPECT_TRUE(batcher->isBatched(b));
+    EXPECT_FALSE(batcher->isBatched(c));
+    EXPECT_FALSE(batcher->isBatched(d));
+    EXPECT_EQ(rm.getLayerMask(rm.getInstance(a)), 0u);
+    EXPECT_EQ(rm.getLayerMask(rm.getInstance(b)), 0u);
+    EXPECT_EQ(rm.getLayerMask(rm.getInstance(c)), layerMask);
+    EXPECT_EQ(rm.getLayerMask(rm.getInstance(d)), layerMask);
+
+    EXPECT_EQ(batcher->getSourceEntity(batch, { 0.25f, 0.25f, 0.0f }), a);
+    EXPECT_EQ(batcher->getSourceEntity(batch, { 2.25f, 0.25f, 0.0f }), b);
+    EXPECT_TRUE(batcher->getSourceEntity(batch, { 4.25f, 0.25f, 0.0f }).isNull());
+    EXPECT_EQ(batcher->getSourceEntity(c, { 4.25f, 0.25f, 0.0f }), c);
+
+    // Hidden sources are not picked anymore.
+    batcher->setVisible(b, false);
+    batcher->update();
+    EXPECT_TRUE(batcher->getSourceEntity(batch, { 2.25f, 0.25f, 0.0f }).isNull());
+
+    batcher->removeInstance(asset->getInstance());
+    EXPECT_EQ(batcher->getBatchCount(), 0u);
+    EXPECT_EQ(rm.getLayerMask(rm.getInstance(a)), layerMask);
+    EXPECT_EQ(rm.getLayerMask(rm.getInstance(b)), layerMask);
+
+    StaticBatcher::destroy(&batcher);
+    assetLoader->destroyAsset(asset);
+    AssetLoader::destroy(&assetLoader);
+}
+
+// Two untextured nodes that share a mesh.
+static constexpr char const* UNTEXTURED_GLTF_JSON = R"({
+    "asset": { "version": "2.0" },
+    "scene": 0,
+    "scenes": [{ "nodes": [0, 1] }],
+    "nodes": [
+        { "name": "a", "mesh": 0 },
+        { "name": "b", "mesh": 0, "translation": [2, 0, 0] }
+    ],
+    "meshes": [
+        { "primitives": [{ "attributes": { "POSITION": 0 }, "indices": 1 }] }
+    ],)";
+
+TEST_F(glTFIOTest, StreamGeometryUntextured) {
+    std::string const json = withBuffer(
+            std::string(UNTEXTURED_GLTF_JSON) + TRIANGLE_BUFFER_JSON + "}",
+            createTriangleBuffer());
+
+    AssetLoader* assetLoader = AssetLoader::create({ mEngine, mMaterialProvider, mNameManager });
+    ResourceLoader resourceLoader({ .engine = mEngine, .gltfPath = "",
+            .normalizeSkinningWeights = false, .streamGeometry = true });
+    FilamentAsset* asset = assetLoader->createAsset((uint8_t const*) json.data(), json.size());
+    ASSERT_NE(asset, nullptr);
+    ASSERT_TRUE(resourceLoader.asyncBeginLoad(asset));
+
+    // The renderables don't depend on any texture, but their geometry hasn't been uploaded yet.
+    EXPECT_EQ(asset->popRenderables(nullptr, 0), 0u);
+
+    for (size_t i = 0; i < 100 && resourceLoader.asyncGetLoadProgress() < 1.0f; i++) {
+        resourceLoader.asyncUpdateLoad();
+    }
+    EXPECT_EQ(resourceLoader.asyncGetLoadProgress(), 1.0f);
+
+    Entity renderables[2];
+    ASSERT_EQ(asset->popRenderables(renderables, 2), 2u);
+    EXPECT_EQ(asset->popRenderables(nullptr, 0), 0u);
+
+    assetLoader->destroyAsset(asset);
+    AssetLoader::destroy(&assetLoader);
+}
+
+// Two primitives read the same positions through different accessors, and have their own indices.
+static constexpr char const* ALIASED_GLTF_JSON = R"({
+    "asset": { "version": "2.0" },
+    "scene": 0,
+    "scenes": [{ "nodes": [0, 1] }],
+    "nodes": [{ "mesh": 0 }, { "mesh": 1 }],
+    "meshes": [
+        { "primitives": [{ "attributes": { "POSITION": 0 }, "indices": 2 }] },
+        { "primitives": [{ "attributes": { "POSITION": 1 }, "indices": 3 }] }
+    ],
+    "buffers": [{ "byteLength": 68, "uri": "DATA_URI" }],
+    "bufferViews": [
+        { "buffer": 0, "byteOffset": 0, "byteLength": 48 },
+        { "buffer": 0, "byteOffset": 48, "byteLength": 12 },
+        { "buffer": 0, "byteOffset": 60, "byteLength": 6 }
+    ],
+    "accessors": [
+        { "bufferView": 0, "componentType": 5126, "count": 4, "type": "VEC3",
+          "min": [0, 0, 0], "max": [1, 1, 0] },
+        { "bufferView": 0, "componentType": 5126, "count": 4, "type": "VEC3",
+          "min": [0, 0, 0], "max": [1, 1, 0] },
+        { "bufferView": 1, "componentType": 5123, "count": 6, "type": "SCALAR" },
+        { "bufferView": 2, "componentType": 5123, "count": 3, "type": "SCALAR" }
+    ]
+})";
+
+using Triangle = std::array<math::float3, 3>;
+
+// Returns the triangles of the given primitive, each one starting with its smallest vertex so that
+// they can be compared regardless of the order of the vertices and triangles.
+static std::vector<Triangle> getTriangles(cgltf_primitive const& prim) {
+    auto less = [](math::float3 const& a, math::float3 const& b) {
+        return std::tie(a.x, a.y, a.z) < std::tie(b.x, b.y, b.z);
+    };
+    std::vector<Triangle> triangles(prim.indices->count / 3);
+    for (size_t i = 0; i < prim.indices->count; i++) {
+        size_t const index = cgltf_accessor_read_index(prim.indices, i);
+        cgltf_accessor_read_float(prim.attributes[0].data, index, &triangles[i / 3][i % 3].x, 3);
+    }
+    for (Triangle& triangle : triangles) {
+        std::rotate(triangle.begin(),
+                std::min_element(triangle.begin(), triangle.end(), less), triangle.end());
+    }
+    std::sort(triangles.begin(), triangles.end(), [&less](Triangle const& a, Triangle const& b) {
+        return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end(), less);
+    });
+    return triangles;
+}
+
+TEST_F(glTFIOTest, OptimizeMeshesAliasedData) {
+    std::vector<uint8_t> buffer;
+    append<float>(buffer, { 0, 0, 0,  1, 0, 0,  1, 1, 0,  0, 1, 0 });
+    append<uint16_t>(buffer, { 3, 2, 1,  3, 1, 0 });
+    append<uint16_t>(buffer, { 0, 1, 2, 0 });
+    std::string const json = withBuffer(ALIASED_GLTF_JSON, buffer);
+
+    AssetLoader* assetLoader = AssetLoader::create({ mEngine, mMaterialProvider, mNameManager });
+    ResourceLoader resourceLoader({ .engine = mEngine, .gltfPath = "",
+            .normalizeSkinningWeights = false, .optimizeMeshes = true });
+    FilamentAsset* asset = assetLoader->createAsset((uint8_t const*) json.data(), json.size());
+    ASSERT_NE(asset, nullptr);
+
+    cgltf_data const* gltf = (cgltf_data const*) asset->getSourceAsset();
+    ASSERT_TRUE(resourceLoader.loadResources(asset));
+
+    // Reordering the shared vertices for one primitive would break the other one.
+    std::vector<Triangle> const quad = getTriangles(gltf->meshes[0].primitives[0]);
+    ASSERT_EQ(quad.size(), 2u);
+    EXPECT_EQ(quad[0], (Triangle{ math::float3{ 0, 0, 0 }, { 0, 1, 0 }, { 1, 0, 0 } }));
+    EXPECT_EQ(quad[1], (Triangle{ math::float3{ 0, 1, 0 }, { 1, 1, 0 }, { 1, 0, 0 } }));
+
+    std::vector<Triangle> const triangle = getTriangles(gltf->meshes[1].primitives[0]);
+    ASSERT_EQ(triangle.size(), 1u);
+    EXPECT_EQ(triangle[0], (Triangle{ math::float3{ 0, 0, 0 }, { 1, 0, 0 }, { 1, 1, 0 } }));
+
+    assetLoader->destroyAsset(asset);
+    AssetLoader::destroy(&assetLoader);
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
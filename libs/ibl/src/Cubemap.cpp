@@ -211,7 +211,9 @@ Cubemap::Texel Cubemap::trilinearFilterAt(const Cubemap& l0, const Cubemap& l1,
     float x1 = std::min(addr.s * l1.mDimensions, l1.mUpperBound);
     float y1 = std::min(addr.t * l1.mDimensions, l1.mUpperBound);
     float3 c0 = filterAt(i0, x0, y0);
-    c0 += lerp * (filterAt(i1, x1, y1) - c0);
+    if (lerp > 0) {
+        c0 += lerp * (filterAt(i1, x1, y1) - c0);
+    }
     return c0;
 }
 
@@ -28,7 +28,6 @@
 #include <math/mat3.h>
 #include <math/scalar.h>
 
-#include <random>
 #include <vector>
 
 using namespace filament::math;
@@ -137,6 +136,19 @@ static float3 UTILS_UNUSED hemisphereImportanceSampleDCharlie(float2 u, float a)
     return { sinTheta * std::cos(phi), sinTheta * std::sin(phi), cosTheta };
 }
 
+// Returns a pseudo-random angle in [-pi, pi) for each texel. Unlike a random engine, this
+// doesn't depend on the order in which texels are processed, so scanlines can be filtered by any
+// number of jobs. Maybe blue-noise instead would look even better.
+static float randomAngle(Cubemap::Face f, size_t x, size_t y) {
+    uint32_t h = uint32_t(x) * 0x8da6b343u ^ uint32_t(y) * 0xd8163841u ^ uint32_t(f) * 0xcb1ab31fu;
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return float(h >> 8) * (2.0f * (float) F_PI / float(1u << 24)) - (float) F_PI;
+}
+
 static float DistributionGGX(float NoH, float linearRoughness) {
     // NOTE: (aa-1) == (a-1)(a+1) produces better fp accuracy
     float a = linearRoughness;
@@ -316,18 +328,28 @@ void CubemapIBL::roughnessFilter(
     std::atomic_uint progress = {0};
 
     if (linearRoughness == 0) {
+        // pick the level that matches the resolution of the destination, so that we don't
+        // alias when the destination is smaller than the base level.
+        const float lod = clamp(std::log2(float(dim0) / float(dst.getDimensions())),
+                0.0f, maxLevelf);
+        const size_t l0 = size_t(lod);
+        const size_t l1 = std::min(maxLevel, l0 + 1);
+        const float lerp = lod - float(l0);
         auto scanline = [&]
                 (CubemapUtils::EmptyState&, size_t y, Cubemap::Face f, Cubemap::Texel* data, size_t dim) {
                     if (UTILS_UNLIKELY(updater)) {
                         size_t p = progress.fetch_add(1, std::memory_order_relaxed) + 1;
                         updater(0, (float)p / ((float) dim * 6.0f), userdata);
                     }
-                    const Cubemap& cm = levels[0];
                     for (size_t x = 0; x < dim; ++x, ++data) {
                         const float2 p(Cubemap::center(x, y));
                         const float3 N(dst.getDirectionFor(f, p.x, p.y) * mirror);
-                        // FIXME: we should pick the proper LOD here and do trilinear filtering
-                        Cubemap::writeAt(data, cm.sampleAt(N));
+                        if (lod == 0) {
+                            Cubemap::writeAt(data, levels[0].sampleAt(N));
+                        } else {
+                            Cubemap::writeAt(data,
+                                    Cubemap::trilinearFilterAt(levels[l0], levels[l1], lerp, N));
+                        }
                     }
         };
         // at least 256 pixel cubemap before we use multithreading -- the overhead of launching
@@ -416,13 +438,7 @@ void CubemapIBL::roughnessFilter(
     });
 
 
-    struct State {
-        // maybe blue-noise instead would look even better
-        std::default_random_engine gen;
-        std::uniform_real_distribution<float> distribution{ -F_PI, F_PI };
-    };
-
-    auto scanline = [&](State& state, size_t y,
+    auto scanline = [&](CubemapUtils::EmptyState&, size_t y,
             Cubemap::Face f, Cubemap::Texel* data, size_t dim) {
         if (UTILS_UNLIKELY(updater)) {
             size_t p = progress.fetch_add(1, std::memory_order_relaxed) + 1;
@@ -440,7 +456,7 @@ void CubemapIBL::roughnessFilter(
             R[1] = cross(N, R[0]);
             R[2] = N;
 
-            R *= mat3f::rotation(state.distribution(state.gen), float3{0,0,1});
+            R *= mat3f::rotation(randomAngle(f, x, y), float3{0,0,1});
 
             float3 Li = 0;
             for (size_t sample = 0; sample < numSamples; sample++) {
@@ -458,9 +474,10 @@ void CubemapIBL::roughnessFilter(
     // don't use the jobsystem unless we have enough work per scanline -- or the overhead of
     // launching jobs will prevail.
     if (dst.getDimensions() * maxNumSamples <= 256) {
-        CubemapUtils::processSingleThreaded<State>(dst, js, std::ref(scanline));
+        CubemapUtils::processSingleThreaded<CubemapUtils::EmptyState>(
+                dst, js, std::ref(scanline));
     } else {
-        CubemapUtils::process<State>(dst, js, std::ref(scanline));
+        CubemapUtils::process<CubemapUtils::EmptyState>(dst, js, std::ref(scanline));
     }
 }
 
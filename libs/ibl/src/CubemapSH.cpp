@@ -127,12 +127,20 @@ void CubemapSH::computeShBasis(
     }
 #endif
 
-    /*
-     * TODO: all the Legendre computation below is identical for all faces, so it
-     * might make sense to pre-compute it once. Also note that there is
-     * a fair amount of symmetry within a face (which we could take advantage of
-     * to reduce the pre-compute table).
-     */
+    if (numBands == 3) {
+        // This is by far the most common case, so we use the closed form of the recursion
+        // below, i.e. the Legendre terms are precomputed.
+        SHb[0] =  1.0f;                                 // (0, 0)
+        SHb[1] = -s.y;                                  // (-1, 1)
+        SHb[2] =  s.z;                                  // (0, 1)
+        SHb[3] = -s.x;                                  // (1, 1)
+        SHb[4] =  6.0f * s.x * s.y;                     // (-2, 2)
+        SHb[5] = -3.0f * s.y * s.z;                     // (-1, 2)
+        SHb[6] =  (3.0f * s.z * s.z - 1.0f) * 0.5f;     // (0, 2)
+        SHb[7] = -3.0f * s.x * s.z;                     // (1, 2)
+        SHb[8] =  3.0f * (s.x * s.x - s.y * s.y);       // (2, 2)
+        return;
+    }
 
     /*
      * Below, we compute the associated Legendre polynomials using recursion.
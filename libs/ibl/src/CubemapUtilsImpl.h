@@ -22,6 +22,10 @@
 #include <utils/compiler.h>
 #include <utils/JobSystem.h>
 
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+
 namespace filament {
 namespace ibl {
 
@@ -36,18 +40,29 @@ void CubemapUtils::process(
 
     const size_t dim = cm.getDimensions();
 
-    STATE states[6];
+    // A STATE can't be shared between jobs, so we can't use parallel_for() when we have one.
+    // Instead, each face is split in bands of scanlines that each get their own STATE, so that
+    // there is enough work for all threads (rather than just 6).
+    constexpr bool isStateLess = std::is_same<STATE, CubemapUtils::EmptyState>::value;
+    const size_t bandsPerFace = isStateLess ? 1 :
+            std::min(dim, std::max(size_t(1), (js.getThreadCount() * 4 + 5) / 6));
+    const size_t rowsPerBand = (dim + bandsPerFace - 1) / bandsPerFace;
+
+    std::vector<STATE> states(6 * bandsPerFace);
     for (STATE& s : states) {
         s = prototype;
     }
 
     JobSystem::Job* parent = js.createJob();
     for (size_t faceIndex = 0; faceIndex < 6; faceIndex++) {
-
-        auto perFaceJob = [faceIndex, &states, &cm, dim, &proc]
-                (utils::JobSystem& js, utils::JobSystem::Job* parent) {
-            STATE& s = states[faceIndex];
-            Image& image(cm.getImageForFace((Cubemap::Face)faceIndex));
+        Image& image(cm.getImageForFace((Cubemap::Face)faceIndex));
+        for (size_t band = 0; band < bandsPerFace; band++) {
+            const size_t y0 = band * rowsPerBand;
+            const size_t y1 = std::min(dim, y0 + rowsPerBand);
+            if (y0 >= y1) {
+                break;
+            }
+            STATE& s = states[faceIndex * bandsPerFace + band];
 
             // here we must limit how much we capture so we can use this closure
             // by value.
@@ -60,21 +75,21 @@ void CubemapUtils::process(
                 }
             };
 
-            constexpr bool isStateLess = std::is_same<STATE, CubemapUtils::EmptyState>::value;
             if (UTILS_LIKELY(isStateLess)) {
-                // create the job, copying it by value
-                auto job = jobs::parallel_for(js, parent, 0, uint32_t(dim),
-                        parallelJobTask, jobs::CountSplitter<64, 8>());
+                // create the job, copying it by value. Scanlines can be expensive (e.g. when
+                // importance sampling), so we keep the granularity fairly fine.
+                auto job = jobs::parallel_for(js, parent, uint32_t(y0), uint32_t(y1 - y0),
+                        parallelJobTask, jobs::CountSplitter<8, 8>());
                 // not need to signal here, since we're just scheduling work
                 js.run(job);
             } else {
-                // if we have a per-thread STATE, we can't parallel_for()
-                parallelJobTask(0, dim);
+                // not need to signal here, since we're just scheduling work
+                js.run(jobs::createJob(js, parent,
+                        [parallelJobTask, y0 = uint32_t(y0), c = uint32_t(y1 - y0)]() {
+                    parallelJobTask(y0, c);
+                }));
             }
-        };
-
-        // not need to signal here, since we're just scheduling work
-        js.run(jobs::createJob(js, parent, perFaceJob, std::ref(js), parent));
+        }
     }
 
     // wait for all our threads to finish
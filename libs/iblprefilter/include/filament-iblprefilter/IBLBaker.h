@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_IBL_PREFILTER_IBLBAKER_H
+#define TNT_IBL_PREFILTER_IBLBAKER_H
+
+#include <utils/compiler.h>
+
+#include <math/vec3.h>
+
+#include <memory>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace filament {
+class Engine;
+class Texture;
+} // namespace filament
+
+/**
+ * IBLBaker computes the irradiance spherical harmonics and the prefiltered reflections cubemap
+ * used by IndirectLight from an environment cubemap in main memory, on the CPU.
+ *
+ * Unlike the GPU filters of IBLPrefilterContext, IBLBaker doesn't need a render target and works
+ * with any backend, including headless ones. All the heavy work is performed by jobs running on
+ * the Engine's JobSystem and is split in small stages, so that update() never blocks the calling
+ * thread:
+ *
+ * - the first stage computes the irradiance and a low quality version of all reflection levels,
+ *   after which the IndirectLight can already be built;
+ * - each following stage refines one reflection level with the full sample count.
+ *
+ * Baking many probes at once is simply a matter of having one IBLBaker per probe and calling
+ * update() on all of them every frame.
+ *
+ * Usage Example:
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * #include <filament/Engine.h>
+ * using namespace filament;
+ *
+ * IBLBaker baker(*engine);
+ * baker.setEnvironment(256, faces);
+ *
+ * do {
+ *     if (baker.update() && !indirectLight) {
+ *         indirectLight = IndirectLight::Builder()
+ *             .reflections(baker.getReflections())
+ *             .irradiance(3, baker.getIrradiance())
+ *             .build(*engine);
+ *     }
+ *     ...
+ * } while (!quit);
+ *
+ * engine->destroy(indirectLight);
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ */
+class UTILS_PUBLIC IBLBaker {
+public:
+
+    struct Config {
+        //! Size of the reflections cubemap (a power of two), or 0 to only compute the irradiance.
+        uint16_t reflectionsSize = 64;
+        //! Number of samples used to filter the reflections once refined.
+        uint16_t sampleCount = 64;
+        //! Number of samples used for the first, low quality, version of the reflections.
+        uint16_t previewSampleCount = 4;
+        //! Mirror the environment horizontally, which is what IndirectLight expects.
+        bool mirror = true;
+    };
+
+    /**
+     * Creates an IBLBaker using the default Config.
+     * @param engine filament engine to use
+     */
+    explicit IBLBaker(filament::Engine& engine);
+
+    /**
+     * Creates an IBLBaker using the provided Config.
+     * @param engine filament engine to use
+     */
+    IBLBaker(filament::Engine& engine, Config const& config);
+
+    /**
+     * Waits for the pending job, if any, and destroys the reflections texture.
+     * IndirectLight objects using the reflections texture must be destroyed first.
+     */
+    ~IBLBaker() noexcept;
+
+    // not copyable nor movable, jobs in flight refer to this object
+    IBLBaker(IBLBaker const&) = delete;
+    IBLBaker& operator=(IBLBaker const&) = delete;
+
+    /**
+     * Starts baking a new environment. The baking of the previous environment, if any, is
+     * abandoned but the current irradiance and reflections stay valid until the new ones are
+     * ready. A stage in flight can't be interrupted, so this waits for it to finish.
+     *
+     * @param size  size in texels of a face of the cubemap, must be a power of two.
+     * @param faces six faces of size x size linear RGB texels, in the order +x, -x, +y, -y, +z, -z.
+     *              The data is copied and can be released as soon as this call returns.
+     */
+    void setEnvironment(uint32_t size, filament::math::float3 const* faces);
+
+    /**
+     * Collects the result of the pending stage, if it is finished, and starts the next one.
+     * This never waits for the JobSystem nor runs its jobs, and must be called from the Engine's
+     * thread, typically once per frame.
+     *
+     * @return true if the irradiance or the reflections have changed since the last call.
+     */
+    bool update();
+
+    /**
+     * Returns the progress of the current bake, between 0 and 1.
+     */
+    float getProgress() const noexcept;
+
+    /**
+     * Returns true once the reflections have been refined with the full sample count.
+     */
+    bool isDone() const noexcept;
+
+    /**
+     * Returns the 9 pre-scaled irradiance coefficients expected by
+     * IndirectLight::Builder::irradiance(3, ...), or nullptr if they're not computed yet.
+     */
+    filament::math::float3 const* getIrradiance() const noexcept;
+
+    /**
+     * Returns the reflections texture, or nullptr if it's not computed yet. The texture is owned
+     * by the IBLBaker, and its content is updated in place while the bake is refined.
+     */
+    filament::Texture* getReflections() const noexcept;
+
+private:
+    friend class IBLBakerTest;
+    struct Bake;
+    void run(Bake& bake) noexcept;
+    void upload(Bake& bake);
+
+    filament::Engine& mEngine;
+    Config const mConfig;
+    std::unique_ptr<Bake> mBake;
+    filament::Texture* mReflections = nullptr;
+    filament::math::float3 mIrradiance[9] = {};
+    bool mHasIrradiance = false;
+};
+
+#endif //TNT_IBL_PREFILTER_IBLBAKER_H
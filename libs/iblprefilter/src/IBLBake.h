@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_IBL_PREFILTER_IBLBAKE_H
+#define TNT_IBL_PREFILTER_IBLBAKE_H
+
+#include "filament-iblprefilter/IBLBaker.h"
+
+#include <ibl/Cubemap.h>
+#include <ibl/Image.h>
+
+#include <utils/JobSystem.h>
+
+#include <math/vec3.h>
+
+#include <atomic>
+#include <vector>
+
+#include <stdint.h>
+
+// Everything belonging to the bake of one environment. Only the job touches it while it runs,
+// only the engine thread touches it otherwise; `ready` is the hand-off between the two.
+struct IBLBaker::Bake {
+    // the source environment and its mip chain
+    std::vector<filament::ibl::Image> images;
+    std::vector<filament::ibl::Cubemap> levels;
+
+    // what the current stage produced, waiting to be uploaded
+    struct Output {
+        uint8_t level;
+        filament::ibl::Image image;
+        filament::ibl::Cubemap cubemap;
+    };
+    std::vector<Output> outputs;
+    filament::math::float3 irradiance[9] = {};
+
+    uint32_t stage = 0;
+    uint32_t stageCount = 0;
+    utils::JobSystem::Job* job = nullptr;
+    std::atomic<bool> ready = false;
+};
+
+#endif //TNT_IBL_PREFILTER_IBLBAKE_H
@@ -0,0 +1,259 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "filament-iblprefilter/IBLBaker.h"
+
+#include "IBLBake.h"
+
+#include <filament/Engine.h>
+#include <filament/Texture.h>
+
+#include <ibl/CubemapIBL.h>
+#include <ibl/CubemapSH.h>
+#include <ibl/CubemapUtils.h>
+
+#include <utils/algorithm.h>
+#include <utils/compiler.h>
+#include <utils/JobSystem.h>
+#include <utils/Panic.h>
+#include <utils/Systrace.h>
+
+#include <math/scalar.h>
+#include <math/vec3.h>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace filament::math;
+using namespace filament;
+using namespace utils;
+using namespace ibl;
+
+static float lodToPerceptualRoughness(float lod) noexcept {
+    // Inverse perceptualRoughness-to-LOD mapping:
+    // The LOD-to-perceptualRoughness mapping is a quadratic fit for
+    // log2(perceptualRoughness)+iblMaxMipLevel when iblMaxMipLevel is 4.
+    // This must match the mapping used by the shaders, see cmgen.
+    const float a = 2.0f;
+    const float b = -1.0f;
+    return (lod != 0)
+           ? saturate((std::sqrt(a * a + 4.0f * b * lod) - a) / (2.0f * b))
+           : 0.0f;
+}
+
+IBLBaker::IBLBaker(Engine& engine) : IBLBaker(engine, {}) {
+}
+
+IBLBaker::IBLBaker(Engine& engine, Config const& config)
+        : mEngine(engine), mConfig(config) {
+    FILAMENT_CHECK_PRECONDITION(!(config.reflectionsSize & (config.reflectionsSize - 1u)))
+            << "reflectionsSize must be a power-of-two";
+    FILAMENT_CHECK_PRECONDITION(config.sampleCount && config.previewSampleCount)
+            << "sampleCount and previewSampleCount can't be 0";
+}
+
+IBLBaker::~IBLBaker() noexcept {
+    if (mBake && mBake->job) {
+        mEngine.getJobSystem().waitAndRelease(mBake->job);
+    }
+    mEngine.destroy(mReflections);
+}
+
+void IBLBaker::setEnvironment(uint32_t size, float3 const* faces) {
+    FILAMENT_CHECK_PRECONDITION(size && !(size & (size - 1u)))
+            << "environment size must be a power-of-two";
+    FILAMENT_CHECK_PRECONDITION(faces) << "environment data is nullptr";
+
+    if (mBake && mBake->job) {
+        // the stage in flight can't be interrupted
+        mEngine.getJobSystem().waitAndRelease(mBake->job);
+    }
+
+    std::unique_ptr<Bake> bake = std::make_unique<Bake>();
+
+    Image temp;
+    Cubemap cm = CubemapUtils::create(temp, size);
+    for (size_t j = 0; j < 6; j++) {
+        Image const& image = cm.getImageForFace((Cubemap::Face)j);
+        float3 const* src = faces + j * size * size;
+        for (size_t y = 0; y < size; y++, src += size) {
+            memcpy(image.getPixelRef(0, y), src, size * sizeof(float3));
+        }
+    }
+    bake->images.push_back(std::move(temp));
+    bake->levels.push_back(std::move(cm));
+
+    // The first stage computes the irradiance and previews all levels, then each stage refines
+    // one level. Level 0 (zero roughness) doesn't depend on the sample count.
+    uint32_t const levelCount = mConfig.reflectionsSize ? ctz(mConfig.reflectionsSize) + 1u : 0u;
+    bool const refine = mConfig.sampleCount > mConfig.previewSampleCount;
+    bake->stageCount = 1u + (refine && levelCount > 1u ? levelCount - 1u : 0u);
+
+    mBake = std::move(bake);
+
+    Bake& b = *mBake;
+    JobSystem& js = mEngine.getJobSystem();
+    b.job = js.runAndRetain(jobs::createJob(js, nullptr, [this, &b]() { run(b); }));
+}
+
+void IBLBaker::run(Bake& bake) noexcept {
+    SYSTRACE_CALL();
+
+    JobSystem& js = mEngine.getJobSystem();
+    uint32_t const size = mConfig.reflectionsSize;
+    uint32_t const levelCount = size ? ctz(size) + 1u : 0u;
+    float3 const mirror = mConfig.mirror ? float3{ -1, 1, 1 } : float3{ 1, 1, 1 };
+
+    auto filter = [&](uint8_t level, size_t sampleCount) {
+        uint32_t const dim = size >> level;
+        float const lod = saturate(float(level) / float(std::max(1u, levelCount - 1u)));
+        float const perceptualRoughness = lodToPerceptualRoughness(lod);
+        float const linearRoughness = perceptualRoughness * perceptualRoughness;
+        Image image;
+        Cubemap dst = CubemapUtils::create(image, dim);
+        CubemapIBL::roughnessFilter(js, dst,
+                { bake.levels.data(), uint32_t(bake.levels.size()) },
+                linearRoughness, sampleCount, mirror, true);
+        bake.outputs.push_back({ level, std::move(image), std::move(dst) });
+    };
+
+    bake.outputs.clear();
+
+    if (bake.stage == 0) {
+        // make the environment seamless and generate its mip chain
+        bake.levels[0].makeSeamless();
+        size_t dim = bake.levels[0].getDimensions();
+        while (dim > 1) {
+            dim >>= 1u;
+            Image temp;
+            Cubemap dst = CubemapUtils::create(temp, dim);
+            CubemapUtils::downsampleCubemapLevelBoxFilter(js, dst, bake.levels.back());
+            dst.makeSeamless();
+            bake.images.push_back(std::move(temp));
+            bake.levels.push_back(std::move(dst));
+        }
+
+        // irradiance doesn't need a lot of resolution, 64x64 is plenty
+        size_t const shLevel = std::min(bake.levels.size() - 1,
+                size_t(std::max(0, int(ctz(uint32_t(bake.levels[0].getDimensions()))) - 6)));
+        std::unique_ptr<float3[]> sh = CubemapSH::computeSH(js, bake.levels[shLevel], 3, true);
+        CubemapSH::preprocessSHForShader(sh);
+        if (mConfig.mirror) {
+            // the basis functions which are odd in x change sign
+            sh[3] = -sh[3];
+            sh[4] = -sh[4];
+            sh[7] = -sh[7];
+        }
+        std::copy_n(sh.get(), 9, bake.irradiance);
+
+        for (uint32_t level = 0; level < levelCount; level++) {
+            filter(uint8_t(level), mConfig.previewSampleCount);
+        }
+    } else {
+        filter(uint8_t(bake.stage), mConfig.sampleCount);
+    }
+
+    // this must stay the last access to `bake` or `this`, see update()
+    bake.ready.store(true, std::memory_order_release);
+}
+
+void IBLBaker::upload(Bake& bake) {
+    if (bake.stage == 0) {
+        std::copy_n(bake.irradiance, 9, mIrradiance);
+        mHasIrradiance = true;
+    }
+
+    if (!bake.outputs.empty() && !mReflections) {
+        mReflections = Texture::Builder()
+                .sampler(Texture::Sampler::SAMPLER_CUBEMAP)
+                .format(Texture::InternalFormat::R11F_G11F_B10F)
+                .width(mConfig.reflectionsSize).height(mConfig.reflectionsSize)
+                .levels(ctz(mConfig.reflectionsSize) + 1u)
+                .build(mEngine);
+    }
+
+    for (auto const& output : bake.outputs) {
+        // pack the six faces, they're interleaved in the cross layout used by Cubemap
+        size_t const dim = output.cubemap.getDimensions();
+        size_t const faceSize = dim * dim * sizeof(float3);
+        uint8_t* const data = (uint8_t*)malloc(faceSize * 6);
+        for (size_t j = 0; j < 6; j++) {
+            Image const& image = output.cubemap.getImageForFace((Cubemap::Face)j);
+            for (size_t y = 0; y < dim; y++) {
+                memcpy(data + j * faceSize + y * dim * sizeof(float3),
+                        image.getPixelRef(0, y), dim * sizeof(float3));
+            }
+        }
+        mReflections->setImage(mEngine, output.level, 0, 0, 0, dim, dim, 6, {
+                data, faceSize * 6,
+                Texture::Format::RGB, Texture::Type::FLOAT,
+                [](void* buffer, size_t, void*) { free(buffer); }});
+    }
+    bake.outputs.clear();
+}
+
+bool IBLBaker::update() {
+    if (!mBake || !mBake->job || !mBake->ready.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    Bake& bake = *mBake;
+    JobSystem& js = mEngine.getJobSystem();
+
+    // Setting `ready` is the last thing the job does, so we just drop our reference to it, the
+    // JobSystem destroys it once it returns. waitAndRelease() would run other jobs on this thread
+    // while the job isn't completely finished.
+    js.release(bake.job);
+    bake.ready.store(false, std::memory_order_relaxed);
+
+    upload(bake);
+
+    if (++bake.stage < bake.stageCount) {
+        bake.job = js.runAndRetain(jobs::createJob(js, nullptr, [this, &bake]() { run(bake); }));
+    } else {
+        // we don't need the source environment anymore
+        bake.levels.clear();
+        bake.images.clear();
+    }
+    return true;
+}
+
+float IBLBaker::getProgress() const noexcept {
+    if (!mBake) {
+        return 0.0f;
+    }
+    return float(mBake->stage) / float(mBake->stageCount);
+}
+
+bool IBLBaker::isDone() const noexcept {
+    return mBake && mBake->stage == mBake->stageCount;
+}
+
+float3 const* IBLBaker::getIrradiance() const noexcept {
+    return mHasIrradiance ? mIrradiance : nullptr;
+}
+
+Texture* IBLBaker::getReflections() const noexcept {
+    return mReflections;
+}
@@ -0,0 +1,241 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <filament-iblprefilter/IBLBaker.h>
+
+#include "IBLBake.h"
+
+#include <filament/Engine.h>
+
+#include <ibl/Cubemap.h>
+#include <ibl/CubemapIBL.h>
+#include <ibl/CubemapUtils.h>
+#include <ibl/Image.h>
+
+#include <math/vec3.h>
+
+#include <utils/JobSystem.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include <stdint.h>
+
+using namespace filament;
+using namespace filament::math;
+using namespace filament::ibl;
+
+class IBLBakerTest : public testing::Test {
+protected:
+    void SetUp() override {
+        engine = Engine::create(Engine::Backend::NOOP);
+    }
+
+    void TearDown() override {
+        Engine::destroy(&engine);
+    }
+
+    struct Level {
+        uint32_t level;
+        uint32_t dim;
+        std::vector<float3> texels; // the six faces, in the order +x, -x, +y, -y, +z, -z
+    };
+
+    // Creates a cubemap whose texels are given by a function of their direction.
+    static std::vector<float3> environment(uint32_t size,
+            std::function<float3(float3 const&)> const& radiance) {
+        Image image;
+        Cubemap const cm = CubemapUtils::create(image, size);
+        std::vector<float3> faces;
+        for (size_t j = 0; j < 6; j++) {
+            for (size_t y = 0; y < size; y++) {
+                for (size_t x = 0; x < size; x++) {
+                    faces.push_back(radiance(cm.getDirectionFor((Cubemap::Face)j, x, y)));
+                }
+            }
+        }
+        return faces;
+    }
+
+    // Runs the bake to completion. The reflection levels produced by each stage are returned in
+    // order, they're captured before IBLBaker uploads them to its texture and discards them.
+    static std::vector<Level> bake(IBLBaker& baker) {
+        std::vector<Level> levels;
+        while (!baker.isDone()) {
+            IBLBaker::Bake const& bake = *baker.mBake;
+            while (!bake.ready.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            for (auto const& output : bake.outputs) {
+                uint32_t const dim = output.cubemap.getDimensions();
+                Level level{ output.level, dim };
+                for (size_t j = 0; j < 6; j++) {
+                    Image const& image = output.cubemap.getImageForFace((Cubemap::Face)j);
+                    for (size_t y = 0; y < dim; y++) {
+                        float3 const* row = (float3 const*)image.getPixelRef(0, y);
+                        level.texels.insert(level.texels.end(), row, row + dim);
+                    }
+                }
+                levels.push_back(std::move(level));
+            }
+            EXPECT_TRUE(baker.update());
+        }
+        return levels;
+    }
+
+    Engine* engine = nullptr;
+};
+
+static void expectNear(float3 const& a, float3 const& b, float tolerance) {
+    EXPECT_NEAR(a.r, b.r, tolerance);
+    EXPECT_NEAR(a.g, b.g, tolerance);
+    EXPECT_NEAR(a.b, b.b, tolerance);
+}
+
+TEST_F(IBLBakerTest, ConstantEnvironment) {
+    float3 const color{ 0.25f, 0.5f, 2.0f };
+    std::vector<float3> const faces = environment(32, [&](float3 const&) { return color; });
+
+    IBLBaker baker(*engine, { .reflectionsSize = 16, .sampleCount = 16, .previewSampleCount = 4 });
+    baker.setEnvironment(32, faces.data());
+    EXPECT_EQ(baker.getIrradiance(), nullptr);
+    EXPECT_EQ(baker.getReflections(), nullptr);
+
+    std::vector<Level> const levels = bake(baker);
+
+    // the first stage previews the 5 levels, then levels 1 to 4 are refined
+    ASSERT_EQ(levels.size(), 5 + 4);
+    for (uint32_t i = 0; i < 5; i++) {
+        EXPECT_EQ(levels[i].level, i);
+        EXPECT_EQ(levels[i].dim, 16u >> i);
+    }
+    for (uint32_t i = 5; i < levels.size(); i++) {
+        EXPECT_EQ(levels[i].level, i - 4);
+    }
+    EXPECT_TRUE(baker.isDone());
+    EXPECT_EQ(baker.getProgress(), 1.0f);
+    EXPECT_NE(baker.getReflections(), nullptr);
+
+    // a constant environment reflects the same constant at every roughness
+    for (Level const& level : levels) {
+        for (float3 const& texel : level.texels) {
+            expectNear(texel, color, 1e-3f);
+        }
+    }
+
+    // and the irradiance, which includes the lambertian BRDF, is that same constant everywhere
+    float3 const* sh = baker.getIrradiance();
+    ASSERT_NE(sh, nullptr);
+    expectNear(sh[0], color, 1e-3f);
+    for (size_t i = 1; i < 9; i++) {
+        expectNear(sh[i], float3{ 0 }, 1e-3f);
+    }
+
+    // nothing is left to do
+    EXPECT_FALSE(baker.update());
+}
+
+TEST_F(IBLBakerTest, MirroredEnvironment) {
+    // light coming mostly from one octant, so that all the SH coefficients are used
+    auto const radiance = [](float3 const& d) {
+        return float3{ 0.1f } + std::max(0.0f, d.x + 0.5f * d.y + 0.25f * d.z) * float3{ 1, 2, 3 };
+    };
+    auto const mirrored = [&](float3 const& d) { return radiance({ -d.x, d.y, d.z }); };
+
+    // Baking with the mirror option must be the same as baking the mirrored environment
+    // without it, which checks the signs of the mirrored irradiance coefficients.
+    // The environment has the size of the reflections, so that level 0 is a plain copy of it,
+    // the other levels go through the mip chain and filtering which don't commute exactly with
+    // the mirroring.
+    IBLBaker a(*engine, { .reflectionsSize = 8, .sampleCount = 16, .mirror = true });
+    a.setEnvironment(8, environment(8, radiance).data());
+    std::vector<Level> const levelsA = bake(a);
+
+    IBLBaker b(*engine, { .reflectionsSize = 8, .sampleCount = 16, .mirror = false });
+    b.setEnvironment(8, environment(8, mirrored).data());
+    std::vector<Level> const levelsB = bake(b);
+
+    for (size_t i = 0; i < 9; i++) {
+        expectNear(a.getIrradiance()[i], b.getIrradiance()[i], 1e-4f);
+    }
+
+    ASSERT_FALSE(levelsA.empty());
+    ASSERT_FALSE(levelsB.empty());
+    ASSERT_EQ(levelsA[0].level, 0);
+    ASSERT_EQ(levelsB[0].level, 0);
+    ASSERT_EQ(levelsA[0].texels.size(), levelsB[0].texels.size());
+    for (size_t i = 0; i < levelsA[0].texels.size(); i++) {
+        expectNear(levelsA[0].texels[i], levelsB[0].texels[i], 1e-5f);
+    }
+}
+
+TEST_F(IBLBakerTest, LevelRoughness) {
+    auto const radiance = [](float3 const& d) {
+        return float3{ 0.1f } + std::max(0.0f, d.x + 0.5f * d.y + 0.25f * d.z) * float3{ 1, 2, 3 };
+    };
+    std::vector<float3> const faces = environment(16, radiance);
+
+    IBLBaker baker(*engine, { .reflectionsSize = 16, .sampleCount = 16, .mirror = false });
+    baker.setEnvironment(16, faces.data());
+    std::vector<Level> const levels = bake(baker);
+
+    // the same mip chain as the one IBLBaker filters
+    utils::JobSystem& js = engine->getJobSystem();
+    std::vector<Image> images(1);
+    std::vector<Cubemap> chain;
+    chain.push_back(CubemapUtils::create(images[0], 16));
+    for (size_t j = 0; j < 6; j++) {
+        Image const& image = chain[0].getImageForFace((Cubemap::Face)j);
+        for (size_t y = 0; y < 16; y++) {
+            std::copy_n(faces.data() + (j * 16 + y) * 16, 16, (float3*)image.getPixelRef(0, y));
+        }
+    }
+    chain[0].makeSeamless();
+    for (size_t dim = 8; dim >= 1; dim >>= 1u) {
+        images.emplace_back();
+        Cubemap level = CubemapUtils::create(images.back(), dim);
+        CubemapUtils::downsampleCubemapLevelBoxFilter(js, level, chain.back());
+        level.makeSeamless();
+        chain.push_back(std::move(level));
+    }
+
+    // The refined levels must use the roughness the shaders expect for their LOD, which is
+    // perceptualRoughness = 1 - sqrt(1 - lod), the inverse of the quadratic fit used by cmgen.
+    ASSERT_EQ(levels.size(), 5 + 4);
+    for (size_t i = 5; i < levels.size(); i++) {
+        float const lod = float(levels[i].level) / 4.0f;
+        float const perceptualRoughness = 1.0f - std::sqrt(1.0f - lod);
+        Image image;
+        Cubemap expected = CubemapUtils::create(image, levels[i].dim);
+        CubemapIBL::roughnessFilter(js, expected, chain,
+                perceptualRoughness * perceptualRoughness, 16, float3{ 1 }, true);
+        for (size_t j = 0; j < 6; j++) {
+            Image const& face = expected.getImageForFace((Cubemap::Face)j);
+            for (size_t y = 0; y < levels[i].dim; y++) {
+                for (size_t x = 0; x < levels[i].dim; x++) {
+                    expectNear(levels[i].texels[(j * levels[i].dim + y) * levels[i].dim + x],
+                            *(float3 const*)face.getPixelRef(x, y), 1e-5f);
+                }
+            }
+        }
+    }
+}
@@ -21,6 +21,10 @@
 
 #include <utils/compiler.h>
 
+namespace utils {
+class JobSystem;
+} // namespace utils
+
 namespace image {
 
 /**
@@ -114,6 +118,21 @@ UTILS_PUBLIC
 LinearImage resampleImage(const LinearImage& source, uint32_t width, uint32_t height,
         Filter filter = Filter::DEFAULT);
 
+/**
+ * Variants of resampleImage that split the rows of each pass across jobs. The result is identical
+ * to the single-threaded version.
+ *
+ * These wait for the jobs with JobSystem::runAndWait(), so the calling thread must have been
+ * adopted by the JobSystem, see JobSystem::adopt().
+ */
+UTILS_PUBLIC
+LinearImage resampleImage(utils::JobSystem& js, const LinearImage& source,
+        uint32_t width, uint32_t height, const ImageSampler& sampler);
+
+UTILS_PUBLIC
+LinearImage resampleImage(utils::JobSystem& js, const LinearImage& source,
+        uint32_t width, uint32_t height, Filter filter = Filter::DEFAULT);
+
 /**
  * Computes a single sample for the given texture coordinate and writes the resulting color
  * components into the given output holder.
@@ -145,6 +164,14 @@ void computeSingleSample(const LinearImage& source, float x, float y, SingleSamp
 UTILS_PUBLIC
 void generateMipmaps(const LinearImage& source, Filter, LinearImage* result, uint32_t mipCount);
 
+/**
+ * Same as generateMipmaps, but resamples each level with the given JobSystem. The calling thread
+ * must have been adopted by the JobSystem.
+ */
+UTILS_PUBLIC
+void generateMipmaps(utils::JobSystem& js, const LinearImage& source, Filter,
+        LinearImage* result, uint32_t mipCount);
+
 /**
  * Returns the number of miplevels it would take to downsample the given image down to 1x1. This
  * number does not include the original image (i.e. mip 0).
@@ -21,13 +21,24 @@
 #include <math/vec3.h>
 #include <math/vec4.h>
 
+#include <utils/JobSystem.h>
 #include <utils/Panic.h>
 
+#include <algorithm>
+#include <limits>
 #include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define IMAGE_SAMPLER_USE_NEON 1
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define IMAGE_SAMPLER_USE_SSE2 1
+#endif
+
 using namespace image;
 
 namespace {
@@ -132,7 +143,7 @@ void generateMadProgram(uint32_t ntarget, uint32_t nsource, float left, float ri
     // the [0,1] domain. If this were a huge number, the filtered results would look the same, but
     // the filter would perform very poorly because it would be iterating over a lot more samples
     // than necessary.
-    const float filterBounds = domainScale * std::abs(filter.boundingRadius);
+    const float filterBounds = std::abs(filter.boundingRadius) / domainScale;
 
     // Iterate through target samples. "xtarget" points to the center of each target pixel.
     float xtarget = dtarget / 2.0f;
@@ -143,9 +154,19 @@ void generateMadProgram(uint32_t ntarget, uint32_t nsource, float left, float ri
         uint32_t count = 0;
         float sum = 0;
 
-        // Iterate through source samples that lie within the bounded region.
-        const auto isource_lower = int32_t((xtarget - filterBounds) * nsource);
-        const auto isource_upper = int32_t(std::ceil((xtarget + filterBounds) * nsource));
+        // Iterate through source samples that lie within the bounded region, which we map back
+        // to source indices. We keep one sample of margin on each side, the weights of the samples
+        // outside of the filter are zero anyway. The NEAREST filter has no margin, it only
+        // considers the two samples around the target.
+        const int32_t margin = filter.boundingRadius != 0 ? 1 : 0;
+        const float xsource_lower = (left + (xtarget - filterBounds) * (right - left)) * nsource;
+        const float xsource_upper = (left + (xtarget + filterBounds) * (right - left)) * nsource;
+        auto isource_lower = int32_t(std::floor(std::min(xsource_lower, xsource_upper))) - margin;
+        auto isource_upper = int32_t(std::ceil(std::max(xsource_lower, xsource_upper))) + margin;
+        if (filter.rejectExternalSamples) {
+            isource_lower = std::max(isource_lower, 0);
+            isource_upper = std::min(isource_upper, int32_t(nsource) - 1);
+        }
         for (int32_t isource = isource_lower; isource <= isource_upper; ++isource) {
             const float xsource = (((isource + 0.5f) / nsource) - left) / (right - left);
             const bool outside_image = isource < 0 || isource >= int32_t(nsource);
@@ -172,22 +193,90 @@ void generateMadProgram(uint32_t ntarget, uint32_t nsource, float left, float ri
     }
 }
 
-// Transforms a MAD program intended for single-channel data into a program intended for
-// multi-channel data.
-void expandMadProgram(uint32_t nchannels, MadProgram* program) {
-    if (nchannels == 1) {
-        return;
+// A MAD program compiled into runs of instructions that have the same target and consecutive
+// sources, i.e. each run is a dot product of its weights with a span of source samples. Executing
+// the runs in order performs exactly the same floating-point operations as the original program.
+struct MadRun {
+    uint32_t targetIndex;
+    int32_t sourceIndex;
+    uint32_t firstWeight;
+    uint32_t count;
+};
+
+struct CompiledMadProgram {
+    std::vector<MadRun> runs;
+    std::vector<float> weights;
+};
+
+void compileMadProgram(MadProgram const& program, CompiledMadProgram* result) {
+    result->runs.clear();
+    result->weights.clear();
+    result->weights.reserve(program.size());
+    for (auto const& mad : program) {
+        if (!result->runs.empty()) {
+            MadRun& run = result->runs.back();
+            if (run.targetIndex == mad.targetIndex &&
+                    run.sourceIndex + int32_t(run.count) == mad.sourceIndex) {
+                result->weights.push_back(mad.weight);
+                run.count++;
+                continue;
+            }
+        }
+        result->runs.push_back({ mad.targetIndex, mad.sourceIndex,
+                uint32_t(result->weights.size()), 1 });
+        result->weights.push_back(mad.weight);
     }
-    MadProgram result;
-    result.reserve(program->size() * nchannels);
-    for (auto mad : *program) {
-        mad.sourceIndex *= nchannels;
-        mad.targetIndex *= nchannels;
-        for (uint32_t j = 0; j < nchannels; ++j, ++mad.sourceIndex, ++mad.targetIndex) {
-            result.push_back(mad);
+}
+
+// Executes a compiled MAD program over a row of pixels. Channels are accumulated independently, in
+// the order of the original program. RGBA pixels are accumulated as a vector, other channel counts
+// are left as a runtime loop, which keeps the compiler from reassociating the sums with fast-math.
+void resampleRow(CompiledMadProgram const& program, float const* UTILS_RESTRICT source,
+        float* UTILS_RESTRICT target, uint32_t nchan) {
+    float const* const weights = program.weights.data();
+    for (MadRun const& run : program.runs) {
+        float const* s = source + int64_t(run.sourceIndex) * nchan;
+        float* t = target + size_t(run.targetIndex) * nchan;
+        float const* w = weights + run.firstWeight;
+#if defined(IMAGE_SAMPLER_USE_NEON)
+        if (nchan == 4) {
+            // the scalar code is contracted into fused multiply-adds on aarch64
+            float32x4_t acc = vld1q_f32(t);
+            for (uint32_t k = 0; k < run.count; ++k, s += 4) {
+                acc = vfmaq_n_f32(acc, vld1q_f32(s), w[k]);
+            }
+            vst1q_f32(t, acc);
+            continue;
+        }
+#elif defined(IMAGE_SAMPLER_USE_SSE2)
+        if (nchan == 4) {
+            __m128 acc = _mm_loadu_ps(t);
+            for (uint32_t k = 0; k < run.count; ++k, s += 4) {
+                acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(s), _mm_set1_ps(w[k])));
+            }
+            _mm_storeu_ps(t, acc);
+            continue;
+        }
+#endif
+        for (uint32_t k = 0; k < run.count; ++k, s += nchan) {
+            for (uint32_t c = 0; c < nchan; ++c) {
+                t[c] += s[c] * w[k];
+            }
+        }
+    }
+}
+
+void minimumRow(CompiledMadProgram const& program, float const* UTILS_RESTRICT source,
+        float* UTILS_RESTRICT target, uint32_t nchan) {
+    for (MadRun const& run : program.runs) {
+        float const* s = source + int64_t(run.sourceIndex) * nchan;
+        float* t = target + size_t(run.targetIndex) * nchan;
+        for (uint32_t k = 0; k < run.count; ++k, s += nchan) {
+            for (uint32_t c = 0; c < nchan; ++c) {
+                t[c] = std::min(s[c], t[c]);
+            }
         }
     }
-    program->swap(result);
 }
 
 FilterFunction createFilterFunction(Filter ftype) {
@@ -226,7 +315,21 @@ void normalize(LinearImage& image) {
     }
 }
 
-LinearImage resampleImage1D(const LinearImage& source, MadProgram* program,
+// Runs the given function over all rows, split across jobs if a JobSystem is given.
+template<typename F>
+void forEachRow(utils::JobSystem* js, uint32_t rows, F const& fn) {
+    if (!js || rows < 2) {
+        fn(0, rows);
+        return;
+    }
+    auto* job = utils::jobs::parallel_for(*js, nullptr, 0, rows,
+            [&fn](uint32_t start, uint32_t count) { fn(start, count); },
+            utils::jobs::CountSplitter<16>());
+    js->runAndWait(job);
+}
+
+LinearImage resampleImage1D(utils::JobSystem* js, const LinearImage& source,
+        MadProgram* program, CompiledMadProgram* compiled,
         uint32_t twidth, Filter filter, float left, float right, float filterRadiusMultiplier) {
     const uint32_t swidth = source.getWidth();
     const uint32_t sheight = source.getHeight();
@@ -235,41 +338,37 @@ LinearImage resampleImage1D(const LinearImage& source, MadProgram* program,
     if (filter == Filter::DEFAULT) filter = mag ? Filter::MITCHELL : Filter::LANCZOS;
     const FilterFunction hfn = createFilterFunction(filter);
 
-    // Generate a flat list of multiply-add (MAD) instructions.
+    // Generate a flat list of multiply-add (MAD) instructions, and group them into runs.
     program->clear();
     generateMadProgram(twidth, swidth, left, right, hfn, filterRadiusMultiplier, program);
-    expandMadProgram(nchan, program);
+    compileMadProgram(*program, compiled);
 
     // Allocate the target image.
     LinearImage result(twidth, sheight, nchan);
-    float const* sourceRow = source.getPixelRef();
-    float* targetRow = result.getPixelRef();
+    float const* const sourceData = source.getPixelRef();
+    float* const targetData = result.getPixelRef();
+    const size_t sourceStride = size_t(swidth) * nchan;
+    const size_t targetStride = size_t(twidth) * nchan;
 
     // The MIN filter is special because it starts with non-zero values and ignores filter weights.
     if (filter == Filter::MINIMUM) {
-        for (uint32_t n = 0; n < twidth * sheight * nchan; ++n) {
-            targetRow[n] = std::numeric_limits<float>::max();
-        }
-        for (uint32_t row = 0; row < sheight; ++row) {
-            for (auto mad : *program) {
-                const float a = sourceRow[mad.sourceIndex];
-                const float b = targetRow[mad.targetIndex];
-                targetRow[mad.targetIndex] = std::min(a, b);
+        std::fill_n(targetData, targetStride * sheight, std::numeric_limits<float>::max());
+        forEachRow(js, sheight, [&](uint32_t start, uint32_t count) {
+            for (uint32_t row = start; row < start + count; ++row) {
+                minimumRow(*compiled, sourceData + row * sourceStride,
+                        targetData + row * targetStride, nchan);
             }
-            targetRow += twidth * nchan;
-            sourceRow += swidth * nchan;
-        }
+        });
         return result;
     }
 
     // Resize the image horizontally by executing the MAD instructions over each row.
-    for (uint32_t row = 0; row < sheight; ++row) {
-        for (auto mad : *program) {
-            targetRow[mad.targetIndex] += sourceRow[mad.sourceIndex] * mad.weight;
+    forEachRow(js, sheight, [&](uint32_t start, uint32_t count) {
+        for (uint32_t row = start; row < start + count; ++row) {
+            resampleRow(*compiled, sourceData + row * sourceStride,
+                    targetData + row * targetStride, nchan);
         }
-        targetRow += twidth * nchan;
-        sourceRow += swidth * nchan;
-    }
+    });
 
     // Perform post processing for the current pass.
     if (filter == Filter::GAUSSIAN_NORMALS) {
@@ -278,16 +377,8 @@ LinearImage resampleImage1D(const LinearImage& source, MadProgram* program,
     return result;
 }
 
-} // anonymous namespace
-
-namespace image {
-
-SingleSample::~SingleSample() {
-    delete[] data;
-}
-
-LinearImage resampleImage(const LinearImage& source, uint32_t width, uint32_t height,
-        const ImageSampler& sampler) {
+LinearImage resampleImage2D(utils::JobSystem* js, const LinearImage& source,
+        uint32_t width, uint32_t height, const ImageSampler& sampler) {
     FILAMENT_CHECK_PRECONDITION(sampler.east.mode == Boundary::EXCLUDE &&
             sampler.north.mode == Boundary::EXCLUDE && sampler.west.mode == Boundary::EXCLUDE &&
             sampler.south.mode == Boundary::EXCLUDE)
@@ -300,12 +391,33 @@ LinearImage resampleImage(const LinearImage& source, uint32_t width, uint32_t he
     const float right = sampler.sourceRegion.right;
     const float bottom = sampler.sourceRegion.bottom;
     MadProgram program;
+    CompiledMadProgram compiled;
     LinearImage result;
-    result = transpose(resampleImage1D(source, &program, width, hfilter, left, right, radius));
-    result = transpose(resampleImage1D(result, &program, height, vfilter, top, bottom, radius));
+    result = transpose(resampleImage1D(js, source, &program, &compiled,
+            width, hfilter, left, right, radius));
+    result = transpose(resampleImage1D(js, result, &program, &compiled,
+            height, vfilter, top, bottom, radius));
     return result;
 }
 
+} // anonymous namespace
+
+namespace image {
+
+SingleSample::~SingleSample() {
+    delete[] data;
+}
+
+LinearImage resampleImage(const LinearImage& source, uint32_t width, uint32_t height,
+        const ImageSampler& sampler) {
+    return resampleImage2D(nullptr, source, width, height, sampler);
+}
+
+LinearImage resampleImage(utils::JobSystem& js, const LinearImage& source,
+        uint32_t width, uint32_t height, const ImageSampler& sampler) {
+    return resampleImage2D(&js, source, width, height, sampler);
+}
+
 LinearImage resampleImage(const LinearImage& source, uint32_t width, uint32_t height,
         Filter filter) {
     return resampleImage(source, width, height, ImageSampler {
@@ -314,6 +426,14 @@ LinearImage resampleImage(const LinearImage& source, uint32_t width, uint32_t he
     });
 }
 
+LinearImage resampleImage(utils::JobSystem& js, const LinearImage& source,
+        uint32_t width, uint32_t height, Filter filter) {
+    return resampleImage2D(&js, source, width, height, ImageSampler {
+        .horizontalFilter = filter,
+        .verticalFilter = filter
+    });
+}
+
 void computeSingleSample(const LinearImage& source, float x, float y, SingleSample* result,
         Filter filter) {
     const float radius = 1.0f;
@@ -322,8 +442,10 @@ void computeSingleSample(const LinearImage& source, float x, float y, SingleSamp
     const float right = x + radius / source.getWidth();
     const float bottom = y + radius / source.getHeight();
     MadProgram program;
-    LinearImage row = transpose(resampleImage1D(source, &program, 1, filter, left, right, radius));
-    row = resampleImage1D(row, &program, 1, filter, top, bottom, radius);
+    CompiledMadProgram compiled;
+    LinearImage row = transpose(resampleImage1D(nullptr, source, &program, &compiled,
+            1, filter, left, right, radius));
+    row = resampleImage1D(nullptr, row, &program, &compiled, 1, filter, top, bottom, radius);
     if (!result->data) {
         result->data = new float[source.getChannels()];
     }
@@ -348,6 +470,18 @@ void generateMipmaps(const LinearImage& source, Filter filter, LinearImage* resu
     }
 }
 
+void generateMipmaps(utils::JobSystem& js, const LinearImage& source, Filter filter,
+        LinearImage* result, uint32_t mips) {
+    mips = std::min(mips, getMipmapCount(source));
+    uint32_t width = source.getWidth();
+    uint32_t height = source.getHeight();
+    for (uint32_t n = 0; n < mips; ++n) {
+        width = std::max(width >> 1u, 1u);
+        height = std::max(height >> 1u, 1u);
+        result[n] = resampleImage(js, source, width, height, filter);
+    }
+}
+
 uint32_t getMipmapCount(const LinearImage& source) {
     uint32_t width = source.getWidth();
     uint32_t height = source.getHeight();
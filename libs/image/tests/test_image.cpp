@@ -26,6 +26,7 @@
 
 #include <gtest/gtest.h>
 
+#include <utils/JobSystem.h>
 #include <utils/Panic.h>
 #include <utils/Path.h>
 
@@ -37,6 +38,8 @@
 #include <sstream>
 #include <vector>
 
+#include <string.h>
+
 using std::istringstream;
 using std::string;
 using std::swap;
@@ -259,6 +262,44 @@ TEST_F(ImageTest, DepthFilters) { // NOLINT
     updateOrCompare(atlas, "depths.png");
 }
 
+TEST_F(ImageTest, ParallelFilters) { // NOLINT
+    utils::JobSystem js;
+    js.adopt();
+    auto normals = createNormalMap(256);
+    auto depths = createDepthMap(256);
+    auto colors = vectorsToColors(normals);
+    LinearImage rgba(colors.getWidth(), colors.getHeight(), 4);
+    for (uint32_t i = 0, n = colors.getWidth() * colors.getHeight(); i < n; i++) {
+        for (uint32_t c = 0; c < 3; c++) {
+            rgba.getPixelRef()[i * 4 + c] = colors.getPixelRef()[i * 3 + c];
+        }
+        rgba.getPixelRef()[i * 4 + 3] = depths.getPixelRef()[i];
+    }
+    auto isSame = [](const LinearImage& a, const LinearImage& b) {
+        return a.getWidth() == b.getWidth() && a.getHeight() == b.getHeight() &&
+                a.getChannels() == b.getChannels() &&
+                !memcmp(a.getPixelRef(), b.getPixelRef(),
+                        sizeof(float) * a.getWidth() * a.getHeight() * a.getChannels());
+    };
+    for (Filter filter : { Filter::BOX, Filter::NEAREST, Filter::GAUSSIAN_SCALARS,
+            Filter::MITCHELL, Filter::LANCZOS, Filter::MINIMUM }) {
+        for (const LinearImage* image : { &depths, &colors, &rgba }) {
+            EXPECT_TRUE(isSame(resampleImage(*image, 37, 100, filter),
+                    resampleImage(js, *image, 37, 100, filter)));
+            EXPECT_TRUE(isSame(resampleImage(*image, 512, 300, filter),
+                    resampleImage(js, *image, 512, 300, filter)));
+        }
+    }
+    LinearImage mips[8];
+    LinearImage parallelMips[8];
+    generateMipmaps(rgba, Filter::BOX, mips, 8);
+    generateMipmaps(js, rgba, Filter::BOX, parallelMips, 8);
+    for (int i = 0; i < 8; i++) {
+        EXPECT_TRUE(isSame(mips[i], parallelMips[i]));
+    }
+    js.emancipate();
+}
+
 TEST_F(ImageTest, ImageOps) { // NOLINT
     auto finalize = [] (LinearImage image) {
         return resampleImage(image, 100, 100, Filter::NEAREST);
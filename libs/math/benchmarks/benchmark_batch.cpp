@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "PerformanceCounters.h"
+
+#include <benchmark/benchmark.h>
+
+#include <math/batch.h>
+#include <math/mat3.h>
+#include <math/mat4.h>
+#include <math/quat.h>
+#include <math/vec3.h>
+
+#include <type_traits>
+#include <vector>
+
+using namespace filament::math;
+
+struct Scalar{};
+struct Batch{};
+
+struct Data {
+    static constexpr size_t COUNT = 1024;
+
+    std::vector<mat4f> a;
+    std::vector<mat4f> b;
+    std::vector<quatf> q;
+    std::vector<float3> center;
+    std::vector<float3> halfExtent;
+
+    Data() : a(COUNT), b(COUNT), q(COUNT), center(COUNT), halfExtent(COUNT) {
+        for (size_t i = 0; i < COUNT; i++) {
+            float const t = float(i) / COUNT;
+            a[i] = mat4f::translation(float3{ t, 2 * t, 3 * t }) *
+                   mat4f::rotation(t * 6.0f, float3{ 0, 1, 0 }) * mat4f::scaling(1.0f + t);
+            b[i] = mat4f::rotation(t * 3.0f, float3{ 1, 0, 0 });
+            q[i] = quatf::fromAxisAngle(normalize(float3{ 1, t, 0 }), t * 6.0f);
+            center[i] = float3{ t, -t, 0.5f };
+            halfExtent[i] = float3{ 1.0f, t, 2.0f };
+        }
+    }
+};
+
+template<typename F>
+static void run(benchmark::State& state, F f) noexcept {
+    PerformanceCounters pc(state);
+    for (auto _ : state) {
+        f();
+        benchmark::ClobberMemory();
+    }
+    pc.stop();
+    state.SetItemsProcessed(state.iterations() * Data::COUNT);
+}
+
+template<typename A>
+static void BM_multiply(benchmark::State& state) noexcept {
+    Data d;
+    std::vector<mat4f> out(Data::COUNT);
+    run(state, [&]() {
+        if constexpr (std::is_same_v<A, Batch>) {
+            batch::multiply(out.data(), d.a.data(), d.b.data(), Data::COUNT);
+        } else {
+            for (size_t i = 0; i < Data::COUNT; i++) {
+                out[i] = d.a[i] * d.b[i];
+            }
+        }
+        benchmark::DoNotOptimize(out);
+    });
+}
+
+template<typename A>
+static void BM_transformBoxes(benchmark::State& state) noexcept {
+    Data d;
+    std::vector<float3> c(Data::COUNT);
+    std::vector<float3> e(Data::COUNT);
+    run(state, [&]() {
+        if constexpr (std::is_same_v<A, Batch>) {
+            batch::transformBoxes(c.data(), e.data(), d.center.data(), d.halfExtent.data(),
+                    d.a.data(), Data::COUNT);
+        } else {
+            for (size_t i = 0; i < Data::COUNT; i++) {
+                mat3f const m = d.a[i].upperLeft();
+                c[i] = m * d.center[i] + d.a[i][3].xyz;
+                e[i] = abs(m) * d.halfExtent[i];
+            }
+        }
+        benchmark::DoNotOptimize(c);
+        benchmark::DoNotOptimize(e);
+    });
+}
+
+template<typename A>
+static void BM_rotationMatrices(benchmark::State& state) noexcept {
+    Data d;
+    std::vector<mat4f> out(Data::COUNT);
+    run(state, [&]() {
+        if constexpr (std::is_same_v<A, Batch>) {
+            batch::rotationMatrices(out.data(), d.q.data(), Data::COUNT);
+        } else {
+            for (size_t i = 0; i < Data::COUNT; i++) {
+                out[i] = mat4f(d.q[i]);
+            }
+        }
+        benchmark::DoNotOptimize(out);
+    });
+}
+
+template<typename A>
+static void BM_normalMatrices(benchmark::State& state) noexcept {
+    Data d;
+    std::vector<mat3f> out(Data::COUNT);
+    run(state, [&]() {
+        if constexpr (std::is_same_v<A, Batch>) {
+            batch::normalMatrices(out.data(), d.a.data(), Data::COUNT);
+        } else {
+            for (size_t i = 0; i < Data::COUNT; i++) {
+                out[i] = prescaleForNormals(mat3f::getTransformForNormals(d.a[i].upperLeft()));
+            }
+        }
+        benchmark::DoNotOptimize(out);
+    });
+}
+
+BENCHMARK_TEMPLATE(BM_multiply, Scalar);
+BENCHMARK_TEMPLATE(BM_multiply, Batch);
+
+BENCHMARK_TEMPLATE(BM_transformBoxes, Scalar);
+BENCHMARK_TEMPLATE(BM_transformBoxes, Batch);
+
+BENCHMARK_TEMPLATE(BM_rotationMatrices, Scalar);
+BENCHMARK_TEMPLATE(BM_rotationMatrices, Batch);
+
+BENCHMARK_TEMPLATE(BM_normalMatrices, Scalar);
+BENCHMARK_TEMPLATE(BM_normalMatrices, Batch);
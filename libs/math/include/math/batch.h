@@ -0,0 +1,419 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_MATH_BATCH_H
+#define TNT_MATH_BATCH_H
+
+#include <math/compiler.h>
+#include <math/mat3.h>
+#include <math/mat4.h>
+#include <math/quat.h>
+#include <math/vec3.h>
+#include <math/vec4.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <stddef.h>
+
+#if defined(__ARM_NEON)
+#   include <arm_neon.h>
+#   define MATH_BATCH_USE_NEON 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   include <immintrin.h>
+#   define MATH_BATCH_USE_SSE 1
+#   if defined(__AVX__)
+#       define MATH_BATCH_USE_AVX 1
+#   endif
+#endif
+
+/*
+ * Operations on arrays of vectors, matrices and quaternions, for the loops that transform many
+ * objects at once. They produce the same results as the equivalent scalar loops (up to rounding),
+ * but use explicit SIMD code: NEON on ARM, SSE2 on x86, AVX when the compiler targets it, and FMA
+ * when available. Like the rest of libs/math, the code path is selected at compile time.
+ *
+ * Unless noted otherwise, the output arrays can be the same as the input arrays, but they must not
+ * partially overlap.
+ */
+
+namespace filament::math::batch {
+
+namespace details {
+
+#if defined(MATH_BATCH_USE_NEON)
+
+using f32x4 = float32x4_t;
+
+inline f32x4 load(float const* p) noexcept { return vld1q_f32(p); }
+inline void store(float* p, f32x4 v) noexcept { vst1q_f32(p, v); }
+inline f32x4 splat(float s) noexcept { return vdupq_n_f32(s); }
+inline f32x4 add(f32x4 a, f32x4 b) noexcept { return vaddq_f32(a, b); }
+inline f32x4 sub(f32x4 a, f32x4 b) noexcept { return vsubq_f32(a, b); }
+inline f32x4 mul(f32x4 a, f32x4 b) noexcept { return vmulq_f32(a, b); }
+inline f32x4 maximum(f32x4 a, f32x4 b) noexcept { return vmaxq_f32(a, b); }
+inline f32x4 absolute(f32x4 v) noexcept { return vabsq_f32(v); }
+
+// a / b
+inline f32x4 divide(f32x4 a, f32x4 b) noexcept {
+#if defined(__aarch64__)
+    return vdivq_f32(a, b);
+#else
+    // refine the reciprocal estimate twice to get full precision, like rsqrt() below.
+    f32x4 y = vrecpeq_f32(b);
+    y = vmulq_f32(y, vrecpsq_f32(b, y));
+    y = vmulq_f32(y, vrecpsq_f32(b, y));
+    return vmulq_f32(a, y);
+#endif
+}
+
+// a * b + c
+inline f32x4 madd(f32x4 a, f32x4 b, f32x4 c) noexcept {
+#if defined(__aarch64__)
+    return vfmaq_f32(c, a, b);
+#else
+    return vmlaq_f32(c, a, b);
+#endif
+}
+
+// 1 / sqrt(v)
+inline f32x4 rsqrt(f32x4 v) noexcept {
+#if defined(__aarch64__)
+    return vdivq_f32(vdupq_n_f32(1.0f), vsqrtq_f32(v));
+#else
+    // ARMv7 has no division nor square root, refine the estimate twice to get full precision.
+    f32x4 y = vrsqrteq_f32(v);
+    y = vmulq_f32(y, vrsqrtsq_f32(vmulq_f32(v, y), y));
+    y = vmulq_f32(y, vrsqrtsq_f32(vmulq_f32(v, y), y));
+    return y;
+#endif
+}
+
+inline void transpose(f32x4& a, f32x4& b, f32x4& c, f32x4& d) noexcept {
+    float32x4x2_t const ab = vtrnq_f32(a, b);
+    float32x4x2_t const cd = vtrnq_f32(c, d);
+    a = vcombine_f32(vget_low_f32(ab.val[0]), vget_low_f32(cd.val[0]));
+    b = vcombine_f32(vget_low_f32(ab.val[1]), vget_low_f32(cd.val[1]));
+    c = vcombine_f32(vget_high_f32(ab.val[0]), vget_high_f32(cd.val[0]));
+    d = vcombine_f32(vget_high_f32(ab.val[1]), vget_high_f32(cd.val[1]));
+}
+
+#elif defined(MATH_BATCH_USE_SSE)
+
+using f32x4 = __m128;
+
+inline f32x4 load(float const* p) noexcept { return _mm_loadu_ps(p); }
+inline void store(float* p, f32x4 v) noexcept { _mm_storeu_ps(p, v); }
+inline f32x4 splat(float s) noexcept { return _mm_set1_ps(s); }
+inline f32x4 add(f32x4 a, f32x4 b) noexcept { return _mm_add_ps(a, b); }
+inline f32x4 sub(f32x4 a, f32x4 b) noexcept { return _mm_sub_ps(a, b); }
+inline f32x4 mul(f32x4 a, f32x4 b) noexcept { return _mm_mul_ps(a, b); }
+inline f32x4 maximum(f32x4 a, f32x4 b) noexcept { return _mm_max_ps(a, b); }
+inline f32x4 absolute(f32x4 v) noexcept { return _mm_andnot_ps(_mm_set1_ps(-0.0f), v); }
+inline f32x4 divide(f32x4 a, f32x4 b) noexcept { return _mm_div_ps(a, b); }
+
+// a * b + c
+inline f32x4 madd(f32x4 a, f32x4 b, f32x4 c) noexcept {
+#if defined(__FMA__)
+    return _mm_fmadd_ps(a, b, c);
+#else
+    return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+}
+
+// 1 / sqrt(v)
+inline f32x4 rsqrt(f32x4 v) noexcept {
+    return _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(v));
+}
+
+inline void transpose(f32x4& a, f32x4& b, f32x4& c, f32x4& d) noexcept {
+    _MM_TRANSPOSE4_PS(a, b, c, d);
+}
+
+#else
+
+using f32x4 = float4;
+
+inline f32x4 load(float const* p) noexcept { return { p[0], p[1], p[2], p[3] }; }
+inline void store(float* p, f32x4 v) noexcept { p[0] = v.x; p[1] = v.y; p[2] = v.z; p[3] = v.w; }
+inline f32x4 splat(float s) noexcept { return f32x4(s); }
+inline f32x4 add(f32x4 a, f32x4 b) noexcept { return a + b; }
+inline f32x4 sub(f32x4 a, f32x4 b) noexcept { return a - b; }
+inline f32x4 mul(f32x4 a, f32x4 b) noexcept { return a * b; }
+inline f32x4 maximum(f32x4 a, f32x4 b) noexcept {
+    return { std::max(a.x, b.x), std::max(a.y, b.y), std::max(a.z, b.z), std::max(a.w, b.w) };
+}
+inline f32x4 absolute(f32x4 v) noexcept {
+    return { std::abs(v.x), std::abs(v.y), std::abs(v.z), std::abs(v.w) };
+}
+inline f32x4 divide(f32x4 a, f32x4 b) noexcept { return a / b; }
+inline f32x4 madd(f32x4 a, f32x4 b, f32x4 c) noexcept { return a * b + c; }
+inline f32x4 rsqrt(f32x4 v) noexcept { return 1.0f / sqrt(v); }
+
+inline void transpose(f32x4& a, f32x4& b, f32x4& c, f32x4& d) noexcept {
+    f32x4 const ta{ a.x, b.x, c.x, d.x };
+    f32x4 const tb{ a.y, b.y, c.y, d.y };
+    f32x4 const tc{ a.z, b.z, c.z, d.z };
+    f32x4 const td{ a.w, b.w, c.w, d.w };
+    a = ta; b = tb; c = tc; d = td;
+}
+
+#endif
+
+inline void store3(float3& out, f32x4 v) noexcept {
+    float t[4];
+    store(t, v);
+    out = { t[0], t[1], t[2] };
+}
+
+// out = a * b, for column-major 4x4 matrices; out can be a or b.
+inline void multiply(float* out, float const* a, float const* b) noexcept {
+#if defined(MATH_BATCH_USE_AVX)
+    // two columns at a time, with each column of a duplicated in both halves
+    __m256 const a0 = _mm256_broadcast_ps((__m128 const*) (a + 0));
+    __m256 const a1 = _mm256_broadcast_ps((__m128 const*) (a + 4));
+    __m256 const a2 = _mm256_broadcast_ps((__m128 const*) (a + 8));
+    __m256 const a3 = _mm256_broadcast_ps((__m128 const*) (a + 12));
+    for (size_t c = 0; c < 16; c += 8) {
+        __m256 const bc = _mm256_loadu_ps(b + c);
+#if defined(__FMA__)
+        __m256 r = _mm256_mul_ps(a0, _mm256_permute_ps(bc, 0x00));
+        r = _mm256_fmadd_ps(a1, _mm256_permute_ps(bc, 0x55), r);
+        r = _mm256_fmadd_ps(a2, _mm256_permute_ps(bc, 0xAA), r);
+        r = _mm256_fmadd_ps(a3, _mm256_permute_ps(bc, 0xFF), r);
+#else
+        __m256 r = _mm256_add_ps(
+                _mm256_add_ps(
+                        _mm256_mul_ps(a0, _mm256_permute_ps(bc, 0x00)),
+                        _mm256_mul_ps(a1, _mm256_permute_ps(bc, 0x55))),
+                _mm256_add_ps(
+                        _mm256_mul_ps(a2, _mm256_permute_ps(bc, 0xAA)),
+                        _mm256_mul_ps(a3, _mm256_permute_ps(bc, 0xFF))));
+#endif
+        _mm256_storeu_ps(out + c, r);
+    }
+#else
+    f32x4 const a0 = load(a + 0);
+    f32x4 const a1 = load(a + 4);
+    f32x4 const a2 = load(a + 8);
+    f32x4 const a3 = load(a + 12);
+    for (size_t c = 0; c < 16; c += 4) {
+        f32x4 r = mul(a0, splat(b[c + 0]));
+        r = madd(a1, splat(b[c + 1]), r);
+        r = madd(a2, splat(b[c + 2]), r);
+        r = madd(a3, splat(b[c + 3]), r);
+        store(out + c, r);
+    }
+#endif
+}
+
+// Cofactors of the upper-left 3x3 of four matrices, in SoA form: m[col][row] holds the element
+// (col, row) of each of the four matrices.
+inline void cofactors(f32x4 const (&m)[3][3], f32x4 (&c)[3][3]) noexcept {
+    // c[0] = cross(m[1], m[2]), c[1] = cross(m[2], m[0]), c[2] = cross(m[0], m[1])
+    for (size_t k = 0; k < 3; k++) {
+        f32x4 const* u = m[(k + 1) % 3];
+        f32x4 const* v = m[(k + 2) % 3];
+        c[k][0] = sub(mul(u[1], v[2]), mul(u[2], v[1]));
+        c[k][1] = sub(mul(u[2], v[0]), mul(u[0], v[2]));
+        c[k][2] = sub(mul(u[0], v[1]), mul(u[1], v[0]));
+    }
+}
+
+// Loads the upper-left 3x3 of four consecutive matrices in SoA form.
+inline void loadUpperLeft(mat4f const* in, f32x4 (&m)[3][3]) noexcept {
+    for (size_t k = 0; k < 3; k++) {
+        f32x4 x = load(&in[0][k][0]);
+        f32x4 y = load(&in[1][k][0]);
+        f32x4 z = load(&in[2][k][0]);
+        f32x4 w = load(&in[3][k][0]);
+        transpose(x, y, z, w);
+        m[k][0] = x;
+        m[k][1] = y;
+        m[k][2] = z;
+    }
+}
+
+// Stores four 3x3 matrices given in SoA form to consecutive mat3f.
+inline void store(mat3f* out, f32x4 const (&m)[3][3]) noexcept {
+    for (size_t k = 0; k < 3; k++) {
+        f32x4 a = m[k][0];
+        f32x4 b = m[k][1];
+        f32x4 c = m[k][2];
+        f32x4 d = splat(0.0f);
+        transpose(a, b, c, d);
+        store3(out[0][k], a);
+        store3(out[1][k], b);
+        store3(out[2][k], c);
+        store3(out[3][k], d);
+    }
+}
+
+} // namespace details
+
+/**
+ * out[i] = a[i] * b[i]
+ */
+inline void multiply(mat4f* out, mat4f const* a, mat4f const* b, size_t count) noexcept {
+    for (size_t i = 0; i < count; i++) {
+        details::multiply(&out[i][0][0], &a[i][0][0], &b[i][0][0]);
+    }
+}
+
+/**
+ * out[i] = a * b[i], typically to bring many local transforms into the space of their parent.
+ */
+inline void multiply(mat4f* out, mat4f const& a, mat4f const* b, size_t count) noexcept {
+    for (size_t i = 0; i < count; i++) {
+        details::multiply(&out[i][0][0], &a[0][0], &b[i][0][0]);
+    }
+}
+
+/**
+ * Transforms boxes given by their center and half-extent, as Box::transform() does:
+ *
+ *     outCenter[i]     = transforms[i] * center[i]
+ *     outHalfExtent[i] = abs(transforms[i].upperLeft()) * halfExtent[i]
+ *
+ * The w row of the transforms is ignored.
+ */
+inline void transformBoxes(float3* outCenter, float3* outHalfExtent,
+        float3 const* center, float3 const* halfExtent, mat4f const* transforms,
+        size_t count) noexcept {
+    using namespace details;
+    for (size_t i = 0; i < count; i++) {
+        float const* m = &transforms[i][0][0];
+        f32x4 const m0 = load(m + 0);
+        f32x4 const m1 = load(m + 4);
+        f32x4 const m2 = load(m + 8);
+        f32x4 const m3 = load(m + 12);
+        float3 const c = center[i];
+        float3 const e = halfExtent[i];
+        f32x4 const wc = madd(m2, splat(c.z), madd(m1, splat(c.y), madd(m0, splat(c.x), m3)));
+        f32x4 const we = madd(absolute(m2), splat(e.z),
+                madd(absolute(m1), splat(e.y), mul(absolute(m0), splat(e.x))));
+        store3(outCenter[i], wc);
+        store3(outHalfExtent[i], we);
+    }
+}
+
+/**
+ * out[i] = mat4f(q[i]), the rotation matrices of the quaternions. Like mat4f(q), the quaternions
+ * don't need to be normalized.
+ */
+inline void rotationMatrices(mat4f* out, quatf const* q, size_t count) noexcept {
+    using namespace details;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        // four quaternions at a time in SoA form
+        f32x4 x = load(&q[i + 0].x);
+        f32x4 y = load(&q[i + 1].x);
+        f32x4 z = load(&q[i + 2].x);
+        f32x4 w = load(&q[i + 3].x);
+        transpose(x, y, z, w);
+
+        // s = 2 / |q|^2 normalizes the quaternions. The null quaternion yields the identity,
+        // as with mat4f(q), because its products below are all zero whatever s is.
+        f32x4 const one = splat(1.0f);
+        f32x4 const n = madd(w, w, madd(z, z, madd(y, y, mul(x, x))));
+        f32x4 const s = divide(splat(2.0f), maximum(n, splat(std::numeric_limits<float>::min())));
+        f32x4 const x2 = mul(x, s);
+        f32x4 const y2 = mul(y, s);
+        f32x4 const z2 = mul(z, s);
+        f32x4 const xx = mul(x, x2);
+        f32x4 const yy = mul(y, y2);
+        f32x4 const zz = mul(z, z2);
+        f32x4 const xy = mul(x, y2);
+        f32x4 const xz = mul(x, z2);
+        f32x4 const yz = mul(y, z2);
+        f32x4 const wx = mul(w, x2);
+        f32x4 const wy = mul(w, y2);
+        f32x4 const wz = mul(w, z2);
+
+        f32x4 const zero = splat(0.0f);
+        f32x4 cols[3][4] = {
+                { sub(one, add(yy, zz)), add(xy, wz), sub(xz, wy), zero },
+                { sub(xy, wz), sub(one, add(xx, zz)), add(yz, wx), zero },
+                { add(xz, wy), sub(yz, wx), sub(one, add(xx, yy)), zero },
+        };
+        for (size_t k = 0; k < 3; k++) {
+            transpose(cols[k][0], cols[k][1], cols[k][2], cols[k][3]);
+            for (size_t j = 0; j < 4; j++) {
+                store(&out[i + j][k][0], cols[k][j]);
+            }
+        }
+        for (size_t j = 0; j < 4; j++) {
+            out[i + j][3] = float4{ 0.0f, 0.0f, 0.0f, 1.0f };
+        }
+    }
+    for (; i < count; i++) {
+        out[i] = mat4f(q[i]);
+    }
+}
+
+/**
+ * out[i] = cof(transforms[i].upperLeft()), which is what transforms normals up to a scale factor,
+ * see mat3f::getTransformForNormals().
+ */
+inline void cofactors(mat3f* out, mat4f const* transforms, size_t count) noexcept {
+    using namespace details;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        f32x4 m[3][3];
+        f32x4 c[3][3];
+        loadUpperLeft(transforms + i, m);
+        details::cofactors(m, c);
+        store(out + i, c);
+    }
+    for (; i < count; i++) {
+        out[i] = cof(transforms[i].upperLeft());
+    }
+}
+
+/**
+ * out[i] = prescaleForNormals(mat3f::getTransformForNormals(transforms[i].upperLeft())), the
+ * matrices used to transform normals in the shaders.
+ */
+inline void normalMatrices(mat3f* out, mat4f const* transforms, size_t count) noexcept {
+    using namespace details;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        f32x4 m[3][3];
+        f32x4 c[3][3];
+        loadUpperLeft(transforms + i, m);
+        details::cofactors(m, c);
+        f32x4 l = splat(0.0f);
+        for (size_t k = 0; k < 3; k++) {
+            f32x4 const l2 = madd(c[k][2], c[k][2], madd(c[k][1], c[k][1], mul(c[k][0], c[k][0])));
+            l = maximum(l, l2);
+        }
+        f32x4 const s = rsqrt(l);
+        for (size_t k = 0; k < 3; k++) {
+            c[k][0] = mul(c[k][0], s);
+            c[k][1] = mul(c[k][1], s);
+            c[k][2] = mul(c[k][2], s);
+        }
+        store(out + i, c);
+    }
+    for (; i < count; i++) {
+        out[i] = prescaleForNormals(mat3f::getTransformForNormals(transforms[i].upperLeft()));
+    }
+}
+
+} // namespace filament::math::batch
+
+#endif // TNT_MATH_BATCH_H
@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <math/batch.h>
+#include <math/mat3.h>
+#include <math/mat4.h>
+#include <math/quat.h>
+#include <math/vec3.h>
+
+#include <random>
+#include <vector>
+
+using namespace filament::math;
+
+class BatchTest : public testing::Test {
+protected:
+    // not a multiple of 4, so that the remainder of the SIMD loops is tested too
+    static constexpr size_t COUNT = 11;
+
+    void SetUp() override {
+        std::default_random_engine gen(42);
+        std::uniform_real_distribution<float> dist(-2.0f, 2.0f);
+        for (size_t i = 0; i < COUNT; i++) {
+            mat4f m;
+            for (size_t c = 0; c < 4; c++) {
+                m[c] = float4{ dist(gen), dist(gen), dist(gen), c == 3 ? 1.0f : 0.0f };
+            }
+            a.push_back(m);
+            for (size_t c = 0; c < 4; c++) {
+                m[c] = float4{ dist(gen), dist(gen), dist(gen), c == 3 ? 1.0f : 0.0f };
+            }
+            b.push_back(m);
+            q.push_back(normalize(quatf{ dist(gen), dist(gen), dist(gen), dist(gen) }));
+            center.push_back({ dist(gen), dist(gen), dist(gen) });
+            halfExtent.push_back(abs(float3{ dist(gen), dist(gen), dist(gen) }));
+        }
+    }
+
+    std::vector<mat4f> a;
+    std::vector<mat4f> b;
+    std::vector<quatf> q;
+    std::vector<float3> center;
+    std::vector<float3> halfExtent;
+};
+
+#define EXPECT_VEC_NEAR(VEC1, VEC2, eps)                   \
+do {                                                       \
+    const decltype(VEC1) v1 = VEC1;                        \
+    const decltype(VEC2) v2 = VEC2;                        \
+    for (size_t k = 0; k < v1.SIZE; k++) {                 \
+        EXPECT_NEAR(v1[k], v2[k], eps);                    \
+    }                                                      \
+} while(0)
+
+#define EXPECT_MAT_NEAR(MAT1, MAT2, eps)                   \
+do {                                                       \
+    const decltype(MAT1) m1 = MAT1;                        \
+    const decltype(MAT2) m2 = MAT2;                        \
+    for (size_t c = 0; c < m1.NUM_COLS; c++) {             \
+        EXPECT_VEC_NEAR(m1[c], m2[c], eps);                \
+    }                                                      \
+} while(0)
+
+TEST_F(BatchTest, Multiply) {
+    std::vector<mat4f> out(COUNT);
+    batch::multiply(out.data(), a.data(), b.data(), COUNT);
+    for (size_t i = 0; i < COUNT; i++) {
+        EXPECT_MAT_NEAR(out[i], a[i] * b[i], 1e-5f);
+    }
+
+    // in place, with a single left-hand side
+    out = b;
+    batch::multiply(out.data(), a[0], out.data(), COUNT);
+    for (size_t i = 0; i < COUNT; i++) {
+        EXPECT_MAT_NEAR(out[i], a[0] * b[i], 1e-5f);
+    }
+}
+
+TEST_F(BatchTest, TransformBoxes) {
+    std::vector<float3> c = center;
+    std::vector<float3> e = halfExtent;
+    // in place
+    batch::transformBoxes(c.data(), e.data(), c.data(), e.data(), a.data(), COUNT);
+    for (size_t i = 0; i < COUNT; i++) {
+        mat3f const m = a[i].upperLeft();
+        EXPECT_VEC_NEAR(c[i], m * center[i] + a[i][3].xyz, 1e-5f);
+        EXPECT_VEC_NEAR(e[i], abs(m) * halfExtent[i], 1e-5f);
+    }
+}
+
+TEST_F(BatchTest, RotationMatrices) {
+    std::vector<mat4f> out(COUNT);
+    batch::rotationMatrices(out.data(), q.data(), COUNT);
+    for (size_t i = 0; i < COUNT; i++) {
+        EXPECT_MAT_NEAR(out[i], mat4f(q[i]), 1e-6f);
+    }
+}
+
+TEST_F(BatchTest, RotationMatricesNotNormalized) {
+    // the result must not depend on whether a quaternion is processed in a group of 4 or not
+    std::vector<quatf> scaled(COUNT);
+    for (size_t i = 0; i < COUNT; i++) {
+        scaled[i] = q[i] * float(i + 1) * 0.5f;
+    }
+    scaled[1] = quatf{ 0, 0, 0, 0 };
+    scaled[COUNT - 1] = quatf{ 0, 0, 0, 0 };
+    std::vector<mat4f> out(COUNT);
+    batch::rotationMatrices(out.data(), scaled.data(), COUNT);
+    for (size_t i = 0; i < COUNT; i++) {
+        EXPECT_MAT_NEAR(out[i], mat4f(scaled[i]), 1e-6f);
+    }
+    EXPECT_MAT_NEAR(out[1], mat4f{}, 0.0f);
+    EXPECT_MAT_NEAR(out[COUNT - 1], mat4f{}, 0.0f);
+}
+
+TEST_F(BatchTest, Cofactors) {
+    std::vector<mat3f> out(COUNT);
+    batch::cofactors(out.data(), a.data(), COUNT);
+    for (size_t i = 0; i < COUNT; i++) {
+        EXPECT_MAT_NEAR(out[i], cof(a[i].upperLeft()), 1e-5f);
+    }
+}
+
+TEST_F(BatchTest, NormalMatrices) {
+    std::vector<mat3f> out(COUNT);
+    batch::normalMatrices(out.data(), a.data(), COUNT);
+    for (size_t i = 0; i < COUNT; i++) {
+        mat3f const n = prescaleForNormals(mat3f::getTransformForNormals(a[i].upperLeft()));
+        EXPECT_MAT_NEAR(out[i], n, 1e-5f);
+    }
+}
@@ -17,6 +17,7 @@
 #ifndef UBERZ_READABLE_ARCHIVE_H
 #define UBERZ_READABLE_ARCHIVE_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 #include <uberz/ArchiveEnums.h>
@@ -28,8 +29,24 @@ namespace filament::uberz {
 // ArchiveSpec is a parse-free binary format. The client simply casts a word-aligned content blob
 // into a ReadableArchive struct pointer, then calls the following function to convert all the
 // offset fields into pointers.
+// In seekable archives, the packages are not part of the blob, so their offsets are left as-is.
 void convertOffsetsToPointers(struct ReadableArchive* archive);
 
+// Decompresses the archive metadata of an uberz file into a word-aligned buffer that must be freed
+// with utils::aligned_free(), and converts its offsets into pointers. If the archive is seekable,
+// only the first zstd frame is decompressed and the byte offset of the first package frame is
+// returned in packagesOffset, otherwise the whole file is decompressed and packagesOffset is set
+// to the file size. Returns nullptr if the data is not a valid archive.
+struct ReadableArchive* readArchive(const void* data, size_t size, size_t* packagesOffset);
+
+// Returns the feature index of a seekable archive, or nullptr for archives that predate it.
+struct ArchiveIndex* getArchiveIndex(struct ReadableArchive* archive);
+
+// Decompresses the filamat package of a spec from a seekable archive into out, which must be at
+// least packageByteCount bytes. packages points to the first package frame of the file.
+bool decompressPackage(struct ArchiveSpec const& spec,
+        const uint8_t* packages, size_t packagesSize, uint8_t* out);
+
 UTILS_WARNING_PUSH
 UTILS_WARNING_ENABLE_PADDED
 
@@ -46,6 +63,19 @@ struct ReadableArchive {
     };
 };
 
+// Archives of this version and later are seekable: each package is compressed in its own zstd
+// frame, so that it can be decompressed only when needed, and they have an ArchiveIndex.
+static constexpr uint32_t SEEKABLE_ARCHIVE_VERSION = 1;
+
+static constexpr uint32_t ARCHIVE_MAGIC = 'U' << 24 | 'B' << 16 | 'E' << 8 | 'R';  // "UBER"
+
+// The version written by WritableArchive.
+static constexpr uint32_t ARCHIVE_VERSION = SEEKABLE_ARCHIVE_VERSION;
+
+inline bool isSeekable(ReadableArchive const* archive) {
+    return archive->version >= SEEKABLE_ARCHIVE_VERSION;
+}
+
 static constexpr Shading INVALID_SHADING_MODEL = (Shading) 0xff;
 static constexpr BlendingMode INVALID_BLENDING = (BlendingMode) 0xff;
 
@@ -60,7 +90,7 @@ struct ArchiveSpec {
     };
     union {
         uint8_t* package;
-        uint64_t packageOffset;
+        uint64_t packageOffset;     // relative to the first package frame in seekable archives
     };
 };
 
@@ -72,6 +102,35 @@ struct ArchiveFlag {
     ArchiveFeature value;
 };
 
+// Precomputed in seekable archives, this allows finding a suitable spec by comparing bitmasks
+// rather than flag names. Each feature flag used in the archive is assigned a bit, which is its
+// index in the features list.
+struct ArchiveIndex {
+    uint64_t featuresCount;
+    union {
+        struct ArchiveFeatureName* features;
+        uint64_t featuresOffset;
+    };
+    union {
+        struct ArchiveSpecMask* masks;  // one per spec
+        uint64_t masksOffset;
+    };
+};
+
+struct ArchiveFeatureName {
+    union {
+        const char* name;
+        uint64_t nameOffset;
+    };
+};
+
+struct ArchiveSpecMask {
+    uint64_t supported;     // features that are either OPTIONAL or REQUIRED
+    uint64_t required;      // features that are REQUIRED
+};
+
+static constexpr size_t MAX_ARCHIVE_FEATURE_COUNT = 64;
+
 UTILS_WARNING_POP
 
 } // namespace filament::uberz
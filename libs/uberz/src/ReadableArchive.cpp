@@ -17,6 +17,9 @@
 #include <uberz/ReadableArchive.h>
 
 #include <utils/debug.h>
+#include <utils/memalign.h>
+
+#include <zstd.h>
 
 using namespace filament;
 using namespace utils;
@@ -26,22 +29,80 @@ namespace filament::uberz {
 static_assert(sizeof(ReadableArchive) == 4 + 4 + 8 + 8);
 static_assert(sizeof(ArchiveSpec) == 1 + 1 + 2 + 4 + 8 + 8);
 static_assert(sizeof(ArchiveFlag) == 8 + 8);
+static_assert(sizeof(ArchiveIndex) == 8 + 8 + 8);
+static_assert(sizeof(ArchiveFeatureName) == 8);
+static_assert(sizeof(ArchiveSpecMask) == 8 + 8);
 
 void convertOffsetsToPointers(ReadableArchive* archive) {
     constexpr size_t wordSize = sizeof(uint64_t);
     assert_invariant(archive->specsOffset % wordSize == 0);
     uint64_t* basePointer = (uint64_t*) archive;
     archive->specs = (ArchiveSpec*) (basePointer + archive->specsOffset / wordSize);
+    const bool seekable = isSeekable(archive);
     for (uint64_t i = 0; i < archive->specsCount; ++i) {
         ArchiveSpec& spec = archive->specs[i];
         assert_invariant(spec.flagsOffset % wordSize == 0);
         spec.flags = (ArchiveFlag*) (basePointer + (spec.flagsOffset / wordSize));
-        spec.package = ((uint8_t*) basePointer) + spec.packageOffset;
+        if (!seekable) {
+            spec.package = ((uint8_t*) basePointer) + spec.packageOffset;
+        }
         for (uint64_t j = 0; j < spec.flagsCount; ++j) {
             ArchiveFlag& flag = spec.flags[j];
             flag.name = ((const char*) basePointer) + flag.nameOffset;
         }
     }
+    if (ArchiveIndex* index = getArchiveIndex(archive)) {
+        assert_invariant(index->featuresOffset % wordSize == 0);
+        assert_invariant(index->masksOffset % wordSize == 0);
+        index->features = (ArchiveFeatureName*) (basePointer + index->featuresOffset / wordSize);
+        index->masks = (ArchiveSpecMask*) (basePointer + index->masksOffset / wordSize);
+        for (uint64_t i = 0; i < index->featuresCount; ++i) {
+            ArchiveFeatureName& feature = index->features[i];
+            feature.name = ((const char*) basePointer) + feature.nameOffset;
+        }
+    }
+}
+
+ReadableArchive* readArchive(const void* data, size_t size, size_t* packagesOffset) {
+    const uint64_t decompSize = ZSTD_getFrameContentSize(data, size);
+    if (decompSize == ZSTD_CONTENTSIZE_UNKNOWN || decompSize == ZSTD_CONTENTSIZE_ERROR ||
+            decompSize < sizeof(ReadableArchive)) {
+        return nullptr;
+    }
+    const size_t frameSize = ZSTD_findFrameCompressedSize(data, size);
+    if (ZSTD_isError(frameSize)) {
+        return nullptr;
+    }
+    uint64_t* basePointer = (uint64_t*) utils::aligned_alloc(decompSize, 8);
+    const size_t result = ZSTD_decompress(basePointer, decompSize, data, frameSize);
+    ReadableArchive* archive = (ReadableArchive*) basePointer;
+    if (ZSTD_isError(result) || archive->magic != ARCHIVE_MAGIC) {
+        utils::aligned_free(basePointer);
+        return nullptr;
+    }
+    convertOffsetsToPointers(archive);
+    *packagesOffset = isSeekable(archive) ? frameSize : size;
+    return archive;
+}
+
+ArchiveIndex* getArchiveIndex(ReadableArchive* archive) {
+    // the index immediately follows the header
+    return isSeekable(archive) ? (ArchiveIndex*) (archive + 1) : nullptr;
+}
+
+bool decompressPackage(ArchiveSpec const& spec,
+        const uint8_t* packages, size_t packagesSize, uint8_t* out) {
+    if (spec.packageOffset >= packagesSize) {
+        return false;
+    }
+    const uint8_t* frame = packages + spec.packageOffset;
+    const size_t frameSize = ZSTD_findFrameCompressedSize(frame,
+            packagesSize - spec.packageOffset);
+    if (ZSTD_isError(frameSize)) {
+        return false;
+    }
+    const size_t result = ZSTD_decompress(out, spec.packageByteCount, frame, frameSize);
+    return !ZSTD_isError(result) && result == spec.packageByteCount;
 }
 
 } // namespace filament::uberz
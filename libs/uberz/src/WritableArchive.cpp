@@ -227,7 +227,21 @@ void WritableArchive::addSpecLine(string_view line) {
 }
 
 FixedCapacityVector<uint8_t> WritableArchive::serialize() const {
-    size_t byteCount = sizeof(ReadableArchive);
+    // Assign a bit to each feature flag, in order of first appearance.
+    tsl::robin_map<CString, uint32_t, CString::Hasher> featureBits;
+    for (const auto& mat : mMaterials) {
+        for (const auto& pair : mat.flags) {
+            featureBits.try_emplace(pair.first, uint32_t(featureBits.size()));
+        }
+    }
+    if (featureBits.size() > MAX_ARCHIVE_FEATURE_COUNT) {
+        PANIC_POSTCONDITION("Archives cannot have more than %zu feature flags.",
+                MAX_ARCHIVE_FEATURE_COUNT);
+    }
+
+    // The packages are not part of the metadata, they are compressed separately.
+    size_t byteCount = sizeof(ReadableArchive) + sizeof(ArchiveIndex);
+    const size_t specsOffset = byteCount;
     for (const auto& mat : mMaterials) {
         byteCount += sizeof(ArchiveSpec);
     }
@@ -237,22 +251,27 @@ FixedCapacityVector<uint8_t> WritableArchive::serialize() const {
             byteCount += sizeof(ArchiveFlag);
         }
     }
+    const size_t featuresOffset = byteCount;
+    byteCount += featureBits.size() * sizeof(ArchiveFeatureName);
+    const size_t masksOffset = byteCount;
+    byteCount += mMaterials.size() * sizeof(ArchiveSpecMask);
     size_t nameOffset = byteCount;
     for (const auto& mat : mMaterials) {
         for (const auto& pair : mat.flags) {
             byteCount += pair.first.size() + 1;
         }
     }
-    size_t filamatOffset = byteCount;
-    for (const auto& mat : mMaterials) {
-        byteCount += mat.package.size();
-    }
 
     ReadableArchive archive;
-    archive.magic = 'UBER';
-    archive.version = 0;
+    archive.magic = ARCHIVE_MAGIC;
+    archive.version = ARCHIVE_VERSION;
     archive.specsCount = mMaterials.size();
-    archive.specsOffset = sizeof(ReadableArchive);
+    archive.specsOffset = specsOffset;
+
+    ArchiveIndex index;
+    index.featuresCount = featureBits.size();
+    index.featuresOffset = featuresOffset;
+    index.masksOffset = masksOffset;
 
     auto specs = FixedCapacityVector<ArchiveSpec>::with_capacity(mMaterials.size());
     size_t flagCount = 0;
@@ -263,22 +282,38 @@ FixedCapacityVector<uint8_t> WritableArchive::serialize() const {
         spec.flagsCount = mat.flags.size();
         spec.flagsOffset = flaglistOffset + flagCount * sizeof(ArchiveFlag);
         spec.packageByteCount = mat.package.size();
-        spec.packageOffset = filamatOffset;
         specs.push_back(spec);
-        filamatOffset += mat.package.size();
         flagCount += mat.flags.size();
     }
 
     auto flags = FixedCapacityVector<ArchiveFlag>::with_capacity(flagCount);
+    ArchiveFeatureName unnamed;
+    unnamed.nameOffset = 0;
+    auto features = FixedCapacityVector<ArchiveFeatureName>(featureBits.size(), unnamed);
+    auto masks = FixedCapacityVector<ArchiveSpecMask>::with_capacity(mMaterials.size());
     size_t charCount = 0;
     for (const auto& mat : mMaterials) {
+        ArchiveSpecMask mask = {};
         for (const auto& pair : mat.flags) {
             ArchiveFlag flag;
             flag.nameOffset = nameOffset + charCount;
             flag.value = pair.second;
-            charCount += pair.first.size() + 1;
             flags.push_back(flag);
+
+            // features refer to the name of the first flag that uses them
+            const uint32_t bit = featureBits[pair.first];
+            if (features[bit].nameOffset == 0) {
+                features[bit].nameOffset = flag.nameOffset;
+            }
+            if (pair.second != ArchiveFeature::UNSUPPORTED) {
+                mask.supported |= uint64_t(1) << bit;
+            }
+            if (pair.second == ArchiveFeature::REQUIRED) {
+                mask.required |= uint64_t(1) << bit;
+            }
+            charCount += pair.first.size() + 1;
         }
+        masks.push_back(mask);
     }
 
     std::string flagNames(charCount, ' ');
@@ -295,20 +330,20 @@ FixedCapacityVector<uint8_t> WritableArchive::serialize() const {
     uint8_t* writeCursor = outputBuf.data();
     memcpy(writeCursor, &archive, sizeof(archive));
     writeCursor += sizeof(archive);
+    memcpy(writeCursor, &index, sizeof(index));
+    writeCursor += sizeof(index);
     memcpy(writeCursor, specs.data(), sizeof(ArchiveSpec) * specs.size());
     writeCursor += sizeof(ArchiveSpec) * specs.size();
     memcpy(writeCursor, flags.data(), sizeof(ArchiveFlag) * flags.size());
     writeCursor += sizeof(ArchiveFlag) * flags.size();
+    memcpy(writeCursor, features.data(), sizeof(ArchiveFeatureName) * features.size());
+    writeCursor += sizeof(ArchiveFeatureName) * features.size();
+    memcpy(writeCursor, masks.data(), sizeof(ArchiveSpecMask) * masks.size());
+    writeCursor += sizeof(ArchiveSpecMask) * masks.size();
     memcpy(writeCursor, flagNames.data(), charCount);
     writeCursor += charCount;
-    for (const auto& mat : mMaterials) {
-        memcpy(writeCursor, mat.package.data(), mat.package.size());
-        writeCursor += mat.package.size();
-    }
     assert_invariant(writeCursor - outputBuf.data() == outputBuf.size());
 
-    FixedCapacityVector<uint8_t> compressedBuf(ZSTD_compressBound(outputBuf.size()));
-
     // Maximum zstd compression is slow, but that's okay since uberz is invoked during the build,
     // not at run time.  However in debug builds it is debilitatingly slow, and we're fine with
     // larger archives, so we use minimum compression.
@@ -318,13 +353,37 @@ FixedCapacityVector<uint8_t> WritableArchive::serialize() const {
     const int compressionLevel = ZSTD_minCLevel();
 #endif
 
+    // The metadata and each package are compressed into their own frame, so that packages can
+    // be decompressed individually. Their offsets are patched into the metadata once known.
+    size_t compressedBound = ZSTD_compressBound(outputBuf.size());
+    for (const auto& mat : mMaterials) {
+        compressedBound += ZSTD_compressBound(mat.package.size());
+    }
+    FixedCapacityVector<uint8_t> packagesBuf(compressedBound);
+    size_t packagesSize = 0;
+    ArchiveSpec* outputSpecs = (ArchiveSpec*) (outputBuf.data() + specsOffset);
+    for (size_t i = 0; i < mMaterials.size(); ++i) {
+        const auto& package = mMaterials[i].package;
+        size_t zstdResult = ZSTD_compress(packagesBuf.data() + packagesSize,
+                packagesBuf.size() - packagesSize, package.data(), package.size(),
+                compressionLevel);
+        if (ZSTD_isError(zstdResult)) {
+            PANIC_POSTCONDITION("Error during archive compression: %s",
+                    ZSTD_getErrorName(zstdResult));
+        }
+        outputSpecs[i].packageOffset = packagesSize;
+        packagesSize += zstdResult;
+    }
+
+    FixedCapacityVector<uint8_t> compressedBuf(compressedBound);
     size_t zstdResult = ZSTD_compress(compressedBuf.data(), compressedBuf.size(), outputBuf.data(),
             outputBuf.size(), compressionLevel);
     if (ZSTD_isError(zstdResult)) {
         PANIC_POSTCONDITION("Error during archive compression: %s", ZSTD_getErrorName(zstdResult));
     }
+    memcpy(compressedBuf.data() + zstdResult, packagesBuf.data(), packagesSize);
 
-    compressedBuf.resize(zstdResult);
+    compressedBuf.resize(zstdResult + packagesSize);
     return compressedBuf;
 }
 
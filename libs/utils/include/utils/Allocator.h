@@ -218,6 +218,88 @@ public:
     }
 };
 
+/* ------------------------------------------------------------------------------------------------
+ * GrowingLinearAllocator
+ *
+ * This is a LinearAllocator that chains heap blocks when its area is exhausted. Unlike
+ * LinearAllocatorWithFallback, chained blocks are released by rewind(), so it can be used with
+ * an ArenaScope.
+ *
+ * Chained blocks are kept for the next time the allocator runs out of space, and are freed once
+ * the allocator has been emptied SHRINK_PERIOD times in a row without needing them.
+ * ------------------------------------------------------------------------------------------------
+ */
+class GrowingLinearAllocator {
+public:
+    static constexpr uint32_t SHRINK_PERIOD = 120;
+
+    GrowingLinearAllocator(void* begin, void* end) noexcept;
+
+    template <typename AREA>
+    explicit GrowingLinearAllocator(const AREA& area)
+        : GrowingLinearAllocator(area.begin(), area.end()) {
+    }
+
+    // Allocators can't be copied
+    GrowingLinearAllocator(const GrowingLinearAllocator& rhs) = delete;
+    GrowingLinearAllocator& operator=(const GrowingLinearAllocator& rhs) = delete;
+
+    // Allocators can be moved
+    GrowingLinearAllocator(GrowingLinearAllocator&& rhs) noexcept;
+    GrowingLinearAllocator& operator=(GrowingLinearAllocator&& rhs) noexcept;
+
+    ~GrowingLinearAllocator() noexcept;
+
+    // our allocator concept
+    void* alloc(size_t size, size_t alignment = alignof(std::max_align_t), size_t extra = 0) {
+        void* const p = current().alloc(size, alignment, extra);
+        return UTILS_LIKELY(p) ? p : grow(size, alignment, extra);
+    }
+
+    void *getCurrent() noexcept {
+        return current().getCurrent();
+    }
+
+    // free memory back to the specified point, which can be in any of the chained blocks
+    void rewind(void* p) noexcept;
+
+    // frees all allocated blocks
+    void reset() noexcept;
+
+    void free(void*, size_t) noexcept { }
+
+    void swap(GrowingLinearAllocator& rhs) noexcept;
+
+    // size of the area plus all the chained blocks, including the ones kept for reuse
+    size_t getCapacity() const noexcept;
+
+    // largest amount of memory in use at once since the last call to resetHighWatermark()
+    size_t getHighWatermark() const noexcept;
+    void resetHighWatermark() noexcept { mHighWatermark = 0; }
+
+    bool isHeapAllocation(void* p) const noexcept {
+        return p < mArea.base() || p >= pointermath::add(mArea.base(), mArea.allocated());
+    }
+
+private:
+    LinearAllocator& current() noexcept {
+        return UTILS_LIKELY(!mActiveBlockCount) ? mArea : mBlocks[mActiveBlockCount - 1];
+    }
+
+    size_t getUsed() const noexcept;
+    void* grow(size_t size, size_t alignment, size_t extra) noexcept;
+    void onEmpty() noexcept;
+    void freeBlocks(size_t first) noexcept;
+
+    LinearAllocator mArea;
+    // blocks [0, mActiveBlockCount) are in use, the others are kept for reuse
+    std::vector<LinearAllocator> mBlocks;
+    uint32_t mActiveBlockCount = 0;
+    uint32_t mQuietPeriodCount = 0;
+    bool mGrewInPeriod = false;
+    size_t mHighWatermark = 0;
+};
+
 // ------------------------------------------------------------------------------------------------
 
 class FreeList {
@@ -58,9 +58,12 @@ public:
     size_t getEntityCount() const noexcept;
 
     // Create n entities. Thread safe.
+    // This is much cheaper than creating entities one at a time, the lock is only taken once and,
+    // when possible, the entities are given a contiguous range of indices.
     void create(size_t n, Entity* entities);
 
     // destroys n entities. Thread safe.
+    // The lock is only taken once and listeners are notified once for all entities.
     void destroy(size_t n, Entity* entities) noexcept;
 
     // Create a new Entity. Thread safe.
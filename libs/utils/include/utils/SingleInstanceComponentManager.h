@@ -28,6 +28,7 @@
 #include <assert.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <algorithm>
 
 namespace utils {
 
@@ -116,6 +117,19 @@ public:
         return elementAt<ENTITY_INDEX>(i);
     }
 
+    // Make room for the given number of components, so that adding that many components doesn't
+    // reallocate the arrays or rehash the instance map.
+    void reserve(size_t componentCount) {
+        // the array has an extra dummy component at index 0
+        size_t const needed = componentCount + 1;
+        if (needed > mData.capacity()) {
+            // grow geometrically, so that repeated calls with a slowly increasing count
+            // don't reallocate the arrays each time.
+            mData.setCapacity(std::max(needed, mData.capacity() * 2));
+        }
+        mInstanceMap.reserve(componentCount);
+    }
+
     // Add a component to the given Entity. If the entity already has a component from this
     // manager, this function is a no-op.
     // This invalidates all pointers components.
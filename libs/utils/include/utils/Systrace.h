@@ -37,10 +37,18 @@
 #define FILAMENT_APPLE_SYSTRACE 0
 #endif
 
+// Systrace on Linux only records events when the FILAMENT_SYSTRACE environment variable is set,
+// and is cheap enough otherwise to be left enabled in release builds.
+#ifndef FILAMENT_LINUX_SYSTRACE
+#define FILAMENT_LINUX_SYSTRACE 1
+#endif
+
 #if defined(__ANDROID__)
 #include <utils/android/Systrace.h>
 #elif defined(__APPLE__) && FILAMENT_APPLE_SYSTRACE
 #include <utils/darwin/Systrace.h>
+#elif defined(__linux__) && FILAMENT_LINUX_SYSTRACE
+#include <utils/linux/Systrace.h>
 #else
 
 #define SYSTRACE_ENABLE()
@@ -77,6 +77,146 @@ void LinearAllocatorWithFallback::reset() noexcept {
     mHeapAllocations.clear();
 }
 
+// ------------------------------------------------------------------------------------------------
+// GrowingLinearAllocator
+// ------------------------------------------------------------------------------------------------
+
+static constexpr size_t MIN_CHAINED_BLOCK_SIZE = 64 * 1024;
+
+// p can be the end of a block if the block was full when p was returned by getCurrent()
+static bool contains(LinearAllocator const& allocator, void const* p) noexcept {
+    return p >= allocator.base() &&
+           p <= pointermath::add(allocator.base(), allocator.allocated());
+}
+
+static void rewindTo(LinearAllocator& allocator, void* p) noexcept {
+    if (p < pointermath::add(allocator.base(), allocator.allocated())) {
+        allocator.rewind(p);
+    }
+}
+
+GrowingLinearAllocator::GrowingLinearAllocator(void* begin, void* end) noexcept
+    : mArea(begin, end) {
+}
+
+GrowingLinearAllocator::GrowingLinearAllocator(GrowingLinearAllocator&& rhs) noexcept
+    : mArea(nullptr, nullptr) {
+    this->swap(rhs);
+}
+
+GrowingLinearAllocator& GrowingLinearAllocator::operator=(GrowingLinearAllocator&& rhs) noexcept {
+    if (this != &rhs) {
+        this->swap(rhs);
+    }
+    return *this;
+}
+
+GrowingLinearAllocator::~GrowingLinearAllocator() noexcept {
+    freeBlocks(0);
+}
+
+void GrowingLinearAllocator::swap(GrowingLinearAllocator& rhs) noexcept {
+    mArea.swap(rhs.mArea);
+    std::swap(mBlocks, rhs.mBlocks);
+    std::swap(mActiveBlockCount, rhs.mActiveBlockCount);
+    std::swap(mQuietPeriodCount, rhs.mQuietPeriodCount);
+    std::swap(mGrewInPeriod, rhs.mGrewInPeriod);
+    std::swap(mHighWatermark, rhs.mHighWatermark);
+}
+
+UTILS_NOINLINE
+void* GrowingLinearAllocator::grow(size_t size, size_t alignment, size_t extra) noexcept {
+    mHighWatermark = std::max(mHighWatermark, getUsed());
+    mGrewInPeriod = true;
+
+    size_t const required = size + alignment + extra;
+    if (mActiveBlockCount < mBlocks.size() && mBlocks[mActiveBlockCount].allocated() < required) {
+        // the blocks kept for reuse are too small for this allocation
+        freeBlocks(mActiveBlockCount);
+    }
+
+    if (mActiveBlockCount == mBlocks.size()) {
+        size_t const blockSize = std::max(required,
+                std::max(mArea.allocated() / 2, MIN_CHAINED_BLOCK_SIZE));
+        void* const p = ::malloc(blockSize);
+        if (UTILS_UNLIKELY(!p)) {
+            return nullptr;
+        }
+        mBlocks.emplace_back(p, pointermath::add(p, blockSize));
+    }
+
+    LinearAllocator& block = mBlocks[mActiveBlockCount++];
+    block.reset();
+    return block.alloc(size, alignment, extra);
+}
+
+void GrowingLinearAllocator::rewind(void* p) noexcept {
+    mHighWatermark = std::max(mHighWatermark, getUsed());
+
+    // release the blocks chained after the one p belongs to
+    while (mActiveBlockCount && !contains(mBlocks[mActiveBlockCount - 1], p)) {
+        mBlocks[--mActiveBlockCount].reset();
+    }
+
+    if (mActiveBlockCount) {
+        rewindTo(mBlocks[mActiveBlockCount - 1], p);
+    } else {
+        assert_invariant(contains(mArea, p));
+        rewindTo(mArea, p);
+        if (p == mArea.base()) {
+            onEmpty();
+        }
+    }
+}
+
+void GrowingLinearAllocator::reset() noexcept {
+    mHighWatermark = std::max(mHighWatermark, getUsed());
+    while (mActiveBlockCount) {
+        mBlocks[--mActiveBlockCount].reset();
+    }
+    mArea.reset();
+    onEmpty();
+}
+
+void GrowingLinearAllocator::onEmpty() noexcept {
+    if (mGrewInPeriod) {
+        mQuietPeriodCount = 0;
+    } else if (!mBlocks.empty() && ++mQuietPeriodCount >= SHRINK_PERIOD) {
+        // we haven't needed the chained blocks for a while
+        freeBlocks(0);
+        mQuietPeriodCount = 0;
+    }
+    mGrewInPeriod = false;
+}
+
+void GrowingLinearAllocator::freeBlocks(size_t first) noexcept {
+    assert_invariant(first >= mActiveBlockCount);
+    for (size_t i = first, c = mBlocks.size(); i < c; i++) {
+        ::free(mBlocks[i].base());
+    }
+    mBlocks.erase(mBlocks.begin() + ptrdiff_t(first), mBlocks.end());
+}
+
+size_t GrowingLinearAllocator::getUsed() const noexcept {
+    size_t used = mArea.allocated() - mArea.available();
+    for (uint32_t i = 0; i < mActiveBlockCount; i++) {
+        used += mBlocks[i].allocated() - mBlocks[i].available();
+    }
+    return used;
+}
+
+size_t GrowingLinearAllocator::getCapacity() const noexcept {
+    size_t capacity = mArea.allocated();
+    for (auto const& block : mBlocks) {
+        capacity += block.allocated();
+    }
+    return capacity;
+}
+
+size_t GrowingLinearAllocator::getHighWatermark() const noexcept {
+    return std::max(mHighWatermark, getUsed());
+}
+
 // ------------------------------------------------------------------------------------------------
 // FreeList
 // ------------------------------------------------------------------------------------------------
@@ -219,8 +359,10 @@ void TrackingPolicy::Debug::onRewind(void* addr) noexcept {
     // we should never be here if mBase is nullptr because compilation would have failed when
     // Arena::onRewind() tries to call the underlying allocator's onReset()
     assert(mBase);
-    assert(addr >= mBase);
-    memset(addr, 0x55, uintptr_t(mBase) + mSize - uintptr_t(addr));
+    // with GrowingLinearAllocator we could get pointers outside the range
+    if (addr >= mBase && addr < pointermath::add(mBase, mSize)) {
+        memset(addr, 0x55, uintptr_t(mBase) + mSize - uintptr_t(addr));
+    }
 }
 
 } // namespace utils
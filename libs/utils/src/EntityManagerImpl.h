@@ -31,6 +31,7 @@
 #include <tsl/robin_map.h>
 #endif
 
+#include <algorithm>
 #include <deque>
 #include <mutex> // for std::lock_guard
 #include <vector>
@@ -60,41 +61,55 @@ public:
 
     UTILS_NOINLINE
     void create(size_t n, Entity* entities) {
-        Entity::Type index{};
         auto& freeList = mFreeList;
         uint8_t* const gens = mGens;
+        size_t i = 0;
 
         // this must be thread-safe, acquire the free-list mutex
         std::lock_guard<Mutex> const lock(mFreeListLock);
-        Entity::Type currentIndex = mCurrentIndex;
-        for (size_t i = 0; i < n; i++) {
-            // If we have more than a certain number of freed indices, get one from the list.
-            // this is a trade-off between how often we recycle indices and how large the free list
-            // can grow.
-            if (UTILS_UNLIKELY(currentIndex >= RAW_INDEX_COUNT || freeList.size() >= MIN_FREE_INDICES)) {
-
-                // this could only happen if we had gone through all the indices at least once
-                if (UTILS_UNLIKELY(freeList.empty())) {
-                    // return the null entity
-                    entities[i] = {};
-                    continue;
-                }
-
-                index = freeList.front();
-                freeList.pop_front();
-            } else {
-                // In the common case, we just grab the next index.
-                // This works only until all indices have been used once, at which point
-                // we're always in the slower case above. The idea is that we have enough indices
-                // that it doesn't happen in practice.
-                index = currentIndex++;
+
+        // If we have more than a certain number of freed indices, get them from the list.
+        // this is a trade-off between how often we recycle indices and how large the free list
+        // can grow.
+        for (; i < n && freeList.size() >= MIN_FREE_INDICES; i++) {
+            Entity::Type const index = freeList.front();
+            freeList.pop_front();
+            entities[i] = Entity{ makeIdentity(gens[index], index) };
+        }
+
+        // In the common case, we just grab the next range of indices.
+        // This works only until all indices have been used once, at which point
+        // we're always in the slower case below. The idea is that we have enough indices
+        // that it doesn't happen in practice.
+        Entity::Type const currentIndex = mCurrentIndex;
+        size_t const available = RAW_INDEX_COUNT - std::min<size_t>(currentIndex, RAW_INDEX_COUNT);
+        size_t const count = std::min(n - i, available);
+        for (size_t k = 0; k < count; k++) {
+            Entity::Type const index = Entity::Type(currentIndex + k);
+            entities[i + k] = Entity{ makeIdentity(gens[index], index) };
+        }
+        mCurrentIndex = Entity::Type(currentIndex + count);
+        i += count;
+
+        for (; i < n; i++) {
+            // this could only happen if we had gone through all the indices at least once
+            if (UTILS_UNLIKELY(freeList.empty())) {
+                // return the null entity
+                entities[i] = {};
+                continue;
             }
+            Entity::Type const index = freeList.front();
+            freeList.pop_front();
             entities[i] = Entity{ makeIdentity(gens[index], index) };
+        }
+
 #if FILAMENT_UTILS_TRACK_ENTITIES
-            mDebugActiveEntities.emplace(entities[i], CallStack::unwind(5));
-#endif
+        for (i = 0; i < n; i++) {
+            if (entities[i]) {
+                mDebugActiveEntities.emplace(entities[i], CallStack::unwind(5));
+            }
         }
-        mCurrentIndex = currentIndex;
+#endif
     }
 
     UTILS_NOINLINE
@@ -132,7 +147,11 @@ public:
         }
         lock.unlock();
 
-        // notify our listeners that some entities are being destroyed
+        if (UTILS_UNLIKELY(!n)) {
+            return;
+        }
+
+        // notify our listeners that some entities are being destroyed, all at once
         auto listeners = getListeners();
         for (auto const& l : listeners) {
             l->onEntitiesDestroyed(n, entities);
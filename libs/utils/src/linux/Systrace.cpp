@@ -0,0 +1,260 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <utils/Systrace.h>
+#include <utils/Log.h>
+#include <utils/Mutex.h>
+
+#if defined(__linux__) && !defined(__ANDROID__) && FILAMENT_LINUX_SYSTRACE
+
+#include <algorithm>
+#include <cinttypes>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace utils {
+namespace details {
+
+Systrace::GlobalState Systrace::sGlobalState = {};
+
+namespace {
+
+constexpr size_t DEFAULT_EVENT_COUNT = 65536;
+constexpr size_t MIN_EVENT_COUNT = 1024;
+
+struct Event {
+    uint64_t timestamp;     // CLOCK_MONOTONIC, in nanoseconds
+    int64_t value;          // counter value, cookie or frame number
+    uint8_t type;           // Systrace::Type
+    char name[47];          // truncated copy of the name, the source may be transient
+};
+
+static_assert(sizeof(Event) == 64);
+
+// Single-producer ring buffer, only the owning thread writes to it. Readers snapshot the events
+// and discard the ones that may have been overwritten while they were copied.
+struct ThreadBuffer {
+    explicit ThreadBuffer(size_t capacity)
+            : events(new Event[capacity]), mask(capacity - 1) {
+    }
+    std::unique_ptr<Event[]> events;
+    size_t const mask;
+    std::atomic<uint64_t> head = 0;
+    pid_t tid = 0;
+    char threadName[16] = {};
+};
+
+struct Registry {
+    Mutex lock;
+    // buffers are never freed, so that events of threads that have exited can still be written
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    std::string path;
+    size_t capacity = DEFAULT_EVENT_COUNT;
+    bool available = false;
+};
+
+// intentionally leaked, so it can be used until the very end of the process (e.g. by atexit)
+Registry& getRegistry() noexcept {
+    static Registry* const registry = new Registry;
+    return *registry;
+}
+
+thread_local ThreadBuffer* tBuffer = nullptr;
+
+ThreadBuffer* registerThread() noexcept {
+    Registry& registry = getRegistry();
+    auto buffer = std::make_unique<ThreadBuffer>(registry.capacity);
+    buffer->tid = pid_t(syscall(SYS_gettid));
+    pthread_getname_np(pthread_self(), buffer->threadName, sizeof(buffer->threadName));
+    ThreadBuffer* const p = buffer.get();
+    std::lock_guard<Mutex> const lock(registry.lock);
+    registry.buffers.push_back(std::move(buffer));
+    return p;
+}
+
+void writeString(FILE* file, const char* s) noexcept {
+    fputc('"', file);
+    for (; *s; s++) {
+        char const c = *s;
+        if (c == '"' || c == '\\') {
+            fputc('\\', file);
+            fputc(c, file);
+        } else {
+            fputc(uint8_t(c) < 0x20 ? ' ' : c, file);
+        }
+    }
+    fputc('"', file);
+}
+
+void writeEvent(FILE* file, Event const& e, pid_t pid, pid_t tid) noexcept {
+    double const ts = double(e.timestamp) / 1000.0;
+    switch (e.type) {
+        case Systrace::BEGIN:
+            fprintf(file, "{\"ph\":\"B\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"name\":",
+                    pid, tid, ts);
+            writeString(file, e.name);
+            fputs("}", file);
+            break;
+        case Systrace::END:
+            fprintf(file, "{\"ph\":\"E\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f}",
+                    pid, tid, ts);
+            break;
+        case Systrace::ASYNC_BEGIN:
+        case Systrace::ASYNC_END:
+            fprintf(file, "{\"ph\":\"%c\",\"cat\":\"async\",\"id\":%" PRId64
+                          ",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"name\":",
+                    e.type == Systrace::ASYNC_BEGIN ? 'b' : 'e', e.value, pid, tid, ts);
+            writeString(file, e.name);
+            fputs("}", file);
+            break;
+        case Systrace::COUNTER:
+            fprintf(file, "{\"ph\":\"C\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"name\":",
+                    pid, tid, ts);
+            writeString(file, e.name);
+            fprintf(file, ",\"args\":{\"value\":%" PRId64 "}}", e.value);
+            break;
+        case Systrace::FRAME:
+            fprintf(file, "{\"ph\":\"i\",\"s\":\"p\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,"
+                          "\"name\":\"frame\",\"args\":{\"frame\":%" PRId64 "}}",
+                    pid, tid, ts, e.value);
+            break;
+        default:
+            break;
+    }
+}
+
+void flushAtExit() noexcept {
+    Systrace::flush();
+}
+
+// Tracing is only made available by the FILAMENT_SYSTRACE environment variable, which is read
+// when the library is loaded.
+struct Initializer {
+    Initializer() noexcept {
+        const char* const path = getenv("FILAMENT_SYSTRACE");
+        if (!path || !*path) {
+            return;
+        }
+        Registry& registry = getRegistry();
+        registry.path = path;
+        if (const char* const count = getenv("FILAMENT_SYSTRACE_EVENTS")) {
+            size_t const n = std::max(size_t(strtoull(count, nullptr, 10)), MIN_EVENT_COUNT);
+            registry.capacity = size_t(1) << (64 - __builtin_clzll(n - 1));
+        }
+        registry.available = true;
+        atexit(flushAtExit);
+        Systrace::enable(SYSTRACE_TAG_ALWAYS);
+    }
+} sInitializer;
+
+} // anonymous namespace
+
+void Systrace::enable(uint32_t tags) noexcept {
+    if (getRegistry().available) {
+        sGlobalState.isTracingEnabled.fetch_or(tags, std::memory_order_relaxed);
+    }
+}
+
+void Systrace::disable(uint32_t tags) noexcept {
+    sGlobalState.isTracingEnabled.fetch_and(~tags, std::memory_order_relaxed);
+}
+
+void Systrace::record(Type type, const char* name, int64_t value) noexcept {
+    ThreadBuffer* buffer = tBuffer;
+    if (UTILS_UNLIKELY(!buffer)) {
+        buffer = tBuffer = registerThread();
+    }
+
+    timespec now; // NOLINT
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    uint64_t const head = buffer->head.load(std::memory_order_relaxed);
+    Event& e = buffer->events[head & buffer->mask];
+    e.timestamp = uint64_t(now.tv_sec) * 1000000000u + uint64_t(now.tv_nsec);
+    e.value = value;
+    e.type = type;
+    size_t i = 0;
+    if (name) {
+        for (; i < sizeof(e.name) - 1 && name[i]; i++) {
+            e.name[i] = name[i];
+        }
+    }
+    e.name[i] = '\0';
+    buffer->head.store(head + 1, std::memory_order_release);
+}
+
+bool Systrace::flush(const char* path) noexcept {
+    Registry& registry = getRegistry();
+    if (!registry.available) {
+        return false;
+    }
+
+    std::lock_guard<Mutex> const lock(registry.lock);
+
+    FILE* const file = fopen(path ? path : registry.path.c_str(), "w");
+    if (!file) {
+        slog.e << "Systrace: couldn't open " << (path ? path : registry.path.c_str()) << io::endl;
+        return false;
+    }
+
+    pid_t const pid = getpid();
+    size_t const capacity = registry.capacity;
+    std::vector<Event> events;
+    events.reserve(capacity);
+
+    fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", file);
+    bool first = true;
+    for (auto const& buffer : registry.buffers) {
+        fprintf(file, "%s{\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"name\":\"thread_name\","
+                      "\"args\":{\"name\":", first ? "" : ",\n", pid, buffer->tid);
+        writeString(file, buffer->threadName);
+        fputs("}}", file);
+        first = false;
+
+        // snapshot the ring buffer, the owning thread may still be writing to it
+        uint64_t const head = buffer->head.load(std::memory_order_acquire);
+        uint64_t const begin = head > capacity ? head - capacity : 0;
+        events.clear();
+        for (uint64_t i = begin; i < head; i++) {
+            events.push_back(buffer->events[i & buffer->mask]);
+        }
+
+        // the slot of the event being written when we finished may have been overwritten too
+        uint64_t const after = buffer->head.load(std::memory_order_acquire);
+        uint64_t const valid = after >= capacity ? after - capacity + 1 : 0;
+        for (uint64_t i = std::max(begin, valid); i < head; i++) {
+            fputs(",\n", file);
+            writeEvent(file, events[i - begin], pid, buffer->tid);
+        }
+    }
+    fputs("\n]}\n", file);
+
+    return fclose(file) == 0;
+}
+
+} // namespace details
+} // namespace utils
+
+#endif // __linux__ && !__ANDROID__ && FILAMENT_LINUX_SYSTRACE
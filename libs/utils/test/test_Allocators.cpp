@@ -284,6 +284,51 @@ TEST(AllocatorTest, ScopedStackArena) {
     allocator.getAllocator().reset();
 }
 
+TEST(AllocatorTest, GrowingLinearAllocator) {
+    using Allocator = Arena<GrowingLinearAllocator, LockingPolicy::NoLock>;
+    Allocator arena("GrowingLinearAllocator", 1024);
+    GrowingLinearAllocator& allocator = arena.getAllocator();
+    void* const base = arena.getCurrent();
+
+    {
+        ArenaScope<Allocator> scope(arena);
+        // allocations that don't fit in the area are chained
+        void* const p = scope.allocate(1024);
+        void* const q = scope.allocate(4096);
+        EXPECT_EQ(base, p);
+        EXPECT_NE(nullptr, q);
+        EXPECT_TRUE(allocator.isHeapAllocation(q));
+        EXPECT_GT(allocator.getCapacity(), 1024);
+
+        {
+            // nested scopes rewind into the chained block
+            ArenaScope<Allocator> nested(arena);
+            void* const r = nested.allocate(16);
+            EXPECT_TRUE(allocator.isHeapAllocation(r));
+        }
+        EXPECT_EQ(pointermath::add(q, 4096), arena.getCurrent());
+    }
+
+    // the scope released the chained block, but it's kept for reuse
+    EXPECT_EQ(base, arena.getCurrent());
+    EXPECT_GE(allocator.getHighWatermark(), 1024 + 4096 + 16);
+    size_t const capacity = allocator.getCapacity();
+    EXPECT_GT(capacity, 1024);
+
+    allocator.resetHighWatermark();
+    EXPECT_EQ(0, allocator.getHighWatermark());
+
+    // the chained block is freed after a quiet period
+    for (uint32_t i = 0; i < GrowingLinearAllocator::SHRINK_PERIOD; i++) {
+        ArenaScope<Allocator> scope(arena);
+        EXPECT_NE(nullptr, scope.allocate(512));
+        EXPECT_EQ(capacity, allocator.getCapacity());
+    }
+    arena.reset();
+    EXPECT_EQ(1024, allocator.getCapacity());
+    EXPECT_EQ(512, allocator.getHighWatermark());
+}
+
 TEST(AllocatorTest, STLAllocator) {
     struct Tracking {
         Tracking() noexcept { }
@@ -97,6 +97,44 @@ TEST(EntityTest, Free) {
     EXPECT_EQ(EntityManagerImpl::makeIdentity(1, 1), e.getId());
 }
 
+TEST(EntityTest, Bulk) {
+    struct Listener : public EntityManager::Listener {
+        void onEntitiesDestroyed(size_t n, Entity const*) noexcept override {
+            calls++;
+            count += n;
+        }
+        size_t calls = 0;
+        size_t count = 0;
+    } listener;
+
+    EntityManagerImpl em;
+    em.registerListener(&listener);
+
+    Entity entities[1030];
+    em.create(1030, entities);
+    em.destroy(1030, entities);
+
+    // all entities are reported at once
+    EXPECT_EQ(listener.calls, 1u);
+    EXPECT_EQ(listener.count, 1030u);
+
+    // the first entities are recycled until the free list is small enough, then the rest get a
+    // contiguous range of new indices
+    Entity more[10];
+    em.create(10, more);
+    for (size_t i = 0; i < 7; i++) {
+        EXPECT_EQ(EntityManagerImpl::makeIdentity(1, i + 1), more[i].getId());
+    }
+    for (size_t i = 7; i < 10; i++) {
+        EXPECT_EQ(EntityManagerImpl::makeIdentity(0, 1031 + i - 7), more[i].getId());
+        EXPECT_TRUE(em.isAlive(more[i]));
+    }
+
+    em.destroy(10, more);
+    EXPECT_EQ(listener.calls, 2u);
+    em.unregisterListener(&listener);
+}
+
 TEST(EntityTest, Lots) {
     EntityManagerImpl em;
     std::unique_ptr<Entity[]> entities(new Entity[EntityManager::getMaxEntityCount()]);
@@ -19,6 +19,9 @@
 
 #include <viewer/AutomationSpec.h>
 
+#include <string>
+#include <vector>
+
 namespace filament {
 
 class ColorGrading;
@@ -49,6 +52,12 @@ namespace viewer {
  * the first test case until the client unblocks it via signalBatchMode(). This is useful when
  * waiting for a large model file to become fully loaded. Batch mode also offers a query
  * (shouldClose) that is triggered after the last test has been invoked.
+ *
+ * Benchmark mode records the performance of each test: after a number of warm-up frames, it
+ * measures the CPU time of the frame, of the main thread and of the backend thread, the GPU frame
+ * time (where supported), the number of draw calls, and the high watermarks of the Engine's
+ * buffers. The results can be written to a JSON file with exportBenchmark() and checked against
+ * the results of a previous run with compareBenchmark().
  */
 class UTILS_PUBLIC AutomationEngine {
 public:
@@ -82,6 +91,40 @@ public:
          * If true, the tick function writes out a settings JSON file before advancing.
          */
         bool exportSettings = false;
+
+        /**
+         * If true, the tick function records performance statistics for each test.
+         * Tests last at least benchmarkWarmupFrameCount + benchmarkFrameCount frames.
+         */
+        bool benchmark = false;
+
+        /**
+         * In benchmark mode, number of frames rendered with the new settings before measuring.
+         */
+        int benchmarkWarmupFrameCount = 30;
+
+        /**
+         * In benchmark mode, number of frames measured for each test.
+         */
+        int benchmarkFrameCount = 120;
+    };
+
+    /**
+     * Tolerances used by compareBenchmark(). Relative tolerances are fractions of the baseline
+     * value, e.g. 0.1 allows a metric to be 10% worse than the baseline.
+     */
+    struct BenchmarkThresholds {
+        //! Relative tolerance of the median CPU and GPU times.
+        float time = 0.1f;
+
+        //! Time differences below this value, in milliseconds, are never reported.
+        float minTimeDelta = 0.1f;
+
+        //! Relative tolerance of the median number of draw calls.
+        float drawCalls = 0.0f;
+
+        //! Relative tolerance of the memory high watermarks.
+        float memory = 0.1f;
     };
 
     /**
@@ -227,6 +270,32 @@ public:
     static void exportScreenshot(View* view, Renderer* renderer, std::string filename,
             bool autoclose, AutomationEngine* automationEngine);
 
+    /**
+     * Writes out the results of benchmark mode to a JSON file. Times are in milliseconds and
+     * memory sizes in bytes.
+     *
+     * @param filename Desired JSON filename.
+     */
+    void exportBenchmark(const char* filename) const;
+
+    /**
+     * Returns the results of benchmark mode as a JSON string, see exportBenchmark().
+     */
+    std::string getBenchmarkJson() const;
+
+    /**
+     * Compares the results of benchmark mode with a baseline produced by exportBenchmark().
+     * Tests are matched by name, tests missing from the baseline are ignored. Each regression is
+     * logged as a warning.
+     *
+     * @param baselineJson JSON string produced by a previous run.
+     * @param size         Number of characters in the JSON string.
+     * @param thresholds   Tolerances for each metric.
+     * @return             false if the baseline can't be parsed or a metric regressed.
+     */
+    bool compareBenchmark(const char* baselineJson, size_t size,
+            BenchmarkThresholds const& thresholds) const;
+
     Options getOptions() const { return mOptions; }
     bool isRunning() const { return mIsRunning; }
     size_t currentTest() const { return mCurrentTest; }
@@ -236,6 +305,20 @@ public:
     ~AutomationEngine();
 
 private:
+    struct BenchmarkResult {
+        std::string name;
+        std::vector<float> cpuFrameTime;
+        std::vector<float> cpuMainThreadTime;
+        std::vector<float> cpuBackendThreadTime;
+        std::vector<float> gpuFrameTime;
+        std::vector<float> drawCalls;
+        size_t perRenderPassArenaHighWatermark = 0;
+        size_t perFrameCommandsHighWatermark = 0;
+        size_t commandBufferHighWatermark = 0;
+    };
+
+    void recordBenchmark(Engine* engine, Renderer* renderer, float deltaTime);
+
     AutomationSpec const * const mSpec;
     Settings * const mSettings;
     Options mOptions;
@@ -255,6 +338,9 @@ private:
     bool mTerminated = false;
     bool mOwnsSettings = false;
 
+    std::vector<BenchmarkResult> mBenchmarkResults;
+    uint32_t mLastFrameId = 0;
+
 public:
     // For internal use from a screenshot callback.
     void requestClose() { mShouldClose = true; }
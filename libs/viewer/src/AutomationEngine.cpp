@@ -14,8 +14,12 @@
  * limitations under the License.
  */
 
+#define JSMN_HEADER
+
 #include <viewer/AutomationEngine.h>
 
+#include "jsonParseUtils.h"
+
 #include <filament/Camera.h>
 #include <filament/Engine.h>
 #include <filament/Renderer.h>
@@ -26,9 +30,13 @@
 #include <utils/Log.h>
 #include <utils/Path.h>
 
+#include <algorithm>
 #include <iomanip>
 #include <fstream>
 #include <sstream>
+#include <unordered_map>
+
+#include <stdlib.h>
 
 using namespace utils;
 
@@ -97,6 +105,83 @@ void AutomationEngine::exportScreenshot(View* view, Renderer* renderer, std::str
             std::move(buffer));
 }
 
+static std::string getTestName(AutomationSpec const* spec, size_t index) {
+    const int digits = (int) log10 ((double) spec->size()) + 1;
+    std::ostringstream stringStream;
+    stringStream << spec->getName(index) << std::setfill('0') << std::setw(digits) << index;
+    return stringStream.str();
+}
+
+// Writes the statistics of a series of samples as a JSON object.
+static void writeStatistics(std::ostream& out, const char* name, std::vector<float> samples) {
+    if (samples.empty()) {
+        return;
+    }
+    std::sort(samples.begin(), samples.end());
+    double sum = 0;
+    for (float sample : samples) {
+        sum += sample;
+    }
+    const size_t count = samples.size();
+    out << ",\n      \"" << name << "\": { "
+        << "\"median\": " << samples[count / 2] << ", "
+        << "\"mean\": " << float(sum / double(count)) << ", "
+        << "\"min\": " << samples.front() << ", "
+        << "\"max\": " << samples.back() << ", "
+        << "\"p90\": " << samples[std::min(count - 1, count * 9 / 10)] << " }";
+}
+
+// Flattens the tests of a benchmark JSON file into "<test>/<metric>" keys. Only the median of
+// each statistic is kept, since it's the only one compared.
+static int parseBenchmark(jsmntok_t const* tokens, int i, const char* jsonChunk,
+        std::unordered_map<std::string, float>* out) {
+    CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+    int size = tokens[i++].size;
+    for (int j = 0; j < size; ++j) {
+        CHECK_KEY(tokens[i]);
+        if (compare(tokens[i], jsonChunk, "tests") != 0) {
+            i = parse(tokens, i + 1);
+            continue;
+        }
+        CHECK_TOKTYPE(tokens[++i], JSMN_ARRAY);
+        const int testCount = tokens[i++].size;
+        for (int k = 0; k < testCount; ++k) {
+            CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+            const int fieldCount = tokens[i++].size;
+            std::string name;
+            std::vector<std::pair<std::string, float>> metrics;
+            for (int f = 0; f < fieldCount; ++f) {
+                CHECK_KEY(tokens[i]);
+                const std::string key = STR(tokens[i], jsonChunk);
+                const jsmntok_t value = tokens[++i];
+                if (key == "name" && value.type == JSMN_STRING) {
+                    name = STR(value, jsonChunk);
+                } else if (value.type == JSMN_PRIMITIVE) {
+                    metrics.emplace_back(key, strtof(jsonChunk + value.start, nullptr));
+                } else if (value.type == JSMN_OBJECT) {
+                    for (int s = 0, c = value.size; s < c; ++s) {
+                        const jsmntok_t stat = tokens[i + 1 + s * 2];
+                        const jsmntok_t statValue = tokens[i + 2 + s * 2];
+                        if (compare(stat, jsonChunk, "median") == 0 &&
+                                statValue.type == JSMN_PRIMITIVE) {
+                            metrics.emplace_back(key,
+                                    strtof(jsonChunk + statValue.start, nullptr));
+                        }
+                    }
+                }
+                i = parse(tokens, i);
+                if (i < 0) {
+                    return i;
+                }
+            }
+            for (auto const& [key, value] : metrics) {
+                (*out)[name + "/" + key] = value;
+            }
+        }
+    }
+    return i;
+}
+
 AutomationEngine* AutomationEngine::createFromJSON(const char* jsonSpec, size_t size) {
     AutomationSpec* spec = AutomationSpec::generate(jsonSpec, size);
     if (!spec) {
@@ -197,11 +282,174 @@ ViewerOptions AutomationEngine::getViewerOptions() const {
     return mSettings->viewer;
 }
 
+void AutomationEngine::recordBenchmark(Engine* engine, Renderer* renderer, float deltaTime) {
+    BenchmarkResult& result = mBenchmarkResults.back();
+
+    // FrameInfo is available a few frames late, only consider frames we haven't seen yet.
+    auto const history = renderer->getFrameInfoHistory(1);
+    const bool hasFrameInfo = !history.empty() && history[0].frameId != mLastFrameId;
+    if (hasFrameInfo) {
+        mLastFrameId = history[0].frameId;
+    }
+
+    // The draw call count and the high watermarks are reset every time they're queried, so
+    // querying them during the warm-up frames discards the values of the previous test.
+    const size_t drawCalls = engine->getDrawCallCount();
+    const Engine::MemoryStatistics memory = engine->getMemoryStatistics();
+
+    if (mElapsedFrames <= mOptions.benchmarkWarmupFrameCount ||
+            mElapsedFrames > mOptions.benchmarkWarmupFrameCount + mOptions.benchmarkFrameCount) {
+        return;
+    }
+
+    result.cpuFrameTime.push_back(deltaTime * 1000.0f);
+    result.drawCalls.push_back(float(drawCalls));
+    result.perRenderPassArenaHighWatermark = std::max(
+            result.perRenderPassArenaHighWatermark, memory.perRenderPassArenaHighWatermark);
+    result.perFrameCommandsHighWatermark = std::max(
+            result.perFrameCommandsHighWatermark, memory.perFrameCommandsHighWatermark);
+    result.commandBufferHighWatermark = std::max(
+            result.commandBufferHighWatermark, memory.commandBufferHighWatermark);
+
+    if (hasFrameInfo) {
+        Renderer::FrameInfo const& info = history[0];
+        result.cpuMainThreadTime.push_back(float(info.endFrame - info.beginFrame) * 1e-6f);
+        result.cpuBackendThreadTime.push_back(
+                float(info.backendEndFrame - info.backendBeginFrame) * 1e-6f);
+        // the GPU frame time is not available on all backends
+        if (info.frameTime > 0) {
+            result.gpuFrameTime.push_back(float(info.frameTime) * 1e-6f);
+        }
+    }
+}
+
+std::string AutomationEngine::getBenchmarkJson() const {
+    std::ostringstream out;
+    out << "{\n  \"warmupFrameCount\": " << mOptions.benchmarkWarmupFrameCount
+        << ",\n  \"frameCount\": " << mOptions.benchmarkFrameCount
+        << ",\n  \"tests\": [";
+    for (size_t i = 0; i < mBenchmarkResults.size(); i++) {
+        BenchmarkResult const& result = mBenchmarkResults[i];
+        out << (i ? ",\n" : "\n") << "    {\n      \"name\": \"" << result.name << "\"";
+        writeStatistics(out, "cpuFrameTime", result.cpuFrameTime);
+        writeStatistics(out, "cpuMainThreadTime", result.cpuMainThreadTime);
+        writeStatistics(out, "cpuBackendThreadTime", result.cpuBackendThreadTime);
+        writeStatistics(out, "gpuFrameTime", result.gpuFrameTime);
+        writeStatistics(out, "drawCalls", result.drawCalls);
+        out << ",\n      \"perRenderPassArenaHighWatermark\": "
+            << result.perRenderPassArenaHighWatermark
+            << ",\n      \"perFrameCommandsHighWatermark\": "
+            << result.perFrameCommandsHighWatermark
+            << ",\n      \"commandBufferHighWatermark\": "
+            << result.commandBufferHighWatermark
+            << "\n    }";
+    }
+    out << "\n  ]\n}\n";
+    return out.str();
+}
+
+void AutomationEngine::exportBenchmark(const char* filename) const {
+    std::ofstream out(filename);
+    if (!out) {
+        gStatus = "Failed to export benchmark file.";
+        return;
+    }
+    out << getBenchmarkJson();
+    gStatus = "Exported to '" + std::string(filename) + "' in the current folder.";
+}
+
+bool AutomationEngine::compareBenchmark(const char* baselineJson, size_t size,
+        BenchmarkThresholds const& thresholds) const {
+    jsmn_parser parser = { 0, 0, 0 };
+    int tokenCount = jsmn_parse(&parser, baselineJson, size, nullptr, 0);
+    if (tokenCount <= 0) {
+        slog.e << "Badly formed benchmark baseline." << io::endl;
+        return false;
+    }
+    std::vector<jsmntok_t> tokens(tokenCount);
+    jsmn_init(&parser);
+    tokenCount = jsmn_parse(&parser, baselineJson, size, tokens.data(), tokenCount);
+
+    std::unordered_map<std::string, float> baseline;
+    if (tokenCount <= 0 || parseBenchmark(tokens.data(), 0, baselineJson, &baseline) < 0) {
+        slog.e << "Badly formed benchmark baseline." << io::endl;
+        return false;
+    }
+
+    enum class Kind { TIME, DRAW_CALLS, MEMORY };
+
+    size_t regressionCount = 0;
+    const auto check = [&](BenchmarkResult const& result, const char* metric, Kind kind,
+            float value) {
+        auto pos = baseline.find(result.name + "/" + metric);
+        if (pos == baseline.end()) {
+            return;
+        }
+        const float reference = pos->second;
+        bool regressed = false;
+        switch (kind) {
+            case Kind::TIME:
+                regressed = value > reference * (1.0f + thresholds.time) &&
+                        value - reference > thresholds.minTimeDelta;
+                break;
+            case Kind::DRAW_CALLS:
+                regressed = value > reference * (1.0f + thresholds.drawCalls);
+                break;
+            case Kind::MEMORY:
+                regressed = value > reference * (1.0f + thresholds.memory);
+                break;
+        }
+        if (regressed) {
+            slog.w << "Regression in " << result.name << ": " << metric << " is " << value
+                   << ", baseline is " << reference << io::endl;
+            regressionCount++;
+        }
+    };
+
+    const auto median = [](std::vector<float> samples) {
+        if (samples.empty()) {
+            return 0.0f;
+        }
+        std::nth_element(samples.begin(), samples.begin() + samples.size() / 2, samples.end());
+        return samples[samples.size() / 2];
+    };
+
+    for (BenchmarkResult const& result : mBenchmarkResults) {
+        if (!result.cpuFrameTime.empty()) {
+            check(result, "cpuFrameTime", Kind::TIME, median(result.cpuFrameTime));
+            check(result, "drawCalls", Kind::DRAW_CALLS, median(result.drawCalls));
+        }
+        if (!result.cpuMainThreadTime.empty()) {
+            check(result, "cpuMainThreadTime", Kind::TIME, median(result.cpuMainThreadTime));
+            check(result, "cpuBackendThreadTime", Kind::TIME,
+                    median(result.cpuBackendThreadTime));
+        }
+        if (!result.gpuFrameTime.empty()) {
+            check(result, "gpuFrameTime", Kind::TIME, median(result.gpuFrameTime));
+        }
+        check(result, "perRenderPassArenaHighWatermark", Kind::MEMORY,
+                float(result.perRenderPassArenaHighWatermark));
+        check(result, "perFrameCommandsHighWatermark", Kind::MEMORY,
+                float(result.perFrameCommandsHighWatermark));
+        check(result, "commandBufferHighWatermark", Kind::MEMORY,
+                float(result.commandBufferHighWatermark));
+    }
+
+    if (mOptions.verbose) {
+        slog.i << "Benchmark: " << regressionCount << " regression(s) in "
+               << mBenchmarkResults.size() << " test(s)" << io::endl;
+    }
+    return regressionCount == 0;
+}
+
 void AutomationEngine::tick(Engine* engine, const ViewerContent& content, float deltaTime) {
     const auto activateTest = [this, engine, content]() {
         mElapsedTime = 0;
         mElapsedFrames = 0;
         mSpec->get(mCurrentTest, mSettings);
+        if (mOptions.benchmark) {
+            mBenchmarkResults.push_back({ .name = getTestName(mSpec, mCurrentTest) });
+        }
         viewer::applySettings(engine, mSettings->view, content.view);
         for (size_t i = 0; i < content.materialCount; i++) {
             viewer::applySettings(engine, mSettings->material, content.materials[i]);
@@ -217,6 +465,7 @@ void AutomationEngine::tick(Engine* engine, const ViewerContent& content, float
                 mIsRunning = true;
                 mRequestStart = false;
                 mCurrentTest = 0;
+                mBenchmarkResults.clear();
                 activateTest();
             }
         }
@@ -226,17 +475,20 @@ void AutomationEngine::tick(Engine* engine, const ViewerContent& content, float
     mElapsedTime += deltaTime;
     mElapsedFrames++;
 
+    if (mOptions.benchmark && !mBenchmarkResults.empty()) {
+        recordBenchmark(engine, content.renderer, deltaTime);
+        if (mElapsedFrames < mOptions.benchmarkWarmupFrameCount + mOptions.benchmarkFrameCount) {
+            return;
+        }
+    }
+
     if (mElapsedTime < mOptions.sleepDuration || mElapsedFrames < mOptions.minFrameCount) {
         return;
     }
 
     const bool isLastTest = mCurrentTest == mSpec->size() - 1;
 
-    const int digits = (int) log10 ((double) mSpec->size()) + 1;
-    std::ostringstream stringStream;
-    stringStream << mSpec->getName(mCurrentTest)
-            << std::setfill('0') << std::setw(digits) << mCurrentTest;
-    std::string prefix = stringStream.str();
+    std::string prefix = getTestName(mSpec, mCurrentTest);
 
     if (mOptions.exportSettings) {
         std::string filename = prefix + ".json";
@@ -63,6 +63,7 @@
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <iterator>
 #include <set>
 #include <sstream>
 #include <string>
@@ -136,6 +137,9 @@ struct App {
     std::string messageBoxText;
     std::string settingsFile;
     std::string batchFile;
+    std::string baselineFile;
+    bool benchmark = false;
+    int exitCode = 0;
 
     AutomationSpec* automationSpec = nullptr;
     AutomationEngine* automationEngine = nullptr;
@@ -173,6 +177,12 @@ static void printUsage(char* name) {
         "       Start automation using the given JSON spec, then quit the app\n\n"
         "   --headless, -e\n"
         "       Use a headless swapchain; ignored if --batch is not present\n\n"
+        "   --benchmark, -k\n"
+        "       Measure the performance of each test of --batch and write it to benchmark.json\n"
+        "       instead of exporting screenshots and settings\n\n"
+        "   --baseline=<path to JSON file>, -l <path>\n"
+        "       Compare the results of --benchmark with a previous benchmark.json, and exit\n"
+        "       with a non-zero status if a metric regressed\n\n"
         "   --ibl=<path>, -i <path>\n"
         "       Override the built-in IBL\n"
         "       path can either be a directory containing IBL data files generated by cmgen,\n"
@@ -216,13 +226,15 @@ static std::ifstream::pos_type getFileSize(const char* filename) {
 }
 
 static int handleCommandLineArguments(int argc, char* argv[], App* app) {
-    static constexpr const char* OPTSTR = "ha:f:i:usc:rt:b:evg:";
+    static constexpr const char* OPTSTR = "ha:f:i:usc:rt:b:evg:kl:";
     static const struct option OPTIONS[] = {
         { "help",            no_argument,          nullptr, 'h' },
         { "api",             required_argument,    nullptr, 'a' },
         { "feature-level",   required_argument,    nullptr, 'f' },
         { "batch",           required_argument,    nullptr, 'b' },
         { "headless",        no_argument,          nullptr, 'e' },
+        { "benchmark",       no_argument,          nullptr, 'k' },
+        { "baseline",        required_argument,    nullptr, 'l' },
         { "ibl",             required_argument,    nullptr, 'i' },
         { "ubershader",      no_argument,          nullptr, 'u' },
         { "actual-size",     no_argument,          nullptr, 's' },
@@ -290,6 +302,12 @@ static int handleCommandLineArguments(int argc, char* argv[], App* app) {
             case 'e':
                 app->config.headless = true;
                 break;
+            case 'k':
+                app->benchmark = true;
+                break;
+            case 'l':
+                app->baselineFile = arg;
+                break;
             case 'i':
                 app->config.iblDirectory = arg;
                 break;
@@ -323,6 +341,14 @@ static int handleCommandLineArguments(int argc, char* argv[], App* app) {
         std::cerr << "--headless is allowed only when --batch is present." << std::endl;
         app->config.headless = false;
     }
+    if (app->benchmark && app->batchFile.empty()) {
+        std::cerr << "--benchmark is allowed only when --batch is present." << std::endl;
+        app->benchmark = false;
+    }
+    if (!app->baselineFile.empty() && !app->benchmark) {
+        std::cerr << "--baseline is allowed only when --benchmark is present." << std::endl;
+        app->baselineFile.clear();
+    }
     return optind;
 }
 
@@ -609,23 +635,9 @@ int main(int argc, char** argv) {
     }
 
     auto loadAsset = [&app](const utils::Path& filename) {
-        // Peek at the file size to allow pre-allocation.
-        long const contentSize = static_cast<long>(getFileSize(filename.c_str()));
-        if (contentSize <= 0) {
-            std::cerr << "Unable to open " << filename << std::endl;
-            exit(1);
-        }
-
-        // Consume the glTF file.
-        std::ifstream in(filename.c_str(), std::ifstream::binary | std::ifstream::in);
-        std::vector<uint8_t> buffer(static_cast<unsigned long>(contentSize));
-        if (!in.read((char*) buffer.data(), contentSize)) {
-            std::cerr << "Unable to read " << filename << std::endl;
-            exit(1);
-        }
-
-        // Parse the glTF file and create Filament entities.
-        app.asset = app.assetLoader->createAsset(buffer.data(), buffer.size());
+        // Map the glTF file and create Filament entities. The file stays mapped while its content
+        // is uploaded to the GPU, rather than being copied.
+        app.asset = app.assetLoader->createAssetFromFile(filename.c_str());
         if (!app.asset) {
             std::cerr << "Unable to parse " << filename << std::endl;
             exit(1);
@@ -760,8 +772,9 @@ int main(int argc, char** argv) {
             app.automationEngine->startBatchMode();
             auto options = app.automationEngine->getOptions();
             options.sleepDuration = 0.0;
-            options.exportScreenshots = true;
-            options.exportSettings = true;
+            options.exportScreenshots = !app.benchmark;
+            options.exportSettings = !app.benchmark;
+            options.benchmark = app.benchmark;
             app.automationEngine->setOptions(options);
             app.viewer->stopAnimation();
         }
@@ -1157,6 +1170,17 @@ int main(int argc, char** argv) {
             app.screenshot = false;
         }
         if (app.automationEngine->shouldClose()) {
+            if (app.benchmark) {
+                app.automationEngine->exportBenchmark("benchmark.json");
+                if (!app.baselineFile.empty()) {
+                    std::ifstream in(app.baselineFile, std::ifstream::binary | std::ifstream::in);
+                    std::string const json((std::istreambuf_iterator<char>(in)),
+                            std::istreambuf_iterator<char>());
+                    if (!app.automationEngine->compareBenchmark(json.data(), json.size(), {})) {
+                        app.exitCode = 1;
+                    }
+                }
+            }
             FilamentApp::get().close();
             return;
         }
@@ -1197,5 +1221,5 @@ int main(int argc, char** argv) {
 
     filamentApp.run(app.config, setup, cleanup, gui, preRender, postRender);
 
-    return 0;
+    return app.exitCode;
 }
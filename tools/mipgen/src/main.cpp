@@ -24,14 +24,20 @@
 #include <imageio/ImageDecoder.h>
 #include <imageio/ImageEncoder.h>
 
+#include <utils/JobSystem.h>
 #include <utils/Path.h>
 
 #include <getopt/getopt.h>
 
+#include <atomic>
 #include <fstream>
+#include <functional>
 #include <iostream>
+#include <mutex>
 #include <string>
 
+#include <string.h>
+
 using namespace image;
 using namespace std;
 using namespace utils;
@@ -58,6 +64,14 @@ static bool g_ktx2Container = false;
 static bool g_sourceIsLinear = false;
 static bool g_quietMode = false;
 static uint32_t g_mipLevelCount = 0;
+static bool g_cascade = false;
+
+// In cascade mode, each job resamples a band of roughly this many pixels of the source level.
+static constexpr uint32_t BAND_PIXELS = 1u << 20;
+
+// Number of extra rows of the target level that are resampled above and below each band, this
+// covers the support of the widest filter so that bands join seamlessly.
+static constexpr uint32_t BAND_MARGIN = 4;
 
 static const char* USAGE = R"TXT(
 MIPGEN generates mipmaps for an image down to the 1x1 level.
@@ -96,6 +110,12 @@ Options:
    --mip-levels=N, -m N
        specifies the number of mip levels to generate
        if 0 (default), all levels are generated
+   --cascade, -C
+       generate each level from the previous one, resampling horizontal bands in parallel,
+       and encode each level from a job while the next one is generated; this is faster on
+       large images, but the results differ slightly since the levels are no longer filtered
+       from the source; it doesn't bound memory, the source image is fully decoded and KTX
+       and KTX2 containers keep every level until the file is written
    --compression=COMPRESSION, -c COMPRESSION
        format specific compression:
            KTX, PNG, Radiance: Ignored
@@ -151,7 +171,7 @@ static void license() {
 }
 
 static int handleArguments(int argc, char* argv[]) {
-    static constexpr const char* OPTSTR = "hLlgpf:c:k:saqm:";
+    static constexpr const char* OPTSTR = "hLlgpf:c:k:saqm:C";
     static const struct option OPTIONS[] = {
             { "help",                 no_argument, 0, 'h' },
             { "license",              no_argument, 0, 'L' },
@@ -165,6 +185,7 @@ static int handleArguments(int argc, char* argv[]) {
             { "add-alpha",            no_argument, 0, 'a' },
             { "quiet",                no_argument, 0, 'q' },
             { "mip-levels",     required_argument, 0, 'm' },
+            { "cascade",              no_argument, 0, 'C' },
             { 0, 0, 0, 0 }  // termination of the option list
     };
 
@@ -259,12 +280,96 @@ static int handleArguments(int argc, char* argv[]) {
                     // keep default value
                 }
                 break;
+            case 'C':
+                g_cascade = true;
+                break;
         }
     }
 
     return optind;
 }
 
+// Downsamples the given level to the next one. When its height is even, the level is split into
+// horizontal bands which are resampled in parallel, otherwise it is resampled all at once.
+static LinearImage downsample(JobSystem& js, const LinearImage& source) {
+    const uint32_t swidth = source.getWidth();
+    const uint32_t sheight = source.getHeight();
+    const uint32_t width = max(swidth >> 1u, 1u);
+    const uint32_t height = max(sheight >> 1u, 1u);
+    const uint32_t bandRows = max(BAND_PIXELS / (swidth * 2), 16u);
+    if (sheight % 2 || height <= bandRows) {
+        return resampleImage(js, source, width, height, g_filter);
+    }
+
+    const uint32_t channels = source.getChannels();
+    const uint32_t bandCount = (height + bandRows - 1) / bandRows;
+    LinearImage result(width, height, channels);
+    auto resampleBand = [&](uint32_t band) {
+        const uint32_t first = band * bandRows;
+        const uint32_t last = min(first + bandRows, height);
+        const uint32_t top = first - min(first, BAND_MARGIN);
+        const uint32_t bottom = min(last + BAND_MARGIN, height);
+        LinearImage region = cropRegion(source, 0, top * 2, swidth, bottom * 2);
+        region = resampleImage(region, width, bottom - top, g_filter);
+        memcpy(result.getPixelRef(0, first), region.getPixelRef(0, first - top),
+                sizeof(float) * width * channels * (last - first));
+    };
+    auto* job = jobs::parallel_for(js, nullptr, 0, bandCount,
+            [&resampleBand](uint32_t start, uint32_t count) {
+                for (uint32_t band = start; band < start + count; ++band) {
+                    resampleBand(band);
+                }
+            }, jobs::CountSplitter<1>());
+    js.runAndWait(job);
+    return result;
+}
+
+// Generates the given number of miplevels and passes each one to the consumer, from jobs.
+// In cascade mode, a level is consumed while the next one is being generated, and is released
+// as soon as both are done.
+static bool generateLevels(JobSystem& js, const LinearImage& source, uint32_t count,
+        std::function<bool(uint32_t mip, const LinearImage& image)> const& consume) {
+    js.adopt();
+    std::atomic<bool> success = true;
+    if (!g_cascade) {
+        vector<LinearImage> miplevels(count);
+        generateMipmaps(js, source, g_filter, miplevels.data(), count);
+        auto* job = jobs::parallel_for(js, nullptr, 0, count,
+                [&](uint32_t start, uint32_t n) {
+                    for (uint32_t i = start; i < start + n; ++i) {
+                        if (!consume(i + 1, miplevels[i])) {
+                            success = false;
+                        }
+                    }
+                }, jobs::CountSplitter<1>());
+        js.runAndWait(job);
+        js.emancipate();
+        return success;
+    }
+
+    LinearImage level = source;
+    uint32_t mip = 0;
+    JobSystem::Job* pending = nullptr;
+    for (uint32_t n = 1; n <= count; ++n) {
+        LinearImage next = downsample(js, level);
+        if (pending) {
+            js.waitAndRelease(pending);
+        }
+        level = next;
+        mip = n;
+        pending = js.runAndRetain(jobs::createJob(js, nullptr, [&]() {
+            if (!consume(mip, level)) {
+                success = false;
+            }
+        }));
+    }
+    if (pending) {
+        js.waitAndRelease(pending);
+    }
+    js.emancipate();
+    return success;
+}
+
 int main(int argc, char* argv[]) {
     int optionIndex = handleArguments(argc, argv);
     int numArgs = argc - optionIndex;
@@ -323,8 +428,8 @@ int main(int argc, char* argv[]) {
 
     uint32_t count = getMipmapCount(sourceImage);
     count = g_mipLevelCount == 0 ? count : min(g_mipLevelCount - 1, count);
-    vector<LinearImage> miplevels(count);
-    generateMipmaps(sourceImage, g_filter, miplevels.data(), count);
+
+    JobSystem js;
 
     if (g_ktx1Container) {
         if (!g_quietMode) {
@@ -334,7 +439,7 @@ int main(int argc, char* argv[]) {
         // The libimage API does not include the original image in the mip array,
         // which might make sense when generating individual files, but for a KTX
         // bundle, we want to include level 0, so add 1 to the KTX level count.
-        Ktx1Bundle container(1 + miplevels.size(), 1, false);
+        Ktx1Bundle container(1 + count, 1, false);
         auto& info = container.info();
         info = {
             .endianness = Ktx1Bundle::ENDIAN_DEFAULT,
@@ -369,8 +474,8 @@ int main(int argc, char* argv[]) {
             cerr << "Compression not supported with KTX1." << endl;
             return 1;
         }
-        uint32_t mip = 0;
-        auto addLevel = [&](LinearImage image) {
+        std::mutex containerLock;
+        auto addLevel = [&](uint32_t mip, LinearImage image) {
             if (g_filter == Filter::GAUSSIAN_NORMALS) {
                 image = vectorsToColors(image);
             }
@@ -392,12 +497,14 @@ int main(int argc, char* argv[]) {
                     data = fromLinearTosRGB<uint8_t, 4>(image);
                 }
             }
-            container.setBlob({mip++, 0, 0}, data.get(), image.getWidth() * image.getHeight() *
+            std::lock_guard<std::mutex> const guard(containerLock);
+            container.setBlob({mip, 0, 0}, data.get(), image.getWidth() * image.getHeight() *
                     container.info().glTypeSize * componentCount);
+            return true;
         };
-        addLevel(sourceImage);
-        for (auto image : miplevels) {
-            addLevel(image);
+        addLevel(0, sourceImage);
+        if (!generateLevels(js, sourceImage, count, addLevel)) {
+            return 1;
         }
         vector<uint8_t> fileContents(container.getSerializedLength());
         container.serialize(fileContents.data(), fileContents.size());
@@ -416,10 +523,9 @@ int main(int argc, char* argv[]) {
             puts("Writing KTX2 file to disk...");
         }
 
-        BasisEncoder::Builder builder(miplevels.size() + 1, 1);
+        BasisEncoder::Builder builder(count + 1, 1);
         using IntermediateFormat = BasisEncoder::IntermediateFormat;
 
-        size_t mipIndex = 0;
         builder
             .intermediateFormat((g_ktxCompression == UASTC || g_ktxCompression == UASTC_NORMALS) ?
                     IntermediateFormat::UASTC : IntermediateFormat::ETC1S)
@@ -427,10 +533,18 @@ int main(int argc, char* argv[]) {
             .linear(g_sourceIsLinear)
             .quiet(g_quietMode)
             .normals(g_ktxCompression == ETC1S_NORMALS || g_ktxCompression == UASTC_NORMALS)
-            .miplevel(mipIndex++, 0, sourceImage);
-
-        for (auto image : miplevels) {
-            builder.miplevel(mipIndex++, 0, image);
+            .miplevel(0, 0, sourceImage);
+
+        // The builder converts each level to 8 bits as soon as it is added.
+        std::mutex builderLock;
+        bool const generated = generateLevels(js, sourceImage, count,
+                [&](uint32_t mip, const LinearImage& image) {
+                    std::lock_guard<std::mutex> const guard(builderLock);
+                    builder.miplevel(mip, 0, image);
+                    return true;
+                });
+        if (!generated) {
+            return 1;
         }
 
         BasisEncoder* encoder = builder.build();
@@ -460,13 +574,13 @@ int main(int argc, char* argv[]) {
         puts("Writing image files to disk...");
     }
 
-    char path[256];
-    uint32_t mip = 1; // start at 1 because 0 is the original image
-    for (auto image : miplevels) {
-        int result = snprintf(path, sizeof(path), outputPattern.c_str(), mip++);
+    // Levels are written from jobs, possibly out of order.
+    bool success = generateLevels(js, sourceImage, count, [&](uint32_t mip, LinearImage image) {
+        char path[256];
+        int result = snprintf(path, sizeof(path), outputPattern.c_str(), mip);
         if (result < 0 || result >= sizeof(path)) {
             cerr << "Output pattern is too long." << endl;
-            return 1;
+            return false;
         }
         Path(path).getParent().mkdirRecursive();
         ofstream outputStream(path, ios::binary | ios::trunc);
@@ -478,14 +592,18 @@ int main(int argc, char* argv[]) {
             }
             if (!ImageEncoder::encode(outputStream, g_format, image, g_compressionString, path)) {
                 cerr << "An error occurred while encoding the image." << endl;
-                return 1;
+                return false;
             }
             outputStream.close();
             if (!outputStream) {
                 cerr << "An error occurred while writing the output file: " << path << endl;
-                return 1;
+                return false;
             }
         }
+        return true;
+    });
+    if (!success) {
+        return 1;
     }
 
     if (g_createGallery) {
@@ -493,8 +611,8 @@ int main(int argc, char* argv[]) {
             puts("Generating mipmaps.html...");
         }
 
+        char path[256];
         char tag[256];
-        mip = 1;
         const char* pattern = R"(<image src="%s" width="%dpx" height="%dpx">)";
         const uint32_t width = sourceImage.getWidth();
         const uint32_t height = sourceImage.getHeight();
@@ -506,8 +624,8 @@ int main(int argc, char* argv[]) {
             return 1;
         }
         html << tag << std::endl;
-        for (auto image: miplevels) {
-            snprintf(path, sizeof(path), outputPattern.c_str(), mip++);
+        for (uint32_t mip = 1; mip <= count; ++mip) {
+            snprintf(path, sizeof(path), outputPattern.c_str(), mip);
             result = snprintf(tag, sizeof(tag), pattern, path, width, height);
             if (result < 0 || result >= sizeof(tag)) {
                 cerr << "Output pattern is too long." << endl;
@@ -30,7 +30,6 @@
 #include <uberz/ReadableArchive.h>
 #include <uberz/WritableArchive.h>
 
-#include <zstd.h>
 
 using namespace std;
 using namespace utils;
@@ -172,6 +171,8 @@ int main(int argc, char* argv[]) {
 
     size_t existingMaterialsCount = 0;
     ReadableArchive* existingArchive = nullptr;
+    FixedCapacityVector<uint8_t> existingPackages;
+    size_t packagesOffset = 0;
 
     // In append mode, the first step is to consume the output file.
     if (g_appendMode) {
@@ -183,14 +184,11 @@ int main(int argc, char* argv[]) {
             cerr << "Unable to consume " << g_outputFile << endl;
             exit(1);
         }
-        const uint64_t decompSize = ZSTD_getFrameContentSize(archiveData, archiveSize);
-        if (decompSize == ZSTD_CONTENTSIZE_UNKNOWN || decompSize == ZSTD_CONTENTSIZE_ERROR) {
+        existingArchive = readArchive(archiveData, archiveSize, &packagesOffset);
+        if (!existingArchive) {
             PANIC_POSTCONDITION("Decompression error.");
         }
-        uint64_t* basePointer = (uint64_t*) utils::aligned_alloc(decompSize, 8);
-        ZSTD_decompress(basePointer, decompSize, archiveData, archiveSize);
-        existingArchive = (ReadableArchive*) basePointer;
-        convertOffsetsToPointers(existingArchive);
+        existingPackages = std::move(archiveBuffer);
         existingMaterialsCount = existingArchive->specsCount;
     }
 
@@ -203,7 +201,17 @@ int main(int argc, char* argv[]) {
             // a made-up string (it is only used for error messages).
             std::string materialName = "mat" + to_string(specIndex);
             const ArchiveSpec& spec = existingArchive->specs[specIndex];
-            outputArchive.addMaterial(materialName.c_str(), spec.package, spec.packageByteCount);
+            if (isSeekable(existingArchive)) {
+                FixedCapacityVector<uint8_t> package(spec.packageByteCount);
+                if (!decompressPackage(spec, existingPackages.data() + packagesOffset,
+                        existingPackages.size() - packagesOffset, package.data())) {
+                    PANIC_POSTCONDITION("Decompression error.");
+                }
+                outputArchive.addMaterial(materialName.c_str(), package.data(), package.size());
+            } else {
+                outputArchive.addMaterial(materialName.c_str(), spec.package,
+                        spec.packageByteCount);
+            }
             outputArchive.setShadingModel(spec.shadingModel);
             outputArchive.setBlendingModel(spec.blendingMode);
             for (uint16_t flagIndex = 0; flagIndex < spec.flagsCount; ++flagIndex) {